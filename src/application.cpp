@@ -5,14 +5,73 @@
 #include "resource_manager.h"
 #include "shader_cache.h"
 #include "profiler.h"
+#include "frame_stats.h"
+#include "state_cache.h"
+#include "render_stats.h"
+#include "gl_debug.h"
 #include <iostream>
+#include <fstream>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
 
 namespace nimble
 {
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+// --trace <frames> captures a profiler trace of the given number of frames. --trace-delay <frames> postpones the capture by a fixed
+// number of frames and --trace-output <path> overrides the output file.
+static void parse_profiler_arguments(int argc, const char* argv[])
+{
+    uint32_t    trace_frames = 0;
+    uint32_t    trace_delay  = 0;
+    std::string trace_output = "trace.json";
+
+    for (int i = 1; i < argc - 1; i++)
+    {
+        if (strcmp(argv[i], "--trace") == 0)
+            trace_frames = uint32_t(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--trace-delay") == 0)
+            trace_delay = uint32_t(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--trace-output") == 0)
+            trace_output = argv[++i];
+        else if (strcmp(argv[i], "--frame-budget") == 0)
+            frame_stats::set_budget(float(atof(argv[++i])));
+    }
+
+    if (trace_frames > 0)
+        profiler::capture(trace_frames, trace_output, trace_delay);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// --headless renders offscreen without a window. --width <px> and --height <px> set the size of the default framebuffer,
+// --frames <n> exits after n frames and --frame-output <prefix> writes every frame to <prefix>_<frame>.ppm.
+static void parse_headless_arguments(int argc, const char* argv[], AppSettings& settings, uint32_t& frame_limit, std::string& frame_output)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--headless") == 0)
+            settings.headless = true;
+        else if (i + 1 < argc)
+        {
+            if (strcmp(argv[i], "--width") == 0)
+                settings.width = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--height") == 0)
+                settings.height = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--frames") == 0)
+                frame_limit = uint32_t(atoi(argv[++i]));
+            else if (strcmp(argv[i], "--frame-output") == 0)
+                frame_output = argv[++i];
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 Application::Application() :
-    m_mouse_x(0.0), m_mouse_y(0.0), m_last_mouse_x(0.0), m_last_mouse_y(0.0), m_mouse_delta_x(0.0), m_mouse_delta_y(0.0), m_delta(0.0), m_window(nullptr)
+    m_mouse_x(0.0), m_mouse_y(0.0), m_last_mouse_x(0.0), m_last_mouse_y(0.0), m_mouse_delta_x(0.0), m_mouse_delta_y(0.0), m_delta(0.0), m_window(nullptr), m_headless(false), m_exit_requested(false), m_frame_index(0), m_frame_limit(0), m_exit_code(0)
 {
 }
 
@@ -34,7 +93,7 @@ int Application::run(int argc, const char* argv[])
 
     shutdown_base();
 
-    return 0;
+    return m_exit_code;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -69,12 +128,15 @@ bool Application::init_base(int argc, const char* argv[])
     // Defaults
     AppSettings settings = intial_app_settings();
 
+    parse_headless_arguments(argc, argv, settings, m_frame_limit, m_frame_output);
+
     bool resizable    = settings.resizable;
     bool maximized    = settings.maximized;
     int  refresh_rate = settings.refresh_rate;
     m_width           = settings.width;
     m_height          = settings.height;
     m_title           = settings.title;
+    m_headless        = settings.headless;
 
     int major_ver = 4;
 #if defined(__APPLE__)
@@ -86,6 +148,78 @@ bool Application::init_base(int argc, const char* argv[])
     int minor_ver = 3;
 #endif
 
+#if __APPLE__
+    const char* glsl_version = "#version 150";
+#else
+    const char* glsl_version = "#version 130";
+#endif
+
+    if (m_headless)
+    {
+#if defined(NIMBLE_ENABLE_GL_DEBUG_OUTPUT)
+        bool debug_context = true;
+#else
+        bool debug_context = false;
+#endif
+
+        if (!m_headless_context.initialize(m_width, m_height, major_ver, minor_ver, debug_context))
+            return false;
+
+        NIMBLE_LOG_INFO("Successfully initialized headless platform!");
+
+        if (!gladLoadGLLoader((GLADloadproc)HeadlessContext::proc_address))
+            return false;
+    }
+    else if (!init_window(resizable, maximized, refresh_rate, major_ver, minor_ver))
+        return false;
+
+    gl_debug::initialize();
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    (void)io;
+    //io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;  // Enable Keyboard Controls
+    //io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;   // Enable Gamepad Controls
+
+    // Setup Dear ImGui style
+    ImGui::StyleColorsDark();
+    //ImGui::StyleColorsClassic();
+
+    // Setup Platform/Renderer bindings. Headless runs still build the UI so that application code does not have to care, it is just
+    // never drawn.
+    if (!m_headless)
+        ImGui_ImplGlfw_InitForOpenGL(m_window, true);
+
+    ImGui_ImplOpenGL3_Init(glsl_version);
+
+    if (!m_headless)
+    {
+        int display_w, display_h;
+        glfwGetFramebufferSize(m_window, &display_w, &display_h);
+        m_width  = display_w;
+        m_height = display_h;
+    }
+
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+    if (!m_debug_draw.init())
+        return false;
+
+    if (!init(argc, argv))
+        return false;
+
+    profiler::initialize();
+    parse_profiler_arguments(argc, argv);
+    m_renderer.initialize(&m_resource_manager, m_width, m_height);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Application::init_window(bool resizable, bool maximized, int refresh_rate, int major_ver, int minor_ver)
+{
     if (glfwInit() != GLFW_TRUE)
     {
         NIMBLE_LOG_FATAL("Failed to initialize GLFW");
@@ -101,11 +235,12 @@ bool Application::init_base(int argc, const char* argv[])
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
     glfwWindowHint(GLFW_SAMPLES, 8);
 
+#if defined(NIMBLE_ENABLE_GL_DEBUG_OUTPUT)
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+#endif
+
 #if __APPLE__
-    const char* glsl_version = "#version 150";
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#else
-    const char* glsl_version = "#version 130";
 #endif
 
     m_window = glfwCreateWindow(m_width, m_height, m_title.c_str(), nullptr, nullptr);
@@ -131,37 +266,6 @@ bool Application::init_base(int argc, const char* argv[])
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
         return false;
 
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImGuiIO& io = ImGui::GetIO();
-    (void)io;
-    //io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;  // Enable Keyboard Controls
-    //io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;   // Enable Gamepad Controls
-
-    // Setup Dear ImGui style
-    ImGui::StyleColorsDark();
-    //ImGui::StyleColorsClassic();
-
-    // Setup Platform/Renderer bindings
-    ImGui_ImplGlfw_InitForOpenGL(m_window, true);
-    ImGui_ImplOpenGL3_Init(glsl_version);
-
-    int display_w, display_h;
-    glfwGetFramebufferSize(m_window, &display_w, &display_h);
-    m_width  = display_w;
-    m_height = display_h;
-
-    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
-
-    if (!m_debug_draw.init())
-        return false;
-
-    if (!init(argc, argv))
-        return false;
-
-    profiler::initialize();
-    m_renderer.initialize(&m_resource_manager, m_width, m_height);
-
     return true;
 }
 
@@ -189,18 +293,29 @@ void Application::shutdown_base()
     // Shutdown debug draw.
     m_debug_draw.shutdown();
 
+    gl_debug::shutdown();
+
     // Shutdown ImGui.
     ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
+
+    if (!m_headless)
+        ImGui_ImplGlfw_Shutdown();
+
     ImGui::DestroyContext();
 
-    // Shutdown GLFW.
-    glfwDestroyWindow(m_window);
-    glfwTerminate();
+    if (m_headless)
+        m_headless_context.shutdown();
+    else
+    {
+        // Shutdown GLFW.
+        glfwDestroyWindow(m_window);
+        glfwTerminate();
+    }
 
     // Close logger streams.
     logger::close_file_stream();
     logger::close_console_stream();
+    logger::shutdown();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -209,12 +324,25 @@ void Application::begin_frame()
 {
     m_timer.start();
 
-    glfwPollEvents();
-
     ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
+
+    if (m_headless)
+    {
+        ImGuiIO& io = ImGui::GetIO();
+
+        io.DisplaySize = ImVec2(float(m_width), float(m_height));
+        io.DeltaTime   = m_delta > 0.0 ? float(m_delta / 1000.0) : 1.0f / 60.0f;
+    }
+    else
+    {
+        glfwPollEvents();
+        ImGui_ImplGlfw_NewFrame();
+    }
+
     ImGui::NewFrame();
     profiler::begin_frame();
+    state_cache::begin_frame();
+    render_stats::begin_frame();
 
     m_mouse_delta_x = m_mouse_x - m_last_mouse_x;
     m_mouse_delta_y = m_mouse_y - m_last_mouse_y;
@@ -229,9 +357,27 @@ void Application::end_frame()
 {
     profiler::end_frame();
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
-    glfwSwapBuffers(m_window);
+    if (m_headless)
+    {
+        if (!m_frame_output.empty())
+            write_frame();
+
+        m_headless_context.swap_buffers();
+    }
+    else
+    {
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+        glfwSwapBuffers(m_window);
+    }
+
+    m_frame_index++;
+
+    if (m_frame_limit > 0 && m_frame_index >= m_frame_limit)
+        request_exit();
+
+    gl_debug::flush();
 
     m_timer.stop();
     m_delta = m_timer.elapsed_time_milisec();
@@ -239,15 +385,50 @@ void Application::end_frame()
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-void Application::request_exit() const
+void Application::write_frame()
+{
+    std::vector<uint8_t> pixels(size_t(m_width) * size_t(m_height) * 3);
+
+    state_cache::bind_framebuffer(GL_READ_FRAMEBUFFER, 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, m_width, m_height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    char suffix[16];
+    snprintf(suffix, sizeof(suffix), "_%05u.ppm", m_frame_index);
+
+    std::string   path = m_frame_output + suffix;
+    std::ofstream f(path, std::ios::binary);
+
+    if (!f.is_open())
+    {
+        NIMBLE_LOG_ERROR("Failed to open frame output file: " + path);
+        return;
+    }
+
+    f << "P6\n" << m_width << " " << m_height << "\n255\n";
+
+    // OpenGL rows start at the bottom.
+    for (int32_t y = int32_t(m_height) - 1; y >= 0; y--)
+        f.write((const char*)&pixels[size_t(y) * m_width * 3], m_width * 3);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void Application::request_exit()
 {
-    glfwSetWindowShouldClose(m_window, true);
+    if (m_headless)
+        m_exit_requested = true;
+    else
+        glfwSetWindowShouldClose(m_window, true);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 bool Application::exit_requested() const
 {
+    if (m_headless)
+        return m_exit_requested;
+
     return glfwWindowShouldClose(m_window);
 }
 
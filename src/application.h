@@ -15,6 +15,7 @@
 #include "timer.h"
 #include "renderer.h"
 #include "resource_manager.h"
+#include "headless_context.h"
 
 // Main method macro. Use this at the bottom of any cpp file.
 #define NIMBLE_DECLARE_MAIN(class_name)    \
@@ -39,6 +40,7 @@ struct AppSettings
     int         width        = 800;
     int         height       = 600;
     std::string title        = "Nimble";
+    bool        headless     = false; // Render offscreen through EGL without creating a window.
 };
 
 class Application
@@ -79,9 +81,11 @@ protected:
     virtual void mouse_move(double x, double y, double deltaX, double deltaY);
 
     // Application exit related-methods. Self-explanatory.
-    void request_exit() const;
+    void request_exit();
     bool exit_requested() const;
 
+    inline bool is_headless() const { return m_headless; }
+
     // Life cycle hooks. Override these!
     virtual bool init(int argc, const char* argv[]);
     virtual void update(double delta);
@@ -94,9 +98,13 @@ private:
 
     // Internal lifecycle methods
     bool init_base(int argc, const char* argv[]);
+    bool init_window(bool resizable, bool maximized, int refresh_rate, int major_ver, int minor_ver);
     void update_base(double delta);
     void shutdown_base();
 
+    // Headless frames are read back from the default framebuffer and written as binary PPM files.
+    void write_frame();
+
 protected:
     uint32_t                            m_width;
     uint32_t                            m_height;
@@ -111,6 +119,13 @@ protected:
     std::array<bool, MAX_KEYS>          m_keys;
     std::array<bool, MAX_MOUSE_BUTTONS> m_mouse_buttons;
     GLFWwindow*                         m_window;
+    bool                                m_headless;
+    bool                                m_exit_requested;
+    HeadlessContext                     m_headless_context;
+    uint32_t                            m_frame_index;
+    uint32_t                            m_frame_limit;  // Exit after this many frames when non-zero.
+    std::string                         m_frame_output; // Prefix of the files frames are written to, empty to disable.
+    int                                 m_exit_code;    // Returned by run() once the application has shut down.
     Timer                               m_timer;
     DebugDraw                           m_debug_draw;
     ResourceManager                     m_resource_manager;
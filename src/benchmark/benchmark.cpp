@@ -0,0 +1,564 @@
+#include <fstream>
+#include <memory>
+#include <math.h>
+#include <float.h>
+#include <string.h>
+#include <json.hpp>
+#include "../application.h"
+#include "../camera.h"
+#include "../camera_path.h"
+#include "../scene_generator.h"
+#include "../render_graph.h"
+#include "../profiler.h"
+#include "../frame_stats.h"
+#include "../render_stats.h"
+#include "../nodes/forward_node.h"
+#include "../nodes/cubemap_skybox_node.h"
+#include "../nodes/pcf_point_light_depth_node.h"
+#include "../nodes/pcf_directional_light_depth_node.h"
+#include "../nodes/copy_node.h"
+#include "../nodes/g_buffer_node.h"
+#include "../nodes/deferred_node.h"
+#include "../nodes/tone_map_node.h"
+#include "../nodes/bloom_node.h"
+#include "../nodes/ssao_node.h"
+#include "../nodes/hiz_node.h"
+#include "../nodes/adaptive_exposure_node.h"
+#include "../nodes/motion_blur_node.h"
+#include "../nodes/volumetric_light_node.h"
+#include "../nodes/screen_space_reflection_node.h"
+#include "../nodes/reflection_node.h"
+#include "../nodes/fxaa_node.h"
+#include "../nodes/depth_of_field_node.h"
+#include "../nodes/taa_node.h"
+#include "../probe_renderer/bruneton_probe_renderer.h"
+
+namespace nimble
+{
+#define CAMERA_FAR_PLANE 5000.0f
+
+// GPU times arrive a few frames late, give up if the measured window has not filled up this many frames after it should have.
+#define MAX_RESOLVE_FRAMES 64
+
+#define EXIT_CODE_ERROR 1
+#define EXIT_CODE_REGRESSION 2
+
+// Renders a scene along a fixed camera path with a fixed timestep and jitter sequence, so that two runs submit exactly the same
+// work, and reports the CPU and GPU time of the frame and of every profiler sample over the measured frames. Runs headless, on
+// llvmpipe the GPU times are CPU work as well, which makes relative regressions visible on any Linux machine.
+//
+// --scene <path>          Scene to load, relative to the assets directory.
+// --generate              Benchmark a procedurally generated scene instead, sized by the --gen-* options (see scene_generator.cpp).
+// --graph <path>          Scene render graph, relative to the assets directory.
+// --camera-path <path>    Camera path recorded from the editor. Without one the camera orbits the scene once.
+// --warmup <n>            Frames rendered before measuring.
+// --measure-frames <n>    Frames measured.
+// --timestep <ms>         Fixed frame time passed to the renderer and used to advance the camera path.
+// --seed <n>              First index into the camera jitter sequence.
+// --report <path>         JSON report. --report-csv <path> additionally writes the summaries as CSV.
+// --baseline <path>       Report of an earlier run to compare against. Exits with 2 if a median regressed by more than
+//                         --tolerance (relative, default 0.1) and --min-delta (absolute ms, default 0.05).
+class Benchmark : public Application
+{
+protected:
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool init(int argc, const char* argv[]) override
+    {
+        parse_arguments(argc, argv);
+
+        if (scene_generator::parse_arguments(argc, argv, m_generator_settings))
+        {
+            m_scene           = scene_generator::generate(m_generator_settings);
+            m_scene_path      = m_scene->name();
+            m_generated_scene = true;
+        }
+        else
+        {
+            m_scene = m_resource_manager.load_scene(m_scene_path);
+
+            if (!m_scene)
+            {
+                NIMBLE_LOG_FATAL("Failed to load benchmark scene: " + m_scene_path);
+                return false;
+            }
+
+            m_scene->create_directional_light(glm::vec3(45.0f, 0.0f, 0.0f), glm::vec3(1.0f), 10.0f);
+        }
+
+        if (!create_render_graphs())
+            return false;
+
+        create_camera();
+
+        if (!m_camera_path_file.empty())
+        {
+            if (!m_camera_path.load(m_camera_path_file))
+                return false;
+        }
+        else
+            m_camera_path = CameraPath::orbit(m_scene->aabb(), float(m_warmup_frames + m_measure_frames) * m_timestep / 1000.0f);
+
+        // Every frame of a software rasterizer would count as a hitch.
+        frame_stats::set_budget(FLT_MAX);
+        frame_stats::set_window_size(m_measure_frames);
+        render_stats::set_enabled(true);
+
+        NIMBLE_LOG_INFO("Benchmarking " + m_scene_path + " with " + m_graph_path + ": " + std::to_string(m_warmup_frames) + " warmup frames, " + std::to_string(m_measure_frames) + " measured frames");
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void update(double delta) override
+    {
+        // The frame time of the machine is ignored, everything advances by the fixed timestep. Frames reach the statistics once their
+        // GPU times are resolved, a few frames late, so the statistics are limited to the profiler frames of the measured range. Warmup
+        // frames that resolve after this point and frames rendered while waiting for the last measured one are left out.
+        if (m_frame == m_warmup_frames)
+        {
+            frame_stats::set_window_size(m_measure_frames);
+            frame_stats::set_frame_range(profiler::frame_number(), m_measure_frames);
+            frame_stats::clear_hitches();
+        }
+
+        float time     = float(m_frame) * m_timestep / 1000.0f;
+        float duration = m_camera_path.duration();
+
+        if (duration > 0.0f)
+            time = fmodf(time, duration);
+
+        // Generated scenes animate on the unwrapped time so that the dynamic entities keep moving across camera path loops.
+        if (m_generated_scene)
+            scene_generator::animate(m_scene.get(), float(m_frame) * m_timestep / 1000.0f);
+
+        m_camera_path.apply(time, m_scene->camera().get());
+        m_scene->update();
+        m_renderer.render(m_timestep);
+
+        m_frame++;
+
+        if (m_frame <= m_warmup_frames)
+            return;
+
+        if (frame_stats::frame_count() >= m_measure_frames)
+            finish();
+        else if (m_frame > m_warmup_frames + m_measure_frames + MAX_RESOLVE_FRAMES)
+        {
+            NIMBLE_LOG_ERROR("Only " + std::to_string(frame_stats::frame_count()) + " of " + std::to_string(m_measure_frames) + " frames were measured");
+            fail();
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void shutdown() override
+    {
+        m_forward_graph.reset();
+        m_scene.reset();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    AppSettings intial_app_settings() override
+    {
+        AppSettings settings;
+
+        settings.resizable = false;
+        settings.width     = 1280;
+        settings.height    = 720;
+        settings.title     = "Nimble Benchmark";
+        settings.headless  = true;
+
+        return settings;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+private:
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void parse_arguments(int argc, const char* argv[])
+    {
+        for (int i = 1; i < argc - 1; i++)
+        {
+            if (strcmp(argv[i], "--scene") == 0)
+                m_scene_path = argv[++i];
+            else if (strcmp(argv[i], "--graph") == 0)
+                m_graph_path = argv[++i];
+            else if (strcmp(argv[i], "--camera-path") == 0)
+                m_camera_path_file = argv[++i];
+            else if (strcmp(argv[i], "--warmup") == 0)
+                m_warmup_frames = uint32_t(atoi(argv[++i]));
+            else if (strcmp(argv[i], "--measure-frames") == 0)
+                m_measure_frames = std::max(uint32_t(atoi(argv[++i])), 1u);
+            else if (strcmp(argv[i], "--timestep") == 0)
+                m_timestep = float(atof(argv[++i]));
+            else if (strcmp(argv[i], "--seed") == 0)
+                m_seed = uint32_t(atoi(argv[++i]));
+            else if (strcmp(argv[i], "--report") == 0)
+                m_report_path = argv[++i];
+            else if (strcmp(argv[i], "--report-csv") == 0)
+                m_report_csv_path = argv[++i];
+            else if (strcmp(argv[i], "--baseline") == 0)
+                m_baseline_path = argv[++i];
+            else if (strcmp(argv[i], "--tolerance") == 0)
+                m_tolerance = float(atof(argv[++i]));
+            else if (strcmp(argv[i], "--min-delta") == 0)
+                m_min_delta = float(atof(argv[++i]));
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void create_camera()
+    {
+        std::shared_ptr<Camera> camera = m_scene->camera();
+
+        camera->m_upscale_jitter = m_forward_graph->is_upscaled();
+        camera->m_width          = m_forward_graph->rendered_viewport_width();
+        camera->m_height         = m_forward_graph->rendered_viewport_height();
+        camera->m_index          = m_seed;
+
+        camera->update_projection(60.0f, 0.1f, CAMERA_FAR_PLANE, float(m_width) / float(m_height));
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool create_render_graphs()
+    {
+        REGISTER_RENDER_NODE(ForwardNode, m_resource_manager);
+        REGISTER_RENDER_NODE(CubemapSkyboxNode, m_resource_manager);
+        REGISTER_RENDER_NODE(PCFPointLightDepthNode, m_resource_manager);
+        REGISTER_RENDER_NODE(PCFDirectionalLightDepthNode, m_resource_manager);
+        REGISTER_RENDER_NODE(CopyNode, m_resource_manager);
+        REGISTER_RENDER_NODE(GBufferNode, m_resource_manager);
+        REGISTER_RENDER_NODE(DeferredNode, m_resource_manager);
+        REGISTER_RENDER_NODE(ToneMapNode, m_resource_manager);
+        REGISTER_RENDER_NODE(BloomNode, m_resource_manager);
+        REGISTER_RENDER_NODE(SSAONode, m_resource_manager);
+        REGISTER_RENDER_NODE(HiZNode, m_resource_manager);
+        REGISTER_RENDER_NODE(AdaptiveExposureNode, m_resource_manager);
+        REGISTER_RENDER_NODE(MotionBlurNode, m_resource_manager);
+        REGISTER_RENDER_NODE(VolumetricLightNode, m_resource_manager);
+        REGISTER_RENDER_NODE(ScreenSpaceReflectionNode, m_resource_manager);
+        REGISTER_RENDER_NODE(ReflectionNode, m_resource_manager);
+        REGISTER_RENDER_NODE(FXAANode, m_resource_manager);
+        REGISTER_RENDER_NODE(DepthOfFieldNode, m_resource_manager);
+        REGISTER_RENDER_NODE(TAANode, m_resource_manager);
+
+        m_forward_graph = m_resource_manager.load_render_graph(m_graph_path, &m_renderer);
+
+        if (!m_forward_graph)
+        {
+            NIMBLE_LOG_FATAL("Failed to load benchmark render graph: " + m_graph_path);
+            return false;
+        }
+
+        m_pcf_point_light_graph       = std::dynamic_pointer_cast<ShadowRenderGraph>(m_resource_manager.load_render_graph("graph/pcf_point_light_graph.json", &m_renderer));
+        m_pcf_spot_light_graph        = std::dynamic_pointer_cast<ShadowRenderGraph>(m_resource_manager.load_render_graph("graph/pcf_spot_light_graph.json", &m_renderer));
+        m_pcf_directional_light_graph = std::dynamic_pointer_cast<ShadowRenderGraph>(m_resource_manager.load_render_graph("graph/pcf_directional_light_graph.json", &m_renderer));
+        m_bruneton_probe_renderer     = std::make_shared<BrunetonProbeRenderer>();
+
+        m_renderer.set_scene(m_scene);
+
+        m_renderer.set_point_light_render_graph(m_pcf_point_light_graph);
+        m_renderer.set_spot_light_render_graph(m_pcf_spot_light_graph);
+        m_renderer.set_directional_light_render_graph(m_pcf_directional_light_graph);
+        m_renderer.set_global_probe_renderer(m_bruneton_probe_renderer);
+
+        m_renderer.set_scene_render_graph(m_forward_graph);
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    static nlohmann::json summary_to_json(const frame_stats::Summary& summary)
+    {
+        nlohmann::json j;
+
+        j["count"] = summary.count;
+        j["min"]   = summary.min;
+        j["mean"]  = summary.mean;
+        j["p50"]   = summary.p50;
+        j["p95"]   = summary.p95;
+        j["p99"]   = summary.p99;
+        j["max"]   = summary.max;
+
+        return j;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    static void write_csv_row(std::ofstream& f, const std::string& metric, const frame_stats::Summary& summary)
+    {
+        f << "\"" << metric << "\"," << summary.count << "," << summary.min << "," << summary.mean << "," << summary.p50 << "," << summary.p95 << "," << summary.p99 << "," << summary.max << "\n";
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    nlohmann::json build_report()
+    {
+        nlohmann::json report;
+
+        report["scene"]          = m_scene_path;
+        report["graph"]          = m_graph_path;
+        report["camera_path"]    = m_camera_path_file.empty() ? "orbit" : m_camera_path_file;
+        report["width"]          = m_width;
+        report["height"]         = m_height;
+        report["warmup_frames"]  = m_warmup_frames;
+        report["measure_frames"] = m_measure_frames;
+        report["timestep"]       = m_timestep;
+        report["seed"]           = m_seed;
+
+        if (m_generated_scene)
+        {
+            nlohmann::json generator;
+
+            generator["seed"]                       = m_generator_settings.seed;
+            generator["entity_count"]               = m_generator_settings.entity_count;
+            generator["instancing_ratio"]           = m_generator_settings.instancing_ratio;
+            generator["static_ratio"]               = m_generator_settings.static_ratio;
+            generator["material_count"]             = m_generator_settings.material_count;
+            generator["submesh_count"]              = m_generator_settings.submesh_count;
+            generator["point_light_count"]          = m_generator_settings.point_light_count;
+            generator["spot_light_count"]           = m_generator_settings.spot_light_count;
+            generator["directional_light_count"]    = m_generator_settings.directional_light_count;
+            generator["point_shadow_casters"]       = m_generator_settings.point_shadow_casters;
+            generator["spot_shadow_casters"]        = m_generator_settings.spot_shadow_casters;
+            generator["directional_shadow_casters"] = m_generator_settings.directional_shadow_casters;
+            generator["extent"]                     = m_generator_settings.extent;
+
+            report["generator"] = generator;
+        }
+
+        report["frame"]["cpu"] = summary_to_json(frame_stats::cpu_summary());
+        report["frame"]["gpu"] = summary_to_json(frame_stats::gpu_summary());
+
+        std::vector<profiler::SampleID> ids;
+        frame_stats::sample_ids(ids);
+
+        nlohmann::json samples = nlohmann::json::array();
+
+        for (auto id : ids)
+        {
+            nlohmann::json sample;
+
+            sample["name"] = profiler::sample_name(id);
+            sample["cpu"]  = summary_to_json(frame_stats::sample_cpu_summary(id));
+            sample["gpu"]  = summary_to_json(frame_stats::sample_gpu_summary(id));
+
+            samples.push_back(sample);
+        }
+
+        report["samples"] = samples;
+
+        // The amount of work is deterministic, so these are identical between runs unless the renderer changed.
+        const render_stats::FrameStats& stats = render_stats::last_frame();
+
+        for (uint32_t i = 0; i < render_stats::COUNTER_COUNT; i++)
+            report["render_stats"][render_stats::counter_name(render_stats::Counter(i))] = stats.totals.values[i];
+
+        return report;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool write_report(const nlohmann::json& report)
+    {
+        std::ofstream f(m_report_path);
+
+        if (!f.is_open())
+        {
+            NIMBLE_LOG_ERROR("Failed to open benchmark report: " + m_report_path);
+            return false;
+        }
+
+        f << report.dump(4);
+
+        NIMBLE_LOG_INFO("Wrote benchmark report to " + m_report_path);
+
+        if (m_report_csv_path.empty())
+            return true;
+
+        std::ofstream csv(m_report_csv_path);
+
+        if (!csv.is_open())
+        {
+            NIMBLE_LOG_ERROR("Failed to open benchmark report: " + m_report_csv_path);
+            return false;
+        }
+
+        csv << "metric,count,min,mean,p50,p95,p99,max\n";
+
+        write_csv_row(csv, "frame.cpu", frame_stats::cpu_summary());
+        write_csv_row(csv, "frame.gpu", frame_stats::gpu_summary());
+
+        std::vector<profiler::SampleID> ids;
+        frame_stats::sample_ids(ids);
+
+        for (auto id : ids)
+        {
+            std::string name = profiler::sample_name(id);
+
+            write_csv_row(csv, name + ".cpu", frame_stats::sample_cpu_summary(id));
+            write_csv_row(csv, name + ".gpu", frame_stats::sample_gpu_summary(id));
+        }
+
+        NIMBLE_LOG_INFO("Wrote benchmark report to " + m_report_csv_path);
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Compares the medians of two summaries. Returns true on regression. Summaries without values, such as GPU times that were
+    // never resolved, are skipped.
+    bool compare(const std::string& metric, const nlohmann::json& current, const nlohmann::json& baseline)
+    {
+        if (current.find("p50") == current.end() || baseline.find("p50") == baseline.end())
+            return false;
+
+        if (current["count"].get<uint32_t>() == 0 || baseline["count"].get<uint32_t>() == 0)
+            return false;
+
+        float now  = current["p50"];
+        float then = baseline["p50"];
+
+        if (now > then * (1.0f + m_tolerance) && now - then > m_min_delta)
+        {
+            NIMBLE_LOG_ERROR("Regression in " + metric + ": " + std::to_string(then) + " ms -> " + std::to_string(now) + " ms");
+            return true;
+        }
+
+        NIMBLE_LOG_INFO(metric + ": " + std::to_string(then) + " ms -> " + std::to_string(now) + " ms");
+
+        return false;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Returns the number of regressed metrics, or -1 if the baseline could not be read.
+    int compare_to_baseline(const nlohmann::json& report)
+    {
+        std::ifstream f(m_baseline_path);
+
+        if (!f.is_open())
+        {
+            NIMBLE_LOG_ERROR("Failed to open benchmark baseline: " + m_baseline_path);
+            return -1;
+        }
+
+        nlohmann::json baseline = nlohmann::json::parse(f, nullptr, false);
+
+        if (baseline.is_discarded() || baseline.find("frame") == baseline.end())
+        {
+            NIMBLE_LOG_ERROR("Invalid benchmark baseline: " + m_baseline_path);
+            return -1;
+        }
+
+        if (baseline["scene"] != report["scene"] || baseline["graph"] != report["graph"] || baseline["width"] != report["width"] || baseline["height"] != report["height"])
+            NIMBLE_LOG_WARNING("Baseline was recorded with a different scene, graph or resolution");
+
+        int regressions = 0;
+
+        regressions += compare("frame.cpu", report["frame"]["cpu"], baseline["frame"]["cpu"]);
+        regressions += compare("frame.gpu", report["frame"]["gpu"], baseline["frame"]["gpu"]);
+
+        for (const auto& sample : report["samples"])
+        {
+            for (const auto& base : baseline["samples"])
+            {
+                if (base["name"] != sample["name"])
+                    continue;
+
+                std::string name = sample["name"];
+
+                regressions += compare(name + ".cpu", sample["cpu"], base["cpu"]);
+                regressions += compare(name + ".gpu", sample["gpu"], base["gpu"]);
+                break;
+            }
+        }
+
+        return regressions;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void finish()
+    {
+        nlohmann::json report = build_report();
+
+        const frame_stats::Summary cpu = frame_stats::cpu_summary();
+        const frame_stats::Summary gpu = frame_stats::gpu_summary();
+
+        NIMBLE_LOG_INFO("Frame CPU: " + std::to_string(cpu.p50) + " ms (p50), " + std::to_string(cpu.p95) + " ms (p95)");
+        NIMBLE_LOG_INFO("Frame GPU: " + std::to_string(gpu.p50) + " ms (p50), " + std::to_string(gpu.p95) + " ms (p95)");
+
+        if (!write_report(report))
+        {
+            fail();
+            return;
+        }
+
+        if (!m_baseline_path.empty())
+        {
+            int regressions = compare_to_baseline(report);
+
+            if (regressions < 0)
+            {
+                fail();
+                return;
+            }
+
+            if (regressions > 0)
+            {
+                NIMBLE_LOG_ERROR(std::to_string(regressions) + " metrics regressed by more than " + std::to_string(m_tolerance * 100.0f) + "%");
+                m_exit_code = EXIT_CODE_REGRESSION;
+            }
+        }
+
+        request_exit();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void fail()
+    {
+        m_exit_code = EXIT_CODE_ERROR;
+        request_exit();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+private:
+    std::string m_scene_path       = "scene/startup.json";
+    std::string m_graph_path       = "graph/deferred_graph.json";
+    std::string m_camera_path_file;
+    std::string m_report_path      = "benchmark.json";
+    std::string m_report_csv_path;
+    std::string m_baseline_path;
+    uint32_t    m_warmup_frames    = 60;
+    uint32_t    m_measure_frames   = 300;
+    float       m_timestep         = 1000.0f / 60.0f;
+    uint32_t    m_seed             = 0;
+    float       m_tolerance        = 0.1f;
+    float       m_min_delta        = 0.05f;
+    uint32_t    m_frame            = 0;
+    CameraPath  m_camera_path;
+
+    scene_generator::Settings m_generator_settings;
+    bool                      m_generated_scene = false;
+
+    std::shared_ptr<Scene>                 m_scene;
+    std::shared_ptr<RenderGraph>           m_forward_graph;
+    std::shared_ptr<ShadowRenderGraph>     m_pcf_point_light_graph;
+    std::shared_ptr<ShadowRenderGraph>     m_pcf_spot_light_graph;
+    std::shared_ptr<ShadowRenderGraph>     m_pcf_directional_light_graph;
+    std::shared_ptr<BrunetonProbeRenderer> m_bruneton_probe_renderer;
+};
+} // namespace nimble
+
+NIMBLE_DECLARE_MAIN(nimble::Benchmark)
\ No newline at end of file
@@ -0,0 +1,811 @@
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtc/matrix_transform.hpp>
+#include <json.hpp>
+#include "../logger.h"
+#include "../timer.h"
+#include "../ogl.h"
+#include "../geometry.h"
+#include "../murmur_hash.h"
+#include "../static_hash_map.h"
+#include "../packed_array.h"
+#include "../scene.h"
+#include "../renderer.h"
+#include "../render_graph.h"
+#include "../render_node.h"
+#include "../utility.h"
+#include "../headless_context.h"
+
+#define DEFAULT_MIN_TIME_MS 20.0
+#define DEFAULT_REPEATS 5
+#define MAX_CALIBRATION_ITERATIONS (1u << 24)
+
+#define BENCHMARK_SUBMESH_COUNT 4
+#define BENCHMARK_HASH_MAP_SIZE 1024
+#define BENCHMARK_PACKED_ARRAY_SIZE 4096
+#define BENCHMARK_UNIFORM_SETS 8
+
+// Microbenchmarks of the CPU hot paths, each run in isolation on synthetic data at several sizes. Only update_uniforms and the
+// uniform setters need a GL context, they are skipped unless --gl is passed, which creates one through EGL.
+//
+// --filter <text>     Only run benchmarks whose name contains the text.
+// --min-time <ms>     Minimum duration of a timed batch, the iteration count is doubled until a batch takes this long.
+// --repeats <n>       Timed batches per benchmark, the report contains their median and minimum.
+// --report <path>     Writes the results as JSON.
+// --gl                Also runs the benchmarks that need a GL context.
+namespace nimble
+{
+namespace micro_benchmark
+{
+// Results are added to this so that the compiler cannot remove the benchmarked work.
+static volatile uint64_t g_sink = 0;
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+struct Result
+{
+    std::string name;
+    uint32_t    size;
+    uint32_t    iterations;
+    double      median_ns; // Per call.
+    double      min_ns;
+    double      per_item_ns; // Median per call divided by the number of items processed by a call.
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+class Runner
+{
+public:
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool enabled(const std::string& name) const
+    {
+        return m_filter.empty() || name.find(m_filter) != std::string::npos;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Times fn, which processes the given number of items per call.
+    void run(const std::string& name, uint32_t size, uint32_t items, const std::function<void()>& fn)
+    {
+        if (!enabled(name))
+            return;
+
+        // Also warms up caches and lazily allocated storage.
+        uint32_t iterations = 1;
+
+        while (batch(fn, iterations) < m_min_time_ms * 1000.0 && iterations < MAX_CALIBRATION_ITERATIONS)
+            iterations *= 2;
+
+        std::vector<double> times;
+
+        for (uint32_t i = 0; i < m_repeats; i++)
+            times.push_back(batch(fn, iterations) * 1000.0 / double(iterations));
+
+        std::sort(times.begin(), times.end());
+
+        Result result;
+
+        result.name        = name;
+        result.size        = size;
+        result.iterations  = iterations;
+        result.median_ns   = times[times.size() / 2];
+        result.min_ns      = times.front();
+        result.per_item_ns = result.median_ns / double(std::max(items, 1u));
+
+        printf("%-40s %8u %10u %14.1f %14.1f %12.2f\n", name.c_str(), size, iterations, result.median_ns, result.min_ns, result.per_item_ns);
+        fflush(stdout);
+
+        m_results.push_back(result);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool write_report(const std::string& path)
+    {
+        std::ofstream f(path);
+
+        if (!f.is_open())
+        {
+            NIMBLE_LOG_ERROR("Failed to open microbenchmark report: " + path);
+            return false;
+        }
+
+        nlohmann::json results = nlohmann::json::array();
+
+        for (const auto& result : m_results)
+        {
+            nlohmann::json j;
+
+            j["name"]        = result.name;
+            j["size"]        = result.size;
+            j["iterations"]  = result.iterations;
+            j["median_ns"]   = result.median_ns;
+            j["min_ns"]      = result.min_ns;
+            j["per_item_ns"] = result.per_item_ns;
+
+            results.push_back(j);
+        }
+
+        nlohmann::json report;
+
+        report["min_time_ms"] = m_min_time_ms;
+        report["repeats"]     = m_repeats;
+        report["results"]     = results;
+
+        f << report.dump(4);
+
+        NIMBLE_LOG_INFO("Wrote microbenchmark report to " + path);
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+private:
+    // Returns the duration of the batch in microseconds.
+    static double batch(const std::function<void()>& fn, uint32_t iterations)
+    {
+        Timer timer;
+
+        timer.start();
+
+        for (uint32_t i = 0; i < iterations; i++)
+            fn();
+
+        timer.stop();
+
+        return timer.elapsed_time_microsec();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+public:
+    std::string         m_filter;
+    double              m_min_time_ms = DEFAULT_MIN_TIME_MS;
+    uint32_t            m_repeats     = DEFAULT_REPEATS;
+    std::vector<Result> m_results;
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Drives the private per-frame stages of the renderer, see the friend declaration in renderer.h.
+struct RendererAccess
+{
+    static void queue_culled_view(Renderer& renderer, const Frustum& frustum)
+    {
+        renderer.queue_culled_view(frustum);
+    }
+
+    static void queue_update_view(Renderer& renderer, View* view)
+    {
+        renderer.queue_update_view(view);
+    }
+
+    static void cull_scene(Renderer& renderer)
+    {
+        renderer.cull_scene();
+    }
+
+    static void update_uniforms(Renderer& renderer)
+    {
+        renderer.update_uniforms();
+    }
+
+    // The subset of Renderer::initialize that update_uniforms depends on.
+    static void create_uniform_buffers(Renderer& renderer)
+    {
+        renderer.m_per_view   = std::make_unique<ShaderStorageBuffer>(GL_DYNAMIC_DRAW, MAX_VIEWS * sizeof(PerViewUniforms));
+        renderer.m_per_entity = std::make_unique<UniformBuffer>(GL_DYNAMIC_DRAW, MAX_ENTITIES * sizeof(PerEntityUniforms));
+        renderer.m_per_scene  = std::make_unique<ShaderStorageBuffer>(GL_DYNAMIC_DRAW, sizeof(PerSceneUniforms));
+    }
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static const glm::mat4 kViewProj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f) * glm::lookAt(glm::vec3(0.0f, 10.0f, 50.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Entities spread around the origin so that roughly half of them are inside the default frustum. Meshes have no GL buffers, which
+// is all the CPU side of the renderer needs.
+static std::shared_ptr<Scene> create_scene(uint32_t num_entities)
+{
+    std::mt19937                          gen(0);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> rotation(0.0f, 360.0f);
+
+    std::vector<SubMesh> submeshes(BENCHMARK_SUBMESH_COUNT);
+
+    for (uint32_t i = 0; i < BENCHMARK_SUBMESH_COUNT; i++)
+    {
+        submeshes[i].index_count = 36;
+        submeshes[i].base_vertex = 0;
+        submeshes[i].base_index  = 0;
+        submeshes[i].min_extents = glm::vec3(-1.0f) + glm::vec3(float(i));
+        submeshes[i].max_extents = glm::vec3(1.0f) + glm::vec3(float(i));
+    }
+
+    std::shared_ptr<Mesh>  mesh  = std::make_shared<Mesh>("benchmark_mesh", glm::vec3(1.0f + BENCHMARK_SUBMESH_COUNT), glm::vec3(-1.0f), submeshes, nullptr, nullptr, nullptr);
+    std::shared_ptr<Scene> scene = std::make_shared<Scene>("benchmark_scene");
+
+    for (uint32_t i = 0; i < num_entities; i++)
+    {
+        Entity& e = scene->lookup_entity(scene->create_entity("entity_" + std::to_string(i)));
+
+        e.set_position(glm::vec3(position(gen), position(gen), position(gen)));
+        e.set_rotation(glm::vec3(rotation(gen), rotation(gen), rotation(gen)));
+        e.set_scale(glm::vec3(1.0f));
+
+        e.mesh = mesh;
+        e.transform.update();
+
+        e.obb.min      = mesh->aabb().min;
+        e.obb.max      = mesh->aabb().max;
+        e.obb.position = e.transform.position;
+
+#ifdef ENABLE_SUBMESH_CULLING
+        e.submesh_visibility_flags.resize(BENCHMARK_SUBMESH_COUNT);
+
+        for (uint32_t j = 0; j < BENCHMARK_SUBMESH_COUNT; j++)
+        {
+            Sphere sphere;
+
+            sphere.position = (submeshes[j].min_extents + submeshes[j].max_extents) / 2.0f + e.transform.position;
+            sphere.radius   = glm::length(submeshes[j].max_extents - submeshes[j].min_extents) / 2.0f;
+
+            e.submesh_spheres.push_back(sphere);
+        }
+#endif
+    }
+
+    scene->create_directional_light(glm::vec3(45.0f, 0.0f, 0.0f), glm::vec3(1.0f), 10.0f, true);
+
+    for (uint32_t i = 0; i < 32; i++)
+        scene->create_point_light(glm::vec3(position(gen), position(gen), position(gen)), glm::vec3(1.0f), 20.0f, 1.0f);
+
+    for (uint32_t i = 0; i < 8; i++)
+        scene->create_spot_light(glm::vec3(position(gen), position(gen), position(gen)), glm::vec3(rotation(gen), rotation(gen), 0.0f), glm::vec3(1.0f), 30.0f, 45.0f, 50.0f, 1.0f);
+
+    return scene;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void benchmark_scene(Runner& runner)
+{
+    const uint32_t sizes[] = { 64, 256, 1024 };
+
+    for (uint32_t size : sizes)
+    {
+        if (!runner.enabled("Scene::update") && !runner.enabled("Renderer::cull_scene"))
+            return;
+
+        std::shared_ptr<Scene> scene = create_scene(size);
+
+        // Every entity stays dirty, so each call updates all transforms.
+        runner.run("Scene::update", size, size, [&]() {
+            scene->update();
+        });
+
+        const uint32_t view_counts[] = { 1, 8 };
+
+        for (uint32_t views : view_counts)
+        {
+            std::unique_ptr<Renderer> renderer = std::make_unique<Renderer>();
+
+            renderer->set_scene(scene);
+
+            Frustum frustum;
+            frustum_from_matrix(frustum, kViewProj);
+
+            for (uint32_t i = 0; i < views; i++)
+                RendererAccess::queue_culled_view(*renderer, frustum);
+
+            runner.run("Renderer::cull_scene (" + std::to_string(views) + " views)", size, size * views, [&]() {
+                RendererAccess::cull_scene(*renderer);
+                g_sink += scene->entities()[0].visibility_flags;
+            });
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void benchmark_update_uniforms(Runner& runner)
+{
+    const uint32_t sizes[] = { 64, 256, 1024 };
+
+    if (!runner.enabled("Renderer::update_uniforms"))
+        return;
+
+    for (uint32_t size : sizes)
+    {
+        std::shared_ptr<Scene>    scene    = create_scene(size);
+        std::unique_ptr<Renderer> renderer = std::make_unique<Renderer>();
+
+        renderer->set_scene(scene);
+        RendererAccess::create_uniform_buffers(*renderer);
+
+        // The scene view plus the cascades of one directional light.
+        for (uint32_t i = 0; i < 5; i++)
+        {
+            View* view = renderer->allocate_view();
+
+            view->view_mat           = glm::lookAt(glm::vec3(0.0f, 10.0f, 50.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+            view->projection_mat     = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+            view->vp_mat             = kViewProj;
+            view->prev_vp_mat        = kViewProj;
+            view->inv_view_mat       = glm::inverse(view->view_mat);
+            view->inv_projection_mat = glm::inverse(view->projection_mat);
+            view->inv_vp_mat         = glm::inverse(kViewProj);
+            view->position           = glm::vec3(0.0f, 10.0f, 50.0f);
+            view->direction          = glm::vec3(0.0f, 0.0f, -1.0f);
+            view->jitter             = glm::vec4(0.0f);
+            view->near_plane         = 0.1f;
+            view->far_plane          = 1000.0f;
+
+            RendererAccess::queue_update_view(*renderer, view);
+        }
+
+        runner.run("Renderer::update_uniforms", size, size, [&]() {
+            RendererAccess::update_uniforms(*renderer);
+        });
+
+        glFinish();
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Shader prepends the #version directive.
+static const char* kUniformVertexSource = R"(
+uniform mat4 u_Model;
+uniform mat4 u_ViewProj;
+uniform vec4 u_Color;
+uniform vec4 u_Params;
+
+void main()
+{
+    gl_Position = u_ViewProj * u_Model * vec4(u_Params.xyz, 1.0);
+}
+)";
+
+static const char* kUniformFragmentSource = R"(
+uniform vec4      u_Color;
+uniform vec4      u_Albedo;
+uniform vec4      u_Emissive;
+uniform vec4      u_MetalRough;
+uniform sampler2D s_Albedo;
+
+out vec4 FS_OUT_Color;
+
+void main()
+{
+    FS_OUT_Color = u_Color * u_Albedo + u_Emissive * u_MetalRough.x + texture(s_Albedo, vec2(0.0));
+}
+)";
+
+static const UniformHandle kModelUniform      = NIMBLE_UNIFORM_HANDLE("u_Model");
+static const UniformHandle kViewProjUniform   = NIMBLE_UNIFORM_HANDLE("u_ViewProj");
+static const UniformHandle kColorUniform      = NIMBLE_UNIFORM_HANDLE("u_Color");
+static const UniformHandle kParamsUniform     = NIMBLE_UNIFORM_HANDLE("u_Params");
+static const UniformHandle kAlbedoUniform     = NIMBLE_UNIFORM_HANDLE("u_Albedo");
+static const UniformHandle kEmissiveUniform   = NIMBLE_UNIFORM_HANDLE("u_Emissive");
+static const UniformHandle kMetalRoughUniform = NIMBLE_UNIFORM_HANDLE("u_MetalRough");
+static const UniformHandle kAlbedoMapUniform  = NIMBLE_UNIFORM_HANDLE("s_Albedo");
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Setting the uniforms of a typical draw by name against setting them through precomputed handles.
+static void benchmark_uniforms(Runner& runner)
+{
+    if (!runner.enabled("Program::set_uniform"))
+        return;
+
+    std::unique_ptr<Shader> vs = std::make_unique<Shader>(GL_VERTEX_SHADER, kUniformVertexSource);
+    std::unique_ptr<Shader> fs = std::make_unique<Shader>(GL_FRAGMENT_SHADER, kUniformFragmentSource);
+
+    if (!vs->compiled() || !fs->compiled())
+    {
+        NIMBLE_LOG_ERROR("Failed to compile uniform benchmark shaders");
+        return;
+    }
+
+    Shader*                  shaders[] = { vs.get(), fs.get() };
+    std::unique_ptr<Program> program   = std::make_unique<Program>(2, shaders);
+
+    program->use();
+
+    glm::mat4 model       = glm::mat4(1.0f);
+    glm::mat4 view_proj   = kViewProj;
+    glm::vec4 color       = glm::vec4(1.0f);
+    glm::vec4 params      = glm::vec4(0.0f);
+    glm::vec4 albedo      = glm::vec4(1.0f);
+    glm::vec4 emissive    = glm::vec4(0.0f);
+    glm::vec4 metal_rough = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+
+    runner.run("Program::set_uniform (name)", BENCHMARK_UNIFORM_SETS, BENCHMARK_UNIFORM_SETS, [&]() {
+        params.x += 1.0f;
+
+        program->set_uniform("u_Model", model);
+        program->set_uniform("u_ViewProj", view_proj);
+        program->set_uniform("u_Color", color);
+        program->set_uniform("u_Params", params);
+        program->set_uniform("u_Albedo", albedo);
+        program->set_uniform("u_Emissive", emissive);
+        program->set_uniform("u_MetalRough", metal_rough);
+        program->set_uniform("s_Albedo", 0);
+    });
+
+    runner.run("Program::set_uniform (handle)", BENCHMARK_UNIFORM_SETS, BENCHMARK_UNIFORM_SETS, [&]() {
+        params.x += 1.0f;
+
+        program->set_uniform(kModelUniform, model);
+        program->set_uniform(kViewProjUniform, view_proj);
+        program->set_uniform(kColorUniform, color);
+        program->set_uniform(kParamsUniform, params);
+        program->set_uniform(kAlbedoUniform, albedo);
+        program->set_uniform(kEmissiveUniform, emissive);
+        program->set_uniform(kMetalRoughUniform, metal_rough);
+        program->set_uniform(kAlbedoMapUniform, 0);
+    });
+
+    glFinish();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void benchmark_geometry(Runner& runner)
+{
+    const uint32_t sizes[] = { 64, 1024, 16384 };
+
+    std::mt19937                          gen(0);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.28318f);
+
+    for (uint32_t size : sizes)
+    {
+        std::vector<glm::mat4> matrices(size);
+        std::vector<Frustum>   frustums(size);
+        std::vector<Sphere>    spheres(size);
+        std::vector<AABB>      aabbs(size);
+        std::vector<OBB>       obbs(size);
+
+        for (uint32_t i = 0; i < size; i++)
+        {
+            glm::vec3 p = glm::vec3(position(gen), position(gen), position(gen));
+
+            matrices[i] = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f) * glm::lookAt(p, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+            spheres[i].position = p;
+            spheres[i].radius   = 2.0f;
+
+            aabbs[i].min = p - glm::vec3(2.0f);
+            aabbs[i].max = p + glm::vec3(2.0f);
+
+            obbs[i].position    = p;
+            obbs[i].min         = glm::vec3(-2.0f);
+            obbs[i].max         = glm::vec3(2.0f);
+            obbs[i].orientation = glm::mat3(glm::rotate(glm::mat4(1.0f), angle(gen), glm::vec3(0.0f, 1.0f, 0.0f)));
+        }
+
+        runner.run("frustum_from_matrix", size, size, [&]() {
+            for (uint32_t i = 0; i < size; i++)
+                frustum_from_matrix(frustums[i], matrices[i]);
+
+            g_sink += uint64_t(frustums[size - 1].planes[0].distance);
+        });
+
+        Frustum frustum;
+        frustum_from_matrix(frustum, kViewProj);
+
+        runner.run("intersects (Frustum, Sphere)", size, size, [&]() {
+            uint32_t visible = 0;
+
+            for (uint32_t i = 0; i < size; i++)
+                visible += intersects(frustum, spheres[i]);
+
+            g_sink += visible;
+        });
+
+        runner.run("intersects (Frustum, AABB)", size, size, [&]() {
+            uint32_t visible = 0;
+
+            for (uint32_t i = 0; i < size; i++)
+                visible += intersects(frustum, aabbs[i]);
+
+            g_sink += visible;
+        });
+
+        runner.run("intersects (Frustum, OBB)", size, size, [&]() {
+            uint32_t visible = 0;
+
+            for (uint32_t i = 0; i < size; i++)
+                visible += intersects(frustum, obbs[i]);
+
+            g_sink += visible;
+        });
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void benchmark_containers(Runner& runner)
+{
+    const uint32_t sizes[] = { 64, 256, 1024 };
+
+    for (uint32_t size : sizes)
+    {
+        // Same key type and size as the framebuffer cache of the renderer.
+        using Map = StaticHashMap<uint64_t, uint32_t, BENCHMARK_HASH_MAP_SIZE>;
+
+        std::unique_ptr<Map>  map = std::make_unique<Map>();
+        std::vector<uint64_t> keys(size);
+
+        std::mt19937_64 gen(0);
+
+        for (uint32_t i = 0; i < size; i++)
+            keys[i] = gen();
+
+        runner.run("StaticHashMap::set/remove", size, size, [&]() {
+            for (uint32_t i = 0; i < size; i++)
+                map->set(keys[i], i);
+
+            for (uint32_t i = 0; i < size; i++)
+                map->remove(keys[i]);
+        });
+
+        for (uint32_t i = 0; i < size; i++)
+            map->set(keys[i], i);
+
+        runner.run("StaticHashMap::get", size, size, [&]() {
+            uint32_t sum = 0;
+
+            for (uint32_t i = 0; i < size; i++)
+            {
+                uint32_t value = 0;
+
+                if (map->get(keys[i], value))
+                    sum += value;
+            }
+
+            g_sink += sum;
+        });
+
+        struct Object
+        {
+            glm::mat4 transform;
+            uint64_t  flags;
+        };
+
+        std::unique_ptr<PackedArray<Object, BENCHMARK_PACKED_ARRAY_SIZE>> array = std::make_unique<PackedArray<Object, BENCHMARK_PACKED_ARRAY_SIZE>>();
+        std::vector<ID>                                                   ids(size);
+        std::vector<uint32_t>                                             order(size);
+
+        for (uint32_t i = 0; i < size; i++)
+            order[i] = i;
+
+        // Removing in random order exercises the swap with the last element.
+        std::shuffle(order.begin(), order.end(), gen);
+
+        runner.run("PackedArray::add/remove", size, size, [&]() {
+            for (uint32_t i = 0; i < size; i++)
+                ids[i] = array->add();
+
+            for (uint32_t i = 0; i < size; i++)
+                array->remove(ids[order[i]]);
+        });
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void benchmark_hash(Runner& runner)
+{
+    const uint32_t sizes[] = { 8, 64, 1024 };
+
+    for (uint32_t size : sizes)
+    {
+        std::vector<uint8_t> key(size);
+
+        for (uint32_t i = 0; i < size; i++)
+            key[i] = uint8_t(i * 31);
+
+        runner.run("murmur_hash_64", size, size, [&]() {
+            g_sink += murmur_hash_64(key.data(), size, 0);
+        });
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void benchmark_preprocess_shader(Runner& runner)
+{
+    const uint32_t sizes[] = { 100, 1000, 10000 };
+
+    for (uint32_t size : sizes)
+    {
+        std::string source = "#version 430 core\n\n";
+
+        for (uint32_t i = 0; i < size; i++)
+            source += "vec4 value_" + std::to_string(i) + " = texture(s_Texture, vec2(" + std::to_string(i) + ".0)); // Comment\n";
+
+        runner.run("utility::preprocess_shader", size, size, [&]() {
+            std::string includes;
+            std::string out;
+
+            utility::preprocess_shader("benchmark.glsl", source, includes, out);
+
+            g_sink += out.size();
+        });
+    }
+
+    // A real shader including the common headers from disk, if the assets are next to the executable.
+    std::string path = utility::path_for_resource("assets/shader/g_buffer/g_buffer_fs.glsl");
+    std::string source;
+
+    if (!runner.enabled("utility::preprocess_shader (g_buffer_fs)") || !utility::read_text(path, source))
+        return;
+
+    runner.run("utility::preprocess_shader (g_buffer_fs)", 1, 1, [&]() {
+        std::string includes;
+        std::string out;
+
+        utility::preprocess_shader(path, source, includes, out);
+
+        g_sink += includes.size() + out.size();
+    });
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Pass-through node used to build synthetic graphs. Never initialized or executed.
+class BenchmarkNode : public RenderNode
+{
+public:
+    BenchmarkNode(RenderGraph* graph, const std::string& name, bool has_inputs) :
+        RenderNode(graph), m_name(name), m_has_inputs(has_inputs)
+    {
+    }
+
+    void declare_connections() override
+    {
+        if (m_has_inputs)
+        {
+            register_input_render_target("Previous");
+            register_input_render_target("Source");
+        }
+
+        register_output_render_target("Color", 1280, 720, GL_TEXTURE_2D, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    }
+
+    bool        initialize(Renderer* renderer, ResourceManager* res_mgr) override { return true; }
+    void        execute(double delta, Renderer* renderer, Scene* scene, View* view) override {}
+    void        shutdown() override {}
+    std::string name() override { return m_name; }
+
+private:
+    std::string m_name;
+    bool        m_has_inputs;
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void benchmark_render_graph(Runner& runner)
+{
+    const uint32_t sizes[] = { 8, 32, 128 };
+
+    for (uint32_t size : sizes)
+    {
+        if (!runner.enabled("RenderGraph::build"))
+            return;
+
+        RenderGraph graph;
+
+        // A chain where every node also reads the output of the first one, the way post processing reads the G-Buffer.
+        std::vector<std::shared_ptr<RenderNode>> nodes;
+
+        for (uint32_t i = 0; i < size; i++)
+        {
+            std::shared_ptr<RenderNode> node = std::make_shared<BenchmarkNode>(&graph, "Node " + std::to_string(i), i > 0);
+
+            node->declare_connections();
+
+            if (i > 0)
+            {
+                node->set_input("Previous", nodes[i - 1]->find_output_render_target_slot("Color"), nodes[i - 1]);
+                node->set_input("Source", nodes[0]->find_output_render_target_slot("Color"), nodes[0]);
+            }
+
+            nodes.push_back(node);
+        }
+
+        runner.run("RenderGraph::build", size, size, [&]() {
+            graph.build(nodes.back());
+            g_sink += graph.node_count();
+        });
+
+        graph.clear();
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace micro_benchmark
+} // namespace nimble
+
+int main(int argc, const char* argv[])
+{
+    using namespace nimble;
+
+    logger::initialize();
+    logger::open_console_stream();
+
+    micro_benchmark::Runner runner;
+
+    bool        gl = false;
+    std::string report;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--gl") == 0)
+            gl = true;
+        else if (i + 1 < argc)
+        {
+            if (strcmp(argv[i], "--filter") == 0)
+                runner.m_filter = argv[++i];
+            else if (strcmp(argv[i], "--min-time") == 0)
+                runner.m_min_time_ms = atof(argv[++i]);
+            else if (strcmp(argv[i], "--repeats") == 0)
+                runner.m_repeats = std::max(uint32_t(atoi(argv[++i])), 1u);
+            else if (strcmp(argv[i], "--report") == 0)
+                report = argv[++i];
+        }
+    }
+
+    HeadlessContext context;
+
+    if (gl)
+    {
+        if (!context.initialize(64, 64, 4, 3, false) || !gladLoadGLLoader((GLADloadproc)HeadlessContext::proc_address))
+        {
+            NIMBLE_LOG_FATAL("Failed to create a GL context for the microbenchmarks");
+            return 1;
+        }
+    }
+
+    printf("%-40s %8s %10s %14s %14s %12s\n", "Benchmark", "Size", "Iterations", "Median (ns)", "Min (ns)", "Per Item (ns)");
+
+    micro_benchmark::benchmark_scene(runner);
+
+    if (gl)
+    {
+        micro_benchmark::benchmark_update_uniforms(runner);
+        micro_benchmark::benchmark_uniforms(runner);
+    }
+
+    micro_benchmark::benchmark_geometry(runner);
+    micro_benchmark::benchmark_containers(runner);
+    micro_benchmark::benchmark_hash(runner);
+    micro_benchmark::benchmark_preprocess_shader(runner);
+    micro_benchmark::benchmark_render_graph(runner);
+
+    int exit_code = 0;
+
+    if (!report.empty() && !runner.write_report(report))
+        exit_code = 1;
+
+    context.shutdown();
+    logger::close_console_stream();
+    logger::shutdown();
+
+    return exit_code;
+}
\ No newline at end of file
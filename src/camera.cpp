@@ -71,12 +71,12 @@ void Camera::reset(float fov, float near, float far, float aspect_ratio, glm::ve
     //m_bottom_plane.point = position;
     //m_bottom_plane.n = glm::vec3(glm::rotate(glm::mat4(1.0f), -angle, m_right)*glm::vec4(m_forward, 1.0f));
 
-    m_index             = 0;
-    m_half_pixel_jitter = false;
-    m_current_jitter    = glm::vec2(0.0f, 0.0f);
-    m_prev_jitter       = glm::vec2(0.0f, 0.0f);
-    m_width             = 0;
-    m_height            = 0;
+    m_index          = 0;
+    m_upscale_jitter = false;
+    m_current_jitter = glm::vec2(0.0f, 0.0f);
+    m_prev_jitter    = glm::vec2(0.0f, 0.0f);
+    m_width          = 0;
+    m_height         = 0;
 
     for (int i = 1; i <= HALTON_SAMPLES; i++)
         m_jitter_samples.push_back(glm::vec2((halton_sequence(2, i) - 0.5f), (halton_sequence(3, i) - 0.5f)));
@@ -195,14 +195,16 @@ bool Camera::aabb_inside_plane(Plane plane, glm::vec3 max_v, glm::vec3 min_v)
 
 void Camera::apply_jitter()
 {
-    if (m_half_pixel_jitter)
+    if (m_upscale_jitter)
     {
         glm::mat4 jitter;
 
         m_prev_jitter = m_current_jitter;
 
+        // m_width and m_height are the rendered resolution. The offsets span a whole rendered pixel (two NDC units per viewport) so
+        // that a temporal upscaler eventually sees samples at every sub-pixel position of the output.
         glm::vec2 halton = m_jitter_samples[m_index++ % (m_jitter_samples.size())];
-        m_current_jitter = glm::vec2(halton.x / float(m_width), halton.y / float(m_height));
+        m_current_jitter = glm::vec2(2.0f * halton.x / float(m_width), 2.0f * halton.y / float(m_height));
 
         jitter       = glm::translate(glm::mat4(1.0f), glm::vec3(m_current_jitter, 0.0f));
         m_projection = jitter * m_raw_projection;
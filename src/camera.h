@@ -48,7 +48,7 @@ struct Camera
 
     uint32_t               m_index;
     std::vector<glm::vec2> m_jitter_samples;
-    bool                   m_half_pixel_jitter;
+    bool                   m_upscale_jitter;
     glm::vec2              m_current_jitter;
     glm::vec2              m_prev_jitter;
     uint32_t               m_width;
@@ -0,0 +1,208 @@
+#include "camera_path.h"
+#include "camera.h"
+#include "logger.h"
+#include <gtc/matrix_transform.hpp>
+#include <fstream>
+#include <json.hpp>
+
+#define PI 3.14159265359
+
+namespace nimble
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+CameraPath::CameraPath()
+{
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+CameraPath::~CameraPath()
+{
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool CameraPath::load(const std::string& path)
+{
+    std::ifstream i(path);
+
+    if (!i.is_open())
+    {
+        NIMBLE_LOG_ERROR("Failed to open camera path: " + path);
+        return false;
+    }
+
+    nlohmann::json j = nlohmann::json::parse(i, nullptr, false);
+
+    if (j.is_discarded() || j.find("keyframes") == j.end())
+    {
+        NIMBLE_LOG_ERROR("Invalid camera path: " + path);
+        return false;
+    }
+
+    m_keyframes.clear();
+
+    for (auto& keyframe : j["keyframes"])
+    {
+        auto position    = keyframe["position"];
+        auto orientation = keyframe["orientation"];
+
+        add_keyframe(keyframe["time"],
+                     glm::vec3(position[0], position[1], position[2]),
+                     glm::quat(orientation[0], orientation[1], orientation[2], orientation[3]));
+    }
+
+    NIMBLE_LOG_INFO("Loaded camera path with " + std::to_string(m_keyframes.size()) + " keyframes from " + path);
+
+    return !m_keyframes.empty();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool CameraPath::save(const std::string& path) const
+{
+    std::ofstream o(path);
+
+    if (!o.is_open())
+    {
+        NIMBLE_LOG_ERROR("Failed to open camera path: " + path);
+        return false;
+    }
+
+    nlohmann::json keyframes = nlohmann::json::array();
+
+    for (const auto& keyframe : m_keyframes)
+    {
+        nlohmann::json k;
+
+        k["time"]        = keyframe.time;
+        k["position"]    = { keyframe.position.x, keyframe.position.y, keyframe.position.z };
+        k["orientation"] = { keyframe.orientation.w, keyframe.orientation.x, keyframe.orientation.y, keyframe.orientation.z };
+
+        keyframes.push_back(k);
+    }
+
+    nlohmann::json j;
+
+    j["keyframes"] = keyframes;
+
+    o << j.dump(4);
+
+    NIMBLE_LOG_INFO("Saved camera path with " + std::to_string(m_keyframes.size()) + " keyframes to " + path);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void CameraPath::add_keyframe(float time, const glm::vec3& position, const glm::quat& orientation)
+{
+    Keyframe keyframe;
+
+    keyframe.time        = time;
+    keyframe.position    = position;
+    keyframe.orientation = glm::normalize(orientation);
+
+    m_keyframes.push_back(keyframe);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void CameraPath::clear()
+{
+    m_keyframes.clear();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void CameraPath::sample(float time, glm::vec3& position, glm::quat& orientation) const
+{
+    if (m_keyframes.empty())
+        return;
+
+    if (time <= m_keyframes.front().time)
+    {
+        position    = m_keyframes.front().position;
+        orientation = m_keyframes.front().orientation;
+        return;
+    }
+
+    if (time >= m_keyframes.back().time)
+    {
+        position    = m_keyframes.back().position;
+        orientation = m_keyframes.back().orientation;
+        return;
+    }
+
+    // Binary search for the first keyframe after the given time.
+    uint32_t first = 0;
+    uint32_t last  = uint32_t(m_keyframes.size()) - 1;
+
+    while (last - first > 1)
+    {
+        uint32_t mid = (first + last) / 2;
+
+        if (m_keyframes[mid].time <= time)
+            first = mid;
+        else
+            last = mid;
+    }
+
+    const Keyframe& a = m_keyframes[first];
+    const Keyframe& b = m_keyframes[last];
+
+    float t = b.time > a.time ? (time - a.time) / (b.time - a.time) : 0.0f;
+
+    position    = glm::mix(a.position, b.position, t);
+    orientation = glm::slerp(a.orientation, b.orientation, t);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void CameraPath::apply(float time, Camera* camera) const
+{
+    if (m_keyframes.empty())
+        return;
+
+    glm::vec3 position;
+    glm::quat orientation;
+
+    sample(time, position, orientation);
+
+    camera->set_position(position);
+    camera->set_rotatation_delta(glm::vec3(0.0f));
+    camera->m_orientation = orientation;
+    camera->update();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+CameraPath CameraPath::orbit(const AABB& aabb, float duration, uint32_t num_keyframes)
+{
+    CameraPath path;
+
+    glm::vec3 center = (aabb.min + aabb.max) * 0.5f;
+    glm::vec3 extent = (aabb.max - aabb.min) * 0.5f;
+    float     radius = glm::max(glm::length(glm::vec2(extent.x, extent.z)) * 0.75f, 1.0f);
+    float     height = center.y + extent.y * 0.25f;
+
+    num_keyframes = glm::max(num_keyframes, 2u);
+
+    for (uint32_t i = 0; i < num_keyframes; i++)
+    {
+        float     t        = float(i) / float(num_keyframes - 1);
+        float     angle    = t * 2.0f * float(PI);
+        glm::vec3 position = glm::vec3(center.x + radius * cos(angle), height, center.z + radius * sin(angle));
+
+        // The camera orientation rotates world space into view space, which is exactly the rotation part of a look-at matrix.
+        glm::quat orientation = glm::quat_cast(glm::lookAt(position, center, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+        path.add_keyframe(t * duration, position, orientation);
+    }
+
+    return path;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace nimble
\ No newline at end of file
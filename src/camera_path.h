@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glm.hpp>
+#include <gtc/quaternion.hpp>
+#include <string>
+#include <vector>
+#include "geometry.h"
+
+namespace nimble
+{
+class Camera;
+
+// Timed camera keyframes, either recorded from the interactive camera or generated. Playback interpolates linearly between
+// keyframes and sets the camera absolutely, so the same time always yields the same view regardless of the frame rate.
+class CameraPath
+{
+public:
+    struct Keyframe
+    {
+        float     time; // Seconds since the start of the path.
+        glm::vec3 position;
+        glm::quat orientation;
+    };
+
+    CameraPath();
+    ~CameraPath();
+
+    // JSON file of the form {"keyframes": [{"time": 0.0, "position": [x, y, z], "orientation": [w, x, y, z]}, ...]}.
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // Keyframes must be added in increasing time order.
+    void add_keyframe(float time, const glm::vec3& position, const glm::quat& orientation);
+    void clear();
+
+    // Interpolated position and orientation at the given time, clamped to the ends of the path.
+    void sample(float time, glm::vec3& position, glm::quat& orientation) const;
+    void apply(float time, Camera* camera) const;
+
+    // A full orbit around the bounds, looking at their center from slightly above.
+    static CameraPath orbit(const AABB& aabb, float duration, uint32_t num_keyframes = 64);
+
+    inline bool                         empty() const { return m_keyframes.empty(); }
+    inline float                        duration() const { return m_keyframes.empty() ? 0.0f : m_keyframes.back().time; }
+    inline const std::vector<Keyframe>& keyframes() const { return m_keyframes; }
+
+private:
+    std::vector<Keyframe> m_keyframes;
+};
+} // namespace nimble
\ No newline at end of file
@@ -5,6 +5,7 @@
 #define MAX_RELFECTION_PROBES 128
 #define MAX_GI_PROBES 128
 #define MAX_ENTITIES 1024
+#define MAX_MATERIALS 1024
 #define MAX_POINT_LIGHTS 512
 #define MAX_SPOT_LIGHTS 512
 #define MAX_DIRECTIONAL_LIGHTS 512
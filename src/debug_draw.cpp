@@ -1,5 +1,7 @@
 #include "debug_draw.h"
 #include "logger.h"
+#include "state_cache.h"
+#include "render_stats.h"
 #include "utility.h"
 
 namespace nimble
@@ -448,15 +450,15 @@ void DebugDraw::render(Framebuffer* fbo, int width, int height, const glm::mat4&
         GLboolean last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
 
         // Set initial state
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_CULL_FACE);
+        state_cache::disable(GL_DEPTH_TEST);
+        state_cache::disable(GL_CULL_FACE);
 
         if (fbo)
             fbo->bind();
         else
-            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            state_cache::bind_framebuffer(GL_FRAMEBUFFER, 0);
 
-        glViewport(0, 0, width, height);
+        state_cache::viewport(0, 0, width, height);
         m_line_program->use();
         m_ubo->bind_base(0);
         m_line_vao->bind();
@@ -468,6 +470,11 @@ void DebugDraw::render(Framebuffer* fbo, int width, int height, const glm::mat4&
             DrawCommand& cmd = m_draw_commands[i];
             glDrawArrays(cmd.type, v, cmd.vertices);
             v += cmd.vertices;
+
+            render_stats::add(render_stats::COUNTER_DRAW_CALLS);
+
+            if (cmd.type == GL_TRIANGLES)
+                render_stats::add(render_stats::COUNTER_TRIANGLES, cmd.vertices / 3);
         }
 
         m_draw_commands.clear();
@@ -475,10 +482,10 @@ void DebugDraw::render(Framebuffer* fbo, int width, int height, const glm::mat4&
 
         // Restore state
         if (last_enable_cull_face)
-            glEnable(GL_CULL_FACE);
+            state_cache::enable(GL_CULL_FACE);
 
         if (last_enable_depth_test)
-            glEnable(GL_DEPTH_TEST);
+            state_cache::enable(GL_DEPTH_TEST);
     }
 }
 
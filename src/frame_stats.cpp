@@ -0,0 +1,627 @@
+#include "frame_stats.h"
+#include "logger.h"
+#include "utility.h"
+#include <algorithm>
+#include <fstream>
+#include <math.h>
+#include <stdio.h>
+#include <imgui.h>
+
+#define DEFAULT_WINDOW_SIZE 512
+#define DEFAULT_BUDGET_MS 33.3f
+#define DEFAULT_HITCH_CONTEXT 8
+#define MAX_HITCHES 32
+
+namespace nimble
+{
+namespace frame_stats
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+struct FrameStats
+{
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    FrameStats()
+    {
+        set_window_size(DEFAULT_WINDOW_SIZE);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void set_window_size(uint32_t frames)
+    {
+        frames = std::max(frames, 1u);
+
+        m_history.clear();
+        m_history.resize(frames);
+        m_scratch.reserve(frames);
+
+        m_head  = 0;
+        m_count = 0;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Returns the i-th frame of the window, oldest first.
+    inline const FrameTiming& history(uint32_t i)
+    {
+        uint32_t size = uint32_t(m_history.size());
+        return m_history[(m_head + size - m_count + i) % size];
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void add_frame(const FrameTiming& frame)
+    {
+        if (frame.frame < m_first_frame || frame.frame - m_first_frame >= m_frame_range)
+            return;
+
+        FrameTiming& slot = m_history[m_head];
+
+        // Assigning keeps the capacity of the sample vector, so the window stops allocating once it has wrapped around.
+        slot.frame     = frame.frame;
+        slot.cpu_ms    = frame.cpu_ms;
+        slot.gpu_ms    = frame.gpu_ms;
+        slot.gpu_valid = frame.gpu_valid;
+        slot.samples.assign(frame.samples.begin(), frame.samples.end());
+
+        m_head  = (m_head + 1) % uint32_t(m_history.size());
+        m_count = std::min(m_count + 1, uint32_t(m_history.size()));
+
+        for (uint32_t i = 0; i < m_hitches.size(); i++)
+        {
+            if (m_remaining[i] > 0)
+            {
+                m_hitches[i].frames.push_back(frame);
+                m_remaining[i]--;
+            }
+        }
+
+        if (frame.cpu_ms > m_budget || (frame.gpu_valid && frame.gpu_ms > m_budget))
+            record_hitch(frame);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void record_hitch(const FrameTiming& frame)
+    {
+        if (m_hitches.size() == MAX_HITCHES)
+        {
+            m_hitches.erase(m_hitches.begin());
+            m_remaining.erase(m_remaining.begin());
+        }
+
+        m_hitches.push_back(Hitch());
+        m_remaining.push_back(m_context_after);
+
+        Hitch& hitch = m_hitches.back();
+
+        hitch.frame  = frame.frame;
+        hitch.cpu_ms = frame.cpu_ms;
+        hitch.gpu_ms = frame.gpu_valid ? frame.gpu_ms : 0.0f;
+
+        // The window already contains the hitch itself as its newest entry.
+        uint32_t before = std::min(m_context_before + 1, m_count);
+
+        for (uint32_t i = m_count - before; i < m_count; i++)
+            hitch.frames.push_back(history(i));
+
+        m_hitch_count++;
+
+        NIMBLE_LOG_WARNING("Frame " + std::to_string(frame.frame) + " exceeded the budget of " + std::to_string(m_budget) + " ms (CPU: " + std::to_string(frame.cpu_ms) + " ms, GPU: " + (frame.gpu_valid ? std::to_string(frame.gpu_ms) + " ms" : std::string("-")) + ")");
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Nearest-rank percentiles. Sorts the values in place.
+    static Summary summarize(std::vector<float>& values)
+    {
+        Summary summary;
+
+        summary.count = uint32_t(values.size());
+
+        if (values.empty())
+        {
+            summary.min = summary.mean = summary.p50 = summary.p95 = summary.p99 = summary.max = 0.0f;
+            return summary;
+        }
+
+        std::sort(values.begin(), values.end());
+
+        double sum = 0.0;
+
+        for (float value : values)
+            sum += value;
+
+        summary.min  = values.front();
+        summary.max  = values.back();
+        summary.mean = float(sum / double(values.size()));
+        summary.p50  = percentile(values, 0.50);
+        summary.p95  = percentile(values, 0.95);
+        summary.p99  = percentile(values, 0.99);
+
+        return summary;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    static inline float percentile(const std::vector<float>& sorted, double p)
+    {
+        size_t rank = size_t(ceil(p * double(sorted.size())));
+        return sorted[std::min(std::max(rank, size_t(1)), sorted.size()) - 1];
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    Summary frame_summary(bool gpu)
+    {
+        m_scratch.clear();
+
+        for (uint32_t i = 0; i < m_count; i++)
+        {
+            const FrameTiming& frame = history(i);
+
+            if (!gpu)
+                m_scratch.push_back(frame.cpu_ms);
+            else if (frame.gpu_valid)
+                m_scratch.push_back(frame.gpu_ms);
+        }
+
+        return summarize(m_scratch);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    Summary sample_summary(profiler::SampleID id, bool gpu)
+    {
+        m_scratch.clear();
+
+        for (uint32_t i = 0; i < m_count; i++)
+        {
+            const FrameTiming& frame = history(i);
+
+            float total = 0.0f;
+            bool  found = false;
+
+            for (const auto& sample : frame.samples)
+            {
+                if (sample.id != id || (gpu && !sample.gpu_valid))
+                    continue;
+
+                total += gpu ? sample.gpu_ms : sample.cpu_ms;
+                found = true;
+            }
+
+            if (found)
+                m_scratch.push_back(total);
+        }
+
+        return summarize(m_scratch);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void sample_ids(std::vector<profiler::SampleID>& ids)
+    {
+        ids.clear();
+
+        for (uint32_t i = 0; i < m_count; i++)
+        {
+            for (const auto& sample : history(i).samples)
+            {
+                if (std::find(ids.begin(), ids.end(), sample.id) == ids.end())
+                    ids.push_back(sample.id);
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Builds the per-frame totals of every sample in the window in a single pass. Sample IDs are dense, so they index the series
+    // directly.
+    void update_series()
+    {
+        for (auto& series : m_cpu_series)
+            series.clear();
+
+        for (auto& series : m_gpu_series)
+            series.clear();
+
+        for (uint32_t i = 0; i < m_count; i++)
+        {
+            const FrameTiming& frame = history(i);
+
+            for (const auto& sample : frame.samples)
+            {
+                if (sample.id >= m_cpu_series.size())
+                {
+                    m_cpu_series.resize(sample.id + 1);
+                    m_gpu_series.resize(sample.id + 1);
+                    m_last_seen.resize(sample.id + 1, UINT32_MAX);
+                }
+
+                // The first occurrence in a frame starts a new value, later ones are added to it.
+                if (m_last_seen[sample.id] != i)
+                {
+                    m_last_seen[sample.id] = i;
+                    m_cpu_series[sample.id].push_back(sample.cpu_ms);
+
+                    if (sample.gpu_valid)
+                        m_gpu_series[sample.id].push_back(sample.gpu_ms);
+                }
+                else
+                {
+                    m_cpu_series[sample.id].back() += sample.cpu_ms;
+
+                    if (sample.gpu_valid && !m_gpu_series[sample.id].empty())
+                        m_gpu_series[sample.id].back() += sample.gpu_ms;
+                }
+            }
+        }
+
+        for (auto& last_seen : m_last_seen)
+            last_seen = UINT32_MAX;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool write_hitch_log(const std::string& path)
+    {
+        std::ofstream f(path);
+
+        if (!f.is_open())
+        {
+            NIMBLE_LOG_ERROR("Failed to open hitch log: " + path);
+            return false;
+        }
+
+        f.precision(3);
+        f << std::fixed;
+
+        f << "{\n\"budget_ms\":" << m_budget << ",\n\"hitches\":[";
+
+        for (uint32_t i = 0; i < m_hitches.size(); i++)
+        {
+            const Hitch& hitch = m_hitches[i];
+
+            f << (i > 0 ? ",\n" : "\n") << "{\"frame\":" << hitch.frame << ",\"cpu_ms\":" << hitch.cpu_ms << ",\"gpu_ms\":" << hitch.gpu_ms << ",\"frames\":[";
+
+            for (uint32_t j = 0; j < hitch.frames.size(); j++)
+            {
+                const FrameTiming& frame = hitch.frames[j];
+
+                f << (j > 0 ? ",\n" : "\n") << "{\"frame\":" << frame.frame << ",\"cpu_ms\":" << frame.cpu_ms << ",\"gpu_ms\":";
+
+                if (frame.gpu_valid)
+                    f << frame.gpu_ms;
+                else
+                    f << "null";
+
+                f << ",\"samples\":[";
+
+                for (uint32_t k = 0; k < frame.samples.size(); k++)
+                {
+                    const SampleTiming& sample = frame.samples[k];
+
+                    f << (k > 0 ? "," : "") << "{\"name\":";
+                    utility::write_json_string(f, profiler::sample_name(sample.id));
+                    f << ",\"depth\":" << sample.depth << ",\"cpu_ms\":" << sample.cpu_ms << ",\"gpu_ms\":";
+
+                    if (sample.gpu_valid)
+                        f << sample.gpu_ms;
+                    else
+                        f << "null";
+
+                    f << "}";
+                }
+
+                f << "]}";
+            }
+
+            f << "\n]}";
+        }
+
+        f << "\n]\n}\n";
+
+        NIMBLE_LOG_INFO("Wrote " + std::to_string(m_hitches.size()) + " hitches to " + path);
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    static void summary_row(const char* name, const Summary& summary)
+    {
+        ImGui::Text("%s", name);
+        ImGui::NextColumn();
+
+        if (summary.count == 0)
+        {
+            for (uint32_t i = 0; i < 6; i++)
+            {
+                ImGui::Text("-");
+                ImGui::NextColumn();
+            }
+
+            return;
+        }
+
+        const float values[] = { summary.min, summary.mean, summary.p50, summary.p95, summary.p99, summary.max };
+
+        for (uint32_t i = 0; i < 6; i++)
+        {
+            ImGui::Text("%.2f", values[i]);
+            ImGui::NextColumn();
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void frame_ui(const FrameTiming& frame, bool hitch)
+    {
+        char gpu[32];
+
+        if (frame.gpu_valid)
+            snprintf(gpu, sizeof(gpu), "%.2f ms", frame.gpu_ms);
+        else
+            snprintf(gpu, sizeof(gpu), "-");
+
+        if (!ImGui::TreeNode((void*)(intptr_t)frame.frame, "%sFrame %u | %.2f ms (CPU) | %s (GPU)", hitch ? "* " : "", frame.frame, frame.cpu_ms, gpu))
+            return;
+
+        for (const auto& sample : frame.samples)
+        {
+            if (sample.gpu_valid)
+                ImGui::Text("%*s%s | %.3f ms (CPU) | %.3f ms (GPU)", int(sample.depth * 4), "", profiler::sample_name(sample.id), sample.cpu_ms, sample.gpu_ms);
+            else
+                ImGui::Text("%*s%s | %.3f ms (CPU) | - (GPU)", int(sample.depth * 4), "", profiler::sample_name(sample.id), sample.cpu_ms);
+        }
+
+        ImGui::TreePop();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void ui()
+    {
+        int32_t window = int32_t(m_history.size());
+
+        if (ImGui::InputInt("Window (frames)", &window))
+            set_window_size(uint32_t(std::max(window, 1)));
+
+        ImGui::InputFloat("Budget (ms)", &m_budget);
+
+        int32_t before = int32_t(m_context_before);
+        int32_t after  = int32_t(m_context_after);
+
+        if (ImGui::InputInt("Frames Before Hitch", &before))
+            m_context_before = uint32_t(std::max(before, 0));
+
+        if (ImGui::InputInt("Frames After Hitch", &after))
+            m_context_after = uint32_t(std::max(after, 0));
+
+        ImGui::Text("Frames: %u", m_count);
+
+        ImGui::Columns(7);
+        ImGui::Text("Time (ms)");
+        ImGui::NextColumn();
+
+        const char* headers[] = { "Min", "Mean", "P50", "P95", "P99", "Max" };
+
+        for (uint32_t i = 0; i < 6; i++)
+        {
+            ImGui::Text("%s", headers[i]);
+            ImGui::NextColumn();
+        }
+
+        ImGui::Separator();
+
+        summary_row("CPU Frame", frame_summary(false));
+        summary_row("GPU Frame", frame_summary(true));
+
+        if (m_count > 0)
+        {
+            update_series();
+
+            // One row per distinct sample of the latest frame, in the order they were recorded.
+            const FrameTiming& latest = history(m_count - 1);
+
+            for (const auto& sample : latest.samples)
+            {
+                if (m_cpu_series[sample.id].empty())
+                    continue;
+
+                std::string name = profiler::sample_name(sample.id);
+
+                ImGui::Separator();
+                summary_row((name + " (CPU)").c_str(), summarize(m_cpu_series[sample.id]));
+                summary_row((name + " (GPU)").c_str(), summarize(m_gpu_series[sample.id]));
+
+                // Consumed, so that samples recorded more than once per frame only get a single row.
+                m_cpu_series[sample.id].clear();
+            }
+        }
+
+        ImGui::Columns(1);
+        ImGui::Separator();
+
+        ImGui::Text("Hitches: %u (%u kept)", m_hitch_count, uint32_t(m_hitches.size()));
+
+        if (ImGui::Button("Write Hitch Log"))
+            write_hitch_log("hitch_log.json");
+
+        ImGui::SameLine();
+
+        if (ImGui::Button("Clear Hitches"))
+        {
+            m_hitches.clear();
+            m_remaining.clear();
+        }
+
+        for (uint32_t i = 0; i < m_hitches.size(); i++)
+        {
+            const Hitch& hitch = m_hitches[i];
+
+            ImGui::PushID(int(i));
+
+            if (ImGui::TreeNode("Hitch", "Frame %u | %.2f ms (CPU) | %.2f ms (GPU)", hitch.frame, hitch.cpu_ms, hitch.gpu_ms))
+            {
+                for (const auto& frame : hitch.frames)
+                    frame_ui(frame, frame.frame == hitch.frame);
+
+                ImGui::TreePop();
+            }
+
+            ImGui::PopID();
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    std::vector<FrameTiming> m_history;
+    uint32_t                 m_head           = 0;
+    uint32_t                 m_count          = 0;
+    float                    m_budget         = DEFAULT_BUDGET_MS;
+    uint32_t                 m_context_before = DEFAULT_HITCH_CONTEXT;
+    uint32_t                 m_context_after  = DEFAULT_HITCH_CONTEXT;
+    uint32_t                 m_hitch_count    = 0;
+    uint32_t                 m_first_frame    = 0;
+    uint32_t                 m_frame_range    = UINT32_MAX;
+    std::vector<Hitch>       m_hitches;
+    std::vector<uint32_t>    m_remaining; // Frames still to be added after each hitch.
+    std::vector<float>       m_scratch;
+
+    // Only used by the UI, kept around to avoid allocating every frame.
+    std::vector<std::vector<float>> m_cpu_series;
+    std::vector<std::vector<float>> m_gpu_series;
+    std::vector<uint32_t>           m_last_seen;
+};
+
+static FrameStats g_frame_stats;
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void add_frame(const FrameTiming& frame)
+{
+    g_frame_stats.add_frame(frame);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void set_window_size(uint32_t frames)
+{
+    g_frame_stats.set_window_size(frames);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+uint32_t window_size()
+{
+    return uint32_t(g_frame_stats.m_history.size());
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+uint32_t frame_count()
+{
+    return g_frame_stats.m_count;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void set_frame_range(uint32_t first, uint32_t count)
+{
+    g_frame_stats.m_first_frame = first;
+    g_frame_stats.m_frame_range = count;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void set_budget(float ms)
+{
+    g_frame_stats.m_budget = ms;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+float budget()
+{
+    return g_frame_stats.m_budget;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void set_hitch_context(uint32_t before, uint32_t after)
+{
+    g_frame_stats.m_context_before = before;
+    g_frame_stats.m_context_after  = after;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+Summary cpu_summary()
+{
+    return g_frame_stats.frame_summary(false);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+Summary gpu_summary()
+{
+    return g_frame_stats.frame_summary(true);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+Summary sample_cpu_summary(profiler::SampleID id)
+{
+    return g_frame_stats.sample_summary(id, false);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+Summary sample_gpu_summary(profiler::SampleID id)
+{
+    return g_frame_stats.sample_summary(id, true);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void sample_ids(std::vector<profiler::SampleID>& ids)
+{
+    g_frame_stats.sample_ids(ids);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+const std::vector<Hitch>& hitches()
+{
+    return g_frame_stats.m_hitches;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void clear_hitches()
+{
+    g_frame_stats.m_hitches.clear();
+    g_frame_stats.m_remaining.clear();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool write_hitch_log(const std::string& path)
+{
+    return g_frame_stats.write_hitch_log(path);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void ui()
+{
+    g_frame_stats.ui();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace frame_stats
+} // namespace nimble
\ No newline at end of file
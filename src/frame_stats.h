@@ -0,0 +1,87 @@
+#pragma once
+
+#include "profiler.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Rolling frame time statistics over the last few hundred frames, fed by the profiler once the GPU times of a frame are known.
+// Frames that exceed the budget are recorded together with the frames around them, including the full per-sample breakdown, so
+// that hitches can be inspected after the fact.
+namespace nimble
+{
+namespace frame_stats
+{
+struct SampleTiming
+{
+    profiler::SampleID id;
+    uint32_t           depth;
+    float              cpu_ms;
+    float              gpu_ms;
+    bool               gpu_valid;
+};
+
+struct FrameTiming
+{
+    uint32_t                  frame;
+    float                     cpu_ms; // Wall time between the start of this frame and the next.
+    float                     gpu_ms; // Span of the top level GPU samples.
+    bool                      gpu_valid;
+    std::vector<SampleTiming> samples;
+};
+
+struct Summary
+{
+    uint32_t count;
+    float    min;
+    float    mean;
+    float    p50;
+    float    p95;
+    float    p99;
+    float    max;
+};
+
+struct Hitch
+{
+    uint32_t                 frame; // The frame that exceeded the budget.
+    float                    cpu_ms;
+    float                    gpu_ms;
+    std::vector<FrameTiming> frames; // The frame itself and the context before and after it, oldest first.
+};
+
+extern void add_frame(const FrameTiming& frame);
+
+extern void     set_window_size(uint32_t frames);
+extern uint32_t window_size();
+
+// Number of frames currently in the window, at most the window size. Resizing the window empties it.
+extern uint32_t frame_count();
+
+// Only frames numbered first to first + count - 1 by the profiler are recorded, everything else is ignored. Frames resolve a few
+// frames late, so this is what separates a measured range cleanly from the frames around it. All frames are recorded by default.
+extern void set_frame_range(uint32_t first, uint32_t count = UINT32_MAX);
+
+// A frame whose CPU or GPU time exceeds the budget is logged as a hitch.
+extern void  set_budget(float ms);
+extern float budget();
+
+// Number of frames before and after a hitch that are kept with it.
+extern void set_hitch_context(uint32_t before, uint32_t after);
+
+extern Summary cpu_summary();
+extern Summary gpu_summary();
+
+// Summaries of a single sample over the window. Samples recorded more than once per frame are summed first.
+extern Summary sample_cpu_summary(profiler::SampleID id);
+extern Summary sample_gpu_summary(profiler::SampleID id);
+
+// Every sample recorded in the window, in order of first appearance.
+extern void sample_ids(std::vector<profiler::SampleID>& ids);
+
+extern const std::vector<Hitch>& hitches();
+extern void                      clear_hitches();
+extern bool                      write_hitch_log(const std::string& path);
+
+extern void ui();
+} // namespace frame_stats
+} // namespace nimble
\ No newline at end of file
@@ -0,0 +1,332 @@
+#include "gl_debug.h"
+#include "logger.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <imgui.h>
+
+#define MAX_QUEUED_MESSAGES 256
+#define MAX_RECENT_MESSAGES 32
+
+namespace nimble
+{
+namespace gl_debug
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+struct Message
+{
+    GLenum      source;
+    GLenum      type;
+    GLuint      id;
+    GLenum      severity;
+    std::string text;
+    std::string node;
+    std::string group;
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+struct DebugOutput
+{
+    bool                     enabled     = false;
+    bool                     synchronous = false;
+    std::atomic<uint32_t>    error_count = { 0 };
+    uint32_t                 dropped     = 0;
+    std::mutex               mutex;
+    std::string              active_node;
+    std::vector<std::string> groups;
+    std::vector<Message>     queue;
+    std::deque<std::string>  recent;
+};
+
+static DebugOutput g_debug_output;
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static const char* source_name(GLenum source)
+{
+    switch (source)
+    {
+        case GL_DEBUG_SOURCE_API: return "API";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "Window System";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "Shader Compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY: return "Third Party";
+        case GL_DEBUG_SOURCE_APPLICATION: return "Application";
+        default: return "Other";
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static const char* type_name(GLenum type)
+{
+    switch (type)
+    {
+        case GL_DEBUG_TYPE_ERROR: return "Error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "Deprecated Behavior";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "Undefined Behavior";
+        case GL_DEBUG_TYPE_PORTABILITY: return "Portability";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "Performance";
+        case GL_DEBUG_TYPE_MARKER: return "Marker";
+        default: return "Other";
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static std::string format_message(const Message& msg)
+{
+    std::string formatted = "OPENGL [" + std::string(type_name(msg.type)) + " | " + source_name(msg.source) + " | " + std::to_string(msg.id) + "]";
+
+    if (!msg.node.empty())
+        formatted += " Node: " + msg.node;
+
+    if (!msg.group.empty())
+        formatted += " Group: " + msg.group;
+
+    return formatted + " : " + msg.text;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void log_message(const Message& msg)
+{
+    std::string formatted = format_message(msg);
+
+    if (msg.type == GL_DEBUG_TYPE_ERROR || msg.severity == GL_DEBUG_SEVERITY_HIGH)
+        NIMBLE_LOG_ERROR(formatted);
+    else
+        NIMBLE_LOG_WARNING(formatted);
+
+    g_debug_output.recent.push_back(formatted);
+
+    if (g_debug_output.recent.size() > MAX_RECENT_MESSAGES)
+        g_debug_output.recent.pop_front();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static void APIENTRY debug_callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* user_param)
+{
+    Message msg;
+
+    msg.source   = source;
+    msg.type     = type;
+    msg.id       = id;
+    msg.severity = severity;
+    msg.text     = length < 0 ? std::string(message) : std::string(message, length);
+
+    // With asynchronous output the message may be delivered after the offending call has returned, so the attribution below is
+    // only exact in synchronous mode. In practice it is almost always the right node.
+    std::lock_guard<std::mutex> lock(g_debug_output.mutex);
+
+    msg.node = g_debug_output.active_node;
+
+    for (uint32_t i = 0; i < g_debug_output.groups.size(); i++)
+    {
+        if (i > 0)
+            msg.group += "/";
+
+        msg.group += g_debug_output.groups[i];
+    }
+
+    if (type == GL_DEBUG_TYPE_ERROR)
+        g_debug_output.error_count++;
+
+    if (g_debug_output.synchronous)
+        log_message(msg);
+    else if (g_debug_output.queue.size() < MAX_QUEUED_MESSAGES)
+        g_debug_output.queue.push_back(msg);
+    else
+        g_debug_output.dropped++;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+ScopedGroup::ScopedGroup(const char* name)
+{
+    push_group(name);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+ScopedGroup::~ScopedGroup()
+{
+    pop_group();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool initialize()
+{
+#if defined(NIMBLE_ENABLE_GL_DEBUG_OUTPUT)
+    if (!GLAD_GL_VERSION_4_3 && !GLAD_GL_KHR_debug)
+    {
+        NIMBLE_LOG_WARNING("KHR_debug is not supported, OpenGL errors will not be reported");
+        return false;
+    }
+
+    glEnable(GL_DEBUG_OUTPUT);
+    glDebugMessageCallback(debug_callback, nullptr);
+
+    // Notifications are mostly buffer placement hints and would drown out everything else.
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+    glDebugMessageControl(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_PUSH_GROUP, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+    glDebugMessageControl(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_POP_GROUP, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+
+    g_debug_output.enabled = true;
+
+    set_synchronous(false);
+
+    NIMBLE_LOG_INFO("OpenGL debug output enabled");
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void shutdown()
+{
+    if (!g_debug_output.enabled)
+        return;
+
+    flush();
+
+    glDebugMessageCallback(nullptr, nullptr);
+    glDisable(GL_DEBUG_OUTPUT);
+
+    g_debug_output.enabled = false;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void flush()
+{
+    if (!g_debug_output.enabled)
+        return;
+
+    std::vector<Message> messages;
+    uint32_t             dropped;
+
+    {
+        std::lock_guard<std::mutex> lock(g_debug_output.mutex);
+
+        messages.swap(g_debug_output.queue);
+        dropped                = g_debug_output.dropped;
+        g_debug_output.dropped = 0;
+    }
+
+    for (auto& msg : messages)
+        log_message(msg);
+
+    if (dropped > 0)
+        NIMBLE_LOG_WARNING("OPENGL: " + std::to_string(dropped) + " debug messages were dropped");
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void set_synchronous(bool synchronous)
+{
+    if (!g_debug_output.enabled)
+        return;
+
+    // Queued messages belong to the previous mode and have to be logged before the callback starts logging directly.
+    flush();
+
+    if (synchronous)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    else
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+
+    std::lock_guard<std::mutex> lock(g_debug_output.mutex);
+    g_debug_output.synchronous = synchronous;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool is_synchronous()
+{
+    return g_debug_output.synchronous;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void push_group(const char* name)
+{
+    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+
+    if (g_debug_output.enabled)
+    {
+        std::lock_guard<std::mutex> lock(g_debug_output.mutex);
+        g_debug_output.groups.push_back(name);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void pop_group()
+{
+    glPopDebugGroup();
+
+    if (g_debug_output.enabled)
+    {
+        std::lock_guard<std::mutex> lock(g_debug_output.mutex);
+
+        if (!g_debug_output.groups.empty())
+            g_debug_output.groups.pop_back();
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void set_active_node(const char* name)
+{
+    if (g_debug_output.enabled)
+    {
+        std::lock_guard<std::mutex> lock(g_debug_output.mutex);
+
+        if (name)
+            g_debug_output.active_node = name;
+        else
+            g_debug_output.active_node.clear();
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+uint32_t error_count()
+{
+    return g_debug_output.error_count;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void ui()
+{
+    if (!g_debug_output.enabled)
+    {
+        ImGui::Text("Debug output is disabled for this build.");
+        return;
+    }
+
+    bool synchronous = g_debug_output.synchronous;
+
+    if (ImGui::Checkbox("Synchronous (exact attribution, slow)", &synchronous))
+        set_synchronous(synchronous);
+
+    ImGui::Text("Errors: %u", g_debug_output.error_count.load());
+
+    for (auto& msg : g_debug_output.recent)
+        ImGui::TextWrapped("%s", msg.c_str());
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace gl_debug
+} // namespace nimble
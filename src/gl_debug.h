@@ -0,0 +1,50 @@
+#pragma once
+
+#include "glad.h"
+#include <stdint.h>
+
+// Asynchronous error reporting through a KHR_debug message callback. Cheap enough to keep enabled in debug builds that are used for
+// profiling since it never forces a round-trip to the driver.
+#if !defined(NDEBUG) && !defined(__EMSCRIPTEN__)
+#    define NIMBLE_ENABLE_GL_DEBUG_OUTPUT
+#endif
+
+#define NIMBLE_GL_DEBUG_CONCAT_IMPL(a, b) a##b
+#define NIMBLE_GL_DEBUG_CONCAT(a, b) NIMBLE_GL_DEBUG_CONCAT_IMPL(a, b)
+
+#define NIMBLE_SCOPED_DEBUG_GROUP(name) nimble::gl_debug::ScopedGroup NIMBLE_GL_DEBUG_CONCAT(nimble_debug_group_, __LINE__)(name)
+
+namespace nimble
+{
+namespace gl_debug
+{
+struct ScopedGroup
+{
+    ScopedGroup(const char* name);
+    ~ScopedGroup();
+};
+
+// Installs the message callback if the context supports KHR_debug. Must be called once the context is current.
+extern bool initialize();
+extern void shutdown();
+
+// Logs all messages received since the last call. Messages may arrive on a driver thread, so they are queued and logged from the
+// main thread once per frame.
+extern void flush();
+
+// Synchronous output delivers every message from within the offending call, which gives exact attribution at the cost of
+// serializing the driver. Asynchronous output is the default.
+extern void set_synchronous(bool synchronous);
+extern bool is_synchronous();
+
+// Debug groups show up in frame debuggers and are used to attribute messages to the work that caused them.
+extern void push_group(const char* name);
+extern void pop_group();
+
+// The render node that is currently executing. Pass nullptr once the node is done.
+extern void set_active_node(const char* name);
+
+extern uint32_t error_count();
+extern void     ui();
+} // namespace gl_debug
+} // namespace nimble
@@ -0,0 +1,211 @@
+#include "headless_context.h"
+#include "logger.h"
+
+#if defined(NIMBLE_ENABLE_HEADLESS)
+// Keep X11 out of the EGL headers, its macros clash with ours.
+#    define EGL_NO_X11
+#    define MESA_EGL_NO_X11_HEADERS
+#    include <EGL/egl.h>
+#    include <EGL/eglext.h>
+#endif
+
+namespace nimble
+{
+#if defined(NIMBLE_ENABLE_HEADLESS)
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static EGLDisplay open_display()
+{
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+#    if defined(EGL_PLATFORM_SURFACELESS_MESA)
+    if (get_platform_display)
+    {
+        EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+
+        if (display != EGL_NO_DISPLAY)
+            return display;
+    }
+#    endif
+
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+#endif
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+HeadlessContext::HeadlessContext() :
+    m_display(nullptr), m_surface(nullptr), m_context(nullptr)
+{
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+HeadlessContext::~HeadlessContext()
+{
+    shutdown();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool HeadlessContext::initialize(uint32_t width, uint32_t height, int major_ver, int minor_ver, bool debug)
+{
+#if defined(NIMBLE_ENABLE_HEADLESS)
+    EGLDisplay display = open_display();
+
+    if (display == EGL_NO_DISPLAY)
+    {
+        NIMBLE_LOG_FATAL("Failed to open EGL display");
+        return false;
+    }
+
+    EGLint egl_major = 0;
+    EGLint egl_minor = 0;
+
+    if (!eglInitialize(display, &egl_major, &egl_minor))
+    {
+        NIMBLE_LOG_FATAL("Failed to initialize EGL");
+        return false;
+    }
+
+    m_display = display;
+
+    NIMBLE_LOG_INFO("EGL " + std::to_string(egl_major) + "." + std::to_string(egl_minor) + " (" + eglQueryString(display, EGL_VENDOR) + ")");
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        NIMBLE_LOG_FATAL("EGL does not support desktop OpenGL");
+        shutdown();
+        return false;
+    }
+
+    // Single-sampled, anti-aliasing is done by the render graph in its own render targets.
+    const EGLint config_attribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_STENCIL_SIZE, 8,
+        EGL_NONE
+    };
+
+    EGLConfig config     = nullptr;
+    EGLint    num_config = 0;
+
+    if (!eglChooseConfig(display, config_attribs, &config, 1, &num_config) || num_config == 0)
+    {
+        NIMBLE_LOG_FATAL("No EGL config supports OpenGL pbuffers");
+        shutdown();
+        return false;
+    }
+
+    const EGLint surface_attribs[] = {
+        EGL_WIDTH, EGLint(width),
+        EGL_HEIGHT, EGLint(height),
+        EGL_NONE
+    };
+
+    EGLSurface surface = eglCreatePbufferSurface(display, config, surface_attribs);
+
+    if (surface == EGL_NO_SURFACE)
+    {
+        NIMBLE_LOG_FATAL("Failed to create EGL pbuffer surface");
+        shutdown();
+        return false;
+    }
+
+    m_surface = surface;
+
+    const EGLint context_attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, major_ver,
+        EGL_CONTEXT_MINOR_VERSION_KHR, minor_ver,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+        EGL_CONTEXT_FLAGS_KHR, debug ? EGL_CONTEXT_OPENGL_DEBUG_BIT_KHR : 0,
+        EGL_NONE
+    };
+
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs);
+
+    if (context == EGL_NO_CONTEXT)
+    {
+        NIMBLE_LOG_FATAL("Failed to create OpenGL " + std::to_string(major_ver) + "." + std::to_string(minor_ver) + " core context through EGL");
+        shutdown();
+        return false;
+    }
+
+    m_context = context;
+
+    if (!eglMakeCurrent(display, surface, surface, context))
+    {
+        NIMBLE_LOG_FATAL("Failed to make EGL context current");
+        shutdown();
+        return false;
+    }
+
+    return true;
+#else
+    NIMBLE_LOG_FATAL("Headless rendering requires a build with EGL support");
+    return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void HeadlessContext::shutdown()
+{
+#if defined(NIMBLE_ENABLE_HEADLESS)
+    if (!m_display)
+        return;
+
+    eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+    if (m_context)
+        eglDestroyContext(m_display, m_context);
+
+    if (m_surface)
+        eglDestroySurface(m_display, m_surface);
+
+    eglTerminate(m_display);
+
+    m_display = nullptr;
+    m_surface = nullptr;
+    m_context = nullptr;
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void HeadlessContext::swap_buffers()
+{
+#if defined(NIMBLE_ENABLE_HEADLESS)
+    eglSwapBuffers(m_display, m_surface);
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool HeadlessContext::is_supported()
+{
+#if defined(NIMBLE_ENABLE_HEADLESS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void* HeadlessContext::proc_address(const char* name)
+{
+#if defined(NIMBLE_ENABLE_HEADLESS)
+    return (void*)eglGetProcAddress(name);
+#else
+    return nullptr;
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace nimble
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace nimble
+{
+// OpenGL context without a window, created through EGL. The default framebuffer is a pbuffer of the requested size so that the
+// renderer runs unchanged. Prefers Mesa's surfaceless platform, which needs neither a display server nor a GPU and therefore also
+// works on llvmpipe. Only available when the build found EGL (NIMBLE_ENABLE_HEADLESS).
+class HeadlessContext
+{
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    bool initialize(uint32_t width, uint32_t height, int major_ver, int minor_ver, bool debug);
+    void shutdown();
+    void swap_buffers();
+
+    static bool  is_supported();
+    static void* proc_address(const char* name);
+
+private:
+    // EGLDisplay, EGLSurface and EGLContext, kept opaque so that the EGL headers stay out of the rest of the code.
+    void* m_display;
+    void* m_surface;
+    void* m_context;
+};
+} // namespace nimble
\ No newline at end of file
@@ -55,6 +55,7 @@
 
 #include "imgui.h"
 #include "imgui_impl_opengl3.h"
+#include "render_stats.h"
 #include <stdio.h>
 #if defined(_MSC_VER) && _MSC_VER <= 1500 // MSVC 2008 or earlier
 #    include <stddef.h>                   // intptr_t
@@ -269,6 +270,9 @@ void ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
                     // Bind texture, Draw
                     glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->TextureId);
                     glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, idx_buffer_offset);
+                    nimble::render_stats::add(nimble::render_stats::COUNTER_TEXTURE_BINDS);
+                    nimble::render_stats::add(nimble::render_stats::COUNTER_DRAW_CALLS);
+                    nimble::render_stats::add(nimble::render_stats::COUNTER_TRIANGLES, pcmd->ElemCount / 3);
                 }
             }
             idx_buffer_offset += pcmd->ElemCount;
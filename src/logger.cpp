@@ -5,321 +5,621 @@
 #include <chrono>
 #include <ctime>
 #include <cstdio>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
 
 #define FILE_STREAM_INDEX 0
 #define CONSOLE_STREAM_INDEX 1
 #define CUSTOM_STREAM_INDEX 2
 
+// Records are fixed-size, a message longer than the text of one record continues in the following records. RING_SIZE must be a
+// power of two.
+#define RECORD_SIZE 256
+#define RECORD_TEXT_SIZE 216
+#define RING_SIZE 4096
+
+// Messages longer than this many records are truncated.
+#define MAX_RECORDS_PER_MESSAGE 64
+
+// How long the logger thread sleeps when there is nothing to write.
+#define IDLE_WAIT_MS 5
+
+// Messages written per lock of the output mutex. Custom stream callbacks are invoked between batches.
+#define DRAIN_BATCH_SIZE 64
+
 #define LOG_SEPERATOR "********************************************************************************************************\n"
 
 namespace nimble
 {
 namespace logger
 {
+// A slot of the ring buffer. The sequence tells who owns it: a producer at position p may write the slot once its sequence is p, the
+// logger thread may read it once the sequence is p + 1 and hands it back to the producers by setting it to p + RING_SIZE.
+struct Record
+{
+    std::atomic<uint64_t> sequence;
+    const char*           file;
+    int64_t               timestamp;
+    int32_t               line;
+    uint32_t              thread_id;
+    uint32_t              length; // Bytes of text in this record.
+    uint16_t              level;
+    uint16_t              count; // Records of the whole message.
+    char                  text[RECORD_TEXT_SIZE];
+};
+
+static_assert(sizeof(Record) == RECORD_SIZE, "Record size must match RECORD_SIZE");
+
+// Output for the custom stream, which is called after the output mutex has been released.
+struct CallbackMessage
+{
+    CustomStreamCallback callback;
+    std::string          text;
+    LogLevel             level;
+};
+
 struct LoggerState
 {
+    ~LoggerState()
+    {
+        shutdown();
+    }
+
+    // Multi-producer single-consumer ring buffer. Producers claim records by incrementing the enqueue position, so they never wait on
+    // each other. The positions are on separate cache lines to keep producers from invalidating the consumer and vice versa.
+    Record                            _ring[RING_SIZE];
+    alignas(64) std::atomic<uint64_t> _enqueue_pos;
+    alignas(64) std::atomic<uint64_t> _dequeue_pos;
+    std::atomic<uint32_t>             _thread_count;
+    std::atomic<uint32_t>             _producers; // Threads between checking _running and finishing their push.
+
+    // Logger thread.
+    std::thread             _thread;
+    std::atomic<bool>       _running;
+    std::mutex              _wake_mutex;
+    std::condition_variable _wake_cv;
+    std::condition_variable _written_cv;
+    bool                    _wake;
+
+    // Streams, only accessed while holding the output mutex.
+    std::mutex           _output_mutex;
     bool                 _open_streams[3];
-    std::mutex           _log_mutex;
     std::ofstream        _stream;
     std::time_t          _rawtime;
     std::tm*             _timeinfo;
-    int                  _verbosity;
     char                 _temp_buffer[80];
     CustomStreamCallback _callback;
-    bool                 _debug;
+
+    std::atomic<int>  _verbosity;
+    std::atomic<bool> _debug;
 };
 
 LoggerState g_logger;
 
-void initialize()
-{
-    for (int i = 0; i < 3; i++)
-        g_logger._open_streams[i] = false;
-
-    g_logger._callback  = nullptr;
-    g_logger._verbosity = VERBOSITY_ALL;
-    g_logger._debug     = false;
-}
+static thread_local bool t_logger_thread = false;
+static thread_local bool t_in_callback   = false;
 
-void set_verbosity(int flags)
+static uint32_t current_thread_id()
 {
-    g_logger._verbosity = flags;
+    static thread_local uint32_t id = g_logger._thread_count.fetch_add(1, std::memory_order_relaxed);
+    return id;
 }
 
-void open_console_stream()
+static const char* level_string(LogLevel level)
 {
-    g_logger._open_streams[CONSOLE_STREAM_INDEX] = true;
+    switch (level)
+    {
+        case LEVEL_INFO:
+            return "INFO   ";
+        case LEVEL_WARNING:
+            return "WARNING";
+        case LEVEL_ERR:
+            return "ERROR  ";
+        case LEVEL_FATAL:
+            return "FATAL  ";
+    }
 
-    std::time(&g_logger._rawtime);
-    std::cout << LOG_SEPERATOR;
-    std::cout << std::ctime(&g_logger._rawtime) << "Log Started.\n";
-    std::cout << LOG_SEPERATOR;
+    return "";
 }
 
-void open_file_stream()
+static void invoke_callback(CustomStreamCallback callback, const std::string& text, LogLevel level)
 {
-    g_logger._open_streams[FILE_STREAM_INDEX] = true;
-    g_logger._stream.open("log.txt", std::ios::app | std::ofstream::out);
-
-    std::time(&g_logger._rawtime);
-    g_logger._stream << LOG_SEPERATOR;
-    g_logger._stream << std::ctime(&g_logger._rawtime) << "Log Started.\n";
-    g_logger._stream << LOG_SEPERATOR;
+    t_in_callback = true;
+    callback(text, level);
+    t_in_callback = false;
 }
 
-void open_custom_stream(CustomStreamCallback callback)
+// Formats a message and writes it to the file and console streams. Simplified API messages have no file. Must hold the output mutex.
+// If the custom stream is open, the formatted message is added to the callback messages to be passed on once the mutex is released.
+static void write(const char* text, size_t length, const char* file, int line, LogLevel level, std::time_t timestamp, uint32_t thread_id, std::vector<CallbackMessage>& callback_messages)
 {
-    g_logger._open_streams[CUSTOM_STREAM_INDEX] = true;
-    g_logger._callback                          = callback;
+    int verbosity = g_logger._verbosity.load(std::memory_order_relaxed);
 
-    std::time(&g_logger._rawtime);
+    g_logger._timeinfo = std::localtime(&timestamp);
+    std::strftime(g_logger._temp_buffer, 80, "%H:%M:%S", g_logger._timeinfo);
 
-    if (g_logger._callback)
+    std::string output;
+
+    if ((verbosity & VERBOSITY_TIMESTAMP) || (verbosity & VERBOSITY_LEVEL) || (verbosity & VERBOSITY_THREAD))
     {
-        g_logger._callback(LOG_SEPERATOR, LEVEL_INFO);
+        const char* separator = "";
 
-        std::string init_string = std::ctime(&g_logger._rawtime);
-        init_string += "Log Started.\n";
+        output = "[ ";
 
-        g_logger._callback(init_string, LEVEL_INFO);
-        g_logger._callback(LOG_SEPERATOR, LEVEL_INFO);
-    }
-}
+        if (verbosity & VERBOSITY_TIMESTAMP)
+        {
+            output += g_logger._temp_buffer;
+            separator = " | ";
+        }
 
-void close_console_stream()
-{
-    g_logger._open_streams[CONSOLE_STREAM_INDEX] = false;
+        if (verbosity & VERBOSITY_LEVEL)
+        {
+            output += separator;
+            output += level_string(level);
+            separator = " | ";
+        }
 
-    std::time(&g_logger._rawtime);
-    std::cout << LOG_SEPERATOR;
-    std::cout << std::ctime(&g_logger._rawtime) << "Log Ended.\n";
-    std::cout << LOG_SEPERATOR;
-}
+        if (verbosity & VERBOSITY_THREAD)
+        {
+            output += separator;
+            output += "T" + std::to_string(thread_id);
+        }
 
-void close_file_stream()
-{
-    g_logger._open_streams[FILE_STREAM_INDEX] = false;
+        output += " ] : ";
+    }
 
-    std::time(&g_logger._rawtime);
-    g_logger._stream << LOG_SEPERATOR;
-    g_logger._stream << std::ctime(&g_logger._rawtime) << "Log Ended.\n";
-    g_logger._stream << LOG_SEPERATOR;
+    output.append(text, length);
 
-    g_logger._stream.close();
-}
+    if (file && (verbosity & VERBOSITY_FILE))
+    {
+        const char* file_with_extension = file;
 
-void close_custom_stream()
-{
-    g_logger._open_streams[CUSTOM_STREAM_INDEX] = false;
+        for (const char* c = file; *c; c++)
+        {
+            if (*c == '/' || *c == '\\')
+                file_with_extension = c + 1;
+        }
 
-    std::time(&g_logger._rawtime);
+        output += " , FILE : ";
+        output += file_with_extension;
+    }
+
+    if (file && (verbosity & VERBOSITY_LINE))
+    {
+        output += " , LINE : ";
+        output += std::to_string(line);
+    }
 
-    if (g_logger._callback)
+    if (g_logger._open_streams[FILE_STREAM_INDEX])
     {
-        g_logger._callback(LOG_SEPERATOR, LEVEL_INFO);
+        g_logger._stream << output << "\n";
+    }
 
-        std::string init_string = std::ctime(&g_logger._rawtime);
-        init_string += "Log Ended.\n";
+    if (g_logger._open_streams[CONSOLE_STREAM_INDEX])
+    {
+        std::cout << output << "\n";
+    }
 
-        g_logger._callback(init_string, LEVEL_INFO);
-        g_logger._callback(LOG_SEPERATOR, LEVEL_INFO);
+    if (g_logger._open_streams[CUSTOM_STREAM_INDEX] && g_logger._callback)
+    {
+        callback_messages.push_back({ g_logger._callback, std::move(output), level });
     }
 }
 
-void enable_debug_mode()
+// Must hold the output mutex.
+static void flush_streams()
 {
-    g_logger._debug = true;
-}
+    if (g_logger._open_streams[FILE_STREAM_INDEX])
+        g_logger._stream.flush();
 
-void disable_debug_mode()
-{
-    g_logger._debug = false;
+    if (g_logger._open_streams[CONSOLE_STREAM_INDEX])
+        std::cout.flush();
 }
 
-void log(std::string text, std::string file, int line, LogLevel level)
+// Writes all complete messages in the ring buffer. Only called by the logger thread, or by shutdown() once it has exited.
+static uint32_t drain()
 {
-    std::lock_guard<std::mutex> lock(g_logger._log_mutex);
-
-    std::string file_with_extension = file.substr(file.find_last_of("/\\") + 1);
-    std::time(&g_logger._rawtime);
-    g_logger._timeinfo = std::localtime(&g_logger._rawtime);
-    std::strftime(g_logger._temp_buffer, 80, "%H:%M:%S", g_logger._timeinfo);
-
-    std::string log_level_string;
+    uint32_t                     written = 0;
+    std::vector<CallbackMessage> callback_messages;
+    std::string                  text;
 
-    switch (level)
+    while (true)
     {
-        case LEVEL_INFO:
+        uint32_t batch = 0;
+
         {
-            log_level_string = "INFO   ";
-            break;
+            std::lock_guard<std::mutex> lock(g_logger._output_mutex);
+
+            uint64_t pos   = g_logger._dequeue_pos.load(std::memory_order_relaxed);
+            bool     flush = false;
+
+            while (batch < DRAIN_BATCH_SIZE)
+            {
+                Record& first = g_logger._ring[pos & (RING_SIZE - 1)];
+
+                if (first.sequence.load(std::memory_order_acquire) != pos + 1)
+                    break;
+
+                uint32_t count = first.count;
+
+                text.assign(first.text, first.length);
+
+                // The producer is still filling the rest of the message.
+                for (uint32_t i = 1; i < count; i++)
+                {
+                    Record& record = g_logger._ring[(pos + i) & (RING_SIZE - 1)];
+
+                    while (record.sequence.load(std::memory_order_acquire) != pos + i + 1)
+                        std::this_thread::yield();
+
+                    text.append(record.text, record.length);
+                }
+
+                LogLevel level = LogLevel(first.level);
+
+                write(text.c_str(), text.size(), first.file, first.line, level, std::time_t(first.timestamp), first.thread_id, callback_messages);
+
+                // Flush stream if error
+                flush = flush || level == LEVEL_ERR || level == LEVEL_FATAL;
+
+                for (uint32_t i = 0; i < count; i++)
+                    g_logger._ring[(pos + i) & (RING_SIZE - 1)].sequence.store(pos + i + RING_SIZE, std::memory_order_release);
+
+                pos += count;
+                batch++;
+
+                g_logger._dequeue_pos.store(pos, std::memory_order_release);
+            }
+
+            if (flush)
+                flush_streams();
         }
-        case LEVEL_WARNING:
-        {
-            log_level_string = "WARNING";
+
+        // Without the output mutex held, so that the callback may flush or close streams.
+        for (const auto& message : callback_messages)
+            invoke_callback(message.callback, message.text, message.level);
+
+        callback_messages.clear();
+        written += batch;
+
+        if (batch < DRAIN_BATCH_SIZE)
             break;
-        }
-        case LEVEL_ERR:
+    }
+
+    return written;
+}
+
+static void thread_main()
+{
+    t_logger_thread = true;
+
+    while (true)
+    {
+        bool     running = g_logger._running.load(std::memory_order_acquire);
+        uint32_t written = drain();
+
+        if (written > 0)
         {
-            log_level_string = "ERROR  ";
-            break;
+            std::lock_guard<std::mutex> lock(g_logger._wake_mutex);
+            g_logger._written_cv.notify_all();
         }
-        case LEVEL_FATAL:
-        {
-            log_level_string = "FATAL  ";
+        else if (!running)
             break;
+        else
+        {
+            std::unique_lock<std::mutex> lock(g_logger._wake_mutex);
+            g_logger._wake_cv.wait_for(lock, std::chrono::milliseconds(IDLE_WAIT_MS), [] { return g_logger._wake || !g_logger._running; });
+            g_logger._wake = false;
         }
     }
+}
 
-    std::string output;
+// Copies the message into the ring buffer. Blocks only while the ring buffer is full.
+static void push(const char* text, size_t length, const char* file, int line, LogLevel level)
+{
+    length = std::min(length, size_t(RECORD_TEXT_SIZE * MAX_RECORDS_PER_MESSAGE));
+
+    uint32_t    count     = std::max(uint32_t((length + RECORD_TEXT_SIZE - 1) / RECORD_TEXT_SIZE), 1u);
+    uint64_t    pos       = g_logger._enqueue_pos.fetch_add(count, std::memory_order_relaxed);
+    std::time_t timestamp = std::time(nullptr);
+    uint32_t    thread_id = current_thread_id();
 
-    if ((g_logger._verbosity & VERBOSITY_TIMESTAMP) || (g_logger._verbosity & VERBOSITY_LEVEL))
+    for (uint32_t i = 0; i < count; i++)
     {
-        output = "[ ";
+        Record& record = g_logger._ring[(pos + i) & (RING_SIZE - 1)];
 
-        if (g_logger._verbosity & VERBOSITY_TIMESTAMP)
-            output += g_logger._temp_buffer;
+        // Wait for the logger thread to release the slot if the ring buffer is full.
+        while (record.sequence.load(std::memory_order_acquire) != pos + i)
+            std::this_thread::yield();
 
-        if ((g_logger._verbosity & VERBOSITY_TIMESTAMP) && (g_logger._verbosity & VERBOSITY_LEVEL))
-            output += " | ";
+        size_t offset = size_t(i) * RECORD_TEXT_SIZE;
 
-        if (g_logger._verbosity & VERBOSITY_LEVEL)
-            output += log_level_string;
+        record.file      = file;
+        record.timestamp = int64_t(timestamp);
+        record.line      = line;
+        record.thread_id = thread_id;
+        record.length    = uint32_t(std::min(length - offset, size_t(RECORD_TEXT_SIZE)));
+        record.level     = uint16_t(level);
+        record.count     = uint16_t(count);
 
-        output += " ] : ";
+        memcpy(record.text, text + offset, record.length);
+
+        record.sequence.store(pos + i + 1, std::memory_order_release);
     }
+}
 
-    output += text;
+static void log_message(const char* text, size_t length, const char* file, int line, LogLevel level)
+{
+    // Messages logged by a custom stream callback are dropped, writing them would invoke the callback again.
+    if (t_in_callback)
+        return;
 
-    if (g_logger._verbosity & VERBOSITY_FILE)
-    {
-        output += " , FILE : ";
-        output += file_with_extension;
-    }
+    // Registering as a producer before checking whether the logger thread runs makes shutdown() wait for the push to finish before
+    // its final drain, so no message is left behind in the ring buffer.
+    g_logger._producers.fetch_add(1);
 
-    if (g_logger._verbosity & VERBOSITY_LINE)
+    // Before initialize() and after shutdown() messages are written synchronously.
+    if (!g_logger._running)
     {
-        output += " , LINE : ";
-        output += std::to_string(line);
+        g_logger._producers.fetch_sub(1);
+
+        std::vector<CallbackMessage> callback_messages;
+
+        {
+            std::lock_guard<std::mutex> lock(g_logger._output_mutex);
+
+            write(text, length, file, line, level, std::time(nullptr), current_thread_id(), callback_messages);
+
+            if (level == LEVEL_ERR || level == LEVEL_FATAL || g_logger._debug)
+                flush_streams();
+        }
+
+        for (const auto& message : callback_messages)
+            invoke_callback(message.callback, message.text, message.level);
+
+        return;
     }
 
-    if (g_logger._open_streams[FILE_STREAM_INDEX])
+    push(text, length, file, line, level);
+
+    g_logger._producers.fetch_sub(1, std::memory_order_release);
+
+    // A fatal error is usually followed by an exit, make sure it has been written by then.
+    if (level == LEVEL_FATAL || g_logger._debug)
+        flush();
+}
+
+void initialize()
+{
+    if (g_logger._running)
+        return;
+
     {
-        g_logger._stream << output << "\n";
+        std::lock_guard<std::mutex> lock(g_logger._output_mutex);
+
+        for (int i = 0; i < 3; i++)
+            g_logger._open_streams[i] = false;
+
+        g_logger._callback = nullptr;
     }
 
-    if (g_logger._open_streams[CONSOLE_STREAM_INDEX])
+    g_logger._verbosity = VERBOSITY_ALL;
+    g_logger._debug     = false;
+
+    for (uint32_t i = 0; i < RING_SIZE; i++)
+        g_logger._ring[i].sequence.store(i, std::memory_order_relaxed);
+
+    g_logger._enqueue_pos = 0;
+    g_logger._dequeue_pos = 0;
+    g_logger._wake        = false;
+    g_logger._running     = true;
+    g_logger._thread      = std::thread(thread_main);
+}
+
+void shutdown()
+{
+    if (!g_logger._thread.joinable())
+        return;
+
     {
-        std::cout << output << "\n";
+        std::lock_guard<std::mutex> lock(g_logger._wake_mutex);
+
+        g_logger._running = false;
+        g_logger._wake_cv.notify_one();
+        g_logger._written_cv.notify_all();
     }
 
-    if (g_logger._open_streams[CUSTOM_STREAM_INDEX] && g_logger._callback)
+    g_logger._thread.join();
+
+    // Messages that were pushed while the thread was stopping.
+    while (g_logger._producers.load(std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+
+    drain();
+
     {
-        g_logger._callback(output, level);
+        std::lock_guard<std::mutex> lock(g_logger._output_mutex);
+        flush_streams();
     }
 
-    // Flush stream if error
-    if (level == LEVEL_ERR || level == LEVEL_FATAL || g_logger._debug)
-        flush();
+    // Wake up flush() calls that waited for these messages.
+    std::lock_guard<std::mutex> lock(g_logger._wake_mutex);
+    g_logger._written_cv.notify_all();
+}
+
+void set_verbosity(int flags)
+{
+    g_logger._verbosity = flags;
 }
 
-void log_simple(std::string text, LogLevel level)
+void open_console_stream()
 {
-    std::lock_guard<std::mutex> lock(g_logger._log_mutex);
+    std::lock_guard<std::mutex> lock(g_logger._output_mutex);
+
+    g_logger._open_streams[CONSOLE_STREAM_INDEX] = true;
 
     std::time(&g_logger._rawtime);
-    g_logger._timeinfo = std::localtime(&g_logger._rawtime);
-    std::strftime(g_logger._temp_buffer, 80, "%H:%M:%S", g_logger._timeinfo);
+    std::cout << LOG_SEPERATOR;
+    std::cout << std::ctime(&g_logger._rawtime) << "Log Started.\n";
+    std::cout << LOG_SEPERATOR;
+}
 
-    std::string log_level_string;
+void open_file_stream()
+{
+    std::lock_guard<std::mutex> lock(g_logger._output_mutex);
+
+    g_logger._open_streams[FILE_STREAM_INDEX] = true;
+    g_logger._stream.open("log.txt", std::ios::app | std::ofstream::out);
+
+    std::time(&g_logger._rawtime);
+    g_logger._stream << LOG_SEPERATOR;
+    g_logger._stream << std::ctime(&g_logger._rawtime) << "Log Started.\n";
+    g_logger._stream << LOG_SEPERATOR;
+}
+
+void open_custom_stream(CustomStreamCallback callback)
+{
+    std::string init_string;
 
-    switch (level)
     {
-        case LEVEL_INFO:
-        {
-            log_level_string = "INFO   ";
-            break;
-        }
-        case LEVEL_WARNING:
-        {
-            log_level_string = "WARNING";
-            break;
-        }
-        case LEVEL_ERR:
-        {
-            log_level_string = "ERROR  ";
-            break;
-        }
-        case LEVEL_FATAL:
-        {
-            log_level_string = "FATAL  ";
-            break;
-        }
-    }
+        std::lock_guard<std::mutex> lock(g_logger._output_mutex);
 
-    std::string output;
+        g_logger._open_streams[CUSTOM_STREAM_INDEX] = true;
+        g_logger._callback                          = callback;
 
-    if ((g_logger._verbosity & VERBOSITY_TIMESTAMP) || (g_logger._verbosity & VERBOSITY_LEVEL))
+        std::time(&g_logger._rawtime);
+        init_string = std::ctime(&g_logger._rawtime);
+        init_string += "Log Started.\n";
+    }
+
+    if (callback)
     {
-        output = "[ ";
+        invoke_callback(callback, LOG_SEPERATOR, LEVEL_INFO);
+        invoke_callback(callback, init_string, LEVEL_INFO);
+        invoke_callback(callback, LOG_SEPERATOR, LEVEL_INFO);
+    }
+}
 
-        if (g_logger._verbosity & VERBOSITY_TIMESTAMP)
-            output += g_logger._temp_buffer;
+void close_console_stream()
+{
+    // Write pending messages before the stream goes away.
+    flush();
 
-        if ((g_logger._verbosity & VERBOSITY_TIMESTAMP) && (g_logger._verbosity & VERBOSITY_LEVEL))
-            output += " | ";
+    std::lock_guard<std::mutex> lock(g_logger._output_mutex);
 
-        if (g_logger._verbosity & VERBOSITY_LEVEL)
-            output += log_level_string;
+    g_logger._open_streams[CONSOLE_STREAM_INDEX] = false;
 
-        output += " ] : ";
-    }
+    std::time(&g_logger._rawtime);
+    std::cout << LOG_SEPERATOR;
+    std::cout << std::ctime(&g_logger._rawtime) << "Log Ended.\n";
+    std::cout << LOG_SEPERATOR;
+}
 
-    output += text;
+void close_file_stream()
+{
+    flush();
 
-    if (g_logger._open_streams[FILE_STREAM_INDEX])
-    {
-        g_logger._stream << output << "\n";
-    }
+    std::lock_guard<std::mutex> lock(g_logger._output_mutex);
+
+    g_logger._open_streams[FILE_STREAM_INDEX] = false;
+
+    std::time(&g_logger._rawtime);
+    g_logger._stream << LOG_SEPERATOR;
+    g_logger._stream << std::ctime(&g_logger._rawtime) << "Log Ended.\n";
+    g_logger._stream << LOG_SEPERATOR;
+
+    g_logger._stream.close();
+}
+
+void close_custom_stream()
+{
+    flush();
+
+    CustomStreamCallback callback = nullptr;
+    std::string          init_string;
 
-    if (g_logger._open_streams[CONSOLE_STREAM_INDEX])
     {
-        std::cout << output << "\n";
+        std::lock_guard<std::mutex> lock(g_logger._output_mutex);
+
+        g_logger._open_streams[CUSTOM_STREAM_INDEX] = false;
+        callback                                    = g_logger._callback;
+
+        std::time(&g_logger._rawtime);
+        init_string = std::ctime(&g_logger._rawtime);
+        init_string += "Log Ended.\n";
     }
 
-    if (g_logger._open_streams[CUSTOM_STREAM_INDEX] && g_logger._callback)
+    if (callback)
     {
-        g_logger._callback(output, level);
+        invoke_callback(callback, LOG_SEPERATOR, LEVEL_INFO);
+        invoke_callback(callback, init_string, LEVEL_INFO);
+        invoke_callback(callback, LOG_SEPERATOR, LEVEL_INFO);
     }
 }
 
-void log_info(std::string text)
+void enable_debug_mode()
 {
-    log_simple(text, LEVEL_INFO);
+    g_logger._debug = true;
 }
 
-void log_error(std::string text)
+void disable_debug_mode()
+{
+    g_logger._debug = false;
+}
+
+void log(const std::string& text, const char* file, int line, LogLevel level)
 {
-    log_simple(text, LEVEL_ERR);
+    log_message(text.c_str(), text.size(), file, line, level);
 }
 
-void log_warning(std::string text)
+void log(const char* text, const char* file, int line, LogLevel level)
 {
-    log_simple(text, LEVEL_WARNING);
+    log_message(text, strlen(text), file, line, level);
 }
 
-void log_fatal(std::string text)
+void log_info(const std::string& text)
 {
-    log_simple(text, LEVEL_FATAL);
+    log_message(text.c_str(), text.size(), nullptr, 0, LEVEL_INFO);
+}
+
+void log_error(const std::string& text)
+{
+    log_message(text.c_str(), text.size(), nullptr, 0, LEVEL_ERR);
+}
+
+void log_warning(const std::string& text)
+{
+    log_message(text.c_str(), text.size(), nullptr, 0, LEVEL_WARNING);
+}
+
+void log_fatal(const std::string& text)
+{
+    log_message(text.c_str(), text.size(), nullptr, 0, LEVEL_FATAL);
 }
 
 void flush()
 {
-    if (g_logger._open_streams[FILE_STREAM_INDEX])
+    // Every pushed message is written eventually, by the logger thread or by the final drain in shutdown(). The logger thread itself
+    // only gets here from a custom stream callback and cannot wait for its own progress.
+    if (!t_logger_thread)
     {
-        g_logger._stream.flush();
+        uint64_t target = g_logger._enqueue_pos.load(std::memory_order_acquire);
+
+        std::unique_lock<std::mutex> lock(g_logger._wake_mutex);
+
+        g_logger._wake = true;
+        g_logger._wake_cv.notify_one();
+        g_logger._written_cv.wait(lock, [target] { return g_logger._dequeue_pos.load(std::memory_order_acquire) >= target; });
     }
+
+    std::lock_guard<std::mutex> lock(g_logger._output_mutex);
+    flush_streams();
 }
 } // namespace logger
-} // namespace nimble
+} // namespace nimble
\ No newline at end of file
@@ -2,11 +2,32 @@
 
 #include <string>
 
+// Lowest level that is compiled in: 0 info, 1 warning, 2 error. Calls below it are removed entirely, including the evaluation of the
+// message. Fatal errors are always logged.
+#ifndef NIMBLE_LOG_LEVEL
+#    define NIMBLE_LOG_LEVEL 0
+#endif
+
 // Macros for quick access. File and line are added through the respective macros.
-#define NIMBLE_LOG_INFO(x) nimble::logger::log(x, std::string(__FILE__), __LINE__, nimble::logger::LEVEL_INFO)
-#define NIMBLE_LOG_WARNING(x) nimble::logger::log(x, std::string(__FILE__), __LINE__, nimble::logger::LEVEL_WARNING)
-#define NIMBLE_LOG_ERROR(x) nimble::logger::log(x, std::string(__FILE__), __LINE__, nimble::logger::LEVEL_ERR)
-#define NIMBLE_LOG_FATAL(x) nimble::logger::log(x, std::string(__FILE__), __LINE__, nimble::logger::LEVEL_FATAL)
+#if NIMBLE_LOG_LEVEL <= 0
+#    define NIMBLE_LOG_INFO(x) nimble::logger::log(x, __FILE__, __LINE__, nimble::logger::LEVEL_INFO)
+#else
+#    define NIMBLE_LOG_INFO(x) ((void)0)
+#endif
+
+#if NIMBLE_LOG_LEVEL <= 1
+#    define NIMBLE_LOG_WARNING(x) nimble::logger::log(x, __FILE__, __LINE__, nimble::logger::LEVEL_WARNING)
+#else
+#    define NIMBLE_LOG_WARNING(x) ((void)0)
+#endif
+
+#if NIMBLE_LOG_LEVEL <= 2
+#    define NIMBLE_LOG_ERROR(x) nimble::logger::log(x, __FILE__, __LINE__, nimble::logger::LEVEL_ERR)
+#else
+#    define NIMBLE_LOG_ERROR(x) ((void)0)
+#endif
+
+#define NIMBLE_LOG_FATAL(x) nimble::logger::log(x, __FILE__, __LINE__, nimble::logger::LEVEL_FATAL)
 
 namespace nimble
 {
@@ -27,13 +48,21 @@ enum LogVerbosity
     VERBOSITY_LEVEL     = 0x02,
     VERBOSITY_FILE      = 0x04,
     VERBOSITY_LINE      = 0x08,
-    VERBOSITY_ALL       = 0x0f
+    VERBOSITY_THREAD    = 0x10,
+    VERBOSITY_ALL       = 0x1f
 };
 
-// Custom stream callback type. Use to implement your own logging stream such as through a network etc.
+// Custom stream callback type. Use to implement your own logging stream such as through a network etc. Called from the logger
+// thread without any logger lock held. Messages logged from within the callback are dropped.
 typedef void (*CustomStreamCallback)(std::string, LogLevel);
 
+// Starts the logger thread. Messages are copied into a lock-free ring buffer by the calling thread and formatted and written to the
+// streams by the logger thread, so logging never waits on I/O unless the ring buffer is full.
 extern void initialize();
+
+// Writes all pending messages and stops the logger thread. Messages logged afterwards are written synchronously.
+extern void shutdown();
+
 extern void set_verbosity(int flags);
 
 // Open streams.
@@ -50,16 +79,18 @@ extern void close_custom_stream();
 extern void enable_debug_mode();
 extern void disable_debug_mode();
 
-// Main log method. File, line and level are required in addition to log message.
-extern void log(std::string text, std::string file, int line, LogLevel level);
+// Main log method. File, line and level are required in addition to log message. The file must be a string literal, only the pointer
+// is stored. Fatal errors block until they have been written and the streams flushed.
+extern void log(const std::string& text, const char* file, int line, LogLevel level);
+extern void log(const char* text, const char* file, int line, LogLevel level);
 
 // Simplified API.
-extern void log_info(std::string text);
-extern void log_error(std::string text);
-extern void log_warning(std::string text);
-extern void log_fatal(std::string text);
+extern void log_info(const std::string& text);
+extern void log_error(const std::string& text);
+extern void log_warning(const std::string& text);
+extern void log_fatal(const std::string& text);
 
-// Explicitly flush all streams.
+// Blocks until every message logged before the call has been written, then flushes all streams.
 extern void flush();
 } // namespace logger
-} // namespace nimble
+} // namespace nimble
\ No newline at end of file
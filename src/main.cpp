@@ -5,6 +5,8 @@
 #include <memory>
 #include "application.h"
 #include "camera.h"
+#include "camera_path.h"
+#include "scene_generator.h"
 #include "utility.h"
 #include "material.h"
 #include "macros.h"
@@ -27,10 +29,15 @@
 #include "nodes/reflection_node.h"
 #include "nodes/fxaa_node.h"
 #include "nodes/depth_of_field_node.h"
+#include "nodes/taa_node.h"
 #include "debug_draw.h"
 #include "imgui_helpers.h"
 #include "external/nfd/nfd.h"
 #include "profiler.h"
+#include "frame_stats.h"
+#include "state_cache.h"
+#include "render_stats.h"
+#include "gl_debug.h"
 #include "probe_renderer/bruneton_probe_renderer.h"
 #include "ImGuizmo.h"
 #include <random>
@@ -48,16 +55,26 @@ protected:
 
     bool init(int argc, const char* argv[]) override
     {
-        // Attempt to load startup scene.
-        std::shared_ptr<Scene> scene = m_resource_manager.load_scene("scene/startup.json");
-
-        // If failed, prompt user to select scene to be loaded.
-        if (!scene && !load_scene_from_dialog())
-            return false;
+        if (scene_generator::parse_arguments(argc, argv, m_generator_settings))
+        {
+            // Generated scenes come with their own lights.
+            m_scene           = scene_generator::generate(m_generator_settings);
+            m_generated_scene = true;
+        }
         else
-            m_scene = scene;
+        {
+            // Attempt to load startup scene.
+            std::shared_ptr<Scene> scene = m_resource_manager.load_scene("scene/startup.json");
+
+            // If failed, prompt user to select scene to be loaded.
+            if (!scene && !load_scene_from_dialog())
+                return false;
+            else
+                m_scene = scene;
+
+            m_scene->create_directional_light(glm::vec3(45.0f, 0.0f, 0.0f), glm::vec3(1.0f), 10.0f);
+        }
 
-        m_scene->create_directional_light(glm::vec3(45.0f, 0.0f, 0.0f), glm::vec3(1.0f), 10.0f);
         //create_random_point_lights();
         //create_random_spot_lights();
 
@@ -83,6 +100,12 @@ protected:
         if (!m_edit_mode)
         {
 #endif
+            if (m_generated_scene)
+            {
+                m_scene_time += float(delta / 1000.0);
+                scene_generator::animate(m_scene.get(), m_scene_time);
+            }
+
             if (m_scene)
                 m_scene->update();
 #ifdef NIMBLE_EDITOR
@@ -120,16 +143,15 @@ protected:
 
     void window_resized(int width, int height) override
     {
+        m_renderer.on_window_resized(width, height);
+
         if (m_scene)
         {
-            m_scene->camera()->m_width  = m_width;
-            m_scene->camera()->m_height = m_height;
+            update_camera_resolution();
 
             // Override window resized method to update camera projection.
             m_scene->camera()->update_projection(60.0f, 0.1f, CAMERA_FAR_PLANE, float(m_width) / float(m_height));
         }
-
-        m_renderer.on_window_resized(width, height);
     }
 
     // -----------------------------------------------------------------------------------------------------------------------------------
@@ -190,14 +212,23 @@ private:
 
     void create_camera()
     {
-        m_scene->camera()->m_width             = m_width;
-        m_scene->camera()->m_height            = m_height;
-        m_scene->camera()->m_half_pixel_jitter = false;
+        m_scene->camera()->m_upscale_jitter = m_forward_graph && m_forward_graph->is_upscaled();
+        update_camera_resolution();
         m_scene->camera()->update_projection(60.0f, 0.1f, CAMERA_FAR_PLANE, float(m_width) / float(m_height));
     }
 
     // -----------------------------------------------------------------------------------------------------------------------------------
 
+    // The projection jitter is measured in rendered pixels, which are larger than window pixels when rendering below the output
+    // resolution.
+    void update_camera_resolution()
+    {
+        m_scene->camera()->m_width  = m_forward_graph ? m_forward_graph->rendered_viewport_width() : m_width;
+        m_scene->camera()->m_height = m_forward_graph ? m_forward_graph->rendered_viewport_height() : m_height;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
     void create_render_graphs()
     {
         REGISTER_RENDER_NODE(ForwardNode, m_resource_manager);
@@ -218,6 +249,7 @@ private:
         REGISTER_RENDER_NODE(ReflectionNode, m_resource_manager);
         REGISTER_RENDER_NODE(FXAANode, m_resource_manager);
         REGISTER_RENDER_NODE(DepthOfFieldNode, m_resource_manager);
+        REGISTER_RENDER_NODE(TAANode, m_resource_manager);
 
         // Create Forward render graph
         m_forward_graph = m_resource_manager.load_render_graph("graph/deferred_graph.json", &m_renderer);
@@ -242,6 +274,9 @@ private:
         m_renderer.set_global_probe_renderer(m_bruneton_probe_renderer);
 
         m_renderer.set_scene_render_graph(m_forward_graph);
+
+        // Temporal upscalers need a differently jittered projection every frame.
+        m_scene->camera()->m_upscale_jitter = m_forward_graph && m_forward_graph->is_upscaled();
     }
 
     // -----------------------------------------------------------------------------------------------------------------------------------
@@ -414,8 +449,35 @@ private:
             if (ImGui::CollapsingHeader("Profiler"))
                 profiler::ui();
 
+            if (ImGui::CollapsingHeader("Frame Statistics"))
+                frame_stats::ui();
+
+            if (ImGui::CollapsingHeader("State Cache"))
+                state_cache::ui();
+
+            if (ImGui::CollapsingHeader("Render Stats"))
+                render_stats::ui();
+
+            if (ImGui::CollapsingHeader("OpenGL Debug Output"))
+                gl_debug::ui();
+
             if (ImGui::CollapsingHeader("Render Graph"))
+            {
+                if (m_forward_graph && m_forward_graph->is_upscaled())
+                {
+                    Renderer::Settings settings = m_renderer.settings();
+
+                    if (ImGui::SliderFloat("Render Scale", &settings.render_scale, 0.5f, 1.0f))
+                    {
+                        m_renderer.set_settings(settings);
+
+                        if (m_scene)
+                            update_camera_resolution();
+                    }
+                }
+
                 render_node_params();
+            }
 
             if (m_renderer.global_probe_renderer())
             {
@@ -446,10 +508,31 @@ private:
             {
 				std::shared_ptr<Camera> camera = m_scene->camera();
 
+				ImGui::Checkbox("Jitter", &camera->m_upscale_jitter);
 				ImGui::SliderFloat("Near Field Begin", &camera->m_near_begin, camera->m_near, camera->m_far);
                 ImGui::SliderFloat("Near Field End", &camera->m_near_end, camera->m_near, camera->m_far);
                 ImGui::SliderFloat("Far Field Begin", &camera->m_far_begin, camera->m_near, camera->m_far);
                 ImGui::SliderFloat("Far Field End", &camera->m_far_end, camera->m_near, camera->m_far);
+
+                ImGui::Separator();
+
+                // Recorded paths can be played back by the benchmark (--camera-path).
+                if (m_recording_camera_path)
+                {
+                    ImGui::Text("Recording: %u keyframes, %.1f s", uint32_t(m_camera_path.keyframes().size()), m_camera_path.duration());
+
+                    if (ImGui::Button("Stop Recording"))
+                    {
+                        m_recording_camera_path = false;
+                        m_camera_path.save("camera_path.json");
+                    }
+                }
+                else if (ImGui::Button("Record Path"))
+                {
+                    m_camera_path.clear();
+                    m_camera_path_time      = 0.0f;
+                    m_recording_camera_path = true;
+                }
 			}
 
             if (ImGui::CollapsingHeader("Point Lights"))
@@ -762,6 +845,12 @@ private:
             }
 
             current->update();
+
+            if (m_recording_camera_path)
+            {
+                m_camera_path.add_keyframe(m_camera_path_time, current->m_position, current->m_orientation);
+                m_camera_path_time += float(m_delta / 1000.0);
+            }
         }
     }
 
@@ -779,6 +868,16 @@ private:
     float m_camera_sensitivity = 0.05f;
     float m_camera_speed       = 0.1f;
 
+    // Camera path recording.
+    CameraPath m_camera_path;
+    bool       m_recording_camera_path = false;
+    float      m_camera_path_time      = 0.0f;
+
+    // Procedurally generated scene, see --generate.
+    scene_generator::Settings m_generator_settings;
+    bool                      m_generated_scene = false;
+    float                     m_scene_time      = 0.0f;
+
     std::shared_ptr<Scene>                 m_scene;
     std::shared_ptr<RenderGraph>           m_forward_graph;
     std::shared_ptr<ShadowRenderGraph>     m_pcf_point_light_graph;
@@ -1,10 +1,32 @@
 #include "material.h"
 #include "ogl.h"
+#include "state_cache.h"
+#include "render_stats.h"
 
 namespace nimble
 {
 static uint32_t g_last_material_id = 0;
 
+static const UniformHandle kSurfaceTextureHandles[] = {
+    NIMBLE_UNIFORM_HANDLE("s_Albedo"),
+    NIMBLE_UNIFORM_HANDLE("s_Normal"),
+    NIMBLE_UNIFORM_HANDLE("s_MetalSpec"),
+    NIMBLE_UNIFORM_HANDLE("s_RoughSmooth"),
+    NIMBLE_UNIFORM_HANDLE("s_Displacement"),
+    NIMBLE_UNIFORM_HANDLE("s_Emissive")
+};
+
+static const UniformHandle kCustomTextureHandles[] = {
+    NIMBLE_UNIFORM_HANDLE("s_Texture1"),
+    NIMBLE_UNIFORM_HANDLE("s_Texture2"),
+    NIMBLE_UNIFORM_HANDLE("s_Texture3"),
+    NIMBLE_UNIFORM_HANDLE("s_Texture4"),
+    NIMBLE_UNIFORM_HANDLE("s_Texture5"),
+    NIMBLE_UNIFORM_HANDLE("s_Texture6"),
+    NIMBLE_UNIFORM_HANDLE("s_Texture7"),
+    NIMBLE_UNIFORM_HANDLE("s_Texture8")
+};
+
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 Material::Material() :
@@ -15,6 +37,8 @@ Material::Material() :
 
     for (uint32_t i = 0; i < MAX_MATERIAL_TEXTURES; i++)
         m_surface_textures[i] = nullptr;
+
+    update_texture_table();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -25,46 +49,53 @@ Material::~Material()
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-void Material::bind(Program* program, int32_t& unit)
+void Material::set_texture_units(Program* program, int32_t first_unit)
 {
-    // Bind surface textures
-    bind_surface_textures(program, unit);
+    for (uint32_t i = 0; i < TEXTURE_TYPE_CUSTOM; i++)
+        program->set_uniform(kSurfaceTextureHandles[i], first_unit + int32_t(i));
 
-    // Bind custom textures
-    bind_custom_textures(program, unit);
+    for (uint32_t i = 0; i < MAX_MATERIAL_TEXTURES; i++)
+        program->set_uniform(kCustomTextureHandles[i], first_unit + int32_t(TEXTURE_TYPE_CUSTOM + i));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-void Material::bind_surface_texture(TextureType type, Program* program, int32_t& unit)
+void Material::bind_textures(int32_t& unit)
 {
-    if (m_surface_textures[type])
-    {
-        if (program->set_uniform(kSurfaceTextureNames[type], unit))
-            m_surface_textures[type]->bind(unit++);
-    }
+    render_stats::add(render_stats::COUNTER_TEXTURE_BINDS, m_texture_unit_count);
+    state_cache::bind_textures(unit, m_texture_unit_count, &m_texture_targets[0], &m_texture_ids[0]);
+    unit += m_texture_unit_count;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-void Material::bind_surface_textures(Program* program, int32_t& unit)
+void Material::bind(Program* program, int32_t& unit)
 {
-    for (uint32_t i = 0; i < (MAX_MATERIAL_TEXTURES - 1); i++)
-        bind_surface_texture(static_cast<TextureType>(i), program, unit);
+    set_texture_units(program, unit);
+    bind_textures(unit);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-void Material::bind_custom_textures(Program* program, int32_t& unit)
+void Material::update_texture_table()
 {
-    for (uint32_t i = 0; i < m_custom_texture_count; i++)
+    for (uint32_t i = 0; i < TEXTURE_TYPE_CUSTOM; i++)
     {
-        if (m_custom_textures[i])
-        {
-            if (program->set_uniform(kCustomTextureNames[i], unit))
-                m_custom_textures[i]->bind(unit++);
-        }
+        m_texture_targets[i] = m_surface_textures[i] ? m_surface_textures[i]->target() : GL_TEXTURE_2D;
+        m_texture_ids[i]     = m_surface_textures[i] ? m_surface_textures[i]->id() : 0;
     }
+
+    for (uint32_t i = 0; i < MAX_MATERIAL_TEXTURES; i++)
+    {
+        m_texture_targets[TEXTURE_TYPE_CUSTOM + i] = m_custom_textures[i] ? m_custom_textures[i]->target() : GL_TEXTURE_2D;
+        m_texture_ids[TEXTURE_TYPE_CUSTOM + i]     = m_custom_textures[i] ? m_custom_textures[i]->id() : 0;
+    }
+
+    // Trailing empty surface units are not worth binding when there are no custom textures.
+    m_texture_unit_count = TEXTURE_TYPE_CUSTOM + m_custom_texture_count;
+
+    while (m_texture_unit_count > 0 && m_custom_texture_count == 0 && m_texture_ids[m_texture_unit_count - 1] == 0)
+        m_texture_unit_count--;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
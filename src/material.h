@@ -8,6 +8,7 @@
 #include "shader_key.h"
 #include "uniforms.h"
 #include "murmur_hash.h"
+#include "glad.h"
 
 namespace nimble
 {
@@ -16,26 +17,7 @@ class Program;
 class UniformBuffer;
 
 #define MAX_MATERIAL_TEXTURES 8
-
-static const std::string kSurfaceTextureNames[] = {
-    "s_Albedo",
-    "s_Normal",
-    "s_MetalSpec",
-    "s_RoughSmooth",
-    "s_Displacement",
-    "s_Emissive"
-};
-
-static const std::string kCustomTextureNames[] = {
-    "s_Texture1",
-    "s_Texture2",
-    "s_Texture3",
-    "s_Texture4",
-    "s_Texture5",
-    "s_Texture6",
-    "s_Texture7",
-    "s_Texture8"
-};
+#define INVALID_MATERIAL_INDEX UINT32_MAX
 
 enum ShadingModel : uint32_t
 {
@@ -76,6 +58,10 @@ enum TextureType : uint32_t
     TEXTURE_TYPE_CUSTOM
 };
 
+// Every material uses the same texture unit layout: surface textures occupy one unit per TextureType (empty ones are left unbound)
+// followed by the custom textures. Sampler uniforms can therefore be assigned once per program instead of once per draw.
+#define MATERIAL_TEXTURE_UNITS (TEXTURE_TYPE_CUSTOM + MAX_MATERIAL_TEXTURES)
+
 class Material
 {
     friend class ResourceManager;
@@ -84,11 +70,16 @@ public:
     Material();
     ~Material();
 
-    // Bind textures and material constants to pipeline.
+    // Points the sampler uniforms of a program at the shared texture unit layout starting at first_unit.
+    static void set_texture_units(Program* program, int32_t first_unit);
+
+    // Bind all textures of this material with a single call, starting at unit. Material constants live in the shared material
+    // buffer and are selected through buffer_index().
+    void bind_textures(int32_t& unit);
+
+    // Set the texture units of the program and bind the textures. Only meant for one-off draws; batched draws should call
+    // set_texture_units once per program instead.
     void bind(Program* program, int32_t& unit);
-    void bind_surface_texture(TextureType type, Program* program, int32_t& unit);
-    void bind_surface_textures(Program* program, int32_t& unit);
-    void bind_custom_textures(Program* program, int32_t& unit);
 
     // Property setters.
     inline void set_name(const std::string& name)
@@ -122,12 +113,25 @@ public:
             m_has_fragment_shader_func = true;
         }
     }
-    inline void set_custom_texture_count(const uint32_t& count) { m_custom_texture_count = count; }
+    inline void set_custom_texture_count(const uint32_t& count)
+    {
+        m_custom_texture_count = count;
+        update_texture_table();
+    }
     inline void set_custom_texture(const uint32_t& index, std::shared_ptr<Texture> texture)
     {
-        if (index < m_custom_texture_count) { m_custom_textures[index] = texture; }
+        if (index < m_custom_texture_count)
+        {
+            m_custom_textures[index] = texture;
+            update_texture_table();
+        }
     }
-    inline void set_surface_texture(TextureType type, std::shared_ptr<Texture> texture) { m_surface_textures[type] = texture; }
+    inline void set_surface_texture(TextureType type, std::shared_ptr<Texture> texture)
+    {
+        m_surface_textures[type] = texture;
+        update_texture_table();
+    }
+    inline void set_buffer_index(const uint32_t& index) { m_buffer_index = index; }
     inline void set_program_key(const ProgramKey& key) { m_program_key = key; }
     inline void set_vs_key(const VertexShaderKey& key) { m_vs_key = key; }
     inline void set_fs_key(const FragmentShaderKey& key) { m_fs_key = key; }
@@ -157,6 +161,10 @@ public:
     inline ProgramKey                program_key() { return m_program_key; }
     inline VertexShaderKey           vs_key() { return m_vs_key; }
     inline FragmentShaderKey         fs_key() { return m_fs_key; }
+    inline uint32_t                  buffer_index() { return m_buffer_index; }
+
+private:
+    void update_texture_table();
 
 private:
     uint32_t                 m_id;
@@ -180,5 +188,9 @@ private:
     ProgramKey               m_program_key;
     VertexShaderKey          m_vs_key;
     FragmentShaderKey        m_fs_key;
+    uint32_t                 m_buffer_index       = INVALID_MATERIAL_INDEX;
+    uint32_t                 m_texture_unit_count = 0;
+    GLenum                   m_texture_targets[MATERIAL_TEXTURE_UNITS];
+    GLuint                   m_texture_ids[MATERIAL_TEXTURE_UNITS];
 };
 } // namespace nimble
\ No newline at end of file
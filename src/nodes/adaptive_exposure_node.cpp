@@ -8,9 +8,9 @@ namespace nimble
 {
 DEFINE_RENDER_NODE_FACTORY(AdaptiveExposureNode)
 
-#define LUM_THREADS 8
-#define AVG_LUM_THREADS 8
-#define LUM_SIZE 1024
+#define HISTOGRAM_THREADS 16
+#define HISTOGRAM_BIN_COUNT 256
+#define HISTOGRAM_BINDING 5
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
@@ -31,9 +31,7 @@ void AdaptiveExposureNode::declare_connections()
 {
     register_input_render_target("Color");
 
-    m_luma_rt         = register_intermediate_render_target("InitialLuma", LUM_SIZE, LUM_SIZE, GL_TEXTURE_2D, GL_R32F, GL_RED, GL_FLOAT);
-    m_compute_luma_rt = register_intermediate_render_target("ComputeLuma", LUM_SIZE / 2, LUM_SIZE / 2, GL_TEXTURE_2D, GL_R32F, GL_RED, GL_FLOAT);
-    m_avg_luma_rt     = register_output_render_target("Luminance", 1, 1, GL_TEXTURE_2D, GL_R32F, GL_RED, GL_FLOAT);
+    m_avg_luma_rt = register_output_render_target("Luminance", 1, 1, GL_TEXTURE_2D, GL_R32F, GL_RED, GL_FLOAT);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -42,48 +40,39 @@ bool AdaptiveExposureNode::initialize(Renderer* renderer, ResourceManager* res_m
 {
     register_float_parameter("Middle Grey", m_middle_grey);
     register_float_parameter("Rate", m_rate);
+    register_float_parameter("Min Log Luminance", m_min_log_luma, -16.0f, 0.0f);
+    register_float_parameter("Max Log Luminance", m_max_log_luma, 0.0f, 16.0f);
+    register_float_parameter("Low Percentile", m_low_percentile, 0.0f, 1.0f);
+    register_float_parameter("High Percentile", m_high_percentile, 0.0f, 1.0f);
 
     m_color_rt = find_input_render_target("Color");
 
-    m_luma_rtv = RenderTargetView(0, 0, 0, m_luma_rt->texture);
+    // The average pass clears the histogram after reading it, so it only has to start out zeroed.
+    uint32_t histogram[HISTOGRAM_BIN_COUNT] = { 0 };
+    m_histogram_ssbo                        = std::make_unique<ShaderStorageBuffer>(GL_DYNAMIC_DRAW, sizeof(histogram), histogram);
 
-    m_vs = res_mgr->load_shader("shader/post_process/fullscreen_triangle_vs.glsl", GL_VERTEX_SHADER);
+    m_histogram_cs = res_mgr->load_shader("shader/post_process/adaptive_exposure/luminance_histogram_cs.glsl", GL_COMPUTE_SHADER);
 
-    if (m_vs)
-    {
-        m_lum_fs = res_mgr->load_shader("shader/post_process/adaptive_exposure/initial_luminance_fs.glsl", GL_FRAGMENT_SHADER);
-
-        if (m_lum_fs)
-            m_lum_program = renderer->create_program(m_vs, m_lum_fs);
-        else
-            return false;
-
-        m_compute_lum_fs = res_mgr->load_shader("shader/post_process/adaptive_exposure/compute_luminance_cs.glsl", GL_COMPUTE_SHADER);
-
-        if (m_compute_lum_fs)
-            m_compute_lum_program = renderer->create_program({ m_compute_lum_fs });
-        else
-            return false;
-
-        m_average_lum_fs = res_mgr->load_shader("shader/post_process/adaptive_exposure/average_luminance_cs.glsl", GL_COMPUTE_SHADER);
+    if (m_histogram_cs)
+        m_histogram_program = renderer->create_program({ m_histogram_cs });
+    else
+        return false;
 
-        if (m_average_lum_fs)
-            m_average_lum_program = renderer->create_program({ m_average_lum_fs });
-        else
-            return false;
+    m_average_lum_cs = res_mgr->load_shader("shader/post_process/adaptive_exposure/average_luminance_cs.glsl", GL_COMPUTE_SHADER);
 
-        return true;
-    }
+    if (m_average_lum_cs)
+        m_average_lum_program = renderer->create_program({ m_average_lum_cs });
     else
         return false;
+
+    return true;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void AdaptiveExposureNode::execute(double delta, Renderer* renderer, Scene* scene, View* view)
 {
-    initial_luminance(renderer, scene, view);
-    compute_luminance(renderer, scene, view);
+    luminance_histogram(renderer, scene, view);
     average_luminance(delta, renderer, scene, view);
 }
 
@@ -102,65 +91,56 @@ std::string AdaptiveExposureNode::name()
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-void AdaptiveExposureNode::initial_luminance(Renderer* renderer, Scene* scene, View* view)
+void AdaptiveExposureNode::luminance_histogram(Renderer* renderer, Scene* scene, View* view)
 {
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Initial Luminance");
+    NIMBLE_SCOPED_DEBUG_GROUP("Luminance Histogram");
 
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    m_histogram_program->use();
 
-    m_lum_program->use();
+    m_histogram_ssbo->bind_base(HISTOGRAM_BINDING);
 
-    if (m_lum_program->set_uniform("s_Texture", 0))
+    if (m_histogram_program->set_uniform("s_Color", 0))
         m_color_rt->texture->bind(0);
 
-    renderer->bind_render_targets(1, &m_luma_rtv, nullptr);
-    glViewport(0, 0, LUM_SIZE, LUM_SIZE);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    render_fullscreen_triangle(renderer, nullptr);
-
-    glPopDebugGroup();
-}
-
-// -----------------------------------------------------------------------------------------------------------------------------------
-
-void AdaptiveExposureNode::compute_luminance(Renderer* renderer, Scene* scene, View* view)
-{
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Compute Luminance");
-
-    m_compute_lum_program->use();
+    uint32_t w = viewport_width();
+    uint32_t h = viewport_height();
 
-    m_compute_luma_rt->texture->bind_image(0, 0, 0, GL_READ_WRITE, GL_R32F);
+    m_histogram_program->set_uniform("u_Size", glm::vec2(float(w), float(h)));
+    m_histogram_program->set_uniform("u_MinLogLuma", m_min_log_luma);
+    m_histogram_program->set_uniform("u_InvLogLumaRange", 1.0f / std::max(m_max_log_luma - m_min_log_luma, 0.001f));
 
-    if (m_compute_lum_program->set_uniform("u_InitialLuma", 0))
-        m_luma_rt->texture->bind(0);
+    // One thread per 2x2 quad of the color buffer.
+    uint32_t tile_size = HISTOGRAM_THREADS * 2;
 
-    glDispatchCompute(512 / LUM_THREADS, 512 / LUM_THREADS, 1);
+    dispatch_compute((w + tile_size - 1) / tile_size, (h + tile_size - 1) / tile_size, 1);
 
-    glPopDebugGroup();
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void AdaptiveExposureNode::average_luminance(double delta, Renderer* renderer, Scene* scene, View* view)
 {
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Average Luminance");
+    NIMBLE_SCOPED_DEBUG_GROUP("Average Luminance");
 
     m_average_lum_program->use();
 
-    m_compute_luma_rt->texture->bind_image(0, 0, 0, GL_READ_ONLY, GL_R32F);
+    m_histogram_ssbo->bind_base(HISTOGRAM_BINDING);
 
-    m_avg_luma_rt->texture->bind_image(1, 0, 0, GL_READ_WRITE, GL_R32F);
+    m_avg_luma_rt->texture->bind_image(0, 0, 0, GL_READ_WRITE, GL_R32F);
 
     m_average_lum_program->set_uniform("u_MiddleGrey", m_middle_grey);
     m_average_lum_program->set_uniform("u_Rate", m_rate);
     m_average_lum_program->set_uniform("u_Delta", static_cast<float>(delta) / 1000.0f);
     m_average_lum_program->set_uniform("u_First", m_first ? 1 : 0);
+    m_average_lum_program->set_uniform("u_MinLogLuma", m_min_log_luma);
+    m_average_lum_program->set_uniform("u_LogLumaRange", std::max(m_max_log_luma - m_min_log_luma, 0.001f));
+    m_average_lum_program->set_uniform("u_LowPercentile", m_low_percentile);
+    m_average_lum_program->set_uniform("u_HighPercentile", std::max(m_high_percentile, m_low_percentile));
 
-    glDispatchCompute(1, 1, 1);
+    dispatch_compute(1, 1, 1);
 
-    glPopDebugGroup();
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
 
     if (m_first)
         m_first = false;
@@ -17,32 +17,28 @@ public:
     std::string name() override;
 
 private:
-    void initial_luminance(Renderer* renderer, Scene* scene, View* view);
-    void compute_luminance(Renderer* renderer, Scene* scene, View* view);
+    void luminance_histogram(Renderer* renderer, Scene* scene, View* view);
     void average_luminance(double delta, Renderer* renderer, Scene* scene, View* view);
 
 private:
     std::shared_ptr<RenderTarget> m_color_rt;
-    std::shared_ptr<RenderTarget> m_luma_rt;
-    std::shared_ptr<RenderTarget> m_compute_luma_rt;
     std::shared_ptr<RenderTarget> m_avg_luma_rt;
 
-    RenderTargetView m_luma_rtv;
+    std::unique_ptr<ShaderStorageBuffer> m_histogram_ssbo;
 
-    std::shared_ptr<Shader> m_vs;
+    std::shared_ptr<Shader>  m_histogram_cs;
+    std::shared_ptr<Program> m_histogram_program;
 
-    std::shared_ptr<Shader>  m_lum_fs;
-    std::shared_ptr<Program> m_lum_program;
-
-    std::shared_ptr<Shader>  m_compute_lum_fs;
-    std::shared_ptr<Program> m_compute_lum_program;
-
-    std::shared_ptr<Shader>  m_average_lum_fs;
+    std::shared_ptr<Shader>  m_average_lum_cs;
     std::shared_ptr<Program> m_average_lum_program;
 
-    float m_middle_grey = 0.18f;
-    float m_rate        = 1.1f;
-    bool  m_first       = true;
+    float m_middle_grey     = 0.18f;
+    float m_rate            = 1.1f;
+    float m_min_log_luma    = -10.0f;
+    float m_max_log_luma    = 2.0f;
+    float m_low_percentile  = 0.1f;
+    float m_high_percentile = 0.9f;
+    bool  m_first           = true;
 };
 
 DECLARE_RENDER_NODE_FACTORY(AdaptiveExposureNode);
@@ -5,6 +5,11 @@
 #include "../logger.h"
 #include "../profiler.h"
 
+#define BLOOM_CHAIN_SCALE 0.5f
+#define BLOOM_TILE_SIZE 32
+#define BLOOM_UPSAMPLE_NUM_THREADS 8
+#define BLOOM_COMPOSITE_NUM_THREADS 8
+
 namespace nimble
 {
 DEFINE_RENDER_NODE_FACTORY(BloomNode)
@@ -14,9 +19,11 @@ DEFINE_RENDER_NODE_FACTORY(BloomNode)
 BloomNode::BloomNode(RenderGraph* graph) :
     RenderNode(graph)
 {
-    m_enabled   = true;
-    m_threshold = 1.0f;
-    m_strength  = 0.65f;
+    m_enabled      = true;
+    m_use_compute  = true;
+    m_threshold    = 1.0f;
+    m_strength     = 0.65f;
+    m_chain_length = BLOOM_TEX_CHAIN_SIZE;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -31,7 +38,9 @@ void BloomNode::declare_connections()
 {
     register_input_render_target("Color");
 
-    m_composite_rt = register_scaled_output_render_target("Bloom", 1.0f, 1.0f, GL_TEXTURE_2D, GL_RGB16F, GL_RGB, GL_HALF_FLOAT);
+    // RGBA so that the compute composite can write it as an image.
+    m_composite_rt = register_scaled_output_render_target("Bloom", 1.0f, 1.0f, GL_TEXTURE_2D, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+    m_chain_rt     = register_scaled_intermediate_render_target("Chain", BLOOM_CHAIN_SCALE, BLOOM_CHAIN_SCALE, GL_TEXTURE_2D, GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT, 1, 1, BLOOM_MAX_CHAIN_SIZE);
 
     // Clear earlier render targets.
     for (uint32_t i = 0; i < BLOOM_TEX_CHAIN_SIZE; i++)
@@ -52,6 +61,8 @@ bool BloomNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
     register_bool_parameter("Enabled", m_enabled);
     register_float_parameter("Threshold", m_threshold, 0.0f, 1.0f);
     register_float_parameter("Strength", m_strength, 0.0f, 1.0f);
+    register_bool_parameter("Compute", m_use_compute);
+    register_int_parameter("Chain Length", m_chain_length, 1, BLOOM_MAX_CHAIN_SIZE);
 
     m_color_rt      = find_input_render_target("Color");
     m_composite_rtv = RenderTargetView(0, 0, 0, m_composite_rt->texture);
@@ -64,6 +75,26 @@ bool BloomNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
     m_bloom_downsample_fs = res_mgr->load_shader("shader/post_process/bloom/downsample_fs.glsl", GL_FRAGMENT_SHADER);
     m_bloom_upsample_fs   = res_mgr->load_shader("shader/post_process/bloom/upsample_fs.glsl", GL_FRAGMENT_SHADER);
     m_bloom_composite_fs  = res_mgr->load_shader("shader/post_process/bloom/composite_fs.glsl", GL_FRAGMENT_SHADER);
+    m_bloom_downsample_cs = res_mgr->load_shader("shader/post_process/bloom/downsample_cs.glsl", GL_COMPUTE_SHADER);
+    m_bloom_upsample_cs   = res_mgr->load_shader("shader/post_process/bloom/upsample_cs.glsl", GL_COMPUTE_SHADER);
+    m_bloom_composite_cs  = res_mgr->load_shader("shader/post_process/bloom/composite_cs.glsl", GL_COMPUTE_SHADER);
+
+    on_window_resized(viewport_width(), viewport_height());
+
+    if (m_bloom_downsample_cs)
+        m_bloom_downsample_compute_program = renderer->create_program({ m_bloom_downsample_cs });
+    else
+        return false;
+
+    if (m_bloom_upsample_cs)
+        m_bloom_upsample_compute_program = renderer->create_program({ m_bloom_upsample_cs });
+    else
+        return false;
+
+    if (m_bloom_composite_cs)
+        m_bloom_composite_compute_program = renderer->create_program({ m_bloom_composite_cs });
+    else
+        return false;
 
     if (m_triangle_vs)
     {
@@ -97,14 +128,25 @@ bool BloomNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 
 void BloomNode::execute(double delta, Renderer* renderer, Scene* scene, View* view)
 {
-    blit_render_target(renderer, m_color_rt, m_composite_rt);
+    if (m_enabled && m_use_compute)
+    {
+        NIMBLE_SCOPED_SAMPLE("Bloom Compute");
 
-    if (m_enabled)
+        downsample_compute(renderer);
+        upsample_compute(renderer);
+        composite_compute(renderer);
+    }
+    else
     {
-        bright_pass(renderer);
-        downsample(renderer);
-        upsample(renderer);
-        composite(renderer);
+        blit_render_target(renderer, m_color_rt, m_composite_rt);
+
+        if (m_enabled)
+        {
+            bright_pass(renderer);
+            downsample(renderer);
+            upsample(renderer);
+            composite(renderer);
+        }
     }
 }
 
@@ -123,11 +165,20 @@ std::string BloomNode::name()
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+void BloomNode::on_window_resized(const uint32_t& w, const uint32_t& h)
+{
+    // The chain texture is recreated on resize. Mip filtering lets the upsample pass sample a single level with textureLod.
+    m_chain_rt->texture->set_min_filter(GL_LINEAR_MIPMAP_NEAREST);
+    m_chain_rt->texture->set_mag_filter(GL_LINEAR);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 void BloomNode::bright_pass(Renderer* renderer)
 {
     NIMBLE_SCOPED_SAMPLE("Bright Pass");
 
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Bright Pass");
+    NIMBLE_SCOPED_DEBUG_GROUP("Bright Pass");
 
     m_bright_pass_program->use();
 
@@ -137,12 +188,10 @@ void BloomNode::bright_pass(Renderer* renderer)
     m_bright_pass_program->set_uniform("u_Threshold", m_threshold);
 
     renderer->bind_render_targets(1, &m_bloom_rtv[0], nullptr);
-    glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
+    state_cache::viewport(0, 0, viewport_width(), viewport_height());
     glClear(GL_COLOR_BUFFER_BIT);
 
     render_fullscreen_triangle(renderer, nullptr);
-
-    glPopDebugGroup();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -151,29 +200,29 @@ void BloomNode::downsample(Renderer* renderer)
 {
     NIMBLE_SCOPED_SAMPLE("Downsample");
 
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Downsample");
+    NIMBLE_SCOPED_DEBUG_GROUP("Downsample");
 
     m_bloom_downsample_program->use();
 
+    uint32_t chain_length = std::min(uint32_t(m_chain_length), uint32_t(BLOOM_TEX_CHAIN_SIZE));
+
     // Progressively blur bright pass into blur textures.
-    for (uint32_t i = 0; i < (BLOOM_TEX_CHAIN_SIZE - 1); i++)
+    for (uint32_t i = 0; i < (chain_length - 1); i++)
     {
         float scale = pow(2, i + 1);
 
-        glm::vec2 pixel_size = glm::vec2(1.0f / (float(m_graph->window_width()) / scale), 1.0f / (float(m_graph->window_height()) / scale));
+        glm::vec2 pixel_size = glm::vec2(1.0f / (float(viewport_width()) / scale), 1.0f / (float(viewport_height()) / scale));
         m_bloom_downsample_program->set_uniform("u_PixelSize", pixel_size);
 
         if (m_bloom_downsample_program->set_uniform("s_Texture", 0))
             m_bloom_rt[i]->texture->bind(0);
 
         renderer->bind_render_targets(1, &m_bloom_rtv[i + 1], nullptr);
-        glViewport(0, 0, m_graph->window_width() / scale, m_graph->window_height() / scale);
+        state_cache::viewport(0, 0, viewport_width() / scale, viewport_height() / scale);
         glClear(GL_COLOR_BUFFER_BIT);
 
         render_fullscreen_triangle(renderer, nullptr);
     }
-
-    glPopDebugGroup();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -183,30 +232,32 @@ void BloomNode::upsample(Renderer* renderer)
 {
     NIMBLE_SCOPED_SAMPLE("Upsample");
 
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Upsample");
+    NIMBLE_SCOPED_DEBUG_GROUP("Upsample");
 
     m_bloom_upsample_program->use();
 
     m_bloom_upsample_program->set_uniform("u_Strength", m_enabled ? m_strength : 0.0f);
 
 #ifdef BLOOM_ADDITIVE_BLEND
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_ONE, GL_ONE);
+    state_cache::enable(GL_BLEND);
+    state_cache::blend_func(GL_ONE, GL_ONE);
 #endif
 
+    uint32_t chain_length = std::min(uint32_t(m_chain_length), uint32_t(BLOOM_TEX_CHAIN_SIZE));
+
     // Upsample each downsampled target
-    for (uint32_t i = 0; i < (BLOOM_TEX_CHAIN_SIZE - 1); i++)
+    for (uint32_t i = 0; i < (chain_length - 1); i++)
     {
-        float scale = pow(2, BLOOM_TEX_CHAIN_SIZE - i - 2);
+        float scale = pow(2, chain_length - i - 2);
 
-        glm::vec2 pixel_size = glm::vec2(1.0f / (float(m_graph->window_width()) / scale), 1.0f / (float(m_graph->window_height()) / scale));
+        glm::vec2 pixel_size = glm::vec2(1.0f / (float(viewport_width()) / scale), 1.0f / (float(viewport_height()) / scale));
         m_bloom_upsample_program->set_uniform("u_PixelSize", pixel_size);
 
         if (m_bloom_upsample_program->set_uniform("s_Texture", 0))
-            m_bloom_rt[BLOOM_TEX_CHAIN_SIZE - i - 1]->texture->bind(0);
+            m_bloom_rt[chain_length - i - 1]->texture->bind(0);
 
-        renderer->bind_render_targets(1, &m_bloom_rtv[BLOOM_TEX_CHAIN_SIZE - i - 2], nullptr);
-        glViewport(0, 0, m_graph->window_width() / scale, m_graph->window_height() / scale);
+        renderer->bind_render_targets(1, &m_bloom_rtv[chain_length - i - 2], nullptr);
+        state_cache::viewport(0, 0, viewport_width() / scale, viewport_height() / scale);
 
 #ifndef BLOOM_ADDITIVE_BLEND
         glClear(GL_COLOR_BUFFER_BIT);
@@ -215,11 +266,9 @@ void BloomNode::upsample(Renderer* renderer)
     }
 
 #ifdef BLOOM_ADDITIVE_BLEND
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_BLEND);
+    state_cache::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state_cache::disable(GL_BLEND);
 #endif
-
-    glPopDebugGroup();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -228,10 +277,10 @@ void BloomNode::composite(Renderer* renderer)
 {
     NIMBLE_SCOPED_SAMPLE("Composite");
 
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Composite");
+    NIMBLE_SCOPED_DEBUG_GROUP("Composite");
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_ONE, GL_ONE);
+    state_cache::enable(GL_BLEND);
+    state_cache::blend_func(GL_ONE, GL_ONE);
 
     m_bloom_composite_program->use();
 
@@ -241,14 +290,101 @@ void BloomNode::composite(Renderer* renderer)
         m_bloom_rt[0]->texture->bind(0);
 
     renderer->bind_render_targets(1, &m_composite_rtv, nullptr);
-    glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
+    state_cache::viewport(0, 0, viewport_width(), viewport_height());
 
     render_fullscreen_triangle(renderer, nullptr);
 
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_BLEND);
+    state_cache::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state_cache::disable(GL_BLEND);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void BloomNode::downsample_compute(Renderer* renderer)
+{
+    NIMBLE_SCOPED_SAMPLE("Downsample");
+
+    NIMBLE_SCOPED_DEBUG_GROUP("Downsample");
+
+    m_bloom_downsample_compute_program->use();
+
+    // The bright pass is folded into the first level and every level of the chain is written by the same dispatch.
+    for (int32_t i = 0; i < m_chain_length; i++)
+        m_chain_rt->texture->bind_image(i, i, 0, GL_WRITE_ONLY, GL_R11F_G11F_B10F);
+
+    // Image binds also occupy the texture units with the same index, so the color buffer goes after them.
+    if (m_bloom_downsample_compute_program->set_uniform("s_Color", BLOOM_MAX_CHAIN_SIZE))
+        m_color_rt->texture->bind(BLOOM_MAX_CHAIN_SIZE);
+
+    m_bloom_downsample_compute_program->set_uniform("u_Threshold", m_threshold);
+    m_bloom_downsample_compute_program->set_uniform("u_ChainLength", m_chain_length);
+
+    uint32_t w = uint32_t(BLOOM_CHAIN_SCALE * float(viewport_width()));
+    uint32_t h = uint32_t(BLOOM_CHAIN_SCALE * float(viewport_height()));
+
+    dispatch_compute((w + BLOOM_TILE_SIZE - 1) / BLOOM_TILE_SIZE, (h + BLOOM_TILE_SIZE - 1) / BLOOM_TILE_SIZE, 1);
+
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void BloomNode::upsample_compute(Renderer* renderer)
+{
+    NIMBLE_SCOPED_SAMPLE("Upsample");
+
+    NIMBLE_SCOPED_DEBUG_GROUP("Upsample");
+
+    m_bloom_upsample_compute_program->use();
+
+    if (m_bloom_upsample_compute_program->set_uniform("s_Chain", 1))
+        m_chain_rt->texture->bind(1);
+
+    uint32_t w = uint32_t(BLOOM_CHAIN_SCALE * float(viewport_width()));
+    uint32_t h = uint32_t(BLOOM_CHAIN_SCALE * float(viewport_height()));
+
+    // Accumulate every level into the one above it. Level 0 is upsampled by the composite pass.
+    for (int32_t i = m_chain_length - 1; i > 0; i--)
+    {
+        uint32_t level_w = std::max(w >> (i - 1), 1u);
+        uint32_t level_h = std::max(h >> (i - 1), 1u);
+
+        m_chain_rt->texture->bind_image(0, i - 1, 0, GL_READ_WRITE, GL_R11F_G11F_B10F);
+
+        m_bloom_upsample_compute_program->set_uniform("u_SourceLevel", float(i));
+
+        dispatch_compute((level_w + BLOOM_UPSAMPLE_NUM_THREADS - 1) / BLOOM_UPSAMPLE_NUM_THREADS, (level_h + BLOOM_UPSAMPLE_NUM_THREADS - 1) / BLOOM_UPSAMPLE_NUM_THREADS, 1);
+
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void BloomNode::composite_compute(Renderer* renderer)
+{
+    NIMBLE_SCOPED_SAMPLE("Composite");
+
+    NIMBLE_SCOPED_DEBUG_GROUP("Composite");
+
+    m_bloom_composite_compute_program->use();
+
+    m_composite_rt->texture->bind_image(0, 0, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+    if (m_bloom_composite_compute_program->set_uniform("s_Color", 1))
+        m_color_rt->texture->bind(1);
+
+    if (m_bloom_composite_compute_program->set_uniform("s_Chain", 2))
+        m_chain_rt->texture->bind(2);
+
+    m_bloom_composite_compute_program->set_uniform("u_Strength", m_strength);
+
+    uint32_t w = viewport_width();
+    uint32_t h = viewport_height();
+
+    dispatch_compute((w + BLOOM_COMPOSITE_NUM_THREADS - 1) / BLOOM_COMPOSITE_NUM_THREADS, (h + BLOOM_COMPOSITE_NUM_THREADS - 1) / BLOOM_COMPOSITE_NUM_THREADS, 1);
 
-    glPopDebugGroup();
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -3,6 +3,7 @@
 #include "../render_node.h"
 
 #define BLOOM_TEX_CHAIN_SIZE 5
+#define BLOOM_MAX_CHAIN_SIZE 6
 
 namespace nimble
 {
@@ -17,17 +18,26 @@ public:
     void        execute(double delta, Renderer* renderer, Scene* scene, View* view) override;
     void        shutdown() override;
     std::string name() override;
+    void        on_window_resized(const uint32_t& w, const uint32_t& h) override;
 
 private:
     void bright_pass(Renderer* renderer);
     void downsample(Renderer* renderer);
     void upsample(Renderer* renderer);
     void composite(Renderer* renderer);
+    void downsample_compute(Renderer* renderer);
+    void upsample_compute(Renderer* renderer);
+    void composite_compute(Renderer* renderer);
 
 private:
-    float m_threshold;
-    float m_strength;
-    bool  m_enabled;
+    float   m_threshold;
+    float   m_strength;
+    bool    m_enabled;
+    bool    m_use_compute;
+    int32_t m_chain_length;
+
+    // Half resolution R11G11B10F mip chain used by the compute path.
+    std::shared_ptr<RenderTarget> m_chain_rt;
 
     std::shared_ptr<RenderTarget> m_composite_rt;
     std::shared_ptr<RenderTarget> m_bloom_rt[BLOOM_TEX_CHAIN_SIZE];
@@ -53,6 +63,14 @@ private:
     std::shared_ptr<Shader>  m_bloom_composite_fs;
     std::shared_ptr<Program> m_bloom_composite_program;
 
+    // Compute shaders
+    std::shared_ptr<Shader>  m_bloom_downsample_cs;
+    std::shared_ptr<Shader>  m_bloom_upsample_cs;
+    std::shared_ptr<Shader>  m_bloom_composite_cs;
+    std::shared_ptr<Program> m_bloom_downsample_compute_program;
+    std::shared_ptr<Program> m_bloom_upsample_compute_program;
+    std::shared_ptr<Program> m_bloom_composite_compute_program;
+
     std::shared_ptr<RenderTarget> m_color_rt;
 };
 
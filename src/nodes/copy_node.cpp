@@ -61,14 +61,14 @@ bool CopyNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 
 void CopyNode::execute(double delta, Renderer* renderer, Scene* scene, View* view)
 {
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    state_cache::disable(GL_DEPTH_TEST);
+    state_cache::disable(GL_CULL_FACE);
 
     m_program->use();
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    state_cache::bind_framebuffer(GL_FRAMEBUFFER, 0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
+    state_cache::viewport(0, 0, viewport_width(), viewport_height());
 
     if (m_program->set_uniform("s_Texture", 0) && m_texture)
         m_texture->texture->bind(0);
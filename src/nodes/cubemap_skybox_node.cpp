@@ -68,14 +68,14 @@ bool CubemapSkyboxNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 
 void CubemapSkyboxNode::execute(double delta, Renderer* renderer, Scene* scene, View* view)
 {
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LEQUAL);
-    glDisable(GL_CULL_FACE);
+    state_cache::enable(GL_DEPTH_TEST);
+    state_cache::depth_func(GL_LEQUAL);
+    state_cache::disable(GL_CULL_FACE);
 
     m_program->use();
 
     renderer->bind_render_targets(1, &m_scene_rtv, &m_depth_rtv);
-    glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
+    state_cache::viewport(0, 0, viewport_width(), viewport_height());
 
     if (m_program->set_uniform("s_Skybox", 0) && scene->env_map())
         scene->env_map()->bind(0);
@@ -86,7 +86,7 @@ void CubemapSkyboxNode::execute(double delta, Renderer* renderer, Scene* scene,
 
     render_fullscreen_quad(renderer, view);
 
-    glDepthFunc(GL_LESS);
+    state_cache::depth_func(GL_LESS);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
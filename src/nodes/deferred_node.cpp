@@ -78,14 +78,14 @@ bool DeferredNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 
 void DeferredNode::execute(double delta, Renderer* renderer, Scene* scene, View* view)
 {
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    state_cache::disable(GL_DEPTH_TEST);
+    state_cache::disable(GL_CULL_FACE);
 
     m_program->use();
 
     renderer->bind_render_targets(1, &m_color_rtv, nullptr);
     glClear(GL_COLOR_BUFFER_BIT);
-    glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
+    state_cache::viewport(0, 0, viewport_width(), viewport_height());
 
     int32_t tex_unit = 0;
 
@@ -3,6 +3,11 @@
 #include "../resource_manager.h"
 #include "../renderer.h"
 #include "../profiler.h"
+#include "../logger.h"
+
+#define DOF_TILE_SIZE 16
+#define DOF_DILATE_NUM_THREADS 8
+#define DOF_COMPOSITE_NUM_THREADS 8
 
 namespace nimble
 {
@@ -10,6 +15,29 @@ DEFINE_RENDER_NODE_FACTORY(DepthOfFieldNode)
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+static std::shared_ptr<RenderTarget> fragment_target(std::vector<std::shared_ptr<RenderTarget>>& rts, float scale, GLenum internal_format, GLenum format, GLenum type)
+{
+    std::shared_ptr<RenderTarget> rt = std::make_shared<RenderTarget>();
+
+    rt->w               = 0;
+    rt->h               = 0;
+    rt->scale_w         = scale;
+    rt->scale_h         = scale;
+    rt->target          = GL_TEXTURE_2D;
+    rt->internal_format = internal_format;
+    rt->format          = format;
+    rt->type            = type;
+    rt->num_samples     = 1;
+    rt->array_size      = 1;
+    rt->mip_levels      = 1;
+
+    rts.push_back(rt);
+
+    return rt;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 DepthOfFieldNode::DepthOfFieldNode(RenderGraph* graph) :
     RenderNode(graph)
 {
@@ -28,19 +56,30 @@ void DepthOfFieldNode::declare_connections()
     register_input_render_target("Color");
     register_input_render_target("Depth");
 
-    m_coc_rt              = register_scaled_intermediate_render_target("CoC", 1.0f, 1.0f, GL_TEXTURE_2D, GL_RG8, GL_RG, GL_UNSIGNED_BYTE);
-    m_color4_rt           = register_scaled_intermediate_render_target("Color4", 0.5f, 0.5f, GL_TEXTURE_2D, GL_RGB32F, GL_RGB, GL_FLOAT);
-    m_mul_coc_far4_rt     = register_scaled_intermediate_render_target("MulCoCFar4", 0.5f, 0.5f, GL_TEXTURE_2D, GL_RGB32F, GL_RGB, GL_FLOAT);
-    m_coc4_rt             = register_scaled_intermediate_render_target("CoC4", 0.5f, 0.5f, GL_TEXTURE_2D, GL_RG8, GL_RG, GL_UNSIGNED_BYTE);
-    m_near_coc_max_x4_rt  = register_scaled_intermediate_render_target("NearCoCMaxX4", 0.5f, 0.5f, GL_TEXTURE_2D, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
-    m_near_coc_max4_rt    = register_scaled_intermediate_render_target("NearCoCMax4", 0.5f, 0.5f, GL_TEXTURE_2D, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
-    m_near_coc_blur_x4_rt = register_scaled_intermediate_render_target("NearCoCBlurX4", 0.5f, 0.5f, GL_TEXTURE_2D, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
-    m_near_coc_blur4_rt   = register_scaled_intermediate_render_target("NearCoCBlur4", 0.5f, 0.5f, GL_TEXTURE_2D, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
-    m_near_dof4_rt        = register_scaled_intermediate_render_target("NearDoF4", 0.5f, 0.5f, GL_TEXTURE_2D, GL_RGB32F, GL_RGB, GL_FLOAT);
-    m_far_dof4_rt         = register_scaled_intermediate_render_target("FarDoF4", 0.5f, 0.5f, GL_TEXTURE_2D, GL_RGB32F, GL_RGB, GL_FLOAT);
-    m_near_fill_dof4_rt   = register_scaled_intermediate_render_target("NearFillDoF4", 0.5f, 0.5f, GL_TEXTURE_2D, GL_RGB32F, GL_RGB, GL_FLOAT);
-    m_far_fill_dof4_rt    = register_scaled_intermediate_render_target("FarFillDoF4", 0.5f, 0.5f, GL_TEXTURE_2D, GL_RGB32F, GL_RGB, GL_FLOAT);
-    m_composite_rt        = register_scaled_output_render_target("DoFComposite", 1.0f, 1.0f, GL_TEXTURE_2D, GL_RGB32F, GL_RGB, GL_FLOAT);
+    m_fragment_rts.clear();
+
+    // The fragment path targets are not registered with the graph, which would allocate them alongside the compute path targets. The
+    // node allocates them itself while the fragment path is selected, see create_fragment_targets().
+    m_coc_rt              = fragment_target(m_fragment_rts, 1.0f, GL_RG8, GL_RG, GL_UNSIGNED_BYTE);
+    m_color4_rt           = fragment_target(m_fragment_rts, 0.5f, GL_RGB32F, GL_RGB, GL_FLOAT);
+    m_mul_coc_far4_rt     = fragment_target(m_fragment_rts, 0.5f, GL_RGB32F, GL_RGB, GL_FLOAT);
+    m_coc4_rt             = fragment_target(m_fragment_rts, 0.5f, GL_RG8, GL_RG, GL_UNSIGNED_BYTE);
+    m_near_coc_max_x4_rt  = fragment_target(m_fragment_rts, 0.5f, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+    m_near_coc_max4_rt    = fragment_target(m_fragment_rts, 0.5f, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+    m_near_coc_blur_x4_rt = fragment_target(m_fragment_rts, 0.5f, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+    m_near_coc_blur4_rt   = fragment_target(m_fragment_rts, 0.5f, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+    m_near_dof4_rt        = fragment_target(m_fragment_rts, 0.5f, GL_RGB32F, GL_RGB, GL_FLOAT);
+    m_far_dof4_rt         = fragment_target(m_fragment_rts, 0.5f, GL_RGB32F, GL_RGB, GL_FLOAT);
+    m_near_fill_dof4_rt   = fragment_target(m_fragment_rts, 0.5f, GL_RGB32F, GL_RGB, GL_FLOAT);
+    m_far_fill_dof4_rt    = fragment_target(m_fragment_rts, 0.5f, GL_RGB32F, GL_RGB, GL_FLOAT);
+
+    // RGBA so that the compute composite can write it as an image.
+    m_composite_rt = register_scaled_output_render_target("DoFComposite", 1.0f, 1.0f, GL_TEXTURE_2D, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+
+    m_half_color_rt = register_scaled_intermediate_render_target("HalfColor", 0.5f, 0.5f, GL_TEXTURE_2D, GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT);
+    m_half_coc_rt   = register_scaled_intermediate_render_target("HalfCoC", 0.5f, 0.5f, GL_TEXTURE_2D, GL_RG8, GL_RG, GL_UNSIGNED_BYTE);
+    m_near_rt       = register_scaled_intermediate_render_target("NearDoF", 0.5f, 0.5f, GL_TEXTURE_2D, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+    m_far_rt        = register_scaled_intermediate_render_target("FarDoF", 0.5f, 0.5f, GL_TEXTURE_2D, GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -48,23 +87,12 @@ void DepthOfFieldNode::declare_connections()
 bool DepthOfFieldNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 {
     register_bool_parameter("Enabled", m_enabled);
+    register_bool_parameter("Compute", m_use_compute);
 
     m_color_rt = find_input_render_target("Color");
     m_depth_rt = find_input_render_target("Depth");
 
-    m_coc_rtv              = RenderTargetView(0, 0, 0, m_coc_rt->texture);
-    m_color4_rtv           = RenderTargetView(0, 0, 0, m_color4_rt->texture);
-    m_mul_coc_far4_rtv     = RenderTargetView(0, 0, 0, m_mul_coc_far4_rt->texture);
-    m_coc4_rtv             = RenderTargetView(0, 0, 0, m_coc4_rt->texture);
-    m_near_coc_max_x4_rtv  = RenderTargetView(0, 0, 0, m_near_coc_max_x4_rt->texture);
-    m_near_coc_max4_rtv    = RenderTargetView(0, 0, 0, m_near_coc_max4_rt->texture);
-    m_near_coc_blur_x4_rtv = RenderTargetView(0, 0, 0, m_near_coc_blur_x4_rt->texture);
-    m_near_coc_blur4_rtv   = RenderTargetView(0, 0, 0, m_near_coc_blur4_rt->texture);
-    m_near_dof4_rtv        = RenderTargetView(0, 0, 0, m_near_dof4_rt->texture);
-    m_far_dof4_rtv         = RenderTargetView(0, 0, 0, m_far_dof4_rt->texture);
-    m_near_fill_dof4_rtv   = RenderTargetView(0, 0, 0, m_near_fill_dof4_rt->texture);
-    m_far_fill_dof4_rtv    = RenderTargetView(0, 0, 0, m_far_fill_dof4_rt->texture);
-    m_composite_rtv        = RenderTargetView(0, 0, 0, m_composite_rt->texture);
+    m_composite_rtv = RenderTargetView(0, 0, 0, m_composite_rt->texture);
 
     m_triangle_vs         = res_mgr->load_shader("shader/post_process/fullscreen_triangle_vs.glsl", GL_VERTEX_SHADER);
     m_coc_fs              = res_mgr->load_shader("shader/post_process/depth_of_field/coc_fs.glsl", GL_FRAGMENT_SHADER);
@@ -76,6 +104,33 @@ bool DepthOfFieldNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
     m_computation_fs      = res_mgr->load_shader("shader/post_process/depth_of_field/computation_fs.glsl", GL_FRAGMENT_SHADER);
     m_fill_fs             = res_mgr->load_shader("shader/post_process/depth_of_field/fill_fs.glsl", GL_FRAGMENT_SHADER);
     m_composite_fs        = res_mgr->load_shader("shader/post_process/depth_of_field/composite_fs.glsl", GL_FRAGMENT_SHADER);
+    m_prepare_cs          = res_mgr->load_shader("shader/post_process/depth_of_field/prepare_cs.glsl", GL_COMPUTE_SHADER);
+    m_dilate_cs           = res_mgr->load_shader("shader/post_process/depth_of_field/dilate_cs.glsl", GL_COMPUTE_SHADER);
+    m_gather_cs           = res_mgr->load_shader("shader/post_process/depth_of_field/gather_cs.glsl", GL_COMPUTE_SHADER);
+    m_composite_cs        = res_mgr->load_shader("shader/post_process/depth_of_field/composite_cs.glsl", GL_COMPUTE_SHADER);
+
+    create_tile_textures();
+    log_memory_usage();
+
+    if (m_prepare_cs)
+        m_prepare_program = renderer->create_program({ m_prepare_cs });
+    else
+        return false;
+
+    if (m_dilate_cs)
+        m_dilate_program = renderer->create_program({ m_dilate_cs });
+    else
+        return false;
+
+    if (m_gather_cs)
+        m_gather_program = renderer->create_program({ m_gather_cs });
+    else
+        return false;
+
+    if (m_composite_cs)
+        m_composite_compute_program = renderer->create_program({ m_composite_cs });
+    else
+        return false;
 
     if (m_triangle_vs)
     {
@@ -134,11 +189,31 @@ bool DepthOfFieldNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 
 void DepthOfFieldNode::execute(double delta, Renderer* renderer, Scene* scene, View* view)
 {
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    state_cache::disable(GL_DEPTH_TEST);
+    state_cache::disable(GL_CULL_FACE);
 
-	if (m_enabled)
+    // Only the selected path keeps its targets.
+    if (m_enabled && !m_use_compute)
     {
+        if (!m_coc_rt->texture)
+            create_fragment_targets();
+    }
+    else if (m_coc_rt->texture)
+        release_fragment_targets();
+
+    if (m_enabled && m_use_compute)
+    {
+        NIMBLE_SCOPED_SAMPLE("DoF Compute");
+
+        prepare_compute(renderer, scene, view);
+        dilate_compute(renderer);
+        gather_compute(renderer);
+        composite_compute(renderer, scene, view);
+    }
+    else if (m_enabled)
+    {
+        NIMBLE_SCOPED_SAMPLE("DoF Fragment");
+
         coc_generation(delta, renderer, scene, view);
         downsample(delta, renderer, scene, view);
         near_coc_max(delta, renderer, scene, view);
@@ -155,6 +230,8 @@ void DepthOfFieldNode::execute(double delta, Renderer* renderer, Scene* scene, V
 
 void DepthOfFieldNode::shutdown()
 {
+    if (m_coc_rt->texture)
+        release_fragment_targets();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -166,16 +243,275 @@ std::string DepthOfFieldNode::name()
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+void DepthOfFieldNode::on_window_resized(const uint32_t& w, const uint32_t& h)
+{
+    create_tile_textures();
+
+    if (m_coc_rt->texture)
+        create_fragment_targets();
+    else
+        log_memory_usage();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void DepthOfFieldNode::create_fragment_targets()
+{
+    for (auto& rt : m_fragment_rts)
+    {
+        rt->w = uint32_t(rt->scale_w * float(viewport_width()));
+        rt->h = uint32_t(rt->scale_h * float(viewport_height()));
+
+        rt->texture = std::make_shared<Texture2D>(rt->w, rt->h, rt->array_size, rt->mip_levels, rt->num_samples, rt->internal_format, rt->format, rt->type);
+        rt->texture->set_wrapping(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+    }
+
+    m_coc_rtv              = RenderTargetView(0, 0, 0, m_coc_rt->texture);
+    m_color4_rtv           = RenderTargetView(0, 0, 0, m_color4_rt->texture);
+    m_mul_coc_far4_rtv     = RenderTargetView(0, 0, 0, m_mul_coc_far4_rt->texture);
+    m_coc4_rtv             = RenderTargetView(0, 0, 0, m_coc4_rt->texture);
+    m_near_coc_max_x4_rtv  = RenderTargetView(0, 0, 0, m_near_coc_max_x4_rt->texture);
+    m_near_coc_max4_rtv    = RenderTargetView(0, 0, 0, m_near_coc_max4_rt->texture);
+    m_near_coc_blur_x4_rtv = RenderTargetView(0, 0, 0, m_near_coc_blur_x4_rt->texture);
+    m_near_coc_blur4_rtv   = RenderTargetView(0, 0, 0, m_near_coc_blur4_rt->texture);
+    m_near_dof4_rtv        = RenderTargetView(0, 0, 0, m_near_dof4_rt->texture);
+    m_far_dof4_rtv         = RenderTargetView(0, 0, 0, m_far_dof4_rt->texture);
+    m_near_fill_dof4_rtv   = RenderTargetView(0, 0, 0, m_near_fill_dof4_rt->texture);
+    m_far_fill_dof4_rtv    = RenderTargetView(0, 0, 0, m_far_fill_dof4_rt->texture);
+
+    log_memory_usage();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void DepthOfFieldNode::release_fragment_targets()
+{
+    for (auto& rt : m_fragment_rts)
+        rt->texture.reset();
+
+    m_coc_rtv              = RenderTargetView();
+    m_color4_rtv           = RenderTargetView();
+    m_mul_coc_far4_rtv     = RenderTargetView();
+    m_coc4_rtv             = RenderTargetView();
+    m_near_coc_max_x4_rtv  = RenderTargetView();
+    m_near_coc_max4_rtv    = RenderTargetView();
+    m_near_coc_blur_x4_rtv = RenderTargetView();
+    m_near_coc_blur4_rtv   = RenderTargetView();
+    m_near_dof4_rtv        = RenderTargetView();
+    m_far_dof4_rtv         = RenderTargetView();
+    m_near_fill_dof4_rtv   = RenderTargetView();
+    m_far_fill_dof4_rtv    = RenderTargetView();
+
+    log_memory_usage();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void DepthOfFieldNode::create_tile_textures()
+{
+    uint32_t tiles_x = (uint32_t(0.5f * float(viewport_width())) + DOF_TILE_SIZE - 1) / DOF_TILE_SIZE;
+    uint32_t tiles_y = (uint32_t(0.5f * float(viewport_height())) + DOF_TILE_SIZE - 1) / DOF_TILE_SIZE;
+
+    m_tile_texture         = std::make_unique<Texture2D>(tiles_x, tiles_y, 1, 1, 1, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+    m_dilated_tile_texture = std::make_unique<Texture2D>(tiles_x, tiles_y, 1, 1, 1, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+
+    m_tile_texture->set_min_filter(GL_NEAREST);
+    m_tile_texture->set_mag_filter(GL_NEAREST);
+    m_dilated_tile_texture->set_min_filter(GL_NEAREST);
+    m_dilated_tile_texture->set_mag_filter(GL_NEAREST);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static uint32_t bytes_per_pixel(GLenum internal_format)
+{
+    switch (internal_format)
+    {
+        case GL_R8:
+            return 1;
+        case GL_RG8:
+            return 2;
+        case GL_R11F_G11F_B10F:
+            return 4;
+        case GL_RGBA16F:
+            return 8;
+        case GL_RGB32F:
+            return 12;
+        default:
+            return 16;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Logs the intermediate memory of both paths so they can be compared along with their profiler samples, and what is currently allocated.
+// The compute path targets are registered with the graph and always allocated, the fragment path ones only while it is selected.
+void DepthOfFieldNode::log_memory_usage()
+{
+    auto rt_size = [&](const std::shared_ptr<RenderTarget>& rt) -> size_t {
+        size_t w = size_t(rt->scale_w * float(viewport_width()));
+        size_t h = size_t(rt->scale_h * float(viewport_height()));
+
+        return w * h * bytes_per_pixel(rt->internal_format);
+    };
+
+    std::shared_ptr<RenderTarget> compute_rts[] = { m_half_color_rt, m_half_coc_rt, m_near_rt, m_far_rt };
+
+    size_t fragment_size = 0;
+    size_t compute_size  = 2 * m_tile_texture->width() * m_tile_texture->height() * bytes_per_pixel(GL_RGBA16F);
+
+    for (const auto& rt : m_fragment_rts)
+        fragment_size += rt_size(rt);
+
+    for (const auto& rt : compute_rts)
+        compute_size += rt_size(rt);
+
+    size_t allocated_size = compute_size + (m_coc_rt->texture ? fragment_size : 0);
+
+    NIMBLE_LOG_INFO("Depth Of Field intermediates: " + std::to_string(fragment_size / 1024) + " KB (Fragment), " + std::to_string(compute_size / 1024) + " KB (Compute), " + std::to_string(allocated_size / 1024) + " KB allocated");
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void DepthOfFieldNode::prepare_compute(Renderer* renderer, Scene* scene, View* view)
+{
+    NIMBLE_SCOPED_SAMPLE("Prepare");
+
+    NIMBLE_SCOPED_DEBUG_GROUP("Prepare");
+
+    renderer->per_view_ssbo()->bind_range(0, sizeof(PerViewUniforms) * view->uniform_idx, sizeof(PerViewUniforms));
+
+    m_prepare_program->use();
+
+    m_half_color_rt->texture->bind_image(0, 0, 0, GL_WRITE_ONLY, GL_R11F_G11F_B10F);
+    m_half_coc_rt->texture->bind_image(1, 0, 0, GL_WRITE_ONLY, GL_RG8);
+    m_tile_texture->bind_image(2, 0, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+    if (m_prepare_program->set_uniform("s_Color", 3))
+        m_color_rt->texture->bind(3);
+
+    if (m_prepare_program->set_uniform("s_Depth", 4))
+        m_depth_rt->texture->bind(4);
+
+    std::shared_ptr<Camera> camera = scene->camera();
+    m_prepare_program->set_uniform("u_FocalPlanes", glm::vec4(camera->m_near_begin, camera->m_near_end, camera->m_far_begin, camera->m_far_end));
+
+    dispatch_compute(m_tile_texture->width(), m_tile_texture->height(), 1);
+
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void DepthOfFieldNode::dilate_compute(Renderer* renderer)
+{
+    NIMBLE_SCOPED_SAMPLE("Dilate");
+
+    NIMBLE_SCOPED_DEBUG_GROUP("Dilate");
+
+    m_dilate_program->use();
+
+    m_dilated_tile_texture->bind_image(0, 0, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+    if (m_dilate_program->set_uniform("s_Tiles", 1))
+        m_tile_texture->bind(1);
+
+    uint32_t w = m_tile_texture->width();
+    uint32_t h = m_tile_texture->height();
+
+    dispatch_compute((w + DOF_DILATE_NUM_THREADS - 1) / DOF_DILATE_NUM_THREADS, (h + DOF_DILATE_NUM_THREADS - 1) / DOF_DILATE_NUM_THREADS, 1);
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void DepthOfFieldNode::gather_compute(Renderer* renderer)
+{
+    NIMBLE_SCOPED_SAMPLE("Gather");
+
+    NIMBLE_SCOPED_DEBUG_GROUP("Gather");
+
+    m_gather_program->use();
+
+    m_near_rt->texture->bind_image(0, 0, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    m_far_rt->texture->bind_image(1, 0, 0, GL_WRITE_ONLY, GL_R11F_G11F_B10F);
+
+    if (m_gather_program->set_uniform("s_Color4", 2))
+        m_half_color_rt->texture->bind(2);
+
+    if (m_gather_program->set_uniform("s_CoC4", 3))
+        m_half_coc_rt->texture->bind(3);
+
+    if (m_gather_program->set_uniform("s_Tiles", 4))
+        m_dilated_tile_texture->bind(4);
+
+    glm::vec2 pixel_size = glm::vec2(1.0f / float(viewport_width() / 2), 1.0f / float(viewport_height() / 2));
+    m_gather_program->set_uniform("u_PixelSize", pixel_size);
+    m_gather_program->set_uniform("u_KernelSize", m_kernel_size);
+
+    // One work group per tile so that in-focus tiles exit as a whole.
+    dispatch_compute(m_tile_texture->width(), m_tile_texture->height(), 1);
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void DepthOfFieldNode::composite_compute(Renderer* renderer, Scene* scene, View* view)
+{
+    NIMBLE_SCOPED_SAMPLE("Composite");
+
+    NIMBLE_SCOPED_DEBUG_GROUP("Composite");
+
+    renderer->per_view_ssbo()->bind_range(0, sizeof(PerViewUniforms) * view->uniform_idx, sizeof(PerViewUniforms));
+
+    m_composite_compute_program->use();
+
+    m_composite_rt->texture->bind_image(0, 0, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+    if (m_composite_compute_program->set_uniform("s_Color", 1))
+        m_color_rt->texture->bind(1);
+
+    if (m_composite_compute_program->set_uniform("s_Depth", 2))
+        m_depth_rt->texture->bind(2);
+
+    if (m_composite_compute_program->set_uniform("s_NearDoF4", 3))
+        m_near_rt->texture->bind(3);
+
+    if (m_composite_compute_program->set_uniform("s_FarDoF4", 4))
+        m_far_rt->texture->bind(4);
+
+    if (m_composite_compute_program->set_uniform("s_CoC4", 5))
+        m_half_coc_rt->texture->bind(5);
+
+    if (m_composite_compute_program->set_uniform("s_Tiles", 6))
+        m_dilated_tile_texture->bind(6);
+
+    std::shared_ptr<Camera> camera = scene->camera();
+    m_composite_compute_program->set_uniform("u_FocalPlanes", glm::vec4(camera->m_near_begin, camera->m_near_end, camera->m_far_begin, camera->m_far_end));
+    m_composite_compute_program->set_uniform("u_Blend", m_blend);
+
+    uint32_t w = viewport_width();
+    uint32_t h = viewport_height();
+
+    dispatch_compute((w + DOF_COMPOSITE_NUM_THREADS - 1) / DOF_COMPOSITE_NUM_THREADS, (h + DOF_COMPOSITE_NUM_THREADS - 1) / DOF_COMPOSITE_NUM_THREADS, 1);
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 void DepthOfFieldNode::coc_generation(double delta, Renderer* renderer, Scene* scene, View* view)
 {
     NIMBLE_SCOPED_SAMPLE("CoC Generation");
 
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "CoC Generation");
+    NIMBLE_SCOPED_DEBUG_GROUP("CoC Generation");
 
     renderer->bind_render_targets(1, &m_coc_rtv, nullptr);
 
-    glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::viewport(0, 0, viewport_width(), viewport_height());
+    state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     m_coc_program->use();
@@ -183,7 +519,7 @@ void DepthOfFieldNode::coc_generation(double delta, Renderer* renderer, Scene* s
 	if (m_coc_program->set_uniform("s_Depth", 0))
         m_depth_rt->texture->bind(0);
 
-    glm::vec2 pixel_size = glm::vec2(1.0f / float(m_graph->window_width()), 1.0f / float(m_graph->window_height()));
+    glm::vec2 pixel_size = glm::vec2(1.0f / float(viewport_width()), 1.0f / float(viewport_height()));
     m_coc_program->set_uniform("u_PixelSize", pixel_size);
 
 	std::shared_ptr<Camera> camera = scene->camera();
@@ -194,8 +530,6 @@ void DepthOfFieldNode::coc_generation(double delta, Renderer* renderer, Scene* s
 
     int32_t tex_unit = 0;
     render_fullscreen_triangle(renderer, view, m_coc_program.get(), tex_unit, NODE_USAGE_PER_VIEW_UBO);
-
-    glPopDebugGroup();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -204,18 +538,18 @@ void DepthOfFieldNode::downsample(double delta, Renderer* renderer, Scene* scene
 {
     NIMBLE_SCOPED_SAMPLE("Downsample");
 
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Downsample");
+    NIMBLE_SCOPED_DEBUG_GROUP("Downsample");
 
     RenderTargetView rtvs[] = { m_color4_rtv, m_mul_coc_far4_rtv, m_coc4_rtv };
     renderer->bind_render_targets(3, rtvs, nullptr);
 
-    glViewport(0, 0, m_graph->window_width() * 0.5f, m_graph->window_height() * 0.5f);
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::viewport(0, 0, viewport_width() * 0.5f, viewport_height() * 0.5f);
+    state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     m_downsample_program->use();
 
-    glm::vec2 pixel_size = glm::vec2(1.0f / float(m_graph->window_width()), 1.0f / float(m_graph->window_height()));
+    glm::vec2 pixel_size = glm::vec2(1.0f / float(viewport_width()), 1.0f / float(viewport_height()));
     m_downsample_program->set_uniform("u_PixelSize", pixel_size);
 
     if (m_downsample_program->set_uniform("s_Color", 0))
@@ -226,8 +560,6 @@ void DepthOfFieldNode::downsample(double delta, Renderer* renderer, Scene* scene
 
     int32_t tex_unit = 0;
     render_fullscreen_triangle(renderer, view, m_downsample_program.get(), tex_unit, NODE_USAGE_PER_VIEW_UBO);
-
-    glPopDebugGroup();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -236,18 +568,18 @@ void DepthOfFieldNode::near_coc_max(double delta, Renderer* renderer, Scene* sce
 {
     NIMBLE_SCOPED_SAMPLE("Near CoC Max");
 
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Near CoC Max");
+    NIMBLE_SCOPED_DEBUG_GROUP("Near CoC Max");
 
     // Horizontal
     renderer->bind_render_targets(1, &m_near_coc_max_x4_rtv, nullptr);
 
-    glViewport(0, 0, m_graph->window_width() * 0.5f, m_graph->window_height() * 0.5f);
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::viewport(0, 0, viewport_width() * 0.5f, viewport_height() * 0.5f);
+    state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     m_near_coc_max_x_program->use();
 
-    glm::vec2 pixel_size = glm::vec2(1.0f / float(m_graph->window_width() / 2), 1.0f / float(m_graph->window_height() / 2));
+    glm::vec2 pixel_size = glm::vec2(1.0f / float(viewport_width() / 2), 1.0f / float(viewport_height() / 2));
     m_near_coc_max_x_program->set_uniform("u_PixelSize", pixel_size);
 
     if (m_near_coc_max_x_program->set_uniform("s_Texture", 0))
@@ -259,8 +591,8 @@ void DepthOfFieldNode::near_coc_max(double delta, Renderer* renderer, Scene* sce
     // Vertical
     renderer->bind_render_targets(1, &m_near_coc_max4_rtv, nullptr);
 
-    glViewport(0, 0, m_graph->window_width() * 0.5f, m_graph->window_height() * 0.5f);
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::viewport(0, 0, viewport_width() * 0.5f, viewport_height() * 0.5f);
+    state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     m_near_coc_max_program->use();
@@ -271,8 +603,6 @@ void DepthOfFieldNode::near_coc_max(double delta, Renderer* renderer, Scene* sce
         m_near_coc_max_x4_rt->texture->bind(0);
 
     render_fullscreen_triangle(renderer, view, m_near_coc_max_program.get(), tex_unit, NODE_USAGE_PER_VIEW_UBO);
-
-    glPopDebugGroup();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -281,18 +611,18 @@ void DepthOfFieldNode::near_coc_blur(double delta, Renderer* renderer, Scene* sc
 {
     NIMBLE_SCOPED_SAMPLE("Near CoC Blur");
 
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Near CoC Blur");
+    NIMBLE_SCOPED_DEBUG_GROUP("Near CoC Blur");
 
     // Horizontal
     renderer->bind_render_targets(1, &m_near_coc_blur_x4_rtv, nullptr);
 
-    glViewport(0, 0, m_graph->window_width() * 0.5f, m_graph->window_height() * 0.5f);
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::viewport(0, 0, viewport_width() * 0.5f, viewport_height() * 0.5f);
+    state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     m_near_coc_blur_x_program->use();
 
-    glm::vec2 pixel_size = glm::vec2(1.0f / float(m_graph->window_width() / 2), 1.0f / float(m_graph->window_height() / 2));
+    glm::vec2 pixel_size = glm::vec2(1.0f / float(viewport_width() / 2), 1.0f / float(viewport_height() / 2));
     m_near_coc_blur_x_program->set_uniform("u_PixelSize", pixel_size);
 
     if (m_near_coc_blur_x_program->set_uniform("s_Texture", 0))
@@ -304,8 +634,8 @@ void DepthOfFieldNode::near_coc_blur(double delta, Renderer* renderer, Scene* sc
     // Vertical
     renderer->bind_render_targets(1, &m_near_coc_blur4_rtv, nullptr);
 
-    glViewport(0, 0, m_graph->window_width() * 0.5f, m_graph->window_height() * 0.5f);
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::viewport(0, 0, viewport_width() * 0.5f, viewport_height() * 0.5f);
+    state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     m_near_coc_blur_program->use();
@@ -316,8 +646,6 @@ void DepthOfFieldNode::near_coc_blur(double delta, Renderer* renderer, Scene* sc
         m_near_coc_blur_x4_rt->texture->bind(0);
 
     render_fullscreen_triangle(renderer, view, m_near_coc_blur_program.get(), tex_unit, NODE_USAGE_PER_VIEW_UBO);
-
-    glPopDebugGroup();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -326,18 +654,18 @@ void DepthOfFieldNode::dof_computation(double delta, Renderer* renderer, Scene*
 {
     NIMBLE_SCOPED_SAMPLE("DoF Computation");
 
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "DoF Computation");
+    NIMBLE_SCOPED_DEBUG_GROUP("DoF Computation");
 
     RenderTargetView rtvs[] = { m_near_dof4_rtv, m_far_dof4_rtv };
     renderer->bind_render_targets(2, rtvs, nullptr);
 
-    glViewport(0, 0, m_graph->window_width() * 0.5f, m_graph->window_height() * 0.5f);
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::viewport(0, 0, viewport_width() * 0.5f, viewport_height() * 0.5f);
+    state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     m_computation_program->use();
 
-    glm::vec2 pixel_size = glm::vec2(1.0f / float(m_graph->window_width() / 2), 1.0f / float(m_graph->window_height() / 2));
+    glm::vec2 pixel_size = glm::vec2(1.0f / float(viewport_width() / 2), 1.0f / float(viewport_height() / 2));
     m_computation_program->set_uniform("u_PixelSize", pixel_size);
     m_computation_program->set_uniform("u_KernelSize", m_kernel_size);
 
@@ -355,8 +683,6 @@ void DepthOfFieldNode::dof_computation(double delta, Renderer* renderer, Scene*
 
     int32_t tex_unit = 0;
     render_fullscreen_triangle(renderer, view, m_computation_program.get(), tex_unit, NODE_USAGE_PER_VIEW_UBO);
-
-    glPopDebugGroup();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -365,18 +691,18 @@ void DepthOfFieldNode::fill(double delta, Renderer* renderer, Scene* scene, View
 {
     NIMBLE_SCOPED_SAMPLE("Fill");
 
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Fill");
+    NIMBLE_SCOPED_DEBUG_GROUP("Fill");
 
     RenderTargetView rtvs[] = { m_near_fill_dof4_rtv, m_far_fill_dof4_rtv };
     renderer->bind_render_targets(2, rtvs, nullptr);
 
-    glViewport(0, 0, m_graph->window_width() * 0.5f, m_graph->window_height() * 0.5f);
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::viewport(0, 0, viewport_width() * 0.5f, viewport_height() * 0.5f);
+    state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     m_fill_program->use();
 
-    glm::vec2 pixel_size = glm::vec2(1.0f / float(m_graph->window_width() / 2), 1.0f / float(m_graph->window_height() / 2));
+    glm::vec2 pixel_size = glm::vec2(1.0f / float(viewport_width() / 2), 1.0f / float(viewport_height() / 2));
     m_fill_program->set_uniform("u_PixelSize", pixel_size);
 
     if (m_fill_program->set_uniform("s_CoC4", 0))
@@ -393,8 +719,6 @@ void DepthOfFieldNode::fill(double delta, Renderer* renderer, Scene* scene, View
 
     int32_t tex_unit = 0;
     render_fullscreen_triangle(renderer, view, m_fill_program.get(), tex_unit, NODE_USAGE_PER_VIEW_UBO);
-
-    glPopDebugGroup();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -403,17 +727,17 @@ void DepthOfFieldNode::composite(double delta, Renderer* renderer, Scene* scene,
 {
     NIMBLE_SCOPED_SAMPLE("Composite");
 
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Composite");
+    NIMBLE_SCOPED_DEBUG_GROUP("Composite");
 
     renderer->bind_render_targets(1, &m_composite_rtv, nullptr);
 
-    glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::viewport(0, 0, viewport_width(), viewport_height());
+    state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     m_composite_program->use();
 
-    glm::vec2 pixel_size = glm::vec2(1.0f / float(m_graph->window_width() / 2), 1.0f / float(m_graph->window_height() / 2));
+    glm::vec2 pixel_size = glm::vec2(1.0f / float(viewport_width() / 2), 1.0f / float(viewport_height() / 2));
     m_composite_program->set_uniform("u_PixelSize", pixel_size);
     m_composite_program->set_uniform("u_Blend", m_blend);
 
@@ -437,8 +761,6 @@ void DepthOfFieldNode::composite(double delta, Renderer* renderer, Scene* scene,
 
     int32_t tex_unit = 0;
     render_fullscreen_triangle(renderer, view, m_composite_program.get(), tex_unit, NODE_USAGE_PER_VIEW_UBO);
-
-    glPopDebugGroup();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -15,8 +15,17 @@ public:
     void        execute(double delta, Renderer* renderer, Scene* scene, View* view) override;
     void        shutdown() override;
     std::string name() override;
+    void        on_window_resized(const uint32_t& w, const uint32_t& h) override;
 
 private:
+    void create_tile_textures();
+    void create_fragment_targets();
+    void release_fragment_targets();
+    void log_memory_usage();
+    void prepare_compute(Renderer* renderer, Scene* scene, View* view);
+    void dilate_compute(Renderer* renderer);
+    void gather_compute(Renderer* renderer);
+    void composite_compute(Renderer* renderer, Scene* scene, View* view);
     void coc_generation(double delta, Renderer* renderer, Scene* scene, View* view);
     void downsample(double delta, Renderer* renderer, Scene* scene, View* view);
     void near_coc_max(double delta, Renderer* renderer, Scene* scene, View* view);
@@ -27,12 +36,16 @@ private:
 
 private:
     bool  m_enabled     = true;
+    bool  m_use_compute = true;
     float m_blend       = 1.0f;
     float m_kernel_size = 1.0f;
 
     // Properties
     glm::vec2 m_kernel_scale;
 
+    // Fragment path targets, allocated by the node while the fragment path is selected.
+    std::vector<std::shared_ptr<RenderTarget>> m_fragment_rts;
+
     // CoC Pass
     std::shared_ptr<RenderTarget> m_coc_rt;
 
@@ -107,6 +120,25 @@ private:
     std::shared_ptr<Shader>  m_composite_fs;
     std::shared_ptr<Program> m_composite_program;
 
+    // Compute Path
+    std::shared_ptr<RenderTarget> m_half_color_rt;
+    std::shared_ptr<RenderTarget> m_half_coc_rt;
+    std::shared_ptr<RenderTarget> m_near_rt;
+    std::shared_ptr<RenderTarget> m_far_rt;
+
+    // Per tile (max near, max far, min near, min far) CoC, before and after dilation.
+    std::unique_ptr<Texture2D> m_tile_texture;
+    std::unique_ptr<Texture2D> m_dilated_tile_texture;
+
+    std::shared_ptr<Shader>  m_prepare_cs;
+    std::shared_ptr<Shader>  m_dilate_cs;
+    std::shared_ptr<Shader>  m_gather_cs;
+    std::shared_ptr<Shader>  m_composite_cs;
+    std::shared_ptr<Program> m_prepare_program;
+    std::shared_ptr<Program> m_dilate_program;
+    std::shared_ptr<Program> m_gather_program;
+    std::shared_ptr<Program> m_composite_compute_program;
+
     // Common VS
     std::shared_ptr<Shader> m_triangle_vs;
 
@@ -46,14 +46,14 @@ bool ForwardNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 void ForwardNode::execute(double delta, Renderer* renderer, Scene* scene, View* view)
 {
     renderer->bind_render_targets(2, m_color_rtv, &m_depth_rtv);
-    glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
+    state_cache::viewport(0, 0, viewport_width(), viewport_height());
 
-    glEnable(GL_DEPTH_TEST);
+    state_cache::enable(GL_DEPTH_TEST);
 
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    state_cache::enable(GL_CULL_FACE);
+    state_cache::cull_face(GL_BACK);
 
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     render_scene(renderer, scene, view, m_library.get(), NODE_USAGE_DEFAULT);
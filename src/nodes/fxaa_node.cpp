@@ -60,22 +60,22 @@ void FXAANode::execute(double delta, Renderer* renderer, Scene* scene, View* vie
 {
     if (m_enabled)
     {
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_CULL_FACE);
+        state_cache::disable(GL_DEPTH_TEST);
+        state_cache::disable(GL_CULL_FACE);
 
         m_fxaa_program->use();
 
         renderer->bind_render_targets(1, &m_fxaa_rtv, nullptr);
 
         glClear(GL_COLOR_BUFFER_BIT);
-        glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
+        state_cache::viewport(0, 0, viewport_width(), viewport_height());
 
         if (m_fxaa_program->set_uniform("s_Texture", 0) && m_color_rt)
             m_color_rt->texture->bind(0);
 
 		m_fxaa_program->set_uniform("u_QualityEdgeThreshold", m_quality_edge_threshold);
         m_fxaa_program->set_uniform("u_QualityEdgeThresholdMin", m_quality_edge_threshold_min);
-        m_fxaa_program->set_uniform("u_QualityRcpFrame", glm::vec2(1.0f / m_graph->window_width(), 1.0f / m_graph->window_height()));
+        m_fxaa_program->set_uniform("u_QualityRcpFrame", glm::vec2(1.0f / viewport_width(), 1.0f / viewport_height()));
 
         render_fullscreen_triangle(renderer, view);
     }
@@ -4,6 +4,10 @@
 #include "../renderer.h"
 #include "../logger.h"
 
+#define HIZ_TILE_SIZE 64
+#define HIZ_IMAGE_COUNT 8
+#define HIZ_COUNTER_BINDING 4
+
 namespace nimble
 {
 DEFINE_RENDER_NODE_FACTORY(HiZNode)
@@ -34,6 +38,8 @@ void HiZNode::declare_connections()
 
 bool HiZNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 {
+    register_bool_parameter("Compute", m_use_compute);
+
     m_depth_rt = find_input_render_target("Depth");
 
     create_rtvs();
@@ -41,6 +47,16 @@ bool HiZNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
     m_triangle_vs = res_mgr->load_shader("shader/post_process/fullscreen_triangle_vs.glsl", GL_VERTEX_SHADER);
     m_hiz_fs      = res_mgr->load_shader("shader/post_process/hiz/hiz_fs.glsl", GL_FRAGMENT_SHADER);
     m_copy_fs     = res_mgr->load_shader("shader/post_process/hiz/hiz_copy_fs.glsl", GL_FRAGMENT_SHADER);
+    m_hiz_cs      = res_mgr->load_shader("shader/post_process/hiz/hiz_cs.glsl", GL_COMPUTE_SHADER);
+
+    if (m_hiz_cs)
+        m_hiz_compute_program = renderer->create_program({ m_hiz_cs });
+    else
+        return false;
+
+    // Counts finished work groups so that the last one can build the tail of the pyramid. The shader resets it when done.
+    uint32_t counter = 0;
+    m_counter_ssbo   = std::make_unique<ShaderStorageBuffer>(GL_DYNAMIC_DRAW, sizeof(uint32_t), &counter);
 
     if (m_triangle_vs)
     {
@@ -64,26 +80,31 @@ bool HiZNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 
 void HiZNode::execute(double delta, Renderer* renderer, Scene* scene, View* view)
 {
-    // Copy G-Buffer Depth into Mip 0 of HiZ
-    copy_depth(renderer, scene, view);
+    if (m_use_compute)
+        downsample_compute(renderer, scene, view);
+    else
+    {
+        // Copy G-Buffer Depth into Mip 0 of HiZ
+        copy_depth(renderer, scene, view);
 
-    // Generate HiZ Chain
-    downsample(renderer, scene, view);
+        // Generate HiZ Chain
+        downsample(renderer, scene, view);
+    }
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void HiZNode::copy_depth(Renderer* renderer, Scene* scene, View* view)
 {
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    state_cache::disable(GL_DEPTH_TEST);
+    state_cache::disable(GL_CULL_FACE);
 
     m_copy_program->use();
 
     renderer->bind_render_targets(1, &m_hiz_rtv[0], nullptr);
-    glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
+    state_cache::viewport(0, 0, viewport_width(), viewport_height());
 
-    glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::clear_color(1.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     if (m_copy_program->set_uniform("s_Texture", 0))
@@ -96,8 +117,8 @@ void HiZNode::copy_depth(Renderer* renderer, Scene* scene, View* view)
 
 void HiZNode::downsample(Renderer* renderer, Scene* scene, View* view)
 {
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    state_cache::disable(GL_DEPTH_TEST);
+    state_cache::disable(GL_CULL_FACE);
 
     m_hiz_program->use();
 
@@ -106,22 +127,64 @@ void HiZNode::downsample(Renderer* renderer, Scene* scene, View* view)
         float scale = pow(2, i);
 
         renderer->bind_render_targets(1, &m_hiz_rtv[i], nullptr);
-        glViewport(0, 0, m_graph->window_width() / scale, m_graph->window_height() / scale);
+        state_cache::viewport(0, 0, viewport_width() / scale, viewport_height() / scale);
 
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         if (m_hiz_program->set_uniform("s_Texture", 0))
             m_hiz_rt->texture->bind(0);
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, i - 1);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, i - 1);
+        m_hiz_rt->texture->set_mip_level_range(i - 1, i - 1);
 
         render_fullscreen_triangle(renderer, nullptr);
     }
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+    m_hiz_rt->texture->set_mip_level_range(0, 1000);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void HiZNode::downsample_compute(Renderer* renderer, Scene* scene, View* view)
+{
+    m_hiz_compute_program->use();
+
+    m_counter_ssbo->bind_base(HIZ_COUNTER_BINDING);
+
+    uint32_t image_count = std::min(m_num_rtv, uint32_t(HIZ_IMAGE_COUNT));
+
+    for (uint32_t i = 0; i < image_count; i++)
+        m_hiz_rt->texture->bind_image(i, i, 0, GL_READ_WRITE, GL_RG32F);
+
+    if (m_hiz_compute_program->set_uniform("s_Depth", HIZ_IMAGE_COUNT))
+        m_depth_rt->texture->bind(HIZ_IMAGE_COUNT);
+
+    m_hiz_compute_program->set_uniform("u_ImageCount", int32_t(image_count));
+    m_hiz_compute_program->set_uniform("u_TailOnly", 0);
+
+    uint32_t w = viewport_width();
+    uint32_t h = viewport_height();
+
+    dispatch_compute((w + HIZ_TILE_SIZE - 1) / HIZ_TILE_SIZE, (h + HIZ_TILE_SIZE - 1) / HIZ_TILE_SIZE, 1);
+
+    // Pyramids with more levels than image units are finished by a single work group that continues from the last bound level.
+    if (m_num_rtv > image_count)
+    {
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+        uint32_t base_level = image_count - 1;
+        image_count         = std::min(m_num_rtv - base_level, uint32_t(HIZ_IMAGE_COUNT));
+
+        for (uint32_t i = 0; i < image_count; i++)
+            m_hiz_rt->texture->bind_image(i, base_level + i, 0, GL_READ_WRITE, GL_RG32F);
+
+        m_hiz_compute_program->set_uniform("u_ImageCount", int32_t(image_count));
+        m_hiz_compute_program->set_uniform("u_TailOnly", 1);
+
+        dispatch_compute(1, 1, 1);
+    }
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -20,6 +20,7 @@ public:
 private:
     void copy_depth(Renderer* renderer, Scene* scene, View* view);
     void downsample(Renderer* renderer, Scene* scene, View* view);
+    void downsample_compute(Renderer* renderer, Scene* scene, View* view);
     void create_rtvs();
 
 private:
@@ -35,6 +36,12 @@ private:
 
     std::shared_ptr<Shader>  m_copy_fs;
     std::shared_ptr<Program> m_copy_program;
+
+    std::shared_ptr<Shader>              m_hiz_cs;
+    std::shared_ptr<Program>             m_hiz_compute_program;
+    std::unique_ptr<ShaderStorageBuffer> m_counter_ssbo;
+
+    bool m_use_compute = true;
 };
 
 DECLARE_RENDER_NODE_FACTORY(HiZNode);
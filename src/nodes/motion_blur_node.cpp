@@ -3,6 +3,10 @@
 #include "../resource_manager.h"
 #include "../renderer.h"
 #include "../logger.h"
+#include "../profiler.h"
+
+#define MOTION_BLUR_TILE_SIZE 32
+#define MOTION_BLUR_NEIGHBOR_NUM_THREADS 8
 
 namespace nimble
 {
@@ -27,6 +31,7 @@ void MotionBlurNode::declare_connections()
 {
     register_input_render_target("Color");
     register_input_render_target("Velocity");
+    register_input_render_target("Depth");
 
     m_motion_blur_rt = register_scaled_output_render_target("MotionBlur", 1.0f, 1.0f, GL_TEXTURE_2D, GL_RGB16F, GL_RGB, GL_HALF_FLOAT, 1, 1);
 }
@@ -37,18 +42,26 @@ bool MotionBlurNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 {
     register_bool_parameter("Enabled", m_enabled);
     register_int_parameter("Num Samples", m_num_samples, 0, 32);
+    register_float_parameter("Velocity Threshold", m_threshold, 0.0f, 4.0f);
 
     m_color_rt    = find_input_render_target("Color");
     m_velocity_rt = find_input_render_target("Velocity");
+    m_depth_rt    = find_input_render_target("Depth");
 
     m_motion_blur_rtv = RenderTargetView(0, 0, 0, m_motion_blur_rt->texture);
 
-    m_vs = res_mgr->load_shader("shader/post_process/fullscreen_triangle_vs.glsl", GL_VERTEX_SHADER);
-    m_fs = res_mgr->load_shader("shader/post_process/motion_blur/motion_blur_fs.glsl", GL_FRAGMENT_SHADER);
+    create_tile_textures();
+
+    m_vs              = res_mgr->load_shader("shader/post_process/fullscreen_triangle_vs.glsl", GL_VERTEX_SHADER);
+    m_fs              = res_mgr->load_shader("shader/post_process/motion_blur/motion_blur_fs.glsl", GL_FRAGMENT_SHADER);
+    m_tile_max_cs     = res_mgr->load_shader("shader/post_process/motion_blur/tile_max_cs.glsl", GL_COMPUTE_SHADER);
+    m_neighbor_max_cs = res_mgr->load_shader("shader/post_process/motion_blur/neighbor_max_cs.glsl", GL_COMPUTE_SHADER);
 
-    if (m_vs && m_fs)
+    if (m_vs && m_fs && m_tile_max_cs && m_neighbor_max_cs)
     {
-        m_program = renderer->create_program(m_vs, m_fs);
+        m_program              = renderer->create_program(m_vs, m_fs);
+        m_tile_max_program     = renderer->create_program({ m_tile_max_cs });
+        m_neighbor_max_program = renderer->create_program({ m_neighbor_max_cs });
         return true;
     }
     else
@@ -61,15 +74,25 @@ void MotionBlurNode::execute(double delta, Renderer* renderer, Scene* scene, Vie
 {
     if (m_enabled)
     {
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_CULL_FACE);
+        int current_fps = int((1.0f / (static_cast<float>(delta)) * 1000.0f));
+        int target_fps  = 60;
+
+        float scale = static_cast<float>(current_fps) / static_cast<float>(target_fps);
+
+        tile_max(scale);
+        neighbor_max();
+
+        NIMBLE_SCOPED_SAMPLE("Reconstruction");
+
+        state_cache::disable(GL_DEPTH_TEST);
+        state_cache::disable(GL_CULL_FACE);
 
         m_program->use();
 
         renderer->bind_render_targets(1, &m_motion_blur_rtv, nullptr);
-        glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
+        state_cache::viewport(0, 0, viewport_width(), viewport_height());
 
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
         if (m_program->set_uniform("s_Color", 0))
@@ -78,13 +101,18 @@ void MotionBlurNode::execute(double delta, Renderer* renderer, Scene* scene, Vie
         if (m_program->set_uniform("s_Velocity", 1))
             m_velocity_rt->texture->bind(1);
 
-        int current_fps = int((1.0f / (static_cast<float>(delta)) * 1000.0f));
-        int target_fps  = 60;
+        if (m_program->set_uniform("s_NeighborMax", 2))
+            m_neighbor_max_texture->bind(2);
+
+        if (m_program->set_uniform("s_Depth", 3) && m_depth_rt)
+            m_depth_rt->texture->bind(3);
 
-        m_program->set_uniform("u_Scale", static_cast<float>(current_fps) / static_cast<float>(target_fps));
+        m_program->set_uniform("u_Scale", scale);
         m_program->set_uniform("u_NumSamples", m_num_samples);
+        m_program->set_uniform("u_Threshold", m_threshold);
+        m_program->set_uniform("u_UseDepth", m_depth_rt ? 1 : 0);
 
-        render_fullscreen_triangle(renderer, nullptr);
+        render_fullscreen_triangle(renderer, view, nullptr, 0, NODE_USAGE_PER_VIEW_UBO);
     }
     else
         blit_render_target(renderer, m_color_rt, m_motion_blur_rt);
@@ -103,5 +131,70 @@ std::string MotionBlurNode::name()
     return "Motion Blur";
 }
 
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void MotionBlurNode::on_window_resized(const uint32_t& w, const uint32_t& h)
+{
+    create_tile_textures();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void MotionBlurNode::create_tile_textures()
+{
+    uint32_t tiles_x = (viewport_width() + MOTION_BLUR_TILE_SIZE - 1) / MOTION_BLUR_TILE_SIZE;
+    uint32_t tiles_y = (viewport_height() + MOTION_BLUR_TILE_SIZE - 1) / MOTION_BLUR_TILE_SIZE;
+
+    m_tile_max_texture     = std::make_unique<Texture2D>(tiles_x, tiles_y, 1, 1, 1, GL_RG16F, GL_RG, GL_HALF_FLOAT);
+    m_neighbor_max_texture = std::make_unique<Texture2D>(tiles_x, tiles_y, 1, 1, 1, GL_RG16F, GL_RG, GL_HALF_FLOAT);
+
+    m_tile_max_texture->set_min_filter(GL_NEAREST);
+    m_tile_max_texture->set_mag_filter(GL_NEAREST);
+    m_neighbor_max_texture->set_min_filter(GL_NEAREST);
+    m_neighbor_max_texture->set_mag_filter(GL_NEAREST);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void MotionBlurNode::tile_max(float scale)
+{
+    NIMBLE_SCOPED_SAMPLE("Tile Max");
+
+    m_tile_max_program->use();
+
+    m_tile_max_texture->bind_image(0, 0, 0, GL_WRITE_ONLY, GL_RG16F);
+
+    if (m_tile_max_program->set_uniform("s_Velocity", 1))
+        m_velocity_rt->texture->bind(1);
+
+    m_tile_max_program->set_uniform("u_Scale", scale);
+
+    // One work group per tile.
+    dispatch_compute(m_tile_max_texture->width(), m_tile_max_texture->height(), 1);
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void MotionBlurNode::neighbor_max()
+{
+    NIMBLE_SCOPED_SAMPLE("Neighbor Max");
+
+    m_neighbor_max_program->use();
+
+    m_neighbor_max_texture->bind_image(0, 0, 0, GL_WRITE_ONLY, GL_RG16F);
+
+    if (m_neighbor_max_program->set_uniform("s_TileMax", 1))
+        m_tile_max_texture->bind(1);
+
+    uint32_t w = m_tile_max_texture->width();
+    uint32_t h = m_tile_max_texture->height();
+
+    dispatch_compute((w + MOTION_BLUR_NEIGHBOR_NUM_THREADS - 1) / MOTION_BLUR_NEIGHBOR_NUM_THREADS, (h + MOTION_BLUR_NEIGHBOR_NUM_THREADS - 1) / MOTION_BLUR_NEIGHBOR_NUM_THREADS, 1);
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
 // -----------------------------------------------------------------------------------------------------------------------------------
 } // namespace nimble
\ No newline at end of file
@@ -15,10 +15,17 @@ public:
     void        execute(double delta, Renderer* renderer, Scene* scene, View* view) override;
     void        shutdown() override;
     std::string name() override;
+    void        on_window_resized(const uint32_t& w, const uint32_t& h) override;
+
+private:
+    void create_tile_textures();
+    void tile_max(float scale);
+    void neighbor_max();
 
 private:
     std::shared_ptr<RenderTarget> m_color_rt;
     std::shared_ptr<RenderTarget> m_velocity_rt;
+    std::shared_ptr<RenderTarget> m_depth_rt;
 
     std::shared_ptr<RenderTarget> m_motion_blur_rt;
     RenderTargetView              m_motion_blur_rtv;
@@ -27,8 +34,18 @@ private:
     std::shared_ptr<Shader>  m_fs;
     std::shared_ptr<Program> m_program;
 
+    // Longest blur radius of every tile, and of the 3x3 neighbourhood around it.
+    std::unique_ptr<Texture2D> m_tile_max_texture;
+    std::unique_ptr<Texture2D> m_neighbor_max_texture;
+
+    std::shared_ptr<Shader>  m_tile_max_cs;
+    std::shared_ptr<Shader>  m_neighbor_max_cs;
+    std::shared_ptr<Program> m_tile_max_program;
+    std::shared_ptr<Program> m_neighbor_max_program;
+
     bool    m_enabled     = true;
-    int32_t m_num_samples = 32;
+    int32_t m_num_samples = 16;
+    float   m_threshold   = 0.5f;
 };
 
 DECLARE_RENDER_NODE_FACTORY(MotionBlurNode);
@@ -57,12 +57,12 @@ void PCFDirectionalLightDepthNode::execute(double delta, Renderer* renderer, Sce
 
     renderer->bind_render_targets(0, nullptr, view->dest_render_target_view);
 
-    glViewport(0, 0, h, h);
+    state_cache::viewport(0, 0, h, h);
 
-    glEnable(GL_DEPTH_TEST);
+    state_cache::enable(GL_DEPTH_TEST);
 
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    state_cache::enable(GL_CULL_FACE);
+    state_cache::cull_face(GL_BACK);
 
     glClear(GL_DEPTH_BUFFER_BIT);
 
@@ -43,12 +43,12 @@ void PCFPointLightDepthNode::execute(double delta, Renderer* renderer, Scene* sc
 
     renderer->bind_render_targets(0, nullptr, view->dest_render_target_view);
 
-    glViewport(0, 0, w, h);
+    state_cache::viewport(0, 0, w, h);
 
-    glEnable(GL_DEPTH_TEST);
+    state_cache::enable(GL_DEPTH_TEST);
 
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_FRONT);
+    state_cache::enable(GL_CULL_FACE);
+    state_cache::cull_face(GL_FRONT);
 
     glClear(GL_DEPTH_BUFFER_BIT);
 
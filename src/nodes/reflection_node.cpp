@@ -27,6 +27,7 @@ void ReflectionNode::declare_connections()
 {
     register_input_render_target("Color");
     register_input_render_target("SSR");
+    register_input_render_target("Velocity");
 
     m_reflection_rt = register_scaled_output_render_target("Reflection", 1.0f, 1.0f, GL_TEXTURE_2D, GL_RGB16F, GL_RGB, GL_HALF_FLOAT);
 }
@@ -36,12 +37,16 @@ void ReflectionNode::declare_connections()
 bool ReflectionNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 {
     register_bool_parameter("Screen Space Reflections", m_ssr);
+    register_float_parameter("Temporal Weight", m_temporal_weight, 0.0f, 0.98f);
 
-    m_color_rt = find_input_render_target("Color");
-    m_ssr_rt   = find_input_render_target("SSR");
+    m_color_rt    = find_input_render_target("Color");
+    m_ssr_rt      = find_input_render_target("SSR");
+    m_velocity_rt = find_input_render_target("Velocity");
 
     m_reflection_rtv = RenderTargetView(0, 0, 0, m_reflection_rt->texture);
 
+    create_history_textures();
+
     m_fullscreen_triangle_vs = res_mgr->load_shader("shader/post_process/fullscreen_triangle_vs.glsl", GL_VERTEX_SHADER);
     m_reflection_fs          = res_mgr->load_shader("shader/post_process/ssr/reflection_fs.glsl", GL_FRAGMENT_SHADER);
 
@@ -58,15 +63,22 @@ bool ReflectionNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 
 void ReflectionNode::execute(double delta, Renderer* renderer, Scene* scene, View* view)
 {
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    state_cache::disable(GL_DEPTH_TEST);
+    state_cache::disable(GL_CULL_FACE);
 
     m_reflection_program->use();
 
-    renderer->bind_render_targets(1, &m_reflection_rtv, nullptr);
+    uint32_t current  = m_history_index;
+    uint32_t previous = 1 - m_history_index;
+
+    RenderTargetView rtvs[] = { m_reflection_rtv, m_history_rtv[current] };
+
+    renderer->bind_render_targets(2, rtvs, nullptr);
 
     glClear(GL_COLOR_BUFFER_BIT);
-    glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
+    state_cache::viewport(0, 0, viewport_width(), viewport_height());
+
+    bool ssr = m_ssr_rt && m_ssr;
 
 	if (m_ssr_rt)
 	{
@@ -79,9 +91,22 @@ void ReflectionNode::execute(double delta, Renderer* renderer, Scene* scene, Vie
     if (m_reflection_program->set_uniform("s_Color", 1) && m_color_rt)
         m_color_rt->texture->bind(1);
 
-    m_reflection_program->set_uniform("u_SSR", m_ssr_rt ? (float)m_ssr : 0.0f);
+    if (m_reflection_program->set_uniform("s_History", 2))
+        m_history[previous]->bind(2);
+
+    if (m_reflection_program->set_uniform("s_Velocity", 3) && m_velocity_rt)
+        m_velocity_rt->texture->bind(3);
+
+    // Without motion vectors the history cannot be reprojected, so every frame is resolved on its own.
+    bool temporal = ssr && m_velocity_rt && m_history_valid;
+
+    m_reflection_program->set_uniform("u_SSR", ssr ? 1.0f : 0.0f);
+    m_reflection_program->set_uniform("u_TemporalWeight", temporal ? m_temporal_weight : 0.0f);
 
     render_fullscreen_triangle(renderer, view);
+
+    m_history_valid = ssr;
+    m_history_index = previous;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -97,5 +122,29 @@ std::string ReflectionNode::name()
     return "Reflections";
 }
 
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void ReflectionNode::on_window_resized(const uint32_t& w, const uint32_t& h)
+{
+    create_history_textures();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void ReflectionNode::create_history_textures()
+{
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        m_history[i] = std::make_shared<Texture2D>(viewport_width(), viewport_height(), 1, 1, 1, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+        m_history[i]->set_min_filter(GL_LINEAR);
+        m_history[i]->set_mag_filter(GL_LINEAR);
+        m_history[i]->set_wrapping(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+
+        m_history_rtv[i] = RenderTargetView(0, 0, 0, m_history[i]);
+    }
+
+    m_history_valid = false;
+}
+
 // -----------------------------------------------------------------------------------------------------------------------------------
 } // namespace nimble
\ No newline at end of file
@@ -15,19 +15,32 @@ public:
     void        execute(double delta, Renderer* renderer, Scene* scene, View* view) override;
     void        shutdown() override;
     std::string name() override;
+    void        on_window_resized(const uint32_t& w, const uint32_t& h) override;
 
 private:
-    bool m_ssr = true;
+    void create_history_textures();
+
+private:
+    bool     m_ssr             = true;
+    float    m_temporal_weight = 0.9f;
+    bool     m_history_valid   = false;
+    uint32_t m_history_index   = 0;
 
     // Inputs
     std::shared_ptr<RenderTarget> m_color_rt;
     std::shared_ptr<RenderTarget> m_ssr_rt;
+    std::shared_ptr<RenderTarget> m_velocity_rt;
 
     // Outputs
     std::shared_ptr<RenderTarget> m_reflection_rt;
 
     RenderTargetView m_reflection_rtv;
 
+    // Resolved reflections (premultiplied by confidence) of the current and previous frame. Owned by the node since the graph may
+    // alias intermediate render targets.
+    std::shared_ptr<Texture2D> m_history[2];
+    RenderTargetView           m_history_rtv[2];
+
     std::shared_ptr<Shader>  m_fullscreen_triangle_vs;
     std::shared_ptr<Shader>  m_reflection_fs;
     std::shared_ptr<Program> m_reflection_program;
@@ -4,7 +4,10 @@
 #include "../renderer.h"
 #include "../profiler.h"
 
-#define NUM_SSR_THREADS 8
+#define SSR_CLASSIFY_TILE_SIZE 16
+#define SSR_TRACE_TILE_SIZE 8
+#define SSR_TILE_BUFFER_BINDING 4
+#define SSR_DISPATCH_ARGS_SIZE (8 * sizeof(uint32_t))
 
 namespace nimble
 {
@@ -32,7 +35,7 @@ void ScreenSpaceReflectionNode::declare_connections()
     register_input_render_target("Metallic");
     register_input_render_target("Normal");
 
-    m_ssr_rt = register_scaled_output_render_target("SSR", 1.0f, 1.0f, GL_TEXTURE_2D, GL_RGBA32F, GL_RGBA, GL_FLOAT);
+    m_ssr_rt = register_scaled_output_render_target("SSR", 1.0f, 1.0f, GL_TEXTURE_2D, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -41,7 +44,10 @@ bool ScreenSpaceReflectionNode::initialize(Renderer* renderer, ResourceManager*
 {
     register_bool_parameter("Enabled", m_enabled);
     register_float_parameter("Thickness", m_thickness);
-    register_int_parameter("Num Steps", m_num_steps, 1, 100);
+    register_int_parameter("Max Iterations", m_max_iterations, 1, 256);
+    register_float_parameter("Min Metallic", m_min_metallic, 0.0f, 1.0f);
+    register_float_parameter("Max Roughness", m_max_roughness, 0.0f, 1.0f);
+    register_float_parameter("Half Res Roughness", m_half_res_roughness, 0.0f, 1.0f);
 
     m_hiz_depth_rt = find_input_render_target("HiZDepth");
     m_metallic_rt  = find_input_render_target("Metallic");
@@ -49,11 +55,15 @@ bool ScreenSpaceReflectionNode::initialize(Renderer* renderer, ResourceManager*
 
     m_ssr_rtv = RenderTargetView(0, 0, 0, m_ssr_rt->texture);
 
-    m_ssr_cs = res_mgr->load_shader("shader/post_process/ssr/ssr_cs.glsl", GL_COMPUTE_SHADER);
+    create_tile_buffer();
 
-    if (m_ssr_cs)
+    m_classify_cs = res_mgr->load_shader("shader/post_process/ssr/ssr_classify_cs.glsl", GL_COMPUTE_SHADER);
+    m_ssr_cs      = res_mgr->load_shader("shader/post_process/ssr/ssr_cs.glsl", GL_COMPUTE_SHADER);
+
+    if (m_classify_cs && m_ssr_cs)
     {
-        m_ssr_program = renderer->create_program({ m_ssr_cs });
+        m_classify_program = renderer->create_program({ m_classify_cs });
+        m_ssr_program      = renderer->create_program({ m_ssr_cs });
         return true;
     }
     else
@@ -68,24 +78,74 @@ void ScreenSpaceReflectionNode::execute(double delta, Renderer* renderer, Scene*
     {
         renderer->per_view_ssbo()->bind_range(0, sizeof(PerViewUniforms) * view->uniform_idx, sizeof(PerViewUniforms));
 
-        m_ssr_program->use();
+        // Reset the group counts of both trace dispatches.
+        uint32_t dispatch_args[8] = { 0, 1, 1, 0, 0, 1, 1, 0 };
+        m_tile_buffer->set_data(0, SSR_DISPATCH_ARGS_SIZE, &dispatch_args[0]);
+        m_tile_buffer->bind_base(SSR_TILE_BUFFER_BINDING);
+
+        m_ssr_rt->texture->bind_image(0, 0, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+        {
+            NIMBLE_SCOPED_SAMPLE("SSR Classify");
+
+            m_classify_program->use();
+
+            if (m_classify_program->set_uniform("s_HiZDepth", 1))
+                m_hiz_depth_rt->texture->bind(1);
+
+            if (m_classify_program->set_uniform("s_Metallic", 2))
+                m_metallic_rt->texture->bind(2);
+
+            m_classify_program->set_uniform("u_MinMetallic", m_min_metallic);
+            m_classify_program->set_uniform("u_MaxRoughness", m_max_roughness);
+            m_classify_program->set_uniform("u_HalfResRoughness", m_half_res_roughness);
+            m_classify_program->set_uniform("u_HalfResTileOffset", int32_t(m_half_res_tile_offset));
+
+            uint32_t w = viewport_width();
+            uint32_t h = viewport_height();
+
+            dispatch_compute((w + SSR_CLASSIFY_TILE_SIZE - 1) / SSR_CLASSIFY_TILE_SIZE, (h + SSR_CLASSIFY_TILE_SIZE - 1) / SSR_CLASSIFY_TILE_SIZE, 1);
+
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        }
+
+        {
+            NIMBLE_SCOPED_SAMPLE("SSR Trace");
+
+            m_ssr_program->use();
+
+            m_ssr_program->set_uniform("u_Thickness", m_thickness);
+            m_ssr_program->set_uniform("u_MaxIterations", m_max_iterations);
+            m_ssr_program->set_uniform("u_MinMetallic", m_min_metallic);
+            m_ssr_program->set_uniform("u_MaxRoughness", m_max_roughness);
+
+            if (m_ssr_program->set_uniform("s_HiZDepth", 1))
+                m_hiz_depth_rt->texture->bind(1);
 
-        m_ssr_program->set_uniform("u_RayCastSize", glm::vec4(m_graph->window_width(), m_graph->window_height(), 1.0f / m_graph->window_width(), 1.0f / m_graph->window_height()));
-        m_ssr_program->set_uniform("u_Thickness", m_thickness);
-        m_ssr_program->set_uniform("u_NumSteps", m_num_steps);
+            if (m_ssr_program->set_uniform("s_Metallic", 2))
+                m_metallic_rt->texture->bind(2);
 
-        if (m_ssr_program->set_uniform("s_HiZDepth", 1))
-            m_hiz_depth_rt->texture->bind(1);
+            if (m_ssr_program->set_uniform("s_Normal", 3))
+                m_normal_rt->texture->bind(3);
 
-        if (m_ssr_program->set_uniform("s_Metallic", 2))
-            m_metallic_rt->texture->bind(2);
+            state_cache::bind_buffer(GL_DISPATCH_INDIRECT_BUFFER, m_tile_buffer->id());
 
-        if (m_ssr_program->set_uniform("s_Normal", 3))
-            m_normal_rt->texture->bind(3);
+            // Smooth tiles, one work group per 8x8 pixels.
+            m_ssr_program->set_uniform("u_HalfRes", 0);
+            m_ssr_program->set_uniform("u_TileOffset", 0);
 
-        m_ssr_rt->texture->bind_image(0, 0, 0, GL_WRITE_ONLY, GL_RGBA32F);
+            dispatch_compute_indirect(0);
 
-        glDispatchCompute(m_graph->window_width() / NUM_SSR_THREADS, m_graph->window_height() / NUM_SSR_THREADS, 1);
+            // Rough tiles, one work group per 16x16 pixels.
+            m_ssr_program->set_uniform("u_HalfRes", 1);
+            m_ssr_program->set_uniform("u_TileOffset", int32_t(m_half_res_tile_offset));
+
+            dispatch_compute_indirect(4 * sizeof(uint32_t));
+
+            state_cache::bind_buffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+
+            glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        }
     }
 }
 
@@ -102,5 +162,26 @@ std::string ScreenSpaceReflectionNode::name()
     return "Screen Space Reflections";
 }
 
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void ScreenSpaceReflectionNode::on_window_resized(const uint32_t& w, const uint32_t& h)
+{
+    create_tile_buffer();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void ScreenSpaceReflectionNode::create_tile_buffer()
+{
+    uint32_t tiles_x   = (viewport_width() + SSR_CLASSIFY_TILE_SIZE - 1) / SSR_CLASSIFY_TILE_SIZE;
+    uint32_t tiles_y   = (viewport_height() + SSR_CLASSIFY_TILE_SIZE - 1) / SSR_CLASSIFY_TILE_SIZE;
+    uint32_t num_tiles = tiles_x * tiles_y;
+    uint32_t sub_tiles = (SSR_CLASSIFY_TILE_SIZE / SSR_TRACE_TILE_SIZE) * (SSR_CLASSIFY_TILE_SIZE / SSR_TRACE_TILE_SIZE);
+
+    // Any tile may end up in either list, so both are sized for every tile of the window.
+    m_half_res_tile_offset = num_tiles * sub_tiles;
+    m_tile_buffer          = std::make_unique<ShaderStorageBuffer>(GL_DYNAMIC_DRAW, SSR_DISPATCH_ARGS_SIZE + sizeof(uint32_t) * (m_half_res_tile_offset + num_tiles));
+}
+
 // -----------------------------------------------------------------------------------------------------------------------------------
 } // namespace nimble
\ No newline at end of file
@@ -15,11 +15,19 @@ public:
     void        execute(double delta, Renderer* renderer, Scene* scene, View* view) override;
     void        shutdown() override;
     std::string name() override;
+    void        on_window_resized(const uint32_t& w, const uint32_t& h) override;
 
 private:
-    bool m_enabled;
-    float m_thickness = 0.2f;
-    int32_t m_num_steps = 32;
+    void create_tile_buffer();
+
+private:
+    bool     m_enabled;
+    float    m_thickness            = 0.2f;
+    int32_t  m_max_iterations       = 64;
+    float    m_min_metallic         = 0.1f;
+    float    m_max_roughness        = 0.8f;
+    float    m_half_res_roughness   = 0.4f;
+    uint32_t m_half_res_tile_offset = 0;
 
     // Inputs
     std::shared_ptr<RenderTarget> m_hiz_depth_rt;
@@ -31,7 +39,12 @@ private:
 
     RenderTargetView m_ssr_rtv;
 
+    // Indirect dispatch arguments for the full and half resolution traces followed by the tile lists written by the classification.
+    std::unique_ptr<ShaderStorageBuffer> m_tile_buffer;
+
+    std::shared_ptr<Shader>  m_classify_cs;
     std::shared_ptr<Shader>  m_ssr_cs;
+    std::shared_ptr<Program> m_classify_program;
     std::shared_ptr<Program> m_ssr_program;
 };
 
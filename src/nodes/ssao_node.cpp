@@ -8,6 +8,8 @@
 #include <gtx/compatibility.hpp>
 
 #define SSAO_SCALE 0.5f
+#define SSAO_NUM_THREADS 16
+#define SSAO_UPSAMPLE_NUM_THREADS 16
 
 namespace nimble
 {
@@ -34,7 +36,7 @@ void SSAONode::declare_connections()
     register_input_render_target("Depth");
 
     m_ssao_intermediate_rt = register_scaled_intermediate_render_target("SSAO_Intermediate", SSAO_SCALE, SSAO_SCALE, GL_TEXTURE_2D, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
-    m_ssao_rt              = register_scaled_output_render_target("SSAO", SSAO_SCALE, SSAO_SCALE, GL_TEXTURE_2D, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+    m_ssao_rt              = register_scaled_output_render_target("SSAO", 1.0f, 1.0f, GL_TEXTURE_2D, GL_R8, GL_RED, GL_UNSIGNED_BYTE);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -42,6 +44,7 @@ void SSAONode::declare_connections()
 bool SSAONode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 {
     register_bool_parameter("Enabled", m_enabled);
+    register_bool_parameter("Compute", m_use_compute);
     register_int_parameter("Num Samples", m_num_samples, 0, 64);
     register_float_parameter("Radius", m_radius);
     register_float_parameter("Power", m_power);
@@ -91,6 +94,19 @@ bool SSAONode::initialize(Renderer* renderer, ResourceManager* res_mgr)
     m_ssao_fs      = res_mgr->load_shader("shader/post_process/ssao/ssao_fs.glsl", GL_FRAGMENT_SHADER);
     m_ssao_blur_fs = res_mgr->load_shader("shader/post_process/ssao/ssao_blur_fs.glsl", GL_FRAGMENT_SHADER);
 
+    m_ssao_cs          = res_mgr->load_shader("shader/post_process/ssao/ssao_cs.glsl", GL_COMPUTE_SHADER);
+    m_ssao_upsample_cs = res_mgr->load_shader("shader/post_process/ssao/ssao_upsample_cs.glsl", GL_COMPUTE_SHADER);
+
+    if (m_ssao_cs && m_ssao_upsample_cs)
+    {
+        m_ssao_compute_program = renderer->create_program({ m_ssao_cs });
+        m_ssao_compute_program->uniform_block_binding("u_SSAOData", 2);
+
+        m_ssao_upsample_program = renderer->create_program({ m_ssao_upsample_cs });
+    }
+    else
+        return false;
+
     if (m_triangle_vs)
     {
         if (m_ssao_fs)
@@ -118,14 +134,22 @@ void SSAONode::execute(double delta, Renderer* renderer, Scene* scene, View* vie
 {
     if (m_enabled)
     {
-        ssao(renderer, view);
-        blur(renderer);
+        if (m_use_compute)
+        {
+            ssao_compute(renderer, view);
+            upsample_compute(renderer, view);
+        }
+        else
+        {
+            ssao(renderer, view);
+            blur(renderer);
+        }
     }
     else
     {
         renderer->bind_render_targets(1, &m_ssao_rtv, nullptr);
-        glViewport(0, 0, m_graph->window_width() * SSAO_SCALE, m_graph->window_height() * SSAO_SCALE);
-        glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+        state_cache::viewport(0, 0, viewport_width(), viewport_height());
+        state_cache::clear_color(1.0f, 1.0f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
     }
 }
@@ -147,7 +171,7 @@ std::string SSAONode::name()
 
 void SSAONode::ssao(Renderer* renderer, View* view)
 {
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "SSAO");
+    NIMBLE_SCOPED_DEBUG_GROUP("SSAO");
 
     m_ssao_program->use();
 
@@ -162,26 +186,24 @@ void SSAONode::ssao(Renderer* renderer, View* view)
     if (m_ssao_program->set_uniform("s_Noise", 2))
         m_noise_texture->bind(2);
 
-    m_ssao_program->set_uniform("u_ViewportSize", glm::vec2(m_graph->window_width() * SSAO_SCALE, m_graph->window_height() * SSAO_SCALE));
+    m_ssao_program->set_uniform("u_ViewportSize", glm::vec2(viewport_width() * SSAO_SCALE, viewport_height() * SSAO_SCALE));
     m_ssao_program->set_uniform("u_NumSamples", m_num_samples);
     m_ssao_program->set_uniform("u_Radius", m_radius);
     m_ssao_program->set_uniform("u_Bias", m_bias);
     m_ssao_program->set_uniform("u_Power", m_power);
 
     renderer->bind_render_targets(1, &m_ssao_intermediate_rtv, nullptr);
-    glViewport(0, 0, m_graph->window_width() * SSAO_SCALE, m_graph->window_height() * SSAO_SCALE);
+    state_cache::viewport(0, 0, viewport_width() * SSAO_SCALE, viewport_height() * SSAO_SCALE);
     glClear(GL_COLOR_BUFFER_BIT);
 
     render_fullscreen_triangle(renderer, view, nullptr, 0, NODE_USAGE_PER_VIEW_UBO);
-
-    glPopDebugGroup();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void SSAONode::blur(Renderer* renderer)
 {
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Blur");
+    NIMBLE_SCOPED_DEBUG_GROUP("Blur");
 
     m_ssao_blur_program->use();
 
@@ -189,12 +211,77 @@ void SSAONode::blur(Renderer* renderer)
         m_ssao_intermediate_rt->texture->bind(0);
 
     renderer->bind_render_targets(1, &m_ssao_rtv, nullptr);
-    glViewport(0, 0, m_graph->window_width() * SSAO_SCALE, m_graph->window_height() * SSAO_SCALE);
+    state_cache::viewport(0, 0, viewport_width(), viewport_height());
     glClear(GL_COLOR_BUFFER_BIT);
 
     render_fullscreen_triangle(renderer, nullptr);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void SSAONode::ssao_compute(Renderer* renderer, View* view)
+{
+    NIMBLE_SCOPED_DEBUG_GROUP("SSAO Compute");
+
+    uint32_t w = viewport_width() * SSAO_SCALE;
+    uint32_t h = viewport_height() * SSAO_SCALE;
+
+    renderer->per_view_ssbo()->bind_range(0, sizeof(PerViewUniforms) * view->uniform_idx, sizeof(PerViewUniforms));
+
+    m_ssao_compute_program->use();
+
+    m_kernel_ubo->bind_base(2);
+
+    if (m_ssao_compute_program->set_uniform("s_Normals", 0))
+        m_normals_rt->texture->bind(0);
+
+    if (m_ssao_compute_program->set_uniform("s_Depth", 1))
+        m_depth_rt->texture->bind(1);
+
+    if (m_ssao_compute_program->set_uniform("s_Noise", 2))
+        m_noise_texture->bind(2);
+
+    m_ssao_compute_program->set_uniform("u_Size", glm::vec2(w, h));
+    m_ssao_compute_program->set_uniform("u_MaxMip", int32_t(m_depth_rt->texture->mip_levels()) - 1);
+    m_ssao_compute_program->set_uniform("u_NumSamples", m_num_samples);
+    m_ssao_compute_program->set_uniform("u_Radius", m_radius);
+    m_ssao_compute_program->set_uniform("u_Bias", m_bias);
+    m_ssao_compute_program->set_uniform("u_Power", m_power);
+
+    m_ssao_intermediate_rt->texture->bind_image(0, 0, 0, GL_WRITE_ONLY, GL_R8);
+
+    dispatch_compute((w + SSAO_NUM_THREADS - 1) / SSAO_NUM_THREADS, (h + SSAO_NUM_THREADS - 1) / SSAO_NUM_THREADS, 1);
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void SSAONode::upsample_compute(Renderer* renderer, View* view)
+{
+    NIMBLE_SCOPED_DEBUG_GROUP("Bilateral Upsample");
+
+    uint32_t w = viewport_width();
+    uint32_t h = viewport_height();
+
+    m_ssao_upsample_program->use();
+
+    if (m_ssao_upsample_program->set_uniform("s_SSAO", 0))
+        m_ssao_intermediate_rt->texture->bind(0);
+
+    if (m_ssao_upsample_program->set_uniform("s_Normals", 1))
+        m_normals_rt->texture->bind(1);
+
+    if (m_ssao_upsample_program->set_uniform("s_Depth", 2))
+        m_depth_rt->texture->bind(2);
+
+    m_ssao_upsample_program->set_uniform("u_Size", glm::vec2(w, h));
+
+    m_ssao_rt->texture->bind_image(0, 0, 0, GL_WRITE_ONLY, GL_R8);
+
+    dispatch_compute((w + SSAO_UPSAMPLE_NUM_THREADS - 1) / SSAO_UPSAMPLE_NUM_THREADS, (h + SSAO_UPSAMPLE_NUM_THREADS - 1) / SSAO_UPSAMPLE_NUM_THREADS, 1);
 
-    glPopDebugGroup();
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
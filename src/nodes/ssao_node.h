@@ -19,6 +19,8 @@ public:
 private:
     void ssao(Renderer* renderer, View* view);
     void blur(Renderer* renderer);
+    void ssao_compute(Renderer* renderer, View* view);
+    void upsample_compute(Renderer* renderer, View* view);
 
 private:
     std::unique_ptr<Texture2D>     m_noise_texture;
@@ -41,7 +43,14 @@ private:
     std::shared_ptr<Shader>  m_ssao_blur_fs;
     std::shared_ptr<Program> m_ssao_blur_program;
 
+    std::shared_ptr<Shader>  m_ssao_cs;
+    std::shared_ptr<Program> m_ssao_compute_program;
+
+    std::shared_ptr<Shader>  m_ssao_upsample_cs;
+    std::shared_ptr<Program> m_ssao_upsample_program;
+
     bool    m_enabled     = true;
+    bool    m_use_compute = true;
     int32_t m_num_samples = 64;
     float   m_power       = 3.0f;
     float   m_radius      = 25.0f;
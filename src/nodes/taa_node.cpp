@@ -27,6 +27,7 @@ void TAANode::declare_connections()
 {
     register_input_render_target("Color");
     register_input_render_target("Velocity");
+    register_input_render_target("Depth");
 
     m_taa_rt = register_scaled_output_render_target("TAA", 1.0f, 1.0f, GL_TEXTURE_2D, GL_RGB16F, GL_RGB, GL_HALF_FLOAT);
 }
@@ -36,12 +37,17 @@ void TAANode::declare_connections()
 bool TAANode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 {
     register_bool_parameter("Enabled", m_enabled);
+    register_bool_parameter("Closest Velocity", m_closest_velocity);
+    register_float_parameter("Feedback", m_feedback, 0.0f, 0.98f);
 
     m_color_rt    = find_input_render_target("Color");
     m_velocity_rt = find_input_render_target("Velocity");
+    m_depth_rt    = find_input_render_target("Depth");
 
     m_taa_rtv = RenderTargetView(0, 0, 0, m_taa_rt->texture);
 
+    create_history_textures();
+
     m_fullscreen_triangle_vs = res_mgr->load_shader("shader/post_process/fullscreen_triangle_vs.glsl", GL_VERTEX_SHADER);
     m_taa_fs                 = res_mgr->load_shader("shader/post_process/taa/taa_fs.glsl", GL_FRAGMENT_SHADER);
 
@@ -58,28 +64,51 @@ bool TAANode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 
 void TAANode::execute(double delta, Renderer* renderer, Scene* scene, View* view)
 {
-    if (m_enabled)
+    if (m_enabled && m_velocity_rt)
     {
-        glDisable(GL_DEPTH_TEST);
-        glDisable(GL_CULL_FACE);
+        state_cache::disable(GL_DEPTH_TEST);
+        state_cache::disable(GL_CULL_FACE);
 
         m_taa_program->use();
 
-        renderer->bind_render_targets(1, &m_taa_rtv, nullptr);
+        uint32_t current  = m_history_index;
+        uint32_t previous = 1 - m_history_index;
+
+        RenderTargetView rtvs[] = { m_taa_rtv, m_history_rtv[current] };
+
+        renderer->bind_render_targets(2, rtvs, nullptr);
 
         glClear(GL_COLOR_BUFFER_BIT);
-        glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
+        state_cache::viewport(0, 0, viewport_width(), viewport_height());
 
         if (m_taa_program->set_uniform("s_Color", 0) && m_color_rt)
             m_color_rt->texture->bind(0);
 
-        if (m_taa_program->set_uniform("s_Velocity", 1) && m_velocity_rt)
+        if (m_taa_program->set_uniform("s_Velocity", 1))
             m_velocity_rt->texture->bind(1);
 
-        render_fullscreen_triangle(renderer, view);
+        if (m_taa_program->set_uniform("s_Depth", 2) && m_depth_rt)
+            m_depth_rt->texture->bind(2);
+
+        if (m_taa_program->set_uniform("s_History", 3))
+            m_history[previous]->bind(3);
+
+        m_taa_program->set_uniform("u_Feedback", m_feedback);
+        m_taa_program->set_uniform("u_HistoryValid", m_history_valid ? 1 : 0);
+        m_taa_program->set_uniform("u_ClosestVelocity", (m_closest_velocity && m_depth_rt) ? 1 : 0);
+
+        render_fullscreen_triangle(renderer, view, m_taa_program.get(), 4, NODE_USAGE_PER_VIEW_UBO);
+
+        m_history_valid = true;
+        m_history_index = previous;
     }
     else
+    {
+        // Falls back to a bilinear upscale when rendering below the output resolution.
         blit_render_target(renderer, m_color_rt, m_taa_rt);
+
+        m_history_valid = false;
+    }
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -95,5 +124,36 @@ std::string TAANode::name()
     return "TAA";
 }
 
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void TAANode::on_window_resized(const uint32_t& w, const uint32_t& h)
+{
+    create_history_textures();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool TAANode::is_upscaler()
+{
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void TAANode::create_history_textures()
+{
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        m_history[i] = std::make_shared<Texture2D>(viewport_width(), viewport_height(), 1, 1, 1, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+        m_history[i]->set_min_filter(GL_LINEAR);
+        m_history[i]->set_mag_filter(GL_LINEAR);
+        m_history[i]->set_wrapping(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+
+        m_history_rtv[i] = RenderTargetView(0, 0, 0, m_history[i]);
+    }
+
+    m_history_valid = false;
+}
+
 // -----------------------------------------------------------------------------------------------------------------------------------
 } // namespace nimble
\ No newline at end of file
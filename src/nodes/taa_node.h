@@ -15,19 +15,34 @@ public:
     void        execute(double delta, Renderer* renderer, Scene* scene, View* view) override;
     void        shutdown() override;
     std::string name() override;
+    void        on_window_resized(const uint32_t& w, const uint32_t& h) override;
+    bool        is_upscaler() override;
 
 private:
-    bool m_enabled = true;
+    void create_history_textures();
+
+private:
+    bool     m_enabled          = true;
+    bool     m_closest_velocity = true;
+    float    m_feedback         = 0.9f;
+    bool     m_history_valid    = false;
+    uint32_t m_history_index    = 0;
 
     // Inputs
     std::shared_ptr<RenderTarget> m_color_rt;
     std::shared_ptr<RenderTarget> m_velocity_rt;
+    std::shared_ptr<RenderTarget> m_depth_rt;
 
     // Outputs
     std::shared_ptr<RenderTarget> m_taa_rt;
 
     RenderTargetView m_taa_rtv;
 
+    // Output resolution history of the current and previous frame. Owned by the node since the graph may alias intermediate render
+    // targets.
+    std::shared_ptr<Texture2D> m_history[2];
+    RenderTargetView           m_history_rtv[2];
+
     std::shared_ptr<Shader>  m_fullscreen_triangle_vs;
     std::shared_ptr<Shader>  m_taa_fs;
     std::shared_ptr<Program> m_taa_program;
@@ -3,6 +3,10 @@
 #include "../resource_manager.h"
 #include "../renderer.h"
 #include "../logger.h"
+#include "../profiler.h"
+
+#define TONE_MAP_LUT_SIZE 32
+#define TONE_MAP_LUT_NUM_THREADS 4
 
 namespace nimble
 {
@@ -34,19 +38,33 @@ void ToneMapNode::declare_connections()
 
 bool ToneMapNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 {
-    register_int_parameter("Operator", m_tone_map_operator, 0, 4);
+    register_int_parameter("Operator", m_settings.tone_map_operator, 0, 4);
+    register_float_parameter("Saturation", m_settings.saturation, 0.0f, 2.0f);
+    register_float_parameter("Contrast", m_settings.contrast, 0.5f, 2.0f);
+    register_float_parameter("Lift", m_settings.lift, -0.2f, 0.2f);
+    register_float_parameter("Gamma", m_settings.gamma, 0.2f, 3.0f);
+    register_float_parameter("Gain", m_settings.gain, 0.0f, 2.0f);
 
     m_texture  = find_input_render_target("Color");
     m_avg_luma = find_input_render_target("Luminance");
 
-    m_vs = res_mgr->load_shader("shader/post_process/fullscreen_triangle_vs.glsl", GL_VERTEX_SHADER);
-    m_fs = res_mgr->load_shader("shader/post_process/tone_map_fs.glsl", GL_FRAGMENT_SHADER);
+    m_lut = std::make_unique<Texture3D>(TONE_MAP_LUT_SIZE, TONE_MAP_LUT_SIZE, TONE_MAP_LUT_SIZE, 1, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+    m_lut->set_min_filter(GL_LINEAR);
+    m_lut->set_mag_filter(GL_LINEAR);
+    m_lut->set_wrapping(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+
+    m_lut_valid = false;
+
+    m_vs     = res_mgr->load_shader("shader/post_process/fullscreen_triangle_vs.glsl", GL_VERTEX_SHADER);
+    m_fs     = res_mgr->load_shader("shader/post_process/tone_map_fs.glsl", GL_FRAGMENT_SHADER);
+    m_lut_cs = res_mgr->load_shader("shader/post_process/tone_map_lut_cs.glsl", GL_COMPUTE_SHADER);
 
-    if (m_vs && m_fs)
+    if (m_vs && m_fs && m_lut_cs)
     {
-        m_program = renderer->create_program(m_vs, m_fs);
+        m_program     = renderer->create_program(m_vs, m_fs);
+        m_lut_program = renderer->create_program({ m_lut_cs });
 
-        if (m_program)
+        if (m_program && m_lut_program)
             return true;
         else
         {
@@ -65,20 +83,21 @@ bool ToneMapNode::initialize(Renderer* renderer, ResourceManager* res_mgr)
 
 void ToneMapNode::execute(double delta, Renderer* renderer, Scene* scene, View* view)
 {
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    if (!m_lut_valid || !(m_settings == m_lut_settings))
+        bake_lut();
+
+    state_cache::disable(GL_DEPTH_TEST);
+    state_cache::disable(GL_CULL_FACE);
 
     m_program->use();
 
     if (view->dest_render_target_view)
         renderer->bind_render_targets(1, view->dest_render_target_view, nullptr);
     else
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        state_cache::bind_framebuffer(GL_FRAMEBUFFER, 0);
 
     glClear(GL_COLOR_BUFFER_BIT);
-    glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
-
-    m_program->set_uniform("u_ToneMapOperator", m_tone_map_operator);
+    state_cache::viewport(0, 0, viewport_width(), viewport_height());
 
     if (m_program->set_uniform("s_Texture", 0) && m_texture)
         m_texture->texture->bind(0);
@@ -86,6 +105,9 @@ void ToneMapNode::execute(double delta, Renderer* renderer, Scene* scene, View*
     if (m_program->set_uniform("s_AvgLuma", 1) && m_avg_luma)
         m_avg_luma->texture->bind(1);
 
+    if (m_program->set_uniform("s_ToneMapLUT", 2))
+        m_lut->bind(2);
+
     render_fullscreen_triangle(renderer, view);
 }
 
@@ -102,5 +124,41 @@ std::string ToneMapNode::name()
     return "Tone Map";
 }
 
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool ToneMapNode::LUTSettings::operator==(const LUTSettings& other) const
+{
+    return tone_map_operator == other.tone_map_operator && saturation == other.saturation && contrast == other.contrast && lift == other.lift && gamma == other.gamma && gain == other.gain;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Bakes the tone mapping operator, grading and gamma correction into the LUT. Only runs when one of the settings has changed.
+void ToneMapNode::bake_lut()
+{
+    NIMBLE_SCOPED_SAMPLE("Bake LUT");
+    NIMBLE_SCOPED_DEBUG_GROUP("Bake LUT");
+
+    m_lut_program->use();
+
+    m_lut->bind_image(0, 0, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+    m_lut_program->set_uniform("u_ToneMapOperator", m_settings.tone_map_operator);
+    m_lut_program->set_uniform("u_Saturation", m_settings.saturation);
+    m_lut_program->set_uniform("u_Contrast", m_settings.contrast);
+    m_lut_program->set_uniform("u_Lift", m_settings.lift);
+    m_lut_program->set_uniform("u_Gamma", m_settings.gamma);
+    m_lut_program->set_uniform("u_Gain", m_settings.gain);
+
+    uint32_t size = TONE_MAP_LUT_SIZE / TONE_MAP_LUT_NUM_THREADS;
+
+    dispatch_compute(size, size, size);
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    m_lut_settings = m_settings;
+    m_lut_valid    = true;
+}
+
 // -----------------------------------------------------------------------------------------------------------------------------------
 } // namespace nimble
\ No newline at end of file
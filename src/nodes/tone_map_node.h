@@ -17,7 +17,28 @@ public:
     std::string name() override;
 
 private:
-    int32_t                       m_tone_map_operator = 4;
+    struct LUTSettings
+    {
+        int32_t tone_map_operator = 4;
+        float   saturation        = 1.0f;
+        float   contrast          = 1.0f;
+        float   lift              = 0.0f;
+        float   gamma             = 1.0f;
+        float   gain              = 1.0f;
+
+        bool operator==(const LUTSettings& other) const;
+    };
+
+    void bake_lut();
+
+private:
+    // Parameters edited through the UI, and the ones the LUT was last baked with.
+    LUTSettings                   m_settings;
+    LUTSettings                   m_lut_settings;
+    bool                          m_lut_valid = false;
+    std::unique_ptr<Texture3D>    m_lut;
+    std::shared_ptr<Shader>       m_lut_cs;
+    std::shared_ptr<Program>      m_lut_program;
     std::shared_ptr<Shader>       m_vs;
     std::shared_ptr<Shader>       m_fs;
     std::shared_ptr<Program>      m_program;
@@ -7,6 +7,11 @@
 #include <math.h>
 
 #define VOLUMETRIC_LIGHT_BUFFER_SCALE 0.5f
+#define FROXEL_GRID_X 160
+#define FROXEL_GRID_Y 90
+#define FROXEL_GRID_Z 64
+#define FROXEL_NUM_THREADS 8
+#define FROXEL_JITTER_SAMPLES 8
 
 namespace nimble
 {
@@ -14,6 +19,23 @@ DEFINE_RENDER_NODE_FACTORY(VolumetricLightNode)
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+static float halton_sequence(int base, int index)
+{
+    float result = 0.0f;
+    float f      = 1.0f;
+
+    while (index > 0)
+    {
+        f /= float(base);
+        result += f * float(index % base);
+        index /= base;
+    }
+
+    return result;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 VolumetricLightNode::VolumetricLightNode(RenderGraph* graph) :
     RenderNode(graph)
 {
@@ -48,6 +70,11 @@ bool VolumetricLightNode::initialize(Renderer* renderer, ResourceManager* res_mg
     register_bool_parameter("Enabled", m_enabled);
     register_int_parameter("Num Samples", m_num_samples, 0, 32);
     register_float_parameter("Mie Scattering G", m_mie_g, 0.0f, 1.0f);
+    register_bool_parameter("Froxels", m_use_froxels);
+    register_bool_parameter("Temporal Reprojection", m_temporal);
+    register_float_parameter("Density", m_density, 0.0f, 0.1f);
+    register_float_parameter("Max Distance", m_max_distance, 10.0f, 5000.0f);
+    register_float_parameter("History Weight", m_history_weight, 0.0f, 0.99f);
 
     m_depth_rt = find_input_render_target("Depth");
 
@@ -163,6 +190,19 @@ bool VolumetricLightNode::initialize(Renderer* renderer, ResourceManager* res_mg
     m_dither_texture->set_wrapping(GL_REPEAT, GL_REPEAT, GL_REPEAT);
     m_dither_texture->set_data(0, 0, dither.data());
 
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        m_scattering_volume[i] = std::make_unique<Texture3D>(FROXEL_GRID_X, FROXEL_GRID_Y, FROXEL_GRID_Z, 1, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+        m_scattering_volume[i]->set_min_filter(GL_LINEAR);
+        m_scattering_volume[i]->set_mag_filter(GL_LINEAR);
+        m_scattering_volume[i]->set_wrapping(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+    }
+
+    m_integrated_volume = std::make_unique<Texture3D>(FROXEL_GRID_X, FROXEL_GRID_Y, FROXEL_GRID_Z, 1, GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+    m_integrated_volume->set_min_filter(GL_LINEAR);
+    m_integrated_volume->set_mag_filter(GL_LINEAR);
+    m_integrated_volume->set_wrapping(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+
     m_volumetrics_rtv = RenderTargetView(0, 0, 0, m_volumetric_light_rt->texture);
     m_h_blur_rtv      = RenderTargetView(0, 0, 0, m_h_blur_rt->texture);
     m_v_blur_rtv      = RenderTargetView(0, 0, 0, m_v_blur_rt->texture);
@@ -172,9 +212,27 @@ bool VolumetricLightNode::initialize(Renderer* renderer, ResourceManager* res_mg
     m_volumetrics_fs         = res_mgr->load_shader("shader/post_process/volumetric_light/volumetric_light_fs.glsl", GL_FRAGMENT_SHADER, m_flags, renderer);
     m_blur_fs                = res_mgr->load_shader("shader/post_process/volumetric_light/volumetric_light_blur_fs.glsl", GL_FRAGMENT_SHADER);
     m_upscale_fs             = res_mgr->load_shader("shader/post_process/volumetric_light/volumetric_light_upscale_fs.glsl", GL_FRAGMENT_SHADER);
+    m_froxel_scattering_cs   = res_mgr->load_shader("shader/post_process/volumetric_light/froxel_scattering_cs.glsl", GL_COMPUTE_SHADER, m_flags, renderer);
+    m_froxel_integration_cs  = res_mgr->load_shader("shader/post_process/volumetric_light/froxel_integration_cs.glsl", GL_COMPUTE_SHADER);
+    m_froxel_apply_fs        = res_mgr->load_shader("shader/post_process/volumetric_light/froxel_apply_fs.glsl", GL_FRAGMENT_SHADER);
+
+    if (m_froxel_scattering_cs)
+        m_froxel_scattering_program = renderer->create_program({ m_froxel_scattering_cs });
+    else
+        return false;
+
+    if (m_froxel_integration_cs)
+        m_froxel_integration_program = renderer->create_program({ m_froxel_integration_cs });
+    else
+        return false;
 
     if (m_fullscreen_triangle_vs)
     {
+        if (m_froxel_apply_fs)
+            m_froxel_apply_program = renderer->create_program(m_fullscreen_triangle_vs, m_froxel_apply_fs);
+        else
+            return false;
+
         if (m_volumetrics_fs)
             m_volumetrics_program = renderer->create_program(m_fullscreen_triangle_vs, m_volumetrics_fs);
         else
@@ -200,7 +258,13 @@ bool VolumetricLightNode::initialize(Renderer* renderer, ResourceManager* res_mg
 
 void VolumetricLightNode::execute(double delta, Renderer* renderer, Scene* scene, View* view)
 {
-    if (m_enabled)
+    if (m_enabled && m_use_froxels)
+    {
+        froxel_scattering(renderer, scene, view);
+        froxel_integration(renderer, scene, view);
+        froxel_apply(renderer, scene, view);
+    }
+    else if (m_enabled)
     {
         volumetrics(renderer, scene, view);
 
@@ -209,6 +273,10 @@ void VolumetricLightNode::execute(double delta, Renderer* renderer, Scene* scene
 
         upscale(renderer, scene, view);
     }
+
+    // History has to be rebuilt after frames without the froxel path.
+    if (!m_enabled || !m_use_froxels)
+        m_history_valid = false;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -228,19 +296,19 @@ std::string VolumetricLightNode::name()
 
 void VolumetricLightNode::volumetrics(Renderer* renderer, Scene* scene, View* view)
 {
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Volumetric Light Buffer");
+    NIMBLE_SCOPED_DEBUG_GROUP("Volumetric Light Buffer");
 
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    state_cache::disable(GL_DEPTH_TEST);
+    state_cache::disable(GL_CULL_FACE);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_ONE, GL_ONE);
+    state_cache::enable(GL_BLEND);
+    state_cache::blend_func(GL_ONE, GL_ONE);
 
     m_volumetrics_program->use();
 
     renderer->bind_render_targets(1, &m_volumetrics_rtv, nullptr);
-    glViewport(0, 0, m_graph->window_width() * VOLUMETRIC_LIGHT_BUFFER_SCALE, m_graph->window_height() * VOLUMETRIC_LIGHT_BUFFER_SCALE);
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::viewport(0, 0, viewport_width() * VOLUMETRIC_LIGHT_BUFFER_SCALE, viewport_height() * VOLUMETRIC_LIGHT_BUFFER_SCALE);
+    state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     int32_t tex_unit = 0;
@@ -258,33 +326,31 @@ void VolumetricLightNode::volumetrics(Renderer* renderer, Scene* scene, View* vi
 
     render_fullscreen_triangle(renderer, view, m_volumetrics_program.get(), tex_unit, m_flags);
 
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_BLEND);
-
-    glPopDebugGroup();
+    state_cache::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state_cache::disable(GL_BLEND);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void VolumetricLightNode::blur(Renderer* renderer, Scene* scene, View* view)
 {
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Blur");
+    NIMBLE_SCOPED_DEBUG_GROUP("Blur");
 
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    state_cache::disable(GL_DEPTH_TEST);
+    state_cache::disable(GL_CULL_FACE);
 
     m_blur_program->use();
 
     // Horizontal
 
     renderer->bind_render_targets(1, &m_h_blur_rtv, nullptr);
-    glViewport(0, 0, m_graph->window_width() * VOLUMETRIC_LIGHT_BUFFER_SCALE, m_graph->window_height() * VOLUMETRIC_LIGHT_BUFFER_SCALE);
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::viewport(0, 0, viewport_width() * VOLUMETRIC_LIGHT_BUFFER_SCALE, viewport_height() * VOLUMETRIC_LIGHT_BUFFER_SCALE);
+    state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     int32_t tex_unit = 0;
 
-    glm::vec2 pixel_size = glm::vec2(1.0f / (float(m_graph->window_width()) * VOLUMETRIC_LIGHT_BUFFER_SCALE), 1.0f / (float(m_graph->window_height()) * VOLUMETRIC_LIGHT_BUFFER_SCALE));
+    glm::vec2 pixel_size = glm::vec2(1.0f / (float(viewport_width()) * VOLUMETRIC_LIGHT_BUFFER_SCALE), 1.0f / (float(viewport_height()) * VOLUMETRIC_LIGHT_BUFFER_SCALE));
     m_blur_program->set_uniform("u_PixelSize", pixel_size);
     m_blur_program->set_uniform("u_Direction", glm::vec2(1.0f, 0.0f));
 
@@ -309,33 +375,31 @@ void VolumetricLightNode::blur(Renderer* renderer, Scene* scene, View* view)
     m_blur_program->set_uniform("u_Direction", glm::vec2(0.0f, 1.0f));
 
     renderer->bind_render_targets(1, &m_v_blur_rtv, nullptr);
-    glViewport(0, 0, m_graph->window_width() * VOLUMETRIC_LIGHT_BUFFER_SCALE, m_graph->window_height() * VOLUMETRIC_LIGHT_BUFFER_SCALE);
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::viewport(0, 0, viewport_width() * VOLUMETRIC_LIGHT_BUFFER_SCALE, viewport_height() * VOLUMETRIC_LIGHT_BUFFER_SCALE);
+    state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     render_fullscreen_triangle(renderer, view, nullptr, tex_unit, NODE_USAGE_PER_VIEW_UBO);
-
-    glPopDebugGroup();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void VolumetricLightNode::upscale(Renderer* renderer, Scene* scene, View* view)
 {
-    glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, "Upscale");
+    NIMBLE_SCOPED_DEBUG_GROUP("Upscale");
 
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    state_cache::disable(GL_DEPTH_TEST);
+    state_cache::disable(GL_CULL_FACE);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_ONE, GL_ONE);
+    state_cache::enable(GL_BLEND);
+    state_cache::blend_func(GL_ONE, GL_ONE);
 
     m_upscale_program->use();
 
     renderer->bind_render_targets(1, &m_upscale_rtv, nullptr);
-    glViewport(0, 0, m_graph->window_width(), m_graph->window_height());
+    state_cache::viewport(0, 0, viewport_width(), viewport_height());
 
-    glm::vec2 pixel_size = glm::vec2(1.0f / (float(m_graph->window_width()) * VOLUMETRIC_LIGHT_BUFFER_SCALE), 1.0f / (float(m_graph->window_height()) * VOLUMETRIC_LIGHT_BUFFER_SCALE));
+    glm::vec2 pixel_size = glm::vec2(1.0f / (float(viewport_width()) * VOLUMETRIC_LIGHT_BUFFER_SCALE), 1.0f / (float(viewport_height()) * VOLUMETRIC_LIGHT_BUFFER_SCALE));
     m_upscale_program->set_uniform("u_PixelSize", pixel_size);
 
     int32_t tex_unit = 0;
@@ -353,10 +417,104 @@ void VolumetricLightNode::upscale(Renderer* renderer, Scene* scene, View* view)
 
     render_fullscreen_triangle(renderer, view, nullptr, tex_unit, NODE_USAGE_PER_VIEW_UBO);
 
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_BLEND);
+    state_cache::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state_cache::disable(GL_BLEND);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void VolumetricLightNode::froxel_scattering(Renderer* renderer, Scene* scene, View* view)
+{
+    NIMBLE_SCOPED_DEBUG_GROUP("Froxel Scattering");
+
+    m_froxel_scattering_program->use();
+
+    uint32_t current = m_froxel_frame % 2;
+    uint32_t history = 1 - current;
+
+    m_scattering_volume[current]->bind_image(0, 0, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+    // Texture unit 0 is taken by the image binding above.
+    int32_t tex_unit = 1;
+
+    if (m_froxel_scattering_program->set_uniform("s_History", tex_unit))
+        m_scattering_volume[history]->bind(tex_unit++);
+
+    float g_2 = m_mie_g * m_mie_g;
+    m_froxel_scattering_program->set_uniform("u_MieG", glm::vec4(1.0f - g_2, 1.0f + g_2, 2.0f * m_mie_g, 1.0f / (4.0f * M_PI)));
+    m_froxel_scattering_program->set_uniform("u_Density", m_density);
+    m_froxel_scattering_program->set_uniform("u_MaxDistance", m_max_distance);
+    m_froxel_scattering_program->set_uniform("u_Jitter", halton_sequence(2, (m_froxel_frame % FROXEL_JITTER_SAMPLES) + 1));
+    m_froxel_scattering_program->set_uniform("u_HistoryWeight", (m_temporal && m_history_valid) ? m_history_weight : 0.0f);
+
+    renderer->per_view_ssbo()->bind_range(0, sizeof(PerViewUniforms) * view->uniform_idx, sizeof(PerViewUniforms));
+    renderer->per_scene_ssbo()->bind_base(2);
+
+    bind_shadow_maps(renderer, m_froxel_scattering_program.get(), tex_unit, m_flags);
+
+    dispatch_compute((FROXEL_GRID_X + FROXEL_NUM_THREADS - 1) / FROXEL_NUM_THREADS, (FROXEL_GRID_Y + FROXEL_NUM_THREADS - 1) / FROXEL_NUM_THREADS, FROXEL_GRID_Z);
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    m_history_valid = true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void VolumetricLightNode::froxel_integration(Renderer* renderer, Scene* scene, View* view)
+{
+    NIMBLE_SCOPED_DEBUG_GROUP("Froxel Integration");
+
+    m_froxel_integration_program->use();
+
+    m_integrated_volume->bind_image(0, 0, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+    if (m_froxel_integration_program->set_uniform("s_Scattering", 1))
+        m_scattering_volume[m_froxel_frame % 2]->bind(1);
+
+    m_froxel_integration_program->set_uniform("u_MaxDistance", m_max_distance);
+
+    renderer->per_view_ssbo()->bind_range(0, sizeof(PerViewUniforms) * view->uniform_idx, sizeof(PerViewUniforms));
+
+    dispatch_compute((FROXEL_GRID_X + FROXEL_NUM_THREADS - 1) / FROXEL_NUM_THREADS, (FROXEL_GRID_Y + FROXEL_NUM_THREADS - 1) / FROXEL_NUM_THREADS, 1);
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    m_froxel_frame++;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void VolumetricLightNode::froxel_apply(Renderer* renderer, Scene* scene, View* view)
+{
+    NIMBLE_SCOPED_DEBUG_GROUP("Froxel Apply");
+
+    state_cache::disable(GL_DEPTH_TEST);
+    state_cache::disable(GL_CULL_FACE);
+
+    // color * transmittance + in-scattering
+    state_cache::enable(GL_BLEND);
+    state_cache::blend_func(GL_ONE, GL_SRC_ALPHA);
+
+    m_froxel_apply_program->use();
+
+    renderer->bind_render_targets(1, &m_upscale_rtv, nullptr);
+    state_cache::viewport(0, 0, viewport_width(), viewport_height());
+
+    int32_t tex_unit = 0;
+
+    if (m_froxel_apply_program->set_uniform("s_Depth", tex_unit))
+        m_depth_rt->texture->bind(tex_unit++);
+
+    if (m_froxel_apply_program->set_uniform("s_Volume", tex_unit))
+        m_integrated_volume->bind(tex_unit++);
+
+    m_froxel_apply_program->set_uniform("u_MaxDistance", m_max_distance);
+
+    render_fullscreen_triangle(renderer, view, nullptr, tex_unit, NODE_USAGE_PER_VIEW_UBO);
 
-    glPopDebugGroup();
+    state_cache::blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    state_cache::disable(GL_BLEND);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
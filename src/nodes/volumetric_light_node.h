@@ -20,6 +20,9 @@ private:
     void volumetrics(Renderer* renderer, Scene* scene, View* view);
     void blur(Renderer* renderer, Scene* scene, View* view);
     void upscale(Renderer* renderer, Scene* scene, View* view);
+    void froxel_scattering(Renderer* renderer, Scene* scene, View* view);
+    void froxel_integration(Renderer* renderer, Scene* scene, View* view);
+    void froxel_apply(Renderer* renderer, Scene* scene, View* view);
 
 private:
     std::shared_ptr<RenderTarget> m_color_rt;
@@ -47,12 +50,32 @@ private:
 
     std::unique_ptr<Texture2D> m_dither_texture;
 
-    uint32_t m_flags       = 0;
-    bool     m_enabled     = true;
-    bool     m_dither      = true;
-    bool     m_blur        = true;
-    int32_t  m_num_samples = 32;
-    float    m_mie_g       = 0.1f;
+    // Froxel volumes. The scattering volume is double buffered so the previous frame can be reprojected.
+    std::unique_ptr<Texture3D> m_scattering_volume[2];
+    std::unique_ptr<Texture3D> m_integrated_volume;
+
+    std::shared_ptr<Shader>  m_froxel_scattering_cs;
+    std::shared_ptr<Program> m_froxel_scattering_program;
+
+    std::shared_ptr<Shader>  m_froxel_integration_cs;
+    std::shared_ptr<Program> m_froxel_integration_program;
+
+    std::shared_ptr<Shader>  m_froxel_apply_fs;
+    std::shared_ptr<Program> m_froxel_apply_program;
+
+    uint32_t m_flags          = 0;
+    bool     m_enabled        = true;
+    bool     m_dither         = true;
+    bool     m_blur           = true;
+    int32_t  m_num_samples    = 32;
+    float    m_mie_g          = 0.1f;
+    bool     m_use_froxels    = true;
+    bool     m_temporal       = true;
+    bool     m_history_valid  = false;
+    float    m_density        = 0.002f;
+    float    m_max_distance   = 200.0f;
+    float    m_history_weight = 0.9f;
+    uint32_t m_froxel_frame   = 0;
 };
 
 DECLARE_RENDER_NODE_FACTORY(VolumetricLightNode);
@@ -1,12 +1,49 @@
 ﻿#include "ogl.h"
 #include "utility.h"
 #include "logger.h"
+#include "state_cache.h"
+#include "render_stats.h"
 #include <gtc/type_ptr.hpp>
 
+// Uniforms are set through glProgramUniform* where available so that programs don't have to be bound to be updated.
+#if defined(__EMSCRIPTEN__)
+#    define NIMBLE_PROGRAM_UNIFORM(suffix, program, ...) glUniform##suffix(__VA_ARGS__)
+#else
+#    define NIMBLE_PROGRAM_UNIFORM(suffix, program, ...) glProgramUniform##suffix(program, __VA_ARGS__)
+#endif
+
 namespace nimble
 {
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+bool has_direct_state_access()
+{
+#if defined(__EMSCRIPTEN__)
+    return false;
+#else
+    // glad does not expose ARB_direct_state_access on its own, so rely on DSA being core since 4.5.
+    return GLAD_GL_VERSION_4_5 != 0;
+#endif
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void dispatch_compute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
+{
+    GL_CHECK_ERROR(glDispatchCompute(num_groups_x, num_groups_y, num_groups_z));
+    render_stats::add(render_stats::COUNTER_DISPATCHES);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void dispatch_compute_indirect(GLintptr offset)
+{
+    GL_CHECK_ERROR(glDispatchComputeIndirect(offset));
+    render_stats::add(render_stats::COUNTER_DISPATCHES);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 Texture::Texture()
 {
     GL_CHECK_ERROR(glGenTextures(1, &m_gl_tex));
@@ -16,6 +53,7 @@ Texture::Texture()
 
 Texture::~Texture()
 {
+    state_cache::forget_texture(m_gl_tex);
     GL_CHECK_ERROR(glDeleteTextures(1, &m_gl_tex));
 }
 
@@ -23,25 +61,31 @@ Texture::~Texture()
 
 void Texture::bind(uint32_t unit)
 {
-    GL_CHECK_ERROR(glActiveTexture(GL_TEXTURE0 + unit));
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
+    render_stats::add(render_stats::COUNTER_TEXTURE_BINDS);
+    GL_CHECK_ERROR(state_cache::bind_texture(unit, m_target, m_gl_tex));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Texture::unbind(uint32_t unit)
 {
-    GL_CHECK_ERROR(glActiveTexture(GL_TEXTURE0 + unit));
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    GL_CHECK_ERROR(state_cache::bind_texture(unit, m_target, 0));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Texture::generate_mipmaps()
 {
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-    GL_CHECK_ERROR(glGenerateMipmap(m_target));
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    if (has_direct_state_access())
+    {
+        GL_CHECK_ERROR(glGenerateTextureMipmap(m_gl_tex));
+    }
+    else
+    {
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
+        GL_CHECK_ERROR(glGenerateMipmap(m_target));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
+    }
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -76,11 +120,9 @@ uint32_t Texture::version()
 
 void Texture::set_wrapping(GLenum s, GLenum t, GLenum r)
 {
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-    GL_CHECK_ERROR(glTexParameteri(m_target, GL_TEXTURE_WRAP_S, s));
-    GL_CHECK_ERROR(glTexParameteri(m_target, GL_TEXTURE_WRAP_T, t));
-    GL_CHECK_ERROR(glTexParameteri(m_target, GL_TEXTURE_WRAP_R, r));
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    set_parameter(GL_TEXTURE_WRAP_S, s);
+    set_parameter(GL_TEXTURE_WRAP_T, t);
+    set_parameter(GL_TEXTURE_WRAP_R, r);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -88,27 +130,31 @@ void Texture::set_wrapping(GLenum s, GLenum t, GLenum r)
 void Texture::set_border_color(float r, float g, float b, float a)
 {
     float border_color[] = { r, g, b, a };
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-    GL_CHECK_ERROR(glTexParameterfv(m_target, GL_TEXTURE_BORDER_COLOR, border_color));
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+
+    if (has_direct_state_access())
+    {
+        GL_CHECK_ERROR(glTextureParameterfv(m_gl_tex, GL_TEXTURE_BORDER_COLOR, border_color));
+    }
+    else
+    {
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
+        GL_CHECK_ERROR(glTexParameterfv(m_target, GL_TEXTURE_BORDER_COLOR, border_color));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
+    }
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Texture::set_min_filter(GLenum filter)
 {
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-    GL_CHECK_ERROR(glTexParameteri(m_target, GL_TEXTURE_MIN_FILTER, filter));
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    set_parameter(GL_TEXTURE_MIN_FILTER, filter);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Texture::set_mag_filter(GLenum filter)
 {
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-    GL_CHECK_ERROR(glTexParameteri(m_target, GL_TEXTURE_MAG_FILTER, filter));
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    set_parameter(GL_TEXTURE_MAG_FILTER, filter);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -118,7 +164,8 @@ void Texture::bind_image(uint32_t unit, uint32_t mip_level, uint32_t layer, GLen
     bind(unit);
 
     // GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format
-    if (m_array_size > 1)
+    // 3D textures are bound layered so that the whole volume is accessible through an image3D.
+    if (m_array_size > 1 || m_target == GL_TEXTURE_3D)
         glBindImageTexture(unit, m_gl_tex, mip_level, GL_TRUE, layer, access, format);
     else
         glBindImageTexture(unit, m_gl_tex, mip_level, GL_FALSE, 0, access, format);
@@ -128,18 +175,38 @@ void Texture::bind_image(uint32_t unit, uint32_t mip_level, uint32_t layer, GLen
 
 void Texture::set_compare_mode(GLenum mode)
 {
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-    GL_CHECK_ERROR(glTexParameteri(m_target, GL_TEXTURE_COMPARE_MODE, mode));
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    set_parameter(GL_TEXTURE_COMPARE_MODE, mode);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Texture::set_compare_func(GLenum func)
 {
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-    GL_CHECK_ERROR(glTexParameteri(m_target, GL_TEXTURE_COMPARE_FUNC, func));
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    set_parameter(GL_TEXTURE_COMPARE_FUNC, func);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void Texture::set_mip_level_range(int32_t base_level, int32_t max_level)
+{
+    set_parameter(GL_TEXTURE_BASE_LEVEL, base_level);
+    set_parameter(GL_TEXTURE_MAX_LEVEL, max_level);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void Texture::set_parameter(GLenum pname, GLint value)
+{
+    if (has_direct_state_access())
+    {
+        GL_CHECK_ERROR(glTextureParameteri(m_gl_tex, pname, value));
+    }
+    else
+    {
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
+        GL_CHECK_ERROR(glTexParameteri(m_target, pname, value));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
+    }
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -176,34 +243,20 @@ Texture1D::Texture1D(uint32_t w, uint32_t array_size, int32_t mip_levels, GLenum
     else
         m_mip_levels = mip_levels;
 
-    // Allocate memory for mip levels.
+    // Allocate immutable storage for all mip levels.
     if (array_size > 1)
     {
         m_target = GL_TEXTURE_1D_ARRAY;
 
-        int width = m_width;
-
-        GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-
-        for (int i = 0; i < m_mip_levels; i++)
-        {
-            GL_CHECK_ERROR(glTexImage2D(m_target, i, m_internal_format, width, m_array_size, 0, m_format, m_type, NULL));
-            width = std::max(1, (width / 2));
-        }
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
+        GL_CHECK_ERROR(glTexStorage2D(m_target, m_mip_levels, m_internal_format, m_width, m_array_size));
     }
     else
     {
         m_target = GL_TEXTURE_1D;
 
-        int width = m_width;
-
-        GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-
-        for (int i = 0; i < m_mip_levels; i++)
-        {
-            GL_CHECK_ERROR(glTexImage1D(m_target, i, m_internal_format, width, 0, m_format, m_type, NULL));
-            width = std::max(1, (width / 2));
-        }
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
+        GL_CHECK_ERROR(glTexStorage1D(m_target, m_mip_levels, m_internal_format, m_width));
     }
 
     // Default sampling options.
@@ -215,7 +268,7 @@ Texture1D::Texture1D(uint32_t w, uint32_t array_size, int32_t mip_levels, GLenum
     else
         set_min_filter(GL_LINEAR);
 
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -231,18 +284,32 @@ void Texture1D::set_data(int array_index, int mip_level, void* data)
     for (int i = 0; i < mip_level; i++)
         width = std::max(1, width / 2);
 
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-
-    if (m_array_size > 1)
+    if (has_direct_state_access())
     {
-        GL_CHECK_ERROR(glTexImage2D(m_target, mip_level, m_internal_format, width, array_index, 0, m_format, m_type, data));
+        if (m_array_size > 1)
+        {
+            GL_CHECK_ERROR(glTextureSubImage2D(m_gl_tex, mip_level, 0, array_index, width, 1, m_format, m_type, data));
+        }
+        else
+        {
+            GL_CHECK_ERROR(glTextureSubImage1D(m_gl_tex, mip_level, 0, width, m_format, m_type, data));
+        }
     }
     else
     {
-        GL_CHECK_ERROR(glTexImage1D(m_target, mip_level, m_internal_format, width, 0, m_format, m_type, data));
-    }
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
 
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+        if (m_array_size > 1)
+        {
+            GL_CHECK_ERROR(glTexSubImage2D(m_target, mip_level, 0, array_index, width, 1, m_format, m_type, data));
+        }
+        else
+        {
+            GL_CHECK_ERROR(glTexSubImage1D(m_target, mip_level, 0, width, m_format, m_type, data));
+        }
+
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
+    }
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -261,108 +328,13 @@ Texture2D::Texture2D(uint32_t w, uint32_t h, uint32_t array_size, int32_t mip_le
     m_internal_format = internal_format;
     m_format          = format;
     m_type            = type;
-    m_num_samples     = num_samples;
-    m_mip_levels      = mip_levels;
-    m_compressed      = compressed;
-    m_width           = w;
-    m_height          = h;
-
-    // If mip levels is -1, calculate mip levels
-    if (m_mip_levels == -1)
-    {
-        m_mip_levels = 1;
-
-        int width  = m_width;
-        int height = m_height;
-
-        while (width > 1 || height > 1)
-        {
-            width  = std::max(1, (width / 2));
-            height = std::max(1, (height / 2));
-            m_mip_levels++;
-        }
-    }
-
-    // Allocate memory for mip levels.
-    if (m_array_size > 1)
-    {
-        if (m_num_samples > 1)
-            m_target = GL_TEXTURE_2D_MULTISAMPLE_ARRAY;
-        else
-            m_target = GL_TEXTURE_2D_ARRAY;
-
-        if (!m_compressed)
-        {
-            int width  = m_width;
-            int height = m_height;
-
-            GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-
-            if (m_num_samples > 1)
-            {
-                if (m_mip_levels > 1)
-                    NIMBLE_LOG_WARNING("OPENGL: Multisampled textures cannot have mipmaps. Setting mip levels to 1...");
-
-                m_mip_levels = 1;
-                GL_CHECK_ERROR(glTexImage3DMultisample(m_target, m_num_samples, m_internal_format, width, height, m_array_size, true));
-            }
-            else
-            {
-                for (int i = 0; i < m_mip_levels; i++)
-                {
-                    GL_CHECK_ERROR(glTexImage3D(m_target, i, m_internal_format, width, height, m_array_size, 0, m_format, m_type, NULL));
-
-                    width  = std::max(1, (width / 2));
-                    height = std::max(1, (height / 2));
-                }
-            }
-        }
-    }
-    else
-    {
-        if (m_num_samples > 1)
-            m_target = GL_TEXTURE_2D_MULTISAMPLE;
-        else
-            m_target = GL_TEXTURE_2D;
-
-        if (!m_compressed)
-        {
-            int width  = m_width;
-            int height = m_height;
-
-            GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
+    m_num_samples          = num_samples;
+    m_requested_mip_levels = mip_levels;
+    m_compressed           = compressed;
+    m_width                = w;
+    m_height               = h;
 
-            if (m_num_samples > 1)
-            {
-                if (m_mip_levels > 1)
-                    NIMBLE_LOG_WARNING("OPENGL: Multisampled textures cannot have mipmaps. Setting mip levels to 1...");
-
-                m_mip_levels = 1;
-                GL_CHECK_ERROR(glTexImage2DMultisample(m_target, m_num_samples, m_internal_format, width, height, true));
-            }
-            else
-            {
-                for (int i = 0; i < m_mip_levels; i++)
-                {
-                    GL_CHECK_ERROR(glTexImage2D(m_target, i, m_internal_format, width, height, 0, m_format, m_type, NULL));
-
-                    width  = std::max(1, (width / 2));
-                    height = std::max(1, (height / 2));
-                }
-            }
-        }
-    }
-
-    // Default sampling options.
-    set_wrapping(GL_REPEAT, GL_REPEAT, GL_REPEAT);
-    set_mag_filter(GL_LINEAR);
-
-    if (m_mip_levels > 1)
-        set_min_filter(GL_LINEAR_MIPMAP_LINEAR);
-    else
-        set_min_filter(GL_LINEAR);
-
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    allocate();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -388,18 +360,32 @@ void Texture2D::set_data(int array_index, int mip_level, void* data)
             height = std::max(1, (height / 2));
         }
 
-        GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-
-        if (m_array_size > 1)
+        if (has_direct_state_access())
         {
-            GL_CHECK_ERROR(glTexImage3D(m_target, mip_level, m_internal_format, width, height, array_index, 0, m_format, m_type, data));
+            if (m_array_size > 1)
+            {
+                GL_CHECK_ERROR(glTextureSubImage3D(m_gl_tex, mip_level, 0, 0, array_index, width, height, 1, m_format, m_type, data));
+            }
+            else
+            {
+                GL_CHECK_ERROR(glTextureSubImage2D(m_gl_tex, mip_level, 0, 0, width, height, m_format, m_type, data));
+            }
         }
         else
         {
-            GL_CHECK_ERROR(glTexImage2D(m_target, mip_level, m_internal_format, width, height, 0, m_format, m_type, data));
-        }
+            GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
+
+            if (m_array_size > 1)
+            {
+                GL_CHECK_ERROR(glTexSubImage3D(m_target, mip_level, 0, 0, array_index, width, height, 1, m_format, m_type, data));
+            }
+            else
+            {
+                GL_CHECK_ERROR(glTexSubImage2D(m_target, mip_level, 0, 0, width, height, m_format, m_type, data));
+            }
 
-        GL_CHECK_ERROR(glBindTexture(m_target, 0));
+            GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
+        }
     }
 }
 
@@ -422,18 +408,32 @@ void Texture2D::set_compressed_data(int array_index, int mip_level, size_t size,
             height = std::max(1, (height / 2));
         }
 
-        GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-
-        if (m_array_size > 1)
+        if (has_direct_state_access())
         {
-            GL_CHECK_ERROR(glCompressedTexImage3D(m_target, mip_level, m_internal_format, width, height, array_index, 0, size, data));
+            if (m_array_size > 1)
+            {
+                GL_CHECK_ERROR(glCompressedTextureSubImage3D(m_gl_tex, mip_level, 0, 0, array_index, width, height, 1, m_internal_format, size, data));
+            }
+            else
+            {
+                GL_CHECK_ERROR(glCompressedTextureSubImage2D(m_gl_tex, mip_level, 0, 0, width, height, m_internal_format, size, data));
+            }
         }
         else
         {
-            GL_CHECK_ERROR(glCompressedTexImage2D(m_target, mip_level, m_internal_format, width, height, 0, size, data));
-        }
+            GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
 
-        GL_CHECK_ERROR(glBindTexture(m_target, 0));
+            if (m_array_size > 1)
+            {
+                GL_CHECK_ERROR(glCompressedTexSubImage3D(m_target, mip_level, 0, 0, array_index, width, height, 1, m_internal_format, size, data));
+            }
+            else
+            {
+                GL_CHECK_ERROR(glCompressedTexSubImage2D(m_target, mip_level, 0, 0, width, height, m_internal_format, size, data));
+            }
+
+            GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
+        }
     }
 }
 
@@ -441,31 +441,41 @@ void Texture2D::set_compressed_data(int array_index, int mip_level, size_t size,
 
 void Texture2D::data(int mip_level, int array_index, void* data)
 {
-    GL_CHECK_ERROR(glActiveTexture(GL_TEXTURE0));
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
+    GL_CHECK_ERROR(state_cache::active_texture(0));
+    GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
     GL_CHECK_ERROR(glGetTexImage(m_target, mip_level, m_format, m_type, data));
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Texture2D::extents(int mip_level, int& width, int& height)
 {
-    GL_CHECK_ERROR(glActiveTexture(GL_TEXTURE0));
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
+    if (has_direct_state_access())
+    {
+        GL_CHECK_ERROR(glGetTextureLevelParameteriv(m_gl_tex, mip_level, GL_TEXTURE_WIDTH, &width));
+        GL_CHECK_ERROR(glGetTextureLevelParameteriv(m_gl_tex, mip_level, GL_TEXTURE_HEIGHT, &height));
+    }
+    else
+    {
+        GL_CHECK_ERROR(state_cache::active_texture(0));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
 
-    GL_CHECK_ERROR(glGetTexLevelParameteriv(m_target, mip_level, GL_TEXTURE_WIDTH, &width));
-    GL_CHECK_ERROR(glGetTexLevelParameteriv(m_target, mip_level, GL_TEXTURE_HEIGHT, &height));
+        GL_CHECK_ERROR(glGetTexLevelParameteriv(m_target, mip_level, GL_TEXTURE_WIDTH, &width));
+        GL_CHECK_ERROR(glGetTexLevelParameteriv(m_target, mip_level, GL_TEXTURE_HEIGHT, &height));
 
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
+    }
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Texture2D::resize(uint32_t w, uint32_t h)
 {
+    // Immutable storage cannot be respecified, so the texture object is recreated.
     if (m_gl_tex != UINT32_MAX)
     {
+        state_cache::forget_texture(m_gl_tex);
         GL_CHECK_ERROR(glDeleteTextures(1, &m_gl_tex));
     }
 
@@ -475,23 +485,40 @@ void Texture2D::resize(uint32_t w, uint32_t h)
     m_width  = w;
     m_height = h;
 
-    // If mip levels is -1, calculate mip levels
-    if (m_mip_levels == -1)
+    allocate();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void Texture2D::allocate()
+{
+    // The level count is derived from the current size on every allocation, so that a texture with a full mip chain (-1) or more
+    // levels than a smaller size allows can still be resized.
+    uint32_t max_mip_levels = 1;
+
+    int width  = m_width;
+    int height = m_height;
+
+    while (width > 1 || height > 1)
     {
-        m_mip_levels = 1;
+        width  = std::max(1, (width / 2));
+        height = std::max(1, (height / 2));
+        max_mip_levels++;
+    }
 
-        int width  = m_width;
-        int height = m_height;
+    if (m_requested_mip_levels == -1)
+        m_mip_levels = max_mip_levels;
+    else
+        m_mip_levels = std::min(uint32_t(m_requested_mip_levels), max_mip_levels);
 
-        while (width > 1 || height > 1)
-        {
-            width  = std::max(1, (width / 2));
-            height = std::max(1, (height / 2));
-            m_mip_levels++;
-        }
+    if (m_num_samples > 1 && m_mip_levels > 1)
+    {
+        NIMBLE_LOG_WARNING("OPENGL: Multisampled textures cannot have mipmaps. Setting mip levels to 1...");
+        m_mip_levels = 1;
     }
 
-    // Allocate memory for mip levels.
+    // Allocate immutable storage for all mip levels. Compressed formats are sized as well, so they take the same path and are filled
+    // later through set_compressed_data.
     if (m_array_size > 1)
     {
         if (m_num_samples > 1)
@@ -499,31 +526,15 @@ void Texture2D::resize(uint32_t w, uint32_t h)
         else
             m_target = GL_TEXTURE_2D_ARRAY;
 
-        if (!m_compressed)
-        {
-            int width  = m_width;
-            int height = m_height;
-
-            GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-
-            if (m_num_samples > 1)
-            {
-                if (m_mip_levels > 1)
-                    NIMBLE_LOG_WARNING("OPENGL: Multisampled textures cannot have mipmaps. Setting mip levels to 1...");
-
-                m_mip_levels = 1;
-                GL_CHECK_ERROR(glTexImage3DMultisample(m_target, m_num_samples, m_internal_format, width, height, m_array_size, true));
-            }
-            else
-            {
-                for (int i = 0; i < m_mip_levels; i++)
-                {
-                    GL_CHECK_ERROR(glTexImage3D(m_target, i, m_internal_format, width, height, m_array_size, 0, m_format, m_type, NULL));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
 
-                    width  = std::max(1, (width / 2));
-                    height = std::max(1, (height / 2));
-                }
-            }
+        if (m_num_samples > 1)
+        {
+            GL_CHECK_ERROR(glTexStorage3DMultisample(m_target, m_num_samples, m_internal_format, m_width, m_height, m_array_size, true));
+        }
+        else
+        {
+            GL_CHECK_ERROR(glTexStorage3D(m_target, m_mip_levels, m_internal_format, m_width, m_height, m_array_size));
         }
     }
     else
@@ -533,31 +544,15 @@ void Texture2D::resize(uint32_t w, uint32_t h)
         else
             m_target = GL_TEXTURE_2D;
 
-        if (!m_compressed)
-        {
-            int width  = m_width;
-            int height = m_height;
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
 
-            GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-
-            if (m_num_samples > 1)
-            {
-                if (m_mip_levels > 1)
-                    NIMBLE_LOG_WARNING("OPENGL: Multisampled textures cannot have mipmaps. Setting mip levels to 1...");
-
-                m_mip_levels = 1;
-                GL_CHECK_ERROR(glTexImage2DMultisample(m_target, m_num_samples, m_internal_format, width, height, true));
-            }
-            else
-            {
-                for (int i = 0; i < m_mip_levels; i++)
-                {
-                    GL_CHECK_ERROR(glTexImage2D(m_target, i, m_internal_format, width, height, 0, m_format, m_type, NULL));
-
-                    width  = std::max(1, (width / 2));
-                    height = std::max(1, (height / 2));
-                }
-            }
+        if (m_num_samples > 1)
+        {
+            GL_CHECK_ERROR(glTexStorage2DMultisample(m_target, m_num_samples, m_internal_format, m_width, m_height, true));
+        }
+        else
+        {
+            GL_CHECK_ERROR(glTexStorage2D(m_target, m_mip_levels, m_internal_format, m_width, m_height));
         }
     }
 
@@ -570,7 +565,7 @@ void Texture2D::resize(uint32_t w, uint32_t h)
     else
         set_min_filter(GL_LINEAR);
 
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -627,22 +622,11 @@ Texture3D::Texture3D(uint32_t w, uint32_t h, uint32_t d, int mip_levels, GLenum
     else
         m_mip_levels = mip_levels;
 
-    // Allocate memory for mip levels.
+    // Allocate immutable storage for all mip levels.
     m_target = GL_TEXTURE_3D;
 
-    int width  = m_width;
-    int height = m_height;
-    int depth  = m_depth;
-
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-
-    for (int i = 0; i < m_mip_levels; i++)
-    {
-        GL_CHECK_ERROR(glTexImage3D(m_target, i, m_internal_format, width, height, depth, 0, m_format, m_type, NULL));
-        width  = std::max(1, (width / 2));
-        height = std::max(1, (height / 2));
-        depth  = std::max(1, (depth / 2));
-    }
+    GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
+    GL_CHECK_ERROR(glTexStorage3D(m_target, m_mip_levels, m_internal_format, m_width, m_height, m_depth));
 
     // Default sampling options.
     set_wrapping(GL_REPEAT, GL_REPEAT, GL_REPEAT);
@@ -653,7 +637,7 @@ Texture3D::Texture3D(uint32_t w, uint32_t h, uint32_t d, int mip_levels, GLenum
     else
         set_min_filter(GL_LINEAR);
 
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -675,33 +659,49 @@ void Texture3D::set_data(int mip_level, void* data)
         depth  = std::max(1, (depth / 2));
     }
 
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-    GL_CHECK_ERROR(glTexImage3D(m_target, mip_level, m_internal_format, width, height, depth, 0, m_format, m_type, data));
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    if (has_direct_state_access())
+    {
+        GL_CHECK_ERROR(glTextureSubImage3D(m_gl_tex, mip_level, 0, 0, 0, width, height, depth, m_format, m_type, data));
+    }
+    else
+    {
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
+        GL_CHECK_ERROR(glTexSubImage3D(m_target, mip_level, 0, 0, 0, width, height, depth, m_format, m_type, data));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
+    }
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Texture3D::data(int mip_level, void* data)
 {
-    GL_CHECK_ERROR(glActiveTexture(GL_TEXTURE0));
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
+    GL_CHECK_ERROR(state_cache::active_texture(0));
+    GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
     GL_CHECK_ERROR(glGetTexImage(m_target, mip_level, m_format, m_type, data));
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Texture3D::extents(int mip_level, int& width, int& height, int& depth)
 {
-    GL_CHECK_ERROR(glActiveTexture(GL_TEXTURE0));
-    GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
+    if (has_direct_state_access())
+    {
+        GL_CHECK_ERROR(glGetTextureLevelParameteriv(m_gl_tex, mip_level, GL_TEXTURE_WIDTH, &width));
+        GL_CHECK_ERROR(glGetTextureLevelParameteriv(m_gl_tex, mip_level, GL_TEXTURE_HEIGHT, &height));
+        GL_CHECK_ERROR(glGetTextureLevelParameteriv(m_gl_tex, mip_level, GL_TEXTURE_DEPTH, &depth));
+    }
+    else
+    {
+        GL_CHECK_ERROR(state_cache::active_texture(0));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
 
-    GL_CHECK_ERROR(glGetTexLevelParameteriv(m_target, mip_level, GL_TEXTURE_WIDTH, &width));
-    GL_CHECK_ERROR(glGetTexLevelParameteriv(m_target, mip_level, GL_TEXTURE_HEIGHT, &height));
-    GL_CHECK_ERROR(glGetTexLevelParameteriv(m_target, mip_level, GL_TEXTURE_DEPTH, &depth));
+        GL_CHECK_ERROR(glGetTexLevelParameteriv(m_target, mip_level, GL_TEXTURE_WIDTH, &width));
+        GL_CHECK_ERROR(glGetTexLevelParameteriv(m_target, mip_level, GL_TEXTURE_HEIGHT, &height));
+        GL_CHECK_ERROR(glGetTexLevelParameteriv(m_target, mip_level, GL_TEXTURE_DEPTH, &depth));
 
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
+    }
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -754,41 +754,20 @@ TextureCube::TextureCube(uint32_t w, uint32_t h, uint32_t array_size, int32_t mi
     else
         m_mip_levels = mip_levels;
 
-    // Allocate memory for mip levels.
+    // Allocate immutable storage for all mip levels of all faces.
     if (array_size > 1)
     {
         m_target = GL_TEXTURE_CUBE_MAP_ARRAY;
 
-        int width  = m_width;
-        int height = m_height;
-
-        GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-
-        for (int i = 0; i < m_mip_levels; i++)
-        {
-            GL_CHECK_ERROR(glTexImage3D(m_target, i, m_internal_format, width, height, m_array_size * 6, 0, m_format, m_type, NULL));
-            width  = std::max(1, (width / 2));
-            height = std::max(1, (height / 2));
-        }
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
+        GL_CHECK_ERROR(glTexStorage3D(m_target, m_mip_levels, m_internal_format, m_width, m_height, m_array_size * 6));
     }
     else
     {
         m_target = GL_TEXTURE_CUBE_MAP;
 
-        int width  = m_width;
-        int height = m_height;
-
-        GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-
-        for (int face = 0; face < 6; face++)
-        {
-            GL_CHECK_ERROR(glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, m_internal_format, width, height, 0, m_format, m_type, NULL));
-        }
-
-        if (m_mip_levels > 1)
-        {
-            GL_CHECK_ERROR(glGenerateMipmap(GL_TEXTURE_CUBE_MAP));
-        }
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
+        GL_CHECK_ERROR(glTexStorage2D(m_target, m_mip_levels, m_internal_format, m_width, m_height));
     }
 
     // Default sampling options.
@@ -800,7 +779,7 @@ TextureCube::TextureCube(uint32_t w, uint32_t h, uint32_t array_size, int32_t mi
     else
         set_min_filter(GL_LINEAR);
 
-    GL_CHECK_ERROR(glBindTexture(m_target, 0));
+    GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -820,17 +799,22 @@ void TextureCube::set_data(int face_index, int layer_index, int mip_level, void*
         height = std::max(1, (height / 2));
     }
 
-    if (m_array_size > 1)
+    if (has_direct_state_access())
+    {
+        // Direct state access treats cube maps as 2D arrays of faces.
+        GL_CHECK_ERROR(glTextureSubImage3D(m_gl_tex, mip_level, 0, 0, layer_index * 6 + face_index, width, height, 1, m_format, m_type, data));
+    }
+    else if (m_array_size > 1)
     {
-        GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
         GL_CHECK_ERROR(glTexSubImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, mip_level, 0, 0, layer_index * 6 + face_index, width, height, 1, m_format, m_type, data));
-        GL_CHECK_ERROR(glBindTexture(m_target, 0));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
     }
     else
     {
-        GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-        GL_CHECK_ERROR(glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face_index, mip_level, m_internal_format, width, height, 0, m_format, m_type, data));
-        GL_CHECK_ERROR(glBindTexture(m_target, 0));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
+        GL_CHECK_ERROR(glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face_index, mip_level, 0, 0, width, height, m_format, m_type, data));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
     }
 }
 
@@ -847,17 +831,21 @@ void TextureCube::set_compressed_data(int face_index, int layer_index, int mip_l
         height = std::max(1, (height / 2));
     }
 
-    if (m_array_size > 1)
+    if (has_direct_state_access())
     {
-        GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-        GL_CHECK_ERROR(glCompressedTexSubImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, mip_level, 0, 0, layer_index * 6 + face_index, width, height, m_format, size, m_type, data));
-        GL_CHECK_ERROR(glBindTexture(m_target, 0));
+        GL_CHECK_ERROR(glCompressedTextureSubImage3D(m_gl_tex, mip_level, 0, 0, layer_index * 6 + face_index, width, height, 1, m_internal_format, size, data));
+    }
+    else if (m_array_size > 1)
+    {
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
+        GL_CHECK_ERROR(glCompressedTexSubImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, mip_level, 0, 0, layer_index * 6 + face_index, width, height, 1, m_internal_format, size, data));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
     }
     else
     {
-        GL_CHECK_ERROR(glBindTexture(m_target, m_gl_tex));
-        GL_CHECK_ERROR(glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face_index, mip_level, m_internal_format, width, height, size, m_type, data));
-        GL_CHECK_ERROR(glBindTexture(m_target, 0));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, m_gl_tex));
+        GL_CHECK_ERROR(glCompressedTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face_index, mip_level, 0, 0, width, height, m_internal_format, size, data));
+        GL_CHECK_ERROR(state_cache::bind_texture(m_target, 0));
     }
 }
 
@@ -886,6 +874,7 @@ Framebuffer::Framebuffer()
 
 Framebuffer::~Framebuffer()
 {
+    state_cache::forget_framebuffer(m_gl_fbo);
     GL_CHECK_ERROR(glDeleteFramebuffers(1, &m_gl_fbo));
 }
 
@@ -893,21 +882,21 @@ Framebuffer::~Framebuffer()
 
 void Framebuffer::bind()
 {
-    GL_CHECK_ERROR(glBindFramebuffer(GL_FRAMEBUFFER, m_gl_fbo));
+    render_stats::add(render_stats::COUNTER_FRAMEBUFFER_BINDS);
+    GL_CHECK_ERROR(state_cache::bind_framebuffer(GL_FRAMEBUFFER, m_gl_fbo));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Framebuffer::unbind()
 {
-    GL_CHECK_ERROR(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GL_CHECK_ERROR(state_cache::bind_framebuffer(GL_FRAMEBUFFER, 0));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Framebuffer::attach_render_target(uint32_t attachment, Texture* texture, uint32_t layer, uint32_t mip_level, bool draw, bool read)
 {
-    glBindTexture(texture->target(), texture->id());
     bind();
 
     if (texture->array_size() > 1)
@@ -940,7 +929,6 @@ void Framebuffer::attach_render_target(uint32_t attachment, Texture* texture, ui
     check_status();
 
     unbind();
-    glBindTexture(texture->target(), 0);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -953,7 +941,6 @@ void Framebuffer::attach_multiple_render_targets(uint32_t attachment_count, Text
 
     for (int i = 0; i < attachment_count; i++)
     {
-        glBindTexture(texture[i]->target(), texture[i]->id());
         GL_CHECK_ERROR(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, texture[i]->target(), texture[i]->id(), 0));
         attachments[i] = GL_COLOR_ATTACHMENT0 + i;
     }
@@ -969,7 +956,6 @@ void Framebuffer::attach_multiple_render_targets(uint32_t attachment_count, Text
 
 void Framebuffer::attach_render_target(uint32_t attachment, TextureCube* texture, uint32_t face, uint32_t layer, uint32_t mip_level, bool draw, bool read)
 {
-    glBindTexture(texture->target(), texture->id());
     bind();
 
     if (texture->array_size() > 1)
@@ -1003,14 +989,12 @@ void Framebuffer::attach_render_target(uint32_t attachment, TextureCube* texture
     check_status();
 
     unbind();
-    glBindTexture(texture->target(), 0);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Framebuffer::attach_depth_stencil_target(Texture* texture, uint32_t layer, uint32_t mip_level)
 {
-    glBindTexture(texture->target(), texture->id());
     bind();
 
     if (texture->array_size() > 1)
@@ -1025,14 +1009,12 @@ void Framebuffer::attach_depth_stencil_target(Texture* texture, uint32_t layer,
     check_status();
 
     unbind();
-    glBindTexture(texture->target(), 0);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Framebuffer::attach_depth_stencil_target(TextureCube* texture, uint32_t face, uint32_t layer, uint32_t mip_level)
 {
-    glBindTexture(texture->target(), texture->id());
     bind();
 
     if (texture->array_size() > 1)
@@ -1051,7 +1033,6 @@ void Framebuffer::attach_depth_stencil_target(TextureCube* texture, uint32_t fac
     check_status();
 
     unbind();
-    glBindTexture(texture->target(), 0);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -1188,6 +1169,46 @@ GLuint Shader::id()
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+struct UniformNameRegistry
+{
+    std::unordered_map<uint32_t, uint32_t> indices;
+    uint32_t                               count = 0;
+};
+
+// Function-local static so that handles declared at namespace scope in other translation units can register safely.
+static UniformNameRegistry& uniform_name_registry()
+{
+    static UniformNameRegistry registry;
+    return registry;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+UniformHandle::UniformHandle(const char* name) :
+    UniformHandle(name, uniform_name_hash(name))
+{
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+UniformHandle::UniformHandle(const char* name, uint32_t hash) :
+    m_name(name), m_hash(hash)
+{
+    UniformNameRegistry& registry = uniform_name_registry();
+
+    auto itr = registry.indices.find(hash);
+
+    if (itr != registry.indices.end())
+        m_index = itr->second;
+    else
+    {
+        m_index                 = registry.count++;
+        registry.indices[hash] = m_index;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 Program::Program(uint32_t count, Shader** shaders)
 {
 #if !defined(__EMSCRIPTEN__)
@@ -1263,6 +1284,7 @@ Program::Program(uint32_t count, Shader** shaders)
 
 Program::~Program()
 {
+    state_cache::forget_program(m_gl_program);
     glDeleteProgram(m_gl_program);
 }
 
@@ -1270,7 +1292,8 @@ Program::~Program()
 
 void Program::use()
 {
-    glUseProgram(m_gl_program);
+    render_stats::add(render_stats::COUNTER_PROGRAM_BINDS);
+    state_cache::use_program(m_gl_program);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -1294,12 +1317,252 @@ void Program::uniform_block_binding(std::string name, int binding)
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+GLint Program::resolve_location(const UniformHandle& handle)
+{
+    if (handle.index() >= m_handle_locations.size())
+        m_handle_locations.resize(uniform_name_registry().count, kUnresolvedLocation);
+
+    auto itr = m_location_map.find(handle.name());
+
+    GLint location = itr != m_location_map.end() ? itr->second : -1;
+
+    m_handle_locations[handle.index()] = location;
+
+    return location;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, int value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(1i, m_gl_program, location, value);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, float value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(1f, m_gl_program, location, value);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, const glm::vec2& value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(2f, m_gl_program, location, value.x, value.y);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, const glm::vec3& value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(3f, m_gl_program, location, value.x, value.y, value.z);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, const glm::vec4& value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(4f, m_gl_program, location, value.x, value.y, value.z, value.w);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, const glm::mat2& value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(Matrix2fv, m_gl_program, location, 1, GL_FALSE, glm::value_ptr(value));
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, const glm::mat3& value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(Matrix3fv, m_gl_program, location, 1, GL_FALSE, glm::value_ptr(value));
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, const glm::mat4& value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(Matrix4fv, m_gl_program, location, 1, GL_FALSE, glm::value_ptr(value));
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, int count, int* value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(1iv, m_gl_program, location, count, value);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, int count, float* value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(1fv, m_gl_program, location, count, value);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, int count, glm::vec2* value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(2fv, m_gl_program, location, count, glm::value_ptr(value[0]));
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, int count, glm::vec3* value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(3fv, m_gl_program, location, count, glm::value_ptr(value[0]));
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, int count, glm::vec4* value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(4fv, m_gl_program, location, count, glm::value_ptr(value[0]));
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, int count, glm::mat2* value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(Matrix2fv, m_gl_program, location, count, GL_FALSE, glm::value_ptr(value[0]));
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, int count, glm::mat3* value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(Matrix3fv, m_gl_program, location, count, GL_FALSE, glm::value_ptr(value[0]));
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool Program::set_uniform(const UniformHandle& handle, int count, glm::mat4* value)
+{
+    GLint location = this->location(handle);
+
+    if (location == -1)
+        return false;
+
+    NIMBLE_PROGRAM_UNIFORM(Matrix4fv, m_gl_program, location, count, GL_FALSE, glm::value_ptr(value[0]));
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 bool Program::set_uniform(std::string name, int value)
 {
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniform1i(m_location_map[name], value);
+    NIMBLE_PROGRAM_UNIFORM(1i, m_gl_program, m_location_map[name], value);
 
     return true;
 }
@@ -1311,7 +1574,7 @@ bool Program::set_uniform(std::string name, float value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniform1f(m_location_map[name], value);
+    NIMBLE_PROGRAM_UNIFORM(1f, m_gl_program, m_location_map[name], value);
 
     return true;
 }
@@ -1323,7 +1586,7 @@ bool Program::set_uniform(std::string name, glm::vec2 value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniform2f(m_location_map[name], value.x, value.y);
+    NIMBLE_PROGRAM_UNIFORM(2f, m_gl_program, m_location_map[name], value.x, value.y);
 
     return true;
 }
@@ -1335,7 +1598,7 @@ bool Program::set_uniform(std::string name, glm::vec3 value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniform3f(m_location_map[name], value.x, value.y, value.z);
+    NIMBLE_PROGRAM_UNIFORM(3f, m_gl_program, m_location_map[name], value.x, value.y, value.z);
 
     return true;
 }
@@ -1347,7 +1610,7 @@ bool Program::set_uniform(std::string name, glm::vec4 value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniform4f(m_location_map[name], value.x, value.y, value.z, value.w);
+    NIMBLE_PROGRAM_UNIFORM(4f, m_gl_program, m_location_map[name], value.x, value.y, value.z, value.w);
 
     return true;
 }
@@ -1359,7 +1622,7 @@ bool Program::set_uniform(std::string name, glm::mat2 value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniformMatrix2fv(m_location_map[name], 1, GL_FALSE, glm::value_ptr(value));
+    NIMBLE_PROGRAM_UNIFORM(Matrix2fv, m_gl_program, m_location_map[name], 1, GL_FALSE, glm::value_ptr(value));
 
     return true;
 }
@@ -1371,7 +1634,7 @@ bool Program::set_uniform(std::string name, glm::mat3 value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniformMatrix3fv(m_location_map[name], 1, GL_FALSE, glm::value_ptr(value));
+    NIMBLE_PROGRAM_UNIFORM(Matrix3fv, m_gl_program, m_location_map[name], 1, GL_FALSE, glm::value_ptr(value));
 
     return true;
 }
@@ -1383,7 +1646,7 @@ bool Program::set_uniform(std::string name, glm::mat4 value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniformMatrix4fv(m_location_map[name], 1, GL_FALSE, glm::value_ptr(value));
+    NIMBLE_PROGRAM_UNIFORM(Matrix4fv, m_gl_program, m_location_map[name], 1, GL_FALSE, glm::value_ptr(value));
 
     return true;
 }
@@ -1395,7 +1658,7 @@ bool Program::set_uniform(std::string name, int count, int* value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniform1iv(m_location_map[name], count, value);
+    NIMBLE_PROGRAM_UNIFORM(1iv, m_gl_program, m_location_map[name], count, value);
 
     return true;
 }
@@ -1407,7 +1670,7 @@ bool Program::set_uniform(std::string name, int count, float* value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniform1fv(m_location_map[name], count, value);
+    NIMBLE_PROGRAM_UNIFORM(1fv, m_gl_program, m_location_map[name], count, value);
 
     return true;
 }
@@ -1419,7 +1682,7 @@ bool Program::set_uniform(std::string name, int count, glm::vec2* value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniform2fv(m_location_map[name], count, glm::value_ptr(value[0]));
+    NIMBLE_PROGRAM_UNIFORM(2fv, m_gl_program, m_location_map[name], count, glm::value_ptr(value[0]));
 
     return true;
 }
@@ -1431,7 +1694,7 @@ bool Program::set_uniform(std::string name, int count, glm::vec3* value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniform3fv(m_location_map[name], count, glm::value_ptr(value[0]));
+    NIMBLE_PROGRAM_UNIFORM(3fv, m_gl_program, m_location_map[name], count, glm::value_ptr(value[0]));
 
     return true;
 }
@@ -1443,7 +1706,7 @@ bool Program::set_uniform(std::string name, int count, glm::vec4* value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniform4fv(m_location_map[name], count, glm::value_ptr(value[0]));
+    NIMBLE_PROGRAM_UNIFORM(4fv, m_gl_program, m_location_map[name], count, glm::value_ptr(value[0]));
 
     return true;
 }
@@ -1455,7 +1718,7 @@ bool Program::set_uniform(std::string name, int count, glm::mat2* value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniformMatrix2fv(m_location_map[name], count, GL_FALSE, glm::value_ptr(value[0]));
+    NIMBLE_PROGRAM_UNIFORM(Matrix2fv, m_gl_program, m_location_map[name], count, GL_FALSE, glm::value_ptr(value[0]));
 
     return true;
 }
@@ -1467,7 +1730,7 @@ bool Program::set_uniform(std::string name, int count, glm::mat3* value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniformMatrix3fv(m_location_map[name], count, GL_FALSE, glm::value_ptr(value[0]));
+    NIMBLE_PROGRAM_UNIFORM(Matrix3fv, m_gl_program, m_location_map[name], count, GL_FALSE, glm::value_ptr(value[0]));
 
     return true;
 }
@@ -1479,7 +1742,7 @@ bool Program::set_uniform(std::string name, int count, glm::mat4* value)
     if (m_location_map.find(name) == m_location_map.end())
         return false;
 
-    glUniformMatrix4fv(m_location_map[name], count, GL_FALSE, glm::value_ptr(value[0]));
+    NIMBLE_PROGRAM_UNIFORM(Matrix4fv, m_gl_program, m_location_map[name], count, GL_FALSE, glm::value_ptr(value[0]));
 
     return true;
 }
@@ -1496,11 +1759,19 @@ GLint Program::id()
 Buffer::Buffer(GLenum type, GLenum usage, size_t size, void* data) :
     m_type(type), m_size(size)
 {
-    GL_CHECK_ERROR(glGenBuffers(1, &m_gl_buffer));
+    if (has_direct_state_access())
+    {
+        GL_CHECK_ERROR(glCreateBuffers(1, &m_gl_buffer));
+        GL_CHECK_ERROR(glNamedBufferData(m_gl_buffer, size, data, usage));
+    }
+    else
+    {
+        GL_CHECK_ERROR(glGenBuffers(1, &m_gl_buffer));
 
-    GL_CHECK_ERROR(glBindBuffer(m_type, m_gl_buffer));
-    GL_CHECK_ERROR(glBufferData(m_type, size, data, usage));
-    GL_CHECK_ERROR(glBindBuffer(m_type, 0));
+        GL_CHECK_ERROR(state_cache::bind_buffer(m_type, m_gl_buffer));
+        GL_CHECK_ERROR(glBufferData(m_type, size, data, usage));
+        GL_CHECK_ERROR(state_cache::bind_buffer(m_type, 0));
+    }
 
 #if defined(__EMSCRIPTEN__)
     m_staging = malloc(m_size);
@@ -1514,6 +1785,7 @@ Buffer::~Buffer()
 #if defined(__EMSCRIPTEN__)
     free(m_staging);
 #endif
+    state_cache::forget_buffer(m_gl_buffer);
     glDeleteBuffers(1, &m_gl_buffer);
 }
 
@@ -1521,40 +1793,52 @@ Buffer::~Buffer()
 
 void Buffer::bind()
 {
-    GL_CHECK_ERROR(glBindBuffer(m_type, m_gl_buffer));
+    GL_CHECK_ERROR(state_cache::bind_buffer(m_type, m_gl_buffer));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Buffer::bind_base(int index)
 {
-    GL_CHECK_ERROR(glBindBufferBase(m_type, index, m_gl_buffer));
+    GL_CHECK_ERROR(state_cache::bind_buffer_base(m_type, index, m_gl_buffer));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Buffer::bind_range(int index, size_t offset, size_t size)
 {
-    GL_CHECK_ERROR(glBindBufferRange(m_type, index, m_gl_buffer, offset, size));
+    GL_CHECK_ERROR(state_cache::bind_buffer_range(m_type, index, m_gl_buffer, offset, size));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Buffer::unbind()
 {
-    GL_CHECK_ERROR(glBindBuffer(m_type, 0));
+    GL_CHECK_ERROR(state_cache::bind_buffer(m_type, 0));
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void* Buffer::map(GLenum access)
 {
+    if (access != GL_READ_ONLY)
+    {
+        render_stats::add(render_stats::COUNTER_BUFFER_UPLOADS);
+        render_stats::add(render_stats::COUNTER_BUFFER_UPLOAD_BYTES, m_size);
+    }
+
 #if defined(__EMSCRIPTEN__)
     return m_staging;
 #else
-    GL_CHECK_ERROR(glBindBuffer(m_type, m_gl_buffer));
+    if (has_direct_state_access())
+    {
+        GL_CHECK_ERROR(void* ptr = glMapNamedBuffer(m_gl_buffer, access));
+        return ptr;
+    }
+
+    GL_CHECK_ERROR(state_cache::bind_buffer(m_type, m_gl_buffer));
     GL_CHECK_ERROR(void* ptr = glMapBuffer(m_type, access));
-    GL_CHECK_ERROR(glBindBuffer(m_type, 0));
+    GL_CHECK_ERROR(state_cache::bind_buffer(m_type, 0));
     return ptr;
 #endif
 }
@@ -1563,14 +1847,26 @@ void* Buffer::map(GLenum access)
 
 void* Buffer::map_range(GLenum access, size_t offset, size_t size)
 {
+    if (access & GL_MAP_WRITE_BIT)
+    {
+        render_stats::add(render_stats::COUNTER_BUFFER_UPLOADS);
+        render_stats::add(render_stats::COUNTER_BUFFER_UPLOAD_BYTES, size);
+    }
+
 #if defined(__EMSCRIPTEN__)
     m_mapped_size   = size;
     m_mapped_offset = offset;
     return static_cast<char*>(m_staging) + offset;
 #else
-    GL_CHECK_ERROR(glBindBuffer(m_type, m_gl_buffer));
+    if (has_direct_state_access())
+    {
+        GL_CHECK_ERROR(void* ptr = glMapNamedBufferRange(m_gl_buffer, offset, size, access));
+        return ptr;
+    }
+
+    GL_CHECK_ERROR(state_cache::bind_buffer(m_type, m_gl_buffer));
     GL_CHECK_ERROR(void* ptr = glMapBufferRange(m_type, offset, size, access));
-    GL_CHECK_ERROR(glBindBuffer(m_type, 0));
+    GL_CHECK_ERROR(state_cache::bind_buffer(m_type, 0));
     return ptr;
 #endif
 }
@@ -1580,13 +1876,20 @@ void* Buffer::map_range(GLenum access, size_t offset, size_t size)
 void Buffer::unmap()
 {
 #if defined(__EMSCRIPTEN__)
-    GL_CHECK_ERROR(glBindBuffer(m_type, m_gl_buffer));
+    GL_CHECK_ERROR(state_cache::bind_buffer(m_type, m_gl_buffer));
     glBufferSubData(m_type, m_mapped_offset, m_mapped_size, static_cast<char*>(m_staging) + m_mapped_offset);
-    GL_CHECK_ERROR(glBindBuffer(m_type, 0));
+    GL_CHECK_ERROR(state_cache::bind_buffer(m_type, 0));
 #else
-    GL_CHECK_ERROR(glBindBuffer(m_type, m_gl_buffer));
-    GL_CHECK_ERROR(glUnmapBuffer(m_type));
-    GL_CHECK_ERROR(glBindBuffer(m_type, 0));
+    if (has_direct_state_access())
+    {
+        GL_CHECK_ERROR(glUnmapNamedBuffer(m_gl_buffer));
+    }
+    else
+    {
+        GL_CHECK_ERROR(state_cache::bind_buffer(m_type, m_gl_buffer));
+        GL_CHECK_ERROR(glUnmapBuffer(m_type));
+        GL_CHECK_ERROR(state_cache::bind_buffer(m_type, 0));
+    }
 #endif
 }
 
@@ -1594,9 +1897,19 @@ void Buffer::unmap()
 
 void Buffer::set_data(size_t offset, size_t size, void* data)
 {
-    GL_CHECK_ERROR(glBindBuffer(m_type, m_gl_buffer));
-    glBufferSubData(m_type, offset, size, data);
-    GL_CHECK_ERROR(glBindBuffer(m_type, 0));
+    render_stats::add(render_stats::COUNTER_BUFFER_UPLOADS);
+    render_stats::add(render_stats::COUNTER_BUFFER_UPLOAD_BYTES, size);
+
+    if (has_direct_state_access())
+    {
+        GL_CHECK_ERROR(glNamedBufferSubData(m_gl_buffer, offset, size, data));
+    }
+    else
+    {
+        GL_CHECK_ERROR(state_cache::bind_buffer(m_type, m_gl_buffer));
+        GL_CHECK_ERROR(glBufferSubData(m_type, offset, size, data));
+        GL_CHECK_ERROR(state_cache::bind_buffer(m_type, 0));
+    }
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -1648,7 +1961,7 @@ VertexArray::VertexArray(VertexBuffer* vbo, IndexBuffer* ibo, size_t vertex_size
     GL_CHECK_ERROR(glBindVertexArrayOES(m_gl_vao));
 #else
     GL_CHECK_ERROR(glGenVertexArrays(1, &m_gl_vao));
-    GL_CHECK_ERROR(glBindVertexArray(m_gl_vao));
+    GL_CHECK_ERROR(state_cache::bind_vertex_array(m_gl_vao));
 #endif
     vbo->bind();
 
@@ -1669,7 +1982,7 @@ VertexArray::VertexArray(VertexBuffer* vbo, IndexBuffer* ibo, size_t vertex_size
 #if defined(__EMSCRIPTEN__)
     GL_CHECK_ERROR(glBindVertexArrayOES(0));
 #else
-    GL_CHECK_ERROR(glBindVertexArray(0));
+    GL_CHECK_ERROR(state_cache::bind_vertex_array(0));
 #endif
 
     vbo->unbind();
@@ -1685,6 +1998,7 @@ VertexArray::~VertexArray()
 #if defined(__EMSCRIPTEN__)
     glDeleteVertexArraysOES(1, &m_gl_vao);
 #else
+    state_cache::forget_vertex_array(m_gl_vao);
     glDeleteVertexArrays(1, &m_gl_vao);
 #endif
 }
@@ -1696,7 +2010,7 @@ void VertexArray::bind()
 #if defined(__EMSCRIPTEN__)
     GL_CHECK_ERROR(glBindVertexArrayOES(m_gl_vao));
 #else
-    GL_CHECK_ERROR(glBindVertexArray(m_gl_vao));
+    GL_CHECK_ERROR(state_cache::bind_vertex_array(m_gl_vao));
 #endif
 }
 
@@ -1707,7 +2021,7 @@ void VertexArray::unbind()
 #if defined(__EMSCRIPTEN__)
     GL_CHECK_ERROR(glBindVertexArrayOES(0));
 #else
-    GL_CHECK_ERROR(glBindVertexArray(0));
+    GL_CHECK_ERROR(state_cache::bind_vertex_array(0));
 #endif
 }
 
@@ -1763,4 +2077,4 @@ bool Query::result_available()
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
-} // namespace nimble
+} // namespace nimble
\ No newline at end of file
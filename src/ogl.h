@@ -4,10 +4,12 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <type_traits>
 #include <glm.hpp>
 
 //#define NIMBLE_ENABLE_GL_ERROR_CHECK
-// OpenGL error checking macro.
+// Synchronous OpenGL error checking macro. Explicit opt-in only: glGetError after every call stalls the driver, which makes the
+// build useless for profiling. Debug builds report errors asynchronously through gl_debug instead.
 #ifdef NIMBLE_ENABLE_GL_ERROR_CHECK
 #    define GL_CHECK_ERROR(x)                                                                              \
         x;                                                                                                 \
@@ -39,6 +41,13 @@
 
 namespace nimble
 {
+// True if objects can be edited through direct state access (core since OpenGL 4.5) instead of being bound first.
+extern bool has_direct_state_access();
+
+// Compute dispatches. Every dispatch must go through these so that it is counted in the render stats.
+extern void dispatch_compute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+extern void dispatch_compute_indirect(GLintptr offset);
+
 // Texture base class.
 class Texture
 {
@@ -70,9 +79,13 @@ public:
     void set_mag_filter(GLenum filter);
     void set_compare_mode(GLenum mode);
     void set_compare_func(GLenum func);
+    void set_mip_level_range(int32_t base_level, int32_t max_level);
 
     inline GLenum internal_format() { return m_internal_format; }
 
+protected:
+    void set_parameter(GLenum pname, GLint value);
+
 protected:
     GLuint   m_gl_tex = UINT32_MAX;
     GLenum   m_target;
@@ -112,11 +125,15 @@ public:
     uint32_t height();
     uint32_t num_samples();
 
+private:
+    void allocate();
+
 private:
     bool     m_compressed;
     uint32_t m_width;
     uint32_t m_height;
     uint32_t m_num_samples;
+    int32_t  m_requested_mip_levels;
 };
 
 class Texture3D : public Texture
@@ -201,6 +218,34 @@ private:
     GLenum m_type;
 };
 
+// Compile-time FNV-1a hash of a uniform name.
+constexpr uint32_t uniform_name_hash(const char* str, uint32_t hash = 2166136261u)
+{
+    return *str ? uniform_name_hash(str + 1, (hash ^ static_cast<uint32_t>(*str)) * 16777619u) : hash;
+}
+
+// Creates a uniform handle whose name hash is computed at compile time. The name must be a string literal.
+#define NIMBLE_UNIFORM_HANDLE(name) nimble::UniformHandle(name, std::integral_constant<uint32_t, nimble::uniform_name_hash(name)>::value)
+
+// Identifies a uniform name across all programs. Every distinct name is assigned a small dense index when its first handle is
+// created, which programs use to index a flat array of resolved locations. Handles should be created once (e.g as statics) and
+// reused, since creating one involves a hash map lookup.
+class UniformHandle
+{
+public:
+    explicit UniformHandle(const char* name);
+    UniformHandle(const char* name, uint32_t hash);
+
+    inline uint32_t    index() const { return m_index; }
+    inline uint32_t    hash() const { return m_hash; }
+    inline const char* name() const { return m_name; }
+
+private:
+    const char* m_name;
+    uint32_t    m_hash;
+    uint32_t    m_index;
+};
+
 class Program
 {
 public:
@@ -209,6 +254,35 @@ public:
     void    use();
     int32_t num_active_uniform_blocks();
     void    uniform_block_binding(std::string name, int binding);
+
+    // Handle based setters. The location is resolved on first use and cached, so these involve no string hashing or allocation.
+    bool set_uniform(const UniformHandle& handle, int value);
+    bool set_uniform(const UniformHandle& handle, float value);
+    bool set_uniform(const UniformHandle& handle, const glm::vec2& value);
+    bool set_uniform(const UniformHandle& handle, const glm::vec3& value);
+    bool set_uniform(const UniformHandle& handle, const glm::vec4& value);
+    bool set_uniform(const UniformHandle& handle, const glm::mat2& value);
+    bool set_uniform(const UniformHandle& handle, const glm::mat3& value);
+    bool set_uniform(const UniformHandle& handle, const glm::mat4& value);
+    bool set_uniform(const UniformHandle& handle, int count, int* value);
+    bool set_uniform(const UniformHandle& handle, int count, float* value);
+    bool set_uniform(const UniformHandle& handle, int count, glm::vec2* value);
+    bool set_uniform(const UniformHandle& handle, int count, glm::vec3* value);
+    bool set_uniform(const UniformHandle& handle, int count, glm::vec4* value);
+    bool set_uniform(const UniformHandle& handle, int count, glm::mat2* value);
+    bool set_uniform(const UniformHandle& handle, int count, glm::mat3* value);
+    bool set_uniform(const UniformHandle& handle, int count, glm::mat4* value);
+
+    // Returns -1 if the uniform is not active in this program.
+    inline GLint location(const UniformHandle& handle)
+    {
+        if (handle.index() < m_handle_locations.size() && m_handle_locations[handle.index()] != kUnresolvedLocation)
+            return m_handle_locations[handle.index()];
+
+        return resolve_location(handle);
+    }
+
+    // String based setters. These hash the name on every call and are kept for convenience outside of hot paths.
     bool    set_uniform(std::string name, int value);
     bool    set_uniform(std::string name, float value);
     bool    set_uniform(std::string name, glm::vec2 value);
@@ -228,9 +302,15 @@ public:
     GLint   id();
 
 private:
+    GLint resolve_location(const UniformHandle& handle);
+
+private:
+    static const GLint kUnresolvedLocation = -2;
+
     GLuint                                  m_gl_program;
     int32_t                                 m_num_active_uniform_blocks;
     std::unordered_map<std::string, GLuint> m_location_map;
+    std::vector<GLint>                      m_handle_locations;
 };
 
 class Buffer
@@ -247,6 +327,8 @@ public:
     void  unmap();
     void  set_data(size_t offset, size_t size, void* data);
 
+    inline GLuint id() { return m_gl_buffer; }
+
 protected:
     GLenum m_type;
     GLuint m_gl_buffer;
@@ -322,4 +404,4 @@ public:
 private:
     GLuint m_query;
 };
-} // namespace nimble
+} // namespace nimble
\ No newline at end of file
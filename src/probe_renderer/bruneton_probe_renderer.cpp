@@ -2,6 +2,8 @@
 #include "../renderer.h"
 #include "../resource_manager.h"
 #include "../logger.h"
+#include "../state_cache.h"
+#include "../render_stats.h"
 
 #define _USE_MATH_DEFINES
 #include <math.h>
@@ -83,8 +85,8 @@ void BrunetonProbeRenderer::env_map(double delta, Renderer* renderer, Scene* sce
             for (int i = 0; i < 6; i++)
                 m_cubemap_rtv[i] = RenderTargetView(i, 0, 0, scene->env_map());
 
-            glDisable(GL_DEPTH_TEST);
-            glDisable(GL_CULL_FACE);
+            state_cache::disable(GL_DEPTH_TEST);
+            state_cache::disable(GL_CULL_FACE);
 
             m_env_map_program->use();
 
@@ -95,14 +97,17 @@ void BrunetonProbeRenderer::env_map(double delta, Renderer* renderer, Scene* sce
                 m_env_map_program->set_uniform("view_projection", m_cubemap_views[i]);
 
                 renderer->bind_render_targets(1, &m_cubemap_rtv[i], nullptr);
-                glViewport(0, 0, ENVIRONMENT_MAP_SIZE, ENVIRONMENT_MAP_SIZE);
+                state_cache::viewport(0, 0, ENVIRONMENT_MAP_SIZE, ENVIRONMENT_MAP_SIZE);
 
-                glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+                state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
                 glClear(GL_COLOR_BUFFER_BIT);
 
                 renderer->cube_vao()->bind();
 
                 glDrawArrays(GL_TRIANGLES, 0, 36);
+
+                render_stats::add(render_stats::COUNTER_DRAW_CALLS);
+                render_stats::add(render_stats::COUNTER_TRIANGLES, 12);
             }
         }
     }
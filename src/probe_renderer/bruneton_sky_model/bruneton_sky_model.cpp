@@ -374,7 +374,7 @@ void BrunetonSkyModel::precompute()
 
     m_transmittance_t->bind_image(0, 0, 0, GL_READ_WRITE, m_transmittance_t->internal_format());
 
-    GL_CHECK_ERROR(glDispatchCompute(TRANSMITTANCE_W / NUM_THREADS, TRANSMITTANCE_H / NUM_THREADS, 1));
+    dispatch_compute(TRANSMITTANCE_W / NUM_THREADS, TRANSMITTANCE_H / NUM_THREADS, 1);
     GL_CHECK_ERROR(glFinish());
 
     // -----------------------------------------------------------------------------
@@ -389,7 +389,7 @@ void BrunetonSkyModel::precompute()
     if (m_irradiance_1_program->set_uniform("s_TransmittanceRead", 0))
         m_transmittance_t->bind(0);
 
-    GL_CHECK_ERROR(glDispatchCompute(IRRADIANCE_W / NUM_THREADS, IRRADIANCE_H / NUM_THREADS, 1));
+    dispatch_compute(IRRADIANCE_W / NUM_THREADS, IRRADIANCE_H / NUM_THREADS, 1);
     GL_CHECK_ERROR(glFinish());
 
     // -----------------------------------------------------------------------------
@@ -408,7 +408,7 @@ void BrunetonSkyModel::precompute()
     for (int i = 0; i < INSCATTER_R; i++)
     {
         m_inscatter_1_program->set_uniform("u_Layer", i);
-        GL_CHECK_ERROR(glDispatchCompute((INSCATTER_MU_S * INSCATTER_NU) / NUM_THREADS, INSCATTER_MU / NUM_THREADS, 1));
+        dispatch_compute((INSCATTER_MU_S * INSCATTER_NU) / NUM_THREADS, INSCATTER_MU / NUM_THREADS, 1);
         GL_CHECK_ERROR(glFinish());
     }
 
@@ -429,7 +429,7 @@ void BrunetonSkyModel::precompute()
     if (m_copy_irradiance_program->set_uniform("s_IrradianceRead", 1))
         m_irradiance_t[READ]->bind(1);
 
-    GL_CHECK_ERROR(glDispatchCompute(IRRADIANCE_W / NUM_THREADS, IRRADIANCE_H / NUM_THREADS, 1));
+    dispatch_compute(IRRADIANCE_W / NUM_THREADS, IRRADIANCE_H / NUM_THREADS, 1);
     GL_CHECK_ERROR(glFinish());
 
     for (int order = 2; order < 4; order++)
@@ -452,7 +452,7 @@ void BrunetonSkyModel::precompute()
         for (int i = 0; i < INSCATTER_R; i++)
         {
             m_copy_inscatter_1_program->set_uniform("u_Layer", i);
-            GL_CHECK_ERROR(glDispatchCompute((INSCATTER_MU_S * INSCATTER_NU) / NUM_THREADS, INSCATTER_MU / NUM_THREADS, 1));
+            dispatch_compute((INSCATTER_MU_S * INSCATTER_NU) / NUM_THREADS, INSCATTER_MU / NUM_THREADS, 1);
             GL_CHECK_ERROR(glFinish());
         }
 
@@ -484,7 +484,7 @@ void BrunetonSkyModel::precompute()
         for (int i = 0; i < INSCATTER_R; i++)
         {
             m_inscatter_s_program->set_uniform("u_Layer", i);
-            GL_CHECK_ERROR(glDispatchCompute((INSCATTER_MU_S * INSCATTER_NU) / NUM_THREADS, INSCATTER_MU / NUM_THREADS, 1));
+            dispatch_compute((INSCATTER_MU_S * INSCATTER_NU) / NUM_THREADS, INSCATTER_MU / NUM_THREADS, 1);
             GL_CHECK_ERROR(glFinish());
         }
 
@@ -505,7 +505,7 @@ void BrunetonSkyModel::precompute()
         if (m_irradiance_n_program->set_uniform("s_DeltaSMRead", 1))
             m_delta_smt->bind(1);
 
-        GL_CHECK_ERROR(glDispatchCompute(IRRADIANCE_W / NUM_THREADS, IRRADIANCE_H / NUM_THREADS, 1));
+        dispatch_compute(IRRADIANCE_W / NUM_THREADS, IRRADIANCE_H / NUM_THREADS, 1);
         GL_CHECK_ERROR(glFinish());
 
         // -----------------------------------------------------------------------------
@@ -528,7 +528,7 @@ void BrunetonSkyModel::precompute()
         for (int i = 0; i < INSCATTER_R; i++)
         {
             m_inscatter_n_program->set_uniform("u_Layer", i);
-            GL_CHECK_ERROR(glDispatchCompute((INSCATTER_MU_S * INSCATTER_NU) / NUM_THREADS, INSCATTER_MU / NUM_THREADS, 1));
+            dispatch_compute((INSCATTER_MU_S * INSCATTER_NU) / NUM_THREADS, INSCATTER_MU / NUM_THREADS, 1);
             GL_CHECK_ERROR(glFinish());
         }
 
@@ -549,7 +549,7 @@ void BrunetonSkyModel::precompute()
         if (m_copy_irradiance_program->set_uniform("s_IrradianceRead", 1))
             m_irradiance_t[READ]->bind(1);
 
-        GL_CHECK_ERROR(glDispatchCompute(IRRADIANCE_W / NUM_THREADS, IRRADIANCE_H / NUM_THREADS, 1));
+        dispatch_compute(IRRADIANCE_W / NUM_THREADS, IRRADIANCE_H / NUM_THREADS, 1);
         GL_CHECK_ERROR(glFinish());
 
         swap(m_irradiance_t);
@@ -572,7 +572,7 @@ void BrunetonSkyModel::precompute()
         for (int i = 0; i < INSCATTER_R; i++)
         {
             m_copy_inscatter_n_program->set_uniform("u_Layer", i);
-            GL_CHECK_ERROR(glDispatchCompute((INSCATTER_MU_S * INSCATTER_NU) / NUM_THREADS, INSCATTER_MU / NUM_THREADS, 1));
+            dispatch_compute((INSCATTER_MU_S * INSCATTER_NU) / NUM_THREADS, INSCATTER_MU / NUM_THREADS, 1);
             GL_CHECK_ERROR(glFinish());
         }
 
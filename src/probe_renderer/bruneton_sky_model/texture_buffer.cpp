@@ -136,7 +136,7 @@ void TextureBuffer::clear_texture(Program* program, Texture* tex)
         int height = tex_3d->height();
         int depth  = tex_3d->depth();
 
-        glDispatchCompute(width / CONSTANTS::NUM_THREADS, height / CONSTANTS::NUM_THREADS, depth / CONSTANTS::NUM_THREADS);
+        dispatch_compute(width / CONSTANTS::NUM_THREADS, height / CONSTANTS::NUM_THREADS, depth / CONSTANTS::NUM_THREADS);
     }
     else
     {
@@ -145,7 +145,7 @@ void TextureBuffer::clear_texture(Program* program, Texture* tex)
         int width  = tex_2d->width();
         int height = tex_2d->height();
 
-        glDispatchCompute(width / CONSTANTS::NUM_THREADS, height / CONSTANTS::NUM_THREADS, 1);
+        dispatch_compute(width / CONSTANTS::NUM_THREADS, height / CONSTANTS::NUM_THREADS, 1);
     }
 
     GL_CHECK_ERROR(glFinish());
@@ -1,11 +1,27 @@
 #include "profiler.h"
 #include "macros.h"
+#include "logger.h"
+#include "utility.h"
+#include "frame_stats.h"
 #include <vector>
-#include <stack>
+#include <deque>
+#include <algorithm>
+#include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
 #include <imgui.h>
 
 #define BUFFER_COUNT 3
-#define MAX_SAMPLES 100
+#define MAX_LATENCY_FRAMES 16
+#define INITIAL_SAMPLE_CAPACITY 256
+#define INITIAL_QUERY_CAPACITY 512
+#define INITIAL_STACK_CAPACITY 64
+#define CALIBRATION_SAMPLES 1000
+#define TRACE_CPU_TID 1
+#define TRACE_GPU_TID 2
+#define TRACE_FIRST_WORKER_TID 3
 
 namespace nimble
 {
@@ -13,204 +29,766 @@ namespace profiler
 {
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+// Interned sample names. Lives outside the Profiler so that IDs cached in static locals survive a shutdown. The deque keeps the
+// strings at stable addresses so that sample_name() can hand out raw pointers. Samples interned on first use may come from any
+// thread, so both sides take the lock.
+struct NameTable
+{
+    std::mutex                                mutex;
+    std::deque<std::string>                   names;
+    std::unordered_map<std::string, SampleID> ids;
+
+    SampleID intern(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto itr = ids.find(name);
+
+        if (itr != ids.end())
+            return itr->second;
+
+        SampleID id = SampleID(names.size());
+
+        names.push_back(name);
+        ids[name] = id;
+
+        return id;
+    }
+
+    const char* name(SampleID id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return names[id].c_str();
+    }
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static NameTable& name_table()
+{
+    static NameTable table;
+    return table;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static inline uint64_t now_ns()
+{
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Trace thread ID of the calling thread. The thread that creates the profiler is the render thread, every other thread gets its own
+// ID the first time it records a sample.
+static thread_local uint32_t t_trace_tid = 0;
+static std::atomic<uint32_t> g_next_trace_tid(TRACE_FIRST_WORKER_TID);
+
+static inline uint32_t trace_tid()
+{
+    if (t_trace_tid == 0)
+        t_trace_tid = g_next_trace_tid++;
+
+    return t_trace_tid;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Pool of GL_TIMESTAMP queries. A query only returns to the free list once its result has been read, or, for queries whose frame
+// was dropped, once the GPU reports the result as available. Reissuing a query that is still in flight would otherwise stall.
+class QueryPool
+{
+public:
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    inline uint32_t acquire()
+    {
+        if (m_free.empty())
+            grow();
+
+        uint32_t idx = m_free.back();
+        m_free.pop_back();
+
+        return idx;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    inline void timestamp(uint32_t idx)
+    {
+        m_queries[idx]->query_counter(GL_TIMESTAMP);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    inline bool available(uint32_t idx)
+    {
+        return m_queries[idx]->result_available();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Must only be called once available() returned true for this query or a later one.
+    inline uint64_t resolve(uint32_t idx)
+    {
+        uint64_t result = 0;
+        m_queries[idx]->result_64(&result);
+        m_free.push_back(idx);
+
+        return result;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    inline void retire(uint32_t idx)
+    {
+        m_retired.push_back(idx);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Returns the retired queries that have completed to the free list.
+    void collect()
+    {
+        for (uint32_t i = 0; i < m_retired.size();)
+        {
+            if (available(m_retired[i]))
+            {
+                m_free.push_back(m_retired[i]);
+                m_retired[i] = m_retired.back();
+                m_retired.pop_back();
+            }
+            else
+                i++;
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    inline uint32_t size() { return uint32_t(m_queries.size()); }
+    inline uint32_t in_flight() { return uint32_t(m_queries.size() - m_free.size()); }
+
+private:
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void grow()
+    {
+        uint32_t count = std::max(uint32_t(m_queries.size()), uint32_t(INITIAL_QUERY_CAPACITY));
+
+        m_free.reserve(m_queries.size() + count);
+        m_retired.reserve(m_queries.size() + count);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            m_free.push_back(uint32_t(m_queries.size()));
+            m_queries.push_back(std::make_unique<Query>());
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    std::vector<std::unique_ptr<Query>> m_queries;
+    std::vector<uint32_t>               m_free;
+    std::vector<uint32_t>               m_retired;
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 struct Profiler
 {
+    // A single scope.
     struct Sample
     {
-        std::string name;
-        Query       query;
-        bool        start = true;
-        double      cpu_time;
-        Sample*     end_sample;
+        SampleID id;
+        uint32_t depth;
+        uint32_t tid;
+        uint64_t cpu_begin;
+        uint64_t cpu_end;
+        uint32_t query_begin;
+        uint32_t query_end;
+        uint64_t gpu_begin;
+        uint64_t gpu_end;
     };
 
-    struct Buffer
+    // The samples of one frame. Frames stay in flight until the GPU has written all of their timestamps. The sample storage only grows
+    // when a frame records more samples than any frame before it, after which sampling does not touch the heap.
+    struct Frame
     {
-        std::vector<std::unique_ptr<Sample>> samples;
-        int32_t                              index = 0;
+        std::vector<Sample> samples;
+        uint32_t            count      = 0;
+        uint32_t            number     = 0;
+        uint32_t            last_query = UINT32_MAX;
+        bool                gpu_valid  = false;
+        uint64_t            cpu_begin  = 0;
+        uint64_t            cpu_end    = 0;
+    };
 
-        Buffer()
-        {
-            samples.resize(MAX_SAMPLES);
+    struct Stats
+    {
+        uint64_t delayed_samples = 0; // Resolved later than BUFFER_COUNT frames after being recorded.
+        uint64_t dropped_samples = 0; // GPU time discarded because the frame exceeded MAX_LATENCY_FRAMES.
+        uint32_t latency         = 0; // Number of frames currently waiting for the GPU.
+    };
 
-            for (uint32_t i = 0; i < MAX_SAMPLES; i++)
-                samples[i] = nullptr;
-        }
+    // A resolved sample of a frame that is being captured.
+    struct Event
+    {
+        SampleID id;
+        uint32_t frame;
+        uint32_t tid;
+        bool     gpu_valid;
+        uint64_t cpu_begin;
+        uint64_t cpu_end;
+        uint64_t gpu_begin;
+        uint64_t gpu_end;
+    };
+
+    struct Capture
+    {
+        bool               active      = false;
+        uint32_t           start_frame = 0;
+        uint32_t           end_frame   = 0;
+        int64_t            gpu_offset  = 0; // Added to GPU timestamps to move them onto the CPU clock.
+        uint64_t           origin      = 0; // CPU time that becomes zero in the trace.
+        std::string        path;
+        std::vector<Event> events;
     };
 
     // -----------------------------------------------------------------------------------------------------------------------------------
 
     Profiler()
     {
-#ifdef WIN32
-        QueryPerformanceFrequency(&m_frequency);
-#endif
+        m_sample_stack.reserve(INITIAL_STACK_CAPACITY);
+
+        t_trace_tid = TRACE_CPU_TID;
+
+        m_current = acquire_frame();
+
+        calibrate();
+
+        m_current->cpu_begin = now_ns();
     }
 
     // -----------------------------------------------------------------------------------------------------------------------------------
 
-    void begin_sample(std::string name)
+    inline void begin_sample(SampleID id)
     {
-        int32_t idx = m_sample_buffers[m_write_buffer_idx].index++;
+        Frame* frame = m_current;
 
-        if (!m_sample_buffers[m_write_buffer_idx].samples[idx])
-            m_sample_buffers[m_write_buffer_idx].samples[idx] = std::make_unique<Sample>();
+        if (frame->count == frame->samples.size())
+            frame->samples.resize(2 * frame->count);
 
-        auto& sample = m_sample_buffers[m_write_buffer_idx].samples[idx];
+        uint32_t idx    = frame->count++;
+        Sample&  sample = frame->samples[idx];
 
-        sample->name = name;
-        sample->query.query_counter(GL_TIMESTAMP);
-        sample->end_sample = nullptr;
-        sample->start      = true;
+        sample.id          = id;
+        sample.depth       = uint32_t(m_sample_stack.size());
+        sample.tid         = trace_tid();
+        sample.query_begin = UINT32_MAX;
+        sample.query_end   = UINT32_MAX;
+
+        if (m_gpu_timing)
+        {
+            sample.query_begin = m_query_pool.acquire();
+            sample.query_end   = m_query_pool.acquire();
+
+            m_query_pool.timestamp(sample.query_begin);
+
+            frame->last_query = sample.query_begin;
+        }
 
-#ifdef WIN32
-        LARGE_INTEGER cpu_time;
-        QueryPerformanceCounter(&cpu_time);
-        sample->cpu_time = cpu_time.QuadPart * (1000000.0 / m_frequency.QuadPart);
-#else
-        timeval cpu_time;
-        gettimeofday(&sample->cpu_time, nullptr);
-#endif
+        m_sample_stack.push_back(idx);
 
-        m_sample_stack.push(sample.get());
+        sample.cpu_begin = now_ns();
     }
 
     // -----------------------------------------------------------------------------------------------------------------------------------
 
-    void end_sample(std::string name)
+    inline void end_sample()
     {
-        int32_t idx = m_sample_buffers[m_write_buffer_idx].index++;
+        // Unbalanced, or the sample was begun before begin_frame() cleared the stack.
+        if (m_sample_stack.empty())
+        {
+            NIMBLE_LOG_WARNING("Profiler sample ended without a matching begin_sample()");
+            return;
+        }
 
-        if (!m_sample_buffers[m_write_buffer_idx].samples[idx])
-            m_sample_buffers[m_write_buffer_idx].samples[idx] = std::make_unique<Sample>();
+        uint64_t cpu_end = now_ns();
 
-        auto& sample = m_sample_buffers[m_write_buffer_idx].samples[idx];
+        Frame*   frame = m_current;
+        uint32_t idx   = m_sample_stack.back();
 
-        sample->name  = name;
-        sample->start = false;
-        sample->query.query_counter(GL_TIMESTAMP);
-        sample->end_sample = nullptr;
+        m_sample_stack.pop_back();
 
-#ifdef WIN32
-        LARGE_INTEGER cpu_time;
-        QueryPerformanceCounter(&cpu_time);
-        sample->cpu_time = cpu_time.QuadPart * (1000000.0 / m_frequency.QuadPart);
-#else
-        timeval cpu_time;
-        gettimeofday(&sample->cpu_time, nullptr);
-#endif
+        Sample& sample = frame->samples[idx];
 
-        Sample* start = m_sample_stack.top();
+        sample.cpu_end = cpu_end;
 
-        start->end_sample = sample.get();
+        if (sample.query_end != UINT32_MAX)
+        {
+            m_query_pool.timestamp(sample.query_end);
 
-        m_sample_stack.pop();
+            frame->last_query = sample.query_end;
+        }
     }
 
     // -----------------------------------------------------------------------------------------------------------------------------------
 
     void begin_frame()
     {
-        m_read_buffer_idx++;
-        m_write_buffer_idx++;
+        uint64_t now = now_ns();
+
+        m_frame++;
 
-        if (m_read_buffer_idx == 3)
-            m_read_buffer_idx = 0;
+        m_current->cpu_end = now;
+        m_pending.push_back(m_current);
 
-        if (m_write_buffer_idx == 3)
-            m_write_buffer_idx = 0;
+        m_query_pool.collect();
+        resolve_pending_frames();
+
+        m_current            = acquire_frame();
+        m_current->number    = m_frame;
+        m_current->cpu_begin = now;
+
+        m_sample_stack.clear();
     }
 
     // -----------------------------------------------------------------------------------------------------------------------------------
 
     void end_frame()
     {
-        if (m_read_buffer_idx >= 0)
-            m_sample_buffers[m_read_buffer_idx].index = 0;
     }
 
     // -----------------------------------------------------------------------------------------------------------------------------------
 
-    void ui()
+    Frame* acquire_frame()
     {
-        if (m_read_buffer_idx >= 0)
+        Frame* frame = nullptr;
+
+        if (m_free_frames.empty())
         {
-            for (int32_t i = 0; i < m_sample_buffers[m_read_buffer_idx].index; i++)
-            {
-                auto& sample = m_sample_buffers[m_read_buffer_idx].samples[i];
+            m_frames.push_back(std::make_unique<Frame>());
 
-                if (sample->start)
-                {
-                    if (!m_should_pop_stack.empty())
-                    {
-                        if (!m_should_pop_stack.top())
-                        {
-                            m_should_pop_stack.push(false);
-                            continue;
-                        }
-                    }
+            frame = m_frames.back().get();
+            frame->samples.resize(INITIAL_SAMPLE_CAPACITY);
+        }
+        else
+        {
+            frame = m_free_frames.back();
+            m_free_frames.pop_back();
+        }
 
-                    std::string id = std::to_string(i);
+        frame->count      = 0;
+        frame->last_query = UINT32_MAX;
+        frame->gpu_valid  = false;
 
-                    uint64_t time = 0;
+        return frame;
+    }
 
-                    sample->query.result_64(&time);
-                    float gpu_start_time = time / 1000000.0f;
+    // -----------------------------------------------------------------------------------------------------------------------------------
 
-                    sample->end_sample->query.result_64(&time);
-                    float gpu_end_time = time / 1000000.0f;
+    // Resolves in-flight frames oldest first without ever waiting on the GPU. A frame that is not ready simply stays in flight, which
+    // widens the latency window, until more than MAX_LATENCY_FRAMES are waiting. At that point the GPU times of the oldest frame are
+    // dropped and its queries are retired until the GPU is done with them.
+    void resolve_pending_frames()
+    {
+        while (!m_pending.empty())
+        {
+            Frame* frame = m_pending.front();
 
-                    float gpu_time = gpu_end_time - gpu_start_time;
-                    float cpu_time = (sample->end_sample->cpu_time - sample->cpu_time) * 0.001f;
+            // Timestamps complete in submission order, so the last query of a frame being available means all of them are.
+            bool ready = frame->last_query == UINT32_MAX || m_query_pool.available(frame->last_query);
 
-                    if (ImGui::TreeNode(id.c_str(), "%s | %f ms (CPU) | %f ms (GPU)", sample->name.c_str(), cpu_time, gpu_time))
-                        m_should_pop_stack.push(true);
-                    else
-                        m_should_pop_stack.push(false);
-                }
-                else
+            if (ready)
+            {
+                for (uint32_t i = 0; i < frame->count; i++)
                 {
-                    if (!m_should_pop_stack.empty())
-                    {
-                        bool should_pop = m_should_pop_stack.top();
-                        m_should_pop_stack.pop();
+                    Sample& sample = frame->samples[i];
 
-                        if (should_pop)
-                            ImGui::TreePop();
+                    if (sample.query_begin != UINT32_MAX)
+                    {
+                        sample.gpu_begin = m_query_pool.resolve(sample.query_begin);
+                        sample.gpu_end   = m_query_pool.resolve(sample.query_end);
+                    }
+                    else
+                    {
+                        sample.gpu_begin = 0;
+                        sample.gpu_end   = 0;
                     }
                 }
+
+                if (m_frame - frame->number > BUFFER_COUNT)
+                    m_stats.delayed_samples += frame->count;
+
+                frame->gpu_valid = frame->last_query != UINT32_MAX;
             }
+            else if (m_pending.size() > MAX_LATENCY_FRAMES)
+            {
+                discard_gpu_samples(frame);
+                m_stats.dropped_samples += frame->count;
+            }
+            else
+                break;
+
+            m_pending.pop_front();
+            finish_frame(frame);
         }
+
+        m_stats.latency = uint32_t(m_pending.size());
     }
 
     // -----------------------------------------------------------------------------------------------------------------------------------
 
-    int32_t             m_read_buffer_idx  = -3;
-    int32_t             m_write_buffer_idx = -1;
-    Buffer              m_sample_buffers[BUFFER_COUNT];
-    std::stack<Sample*> m_sample_stack;
-    std::stack<bool>    m_should_pop_stack;
+    void discard_gpu_samples(Frame* frame)
+    {
+        for (uint32_t i = 0; i < frame->count; i++)
+        {
+            Sample& sample = frame->samples[i];
+
+            if (sample.query_begin != UINT32_MAX)
+            {
+                m_query_pool.retire(sample.query_begin);
+                m_query_pool.retire(sample.query_end);
 
-#ifdef WIN32
-    LARGE_INTEGER m_frequency;
-#endif
+                sample.query_begin = UINT32_MAX;
+                sample.query_end   = UINT32_MAX;
+            }
+
+            sample.gpu_begin = 0;
+            sample.gpu_end   = 0;
+        }
+
+        frame->gpu_valid  = false;
+        frame->last_query = UINT32_MAX;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Hands a resolved frame to the frame statistics, the capture and the UI.
+    void finish_frame(Frame* frame)
+    {
+        add_frame_timing(frame);
+
+        if (m_capture.active)
+        {
+            if (frame->number >= m_capture.start_frame && frame->number < m_capture.end_frame)
+                capture_frame(frame);
+
+            if (frame->number + 1 >= m_capture.end_frame)
+                write_capture();
+        }
+
+        if (m_resolved)
+            m_free_frames.push_back(m_resolved);
+
+        m_resolved = frame;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void add_frame_timing(Frame* frame)
+    {
+        uint64_t gpu_begin = UINT64_MAX;
+        uint64_t gpu_end   = 0;
+
+        m_timing.frame     = frame->number;
+        m_timing.cpu_ms    = float(double(frame->cpu_end - frame->cpu_begin) / 1000000.0);
+        m_timing.gpu_valid = false;
+        m_timing.samples.resize(frame->count);
+
+        for (uint32_t i = 0; i < frame->count; i++)
+        {
+            const Sample& sample = frame->samples[i];
+            auto&         timing = m_timing.samples[i];
+
+            timing.id        = sample.id;
+            timing.depth     = sample.depth;
+            timing.cpu_ms    = float(double(sample.cpu_end - sample.cpu_begin) / 1000000.0);
+            timing.gpu_valid = frame->gpu_valid && sample.query_begin != UINT32_MAX;
+            timing.gpu_ms    = timing.gpu_valid ? float(double(sample.gpu_end - sample.gpu_begin) / 1000000.0) : 0.0f;
+
+            // The GPU frame time is the span of the top level samples since there is no timestamp around the whole frame.
+            if (timing.gpu_valid && sample.depth == 0)
+            {
+                gpu_begin          = std::min(gpu_begin, sample.gpu_begin);
+                gpu_end            = std::max(gpu_end, sample.gpu_end);
+                m_timing.gpu_valid = true;
+            }
+        }
+
+        m_timing.gpu_ms = m_timing.gpu_valid ? float(double(gpu_end - gpu_begin) / 1000000.0) : 0.0f;
+
+        frame_stats::add_frame(m_timing);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void capture(uint32_t num_frames, const std::string& path, uint32_t delay_frames)
+    {
+        if (m_capture.active)
+        {
+            NIMBLE_LOG_WARNING("A profiler capture is already in progress.");
+            return;
+        }
+
+        m_capture.active      = true;
+        m_capture.start_frame = m_frame + 1 + delay_frames;
+        m_capture.end_frame   = m_capture.start_frame + num_frames;
+        m_capture.path        = path;
+        m_capture.events.clear();
+        m_capture.events.reserve(num_frames * m_current->samples.size());
+
+        calibrate_gpu_clock();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Both clocks are sampled back to back. GL_TIMESTAMP is the time at which every previously issued command has reached the GPU,
+    // which is close enough to align the tracks to well under a millisecond.
+    void calibrate_gpu_clock()
+    {
+        GLint64 gpu_now = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+
+        uint64_t cpu_now = now_ns();
+
+        m_capture.gpu_offset = int64_t(cpu_now) - int64_t(gpu_now);
+        m_capture.origin     = cpu_now;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void capture_frame(Frame* frame)
+    {
+        for (uint32_t i = 0; i < frame->count; i++)
+        {
+            const Sample& sample = frame->samples[i];
+
+            Event event;
+
+            event.id        = sample.id;
+            event.frame     = frame->number;
+            event.tid       = sample.tid;
+            event.gpu_valid = frame->gpu_valid && sample.query_begin != UINT32_MAX;
+            event.cpu_begin = sample.cpu_begin;
+            event.cpu_end   = sample.cpu_end;
+            event.gpu_begin = sample.gpu_begin;
+            event.gpu_end   = sample.gpu_end;
+
+            m_capture.events.push_back(event);
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void write_trace_event(std::ofstream& f, SampleID id, const char* category, uint32_t tid, uint32_t frame, int64_t begin, int64_t end)
+    {
+        f << ",\n{\"name\":";
+        utility::write_json_string(f, sample_name(id));
+        f << ",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid;
+        f << ",\"ts\":" << double(begin - int64_t(m_capture.origin)) / 1000.0;
+        f << ",\"dur\":" << double(end - begin) / 1000.0;
+        f << ",\"args\":{\"frame\":" << frame << "}}";
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void write_capture()
+    {
+        m_capture.active = false;
+
+        std::ofstream f(m_capture.path);
+
+        if (!f.is_open())
+        {
+            NIMBLE_LOG_ERROR("Failed to open profiler trace file: " + m_capture.path);
+            return;
+        }
+
+        f.precision(3);
+        f << std::fixed;
+
+        f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        f << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Nimble\"}}";
+        f << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << TRACE_CPU_TID << ",\"args\":{\"name\":\"CPU: Render Thread\"}}";
+        f << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << TRACE_GPU_TID << ",\"args\":{\"name\":\"GPU\"}}";
+
+        std::vector<uint32_t> worker_tids;
+
+        for (const auto& event : m_capture.events)
+        {
+            if (event.tid != TRACE_CPU_TID && std::find(worker_tids.begin(), worker_tids.end(), event.tid) == worker_tids.end())
+            {
+                worker_tids.push_back(event.tid);
+                f << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << event.tid << ",\"args\":{\"name\":\"CPU: Thread " << event.tid - TRACE_FIRST_WORKER_TID + 1 << "\"}}";
+            }
+        }
+
+        for (const auto& event : m_capture.events)
+        {
+            write_trace_event(f, event.id, "CPU", event.tid, event.frame, int64_t(event.cpu_begin), int64_t(event.cpu_end));
+
+            // Frames whose GPU times were dropped still contribute their CPU timeline.
+            if (event.gpu_valid)
+                write_trace_event(f, event.id, "GPU", TRACE_GPU_TID, event.frame, int64_t(event.gpu_begin) + m_capture.gpu_offset, int64_t(event.gpu_end) + m_capture.gpu_offset);
+        }
+
+        f << "\n]}\n";
+
+        NIMBLE_LOG_INFO("Wrote profiler trace of " + std::to_string(m_capture.end_frame - m_capture.start_frame) + " frames to " + m_capture.path);
+
+        m_capture.events.clear();
+        m_capture.events.shrink_to_fit();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Measures the cost of an empty scope, with and without GPU timestamps, by recording into the current frame and discarding
+    // the result.
+    void calibrate()
+    {
+        static const SampleID kCalibrationID = intern("Profiler Calibration");
+
+        for (uint32_t pass = 0; pass < 2; pass++)
+        {
+            m_gpu_timing = pass == 1;
+
+            uint64_t start = now_ns();
+
+            for (uint32_t i = 0; i < CALIBRATION_SAMPLES; i++)
+            {
+                begin_sample(kCalibrationID);
+                end_sample();
+            }
+
+            uint64_t end = now_ns();
+
+            m_overhead_ns[pass] = double(end - start) / double(CALIBRATION_SAMPLES);
+        }
+
+        m_gpu_timing = true;
+
+        discard_gpu_samples(m_current);
+        m_current->count = 0;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void ui()
+    {
+        ImGui::Text("Overhead: %.1f ns per sample (CPU), %.1f ns per sample (CPU + GPU timestamps)", m_overhead_ns[0], m_overhead_ns[1]);
+
+        ImGui::InputInt("Trace Frames", &m_ui_capture_frames);
+
+        if (m_capture.active)
+            ImGui::Text("Capturing trace to %s...", m_capture.path.c_str());
+        else if (ImGui::Button("Capture Trace"))
+            capture(uint32_t(std::max(m_ui_capture_frames, 1)), "trace_frame_" + std::to_string(m_frame) + ".json", 0);
+
+        ImGui::Text("Latency: %u frames | Delayed samples: %llu | Dropped samples: %llu | Queries: %u (%u in flight)",
+                    m_stats.latency,
+                    (unsigned long long)m_stats.delayed_samples,
+                    (unsigned long long)m_stats.dropped_samples,
+                    m_query_pool.size(),
+                    m_query_pool.in_flight());
+
+        if (!m_resolved)
+            return;
+
+        const Frame* frame     = m_resolved;
+        uint32_t     open_tree = 0;
+
+        ImGui::Text("Frame: %u | Samples: %u", frame->number, frame->count);
+
+        for (uint32_t i = 0; i < frame->count; i++)
+        {
+            const Sample& sample = frame->samples[i];
+
+            while (open_tree > sample.depth)
+            {
+                ImGui::TreePop();
+                open_tree--;
+            }
+
+            // Skip the children of collapsed nodes.
+            if (sample.depth > open_tree)
+                continue;
+
+            float cpu_time = float(double(sample.cpu_end - sample.cpu_begin) / 1000000.0);
+            bool  open     = false;
+
+            if (frame->gpu_valid && sample.query_begin != UINT32_MAX)
+            {
+                float gpu_time = float(double(sample.gpu_end - sample.gpu_begin) / 1000000.0);
+                open           = ImGui::TreeNode((void*)(intptr_t)i, "%s | %f ms (CPU) | %f ms (GPU)", sample_name(sample.id), cpu_time, gpu_time);
+            }
+            else
+                open = ImGui::TreeNode((void*)(intptr_t)i, "%s | %f ms (CPU) | - (GPU)", sample_name(sample.id), cpu_time);
+
+            if (open)
+                open_tree++;
+        }
+
+        while (open_tree > 0)
+        {
+            ImGui::TreePop();
+            open_tree--;
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    uint32_t                            m_frame             = 0;
+    bool                                m_gpu_timing        = true;
+    double                              m_overhead_ns[2]    = { 0.0, 0.0 };
+    int32_t                             m_ui_capture_frames = 60;
+    Capture                             m_capture;
+    Stats                               m_stats;
+    QueryPool                           m_query_pool;
+    std::vector<std::unique_ptr<Frame>> m_frames;
+    std::vector<Frame*>                 m_free_frames;
+    std::deque<Frame*>                  m_pending;
+    Frame*                              m_current  = nullptr;
+    Frame*                              m_resolved = nullptr;
+    frame_stats::FrameTiming            m_timing;
+    std::vector<uint32_t>               m_sample_stack;
 };
 
 Profiler* g_profiler = nullptr;
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-ScopedProfile::ScopedProfile(std::string name) :
-    m_name(name)
+ScopedProfile::ScopedProfile(SampleID id)
 {
-    begin_sample(m_name);
+    begin_sample(id);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 ScopedProfile::~ScopedProfile()
 {
-    end_sample(m_name);
+    end_sample();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+SampleID intern(const char* name)
+{
+    return name_table().intern(name);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+SampleID intern(const std::string& name)
+{
+    return name_table().intern(name);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+const char* sample_name(SampleID id)
+{
+    return name_table().name(id);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -229,16 +807,18 @@ void shutdown()
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-void begin_sample(std::string name)
+void begin_sample(SampleID id)
 {
-    g_profiler->begin_sample(name);
+    if (g_profiler)
+        g_profiler->begin_sample(id);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
-void end_sample(std::string name)
+void end_sample()
 {
-    g_profiler->end_sample(name);
+    if (g_profiler)
+        g_profiler->end_sample();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -257,11 +837,32 @@ void end_frame()
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+uint32_t frame_number()
+{
+    return g_profiler ? g_profiler->m_frame : 0;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 void ui()
 {
     g_profiler->ui();
 }
 
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void capture(uint32_t num_frames, const std::string& path, uint32_t delay_frames)
+{
+    g_profiler->capture(num_frames, path, delay_frames);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool is_capturing()
+{
+    return g_profiler && g_profiler->m_capture.active;
+}
+
 // -----------------------------------------------------------------------------------------------------------------------------------
 } // namespace profiler
 } // namespace nimble
\ No newline at end of file
@@ -5,26 +5,48 @@
 #include <memory>
 #include <string>
 
-#define NIMBLE_SCOPED_SAMPLE(name) nimble::profiler::ScopedProfile __FILE__##__LINE__(name)
+#define NIMBLE_PROFILER_CONCAT_IMPL(a, b) a##b
+#define NIMBLE_PROFILER_CONCAT(a, b) NIMBLE_PROFILER_CONCAT_IMPL(a, b)
+
+// The name is interned once per call site, so it must not change between invocations. Use NIMBLE_SCOPED_SAMPLE_ID with an ID
+// obtained from profiler::intern() for names that do.
+#define NIMBLE_SCOPED_SAMPLE(name)                                                                                                         \
+    static const nimble::profiler::SampleID NIMBLE_PROFILER_CONCAT(nimble_sample_id_, __LINE__) = nimble::profiler::intern(name); \
+    nimble::profiler::ScopedProfile         NIMBLE_PROFILER_CONCAT(nimble_scoped_sample_, __LINE__)(NIMBLE_PROFILER_CONCAT(nimble_sample_id_, __LINE__))
+
+#define NIMBLE_SCOPED_SAMPLE_ID(id) nimble::profiler::ScopedProfile NIMBLE_PROFILER_CONCAT(nimble_scoped_sample_, __LINE__)(id)
 
 namespace nimble
 {
 namespace profiler
 {
+using SampleID = uint32_t;
+
 struct ScopedProfile
 {
-    ScopedProfile(std::string name);
+    ScopedProfile(SampleID id);
     ~ScopedProfile();
-
-    std::string m_name;
 };
 
+// Returns the stable ID of a sample name, registering it on first use. IDs stay valid across profiler shutdown and initialization.
+extern SampleID    intern(const char* name);
+extern SampleID    intern(const std::string& name);
+extern const char* sample_name(SampleID id);
+
 extern void initialize();
 extern void shutdown();
-extern void begin_sample(std::string name);
-extern void end_sample(std::string name);
+extern void begin_sample(SampleID id);
+extern void end_sample();
 extern void begin_frame();
 extern void end_frame();
+
+// Number of the frame currently being recorded, as reported in FrameTiming::frame once it has resolved.
+extern uint32_t frame_number();
 extern void ui();
+
+// Records the CPU and GPU timelines of num_frames frames, starting delay_frames from now, and writes them to path as Chrome trace
+// event JSON which can be opened in chrome://tracing or the Perfetto UI.
+extern void capture(uint32_t num_frames, const std::string& path, uint32_t delay_frames = 0);
+extern bool is_capturing();
 }; // namespace profiler
 } // namespace nimble
\ No newline at end of file
@@ -3,13 +3,14 @@
 #include "utility.h"
 #include "logger.h"
 #include "profiler.h"
+#include "render_stats.h"
 
 namespace nimble
 {
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 RenderGraph::RenderGraph() :
-    m_num_cascade_views(0), m_manual_cascade_rendering(false), m_per_cascade_culling(true)
+    m_window_width(0), m_window_height(0), m_render_scale(1.0f), m_upscaled(false), m_num_cascade_views(0), m_manual_cascade_rendering(false), m_per_cascade_culling(true)
 {
 }
 
@@ -55,6 +56,8 @@ void RenderGraph::clear()
 {
     m_end_node.reset();
     m_flattened_graph.clear();
+    m_sample_ids.clear();
+    m_upscaled = false;
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -69,16 +72,25 @@ void RenderGraph::build(std::shared_ptr<RenderNode> end_node)
 
 void RenderGraph::execute(double delta, Renderer* renderer, Scene* scene, View* view)
 {
-    for (auto& node : m_flattened_graph)
+    profiler::SampleID view_id = render_stats::is_enabled() ? profiler::intern(view->tag) : 0;
+
+    for (uint32_t i = 0; i < m_flattened_graph.size(); i++)
     {
-        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, node->name().c_str());
+        auto&       node = m_flattened_graph[i];
+        const char* name = profiler::sample_name(m_sample_ids[i]);
 
         {
-            NIMBLE_SCOPED_SAMPLE(node->name().c_str());
+            NIMBLE_SCOPED_DEBUG_GROUP(name);
+            NIMBLE_SCOPED_SAMPLE_ID(m_sample_ids[i]);
+
+            gl_debug::set_active_node(name);
+
+            render_stats::begin_scope(view_id, m_sample_ids[i]);
             node->execute(delta, renderer, scene, view);
-        }
+            render_stats::end_scope();
 
-        glPopDebugGroup();
+            gl_debug::set_active_node(nullptr);
+        }
 
         if (m_num_cascade_views > 0)
         {
@@ -142,6 +154,48 @@ void RenderGraph::flatten_graph()
 
     if (m_end_node)
         traverse_and_push_node(m_end_node);
+
+    // Node names are interned up front so that executing the graph does not build strings every frame.
+    m_sample_ids.clear();
+
+    for (auto& node : m_flattened_graph)
+        m_sample_ids.push_back(profiler::intern(node->name()));
+
+    mark_render_scaled_nodes();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void RenderGraph::mark_render_scaled_nodes()
+{
+    m_upscaled = false;
+
+    for (auto& node : m_flattened_graph)
+    {
+        if (node->is_upscaler())
+            m_upscaled = true;
+    }
+
+    // Everything that does not consume the output of an upscaler runs at the render resolution. The flattened graph is in
+    // dependency order so every input has been marked by the time a node is visited.
+    for (auto& node : m_flattened_graph)
+    {
+        bool render_scaled = m_upscaled && !node->is_upscaler();
+
+        for (auto& con : node->input_render_targets())
+        {
+            if (con.prev_node && !con.prev_node->is_render_scaled())
+                render_scaled = false;
+        }
+
+        for (auto& con : node->input_buffers())
+        {
+            if (con.prev_node && !con.prev_node->is_render_scaled())
+                render_scaled = false;
+        }
+
+        node->set_render_scaled(render_scaled);
+    }
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
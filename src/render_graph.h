@@ -2,6 +2,7 @@
 
 #include "render_node.h"
 #include "view.h"
+#include "profiler.h"
 
 namespace nimble
 {
@@ -36,8 +37,11 @@ public:
     inline uint32_t                    window_height() { return m_window_height; }
     inline virtual uint32_t            actual_viewport_width() { return window_width(); }
     inline virtual uint32_t            actual_viewport_height() { return window_height(); }
-    inline virtual uint32_t            rendered_viewport_width() { return actual_viewport_width(); }
-    inline virtual uint32_t            rendered_viewport_height() { return actual_viewport_height(); }
+    inline virtual uint32_t            rendered_viewport_width() { return m_upscaled ? uint32_t(float(actual_viewport_width()) * m_render_scale) : actual_viewport_width(); }
+    inline virtual uint32_t            rendered_viewport_height() { return m_upscaled ? uint32_t(float(actual_viewport_height()) * m_render_scale) : actual_viewport_height(); }
+    inline void                        set_render_scale(float value) { m_render_scale = value; }
+    inline float                       render_scale() { return m_upscaled ? m_render_scale : 1.0f; }
+    inline bool                        is_upscaled() { return m_upscaled; }
     inline void                        set_manual_cascade_rendering(bool value) { m_manual_cascade_rendering = value; }
     inline bool                        is_manual_cascade_rendering() { return m_manual_cascade_rendering; }
     inline void                        set_per_cascade_culling(bool value) { m_per_cascade_culling = value; }
@@ -48,6 +52,7 @@ public:
 
 private:
     void flatten_graph();
+    void mark_render_scaled_nodes();
     void traverse_and_push_node(std::shared_ptr<RenderNode> node);
     bool is_node_pushed(std::shared_ptr<RenderNode> node);
 
@@ -55,12 +60,15 @@ private:
     std::string                              m_name;
     uint32_t                                 m_window_width;
     uint32_t                                 m_window_height;
+    float                                    m_render_scale;
+    bool                                     m_upscaled;
     bool                                     m_per_cascade_culling;
     bool                                     m_manual_cascade_rendering;
     uint32_t                                 m_num_cascade_views;
     View*                                    m_cascade_views[MAX_SHADOW_CASTING_DIRECTIONAL_LIGHTS * MAX_SHADOW_MAP_CASCADES];
     std::shared_ptr<RenderNode>              m_end_node;
     std::vector<std::shared_ptr<RenderNode>> m_flattened_graph;
+    std::vector<profiler::SampleID>          m_sample_ids;
 };
 
 class ShadowRenderGraph : public RenderGraph
@@ -1,6 +1,7 @@
 #include "render_node.h"
 #include "render_graph.h"
 #include "profiler.h"
+#include "render_stats.h"
 #include "view.h"
 #include "scene.h"
 #include "shader_library.h"
@@ -9,10 +10,16 @@
 
 namespace nimble
 {
+static const UniformHandle kDirectionalLightShadowMaps = NIMBLE_UNIFORM_HANDLE("s_DirectionalLightShadowMaps");
+static const UniformHandle kSpotLightShadowMaps        = NIMBLE_UNIFORM_HANDLE("s_SpotLightShadowMaps");
+static const UniformHandle kPointLightShadowMaps       = NIMBLE_UNIFORM_HANDLE("s_PointLightShadowMaps");
+static const UniformHandle kBlitTexture                = NIMBLE_UNIFORM_HANDLE("s_Texture");
+static const UniformHandle kMaterialIndex              = NIMBLE_UNIFORM_HANDLE("u_MaterialIndex");
+
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 RenderNode::RenderNode(RenderGraph* graph) :
-    m_enabled(true), m_graph(graph)
+    m_enabled(true), m_render_scaled(false), m_graph(graph)
 {
 }
 
@@ -178,13 +185,13 @@ void RenderNode::bind_shadow_maps(Renderer* renderer, Program* program, int32_t
 {
     if (program)
     {
-        if ((HAS_BIT_FLAG(flags, NODE_USAGE_SHADOW_MAPPING)) && program->set_uniform("s_DirectionalLightShadowMaps", tex_unit))
+        if ((HAS_BIT_FLAG(flags, NODE_USAGE_SHADOW_MAPPING)) && program->set_uniform(kDirectionalLightShadowMaps, tex_unit))
             renderer->directional_light_shadow_maps()->bind(tex_unit++);
 
-        if ((HAS_BIT_FLAG(flags, NODE_USAGE_SHADOW_MAPPING)) && program->set_uniform("s_SpotLightShadowMaps", tex_unit))
+        if ((HAS_BIT_FLAG(flags, NODE_USAGE_SHADOW_MAPPING)) && program->set_uniform(kSpotLightShadowMaps, tex_unit))
             renderer->spot_light_shadow_maps()->bind(tex_unit++);
 
-        if ((HAS_BIT_FLAG(flags, NODE_USAGE_SHADOW_MAPPING)) && program->set_uniform("s_PointLightShadowMaps", tex_unit))
+        if ((HAS_BIT_FLAG(flags, NODE_USAGE_SHADOW_MAPPING)) && program->set_uniform(kPointLightShadowMaps, tex_unit))
             renderer->point_light_shadow_maps()->bind(tex_unit++);
     }
 }
@@ -210,6 +217,20 @@ void RenderNode::trigger_cascade_view_render(View* view)
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+uint32_t RenderNode::viewport_width()
+{
+    return m_render_scaled ? m_graph->rendered_viewport_width() : m_graph->actual_viewport_width();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+uint32_t RenderNode::viewport_height()
+{
+    return m_render_scaled ? m_graph->rendered_viewport_height() : m_graph->actual_viewport_height();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 void RenderNode::register_input_render_target(const std::string& name)
 {
     for (auto& input : m_input_rts)
@@ -398,20 +419,20 @@ void RenderNode::blit_render_target(Renderer* renderer, std::shared_ptr<RenderTa
 
     std::shared_ptr<Program> program = renderer->copy_program();
 
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    state_cache::disable(GL_DEPTH_TEST);
+    state_cache::disable(GL_CULL_FACE);
 
     program->use();
 
     Texture2D* texture = (Texture2D*)dst->texture.get();
 
     renderer->bind_render_targets(1, &rtv, nullptr);
-    glViewport(0, 0, texture->width(), texture->height());
+    state_cache::viewport(0, 0, texture->width(), texture->height());
 
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    state_cache::clear_color(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    if (program->set_uniform("s_Texture", 0))
+    if (program->set_uniform(kBlitTexture, 0))
         src->texture->bind(0);
 
     render_fullscreen_triangle(renderer, nullptr);
@@ -432,6 +453,13 @@ void RenderNode::render_scene(Renderer* renderer, Scene* scene, View* view, Shad
         if (HAS_BIT_FLAG(flags, NODE_USAGE_POINT_LIGHTS) || HAS_BIT_FLAG(flags, NODE_USAGE_SPOT_LIGHTS) || HAS_BIT_FLAG(flags, NODE_USAGE_DIRECTIONAL_LIGHTS))
             renderer->per_scene_ssbo()->bind_base(2);
 
+        // Any material usage reads the material constants, e.g. the albedo alpha of cutout materials in depth only passes.
+        if (flags & NODE_USAGE_ALL_MATERIALS)
+            renderer->per_material_ssbo()->bind_base(3);
+
+        Program*  last_program  = nullptr;
+        Material* last_material = nullptr;
+
         for (uint32_t i = 0; i < scene->entity_count(); i++)
         {
             Entity& e = entities[i];
@@ -470,17 +498,20 @@ void RenderNode::render_scene(Renderer* renderer, Scene* scene, View* view, Shad
 
                         program->use();
 
-                        // Bind material
-                        if (HAS_BIT_FLAG(flags, NODE_USAGE_MATERIAL_ALBEDO) && !s.material->surface_texture(TEXTURE_TYPE_ALBEDO))
-                            program->set_uniform("u_Albedo", s.material->uniform_albedo());
+                        // Bind material. Constants are read from the shared material buffer, so only the index has to change
+                        // between draws. Sampler units are fixed per program by the shader library.
+                        if (program != last_program || s.material.get() != last_material)
+                        {
+                            uint32_t material_index = s.material->buffer_index();
 
-                        if (HAS_BIT_FLAG(flags, NODE_USAGE_MATERIAL_EMISSIVE) && !s.material->surface_texture(TEXTURE_TYPE_EMISSIVE))
-                            program->set_uniform("u_Emissive", s.material->uniform_emissive());
+                            // Only materials that did not fit into the buffer are left without a slot.
+                            program->set_uniform(kMaterialIndex, material_index == INVALID_MATERIAL_INDEX ? 0 : int32_t(material_index));
 
-                        if ((HAS_BIT_FLAG(flags, NODE_USAGE_MATERIAL_ROUGH_SMOOTH) && !s.material->surface_texture(TEXTURE_TYPE_ROUGH_SMOOTH)) || (HAS_BIT_FLAG(flags, NODE_USAGE_MATERIAL_METAL_SPEC) && !s.material->surface_texture(TEXTURE_TYPE_METAL_SPEC)))
-                            program->set_uniform("u_MetalRough", glm::vec4(s.material->uniform_metallic(), s.material->uniform_roughness(), 0.0f, 0.0f));
+                            last_program  = program;
+                            last_material = s.material.get();
+                        }
 
-                        s.material->bind(program, tex_unit);
+                        s.material->bind_textures(tex_unit);
 
                         bind_shadow_maps(renderer, program, tex_unit, flags);
 
@@ -492,6 +523,9 @@ void RenderNode::render_scene(Renderer* renderer, Scene* scene, View* view, Shad
 
                         glDrawElementsBaseVertex(GL_TRIANGLES, s.index_count, GL_UNSIGNED_INT, (void*)(sizeof(unsigned int) * s.base_index), s.base_vertex);
 
+                        render_stats::add(render_stats::COUNTER_DRAW_CALLS);
+                        render_stats::add(render_stats::COUNTER_TRIANGLES, s.index_count / 3);
+
 #ifdef ENABLE_SUBMESH_CULLING
                     }
 #endif
@@ -516,6 +550,9 @@ void RenderNode::render_fullscreen_triangle(Renderer* renderer, View* view, Prog
 
     // Render fullscreen triangle
     glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    render_stats::add(render_stats::COUNTER_DRAW_CALLS);
+    render_stats::add(render_stats::COUNTER_TRIANGLES, 1);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -533,6 +570,9 @@ void RenderNode::render_fullscreen_quad(Renderer* renderer, View* view, Program*
 
     // Render fullscreen triangle
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    render_stats::add(render_stats::COUNTER_DRAW_CALLS);
+    render_stats::add(render_stats::COUNTER_TRIANGLES, 2);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -7,6 +7,8 @@
 #include "view.h"
 #include "macros.h"
 #include "parameterizable.h"
+#include "state_cache.h"
+#include "gl_debug.h"
 
 #define REGISTER_RENDER_NODE(class_name, resource_manager) resource_manager.register_render_node_factory(#class_name, create_render_node_##class_name)
 #define DECLARE_RENDER_NODE_FACTORY(class_name) extern std::shared_ptr<RenderNode> create_render_node_##class_name(RenderGraph* graph)
@@ -106,10 +108,12 @@ public:
     inline uint32_t                         input_render_target_count() { return (uint32_t)m_input_rts.size(); }
     inline std::shared_ptr<RenderTarget>    input_render_target(const uint32_t& idx) { return m_input_rts[idx].prev_render_target; }
     inline bool                             is_enabled() { return m_enabled; }
+    inline bool                             is_render_scaled() { return m_render_scaled; }
 
     // Inline setters
     inline void enable() { m_enabled = true; }
     inline void disable() { m_enabled = false; }
+    inline void set_render_scaled(bool value) { m_render_scaled = value; }
 
     // Virtual methods
     virtual void        declare_connections();
@@ -118,11 +122,16 @@ public:
     virtual void        shutdown()                                                          = 0;
     virtual std::string name()                                                              = 0;
 
+    // Nodes that reconstruct the output resolution from the jittered, lower resolution frames rendered by every node before them.
+    inline virtual bool is_upscaler() { return false; }
+
     // Event callbacks
     virtual void on_window_resized(const uint32_t& w, const uint32_t& h);
 
 protected:
     void                          trigger_cascade_view_render(View* view);
+    uint32_t                      viewport_width();
+    uint32_t                      viewport_height();
     void                          register_input_render_target(const std::string& name);
     void                          register_input_buffer(const std::string& name);
     std::shared_ptr<RenderTarget> register_output_render_target(const std::string& name, const uint32_t& w, const uint32_t& h, GLenum target, GLenum internal_format, GLenum format, GLenum type, uint32_t num_samples = 1, uint32_t array_size = 1, uint32_t mip_levels = 1);
@@ -144,6 +153,7 @@ protected:
 
 private:
     bool                                                               m_enabled;
+    bool                                                               m_render_scaled;
     std::vector<OutputRenderTarget>                                    m_output_rts;
     std::vector<std::pair<std::string, std::shared_ptr<RenderTarget>>> m_intermediate_rts;
     std::vector<InputRenderTarget>                                     m_input_rts;
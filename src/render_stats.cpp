@@ -0,0 +1,444 @@
+#include "render_stats.h"
+#include "macros.h"
+#include "logger.h"
+#include "utility.h"
+#include <string.h>
+#include <fstream>
+#include <algorithm>
+#include <imgui.h>
+
+#define INITIAL_ENTRY_CAPACITY 256
+#define INITIAL_SCOPE_CAPACITY 16
+
+namespace nimble
+{
+namespace render_stats
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static const char* kCounterNames[] = {
+    "Draw Calls",
+    "Triangles",
+    "Dispatches",
+    "Program Binds",
+    "Texture Binds",
+    "Framebuffer Binds",
+    "Buffer Uploads",
+    "Buffer Upload Bytes"
+};
+
+static const char* kCounterKeys[] = {
+    "draw_calls",
+    "triangles",
+    "dispatches",
+    "program_binds",
+    "texture_binds",
+    "framebuffer_binds",
+    "buffer_uploads",
+    "buffer_upload_bytes"
+};
+
+bool     g_enabled = false;
+uint64_t g_counters[COUNTER_COUNT];
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+struct RenderStats
+{
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    RenderStats()
+    {
+        m_current.frame = 0;
+        m_last.frame    = 0;
+
+        NIMBLE_ZERO_MEMORY(m_current.totals);
+        NIMBLE_ZERO_MEMORY(m_last.totals);
+        NIMBLE_ZERO_MEMORY(m_unscoped);
+
+        m_current.entries.reserve(INITIAL_ENTRY_CAPACITY);
+        m_last.entries.reserve(INITIAL_ENTRY_CAPACITY);
+        m_scope_stack.reserve(INITIAL_SCOPE_CAPACITY);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Moves the counters accumulated since the last scope change into the scope that was open at the time.
+    void flush()
+    {
+        Counters& target = m_scope_stack.empty() ? m_unscoped : m_current.entries[m_scope_stack.back()].counters;
+
+        for (uint32_t i = 0; i < COUNTER_COUNT; i++)
+        {
+            target.values[i] += g_counters[i];
+            m_current.totals.values[i] += g_counters[i];
+            g_counters[i] = 0;
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void begin_frame()
+    {
+        if (!g_enabled)
+            return;
+
+        flush();
+
+        std::swap(m_current, m_last);
+
+        m_current.frame = m_last.frame + 1;
+        m_current.entries.clear();
+
+        NIMBLE_ZERO_MEMORY(m_current.totals);
+        NIMBLE_ZERO_MEMORY(m_unscoped);
+
+        m_scope_stack.clear();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void begin_scope(profiler::SampleID view, profiler::SampleID node)
+    {
+        flush();
+
+        Entry entry;
+
+        entry.view = view;
+        entry.node = node;
+        NIMBLE_ZERO_MEMORY(entry.counters);
+
+        m_scope_stack.push_back(uint32_t(m_current.entries.size()));
+        m_current.entries.push_back(entry);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void end_scope()
+    {
+        if (m_scope_stack.empty())
+            return;
+
+        flush();
+
+        m_scope_stack.pop_back();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void set_enabled(bool enabled)
+    {
+        if (enabled == g_enabled)
+            return;
+
+        // Start from a clean frame either way so that partial frames never show up in the results.
+        NIMBLE_ZERO_MEMORY(g_counters);
+        NIMBLE_ZERO_MEMORY(m_current.totals);
+        NIMBLE_ZERO_MEMORY(m_unscoped);
+
+        m_current.entries.clear();
+        m_scope_stack.clear();
+
+        g_enabled = enabled;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    // Sums the entries of the last frame per view, in order of first appearance.
+    void view_totals(std::vector<Entry>& totals)
+    {
+        totals.clear();
+
+        for (const auto& entry : m_last.entries)
+        {
+            Entry* total = nullptr;
+
+            for (auto& t : totals)
+            {
+                if (t.view == entry.view)
+                {
+                    total = &t;
+                    break;
+                }
+            }
+
+            if (!total)
+            {
+                totals.push_back(entry);
+                continue;
+            }
+
+            for (uint32_t i = 0; i < COUNTER_COUNT; i++)
+                total->counters.values[i] += entry.counters.values[i];
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    static void write_csv_row(std::ofstream& f, const char* scope, const char* view, const char* node, const Counters& counters)
+    {
+        f << scope << ",";
+        utility::write_csv_string(f, view);
+        f << ",";
+        utility::write_csv_string(f, node);
+
+        for (uint32_t i = 0; i < COUNTER_COUNT; i++)
+            f << "," << counters.values[i];
+
+        f << "\n";
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool write_csv(const std::string& path)
+    {
+        std::ofstream f(path);
+
+        if (!f.is_open())
+        {
+            NIMBLE_LOG_ERROR("Failed to open render stats file: " + path);
+            return false;
+        }
+
+        f << "scope,view,node";
+
+        for (uint32_t i = 0; i < COUNTER_COUNT; i++)
+            f << "," << kCounterKeys[i];
+
+        f << "\n";
+
+        for (const auto& entry : m_last.entries)
+            write_csv_row(f, "node", profiler::sample_name(entry.view), profiler::sample_name(entry.node), entry.counters);
+
+        view_totals(m_view_totals);
+
+        for (const auto& total : m_view_totals)
+            write_csv_row(f, "view", profiler::sample_name(total.view), "", total.counters);
+
+        write_csv_row(f, "frame", "", "", m_last.totals);
+
+        NIMBLE_LOG_INFO("Wrote render stats of frame " + std::to_string(m_last.frame) + " to " + path);
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    static void write_json_counters(std::ofstream& f, const Counters& counters)
+    {
+        f << "{";
+
+        for (uint32_t i = 0; i < COUNTER_COUNT; i++)
+            f << (i > 0 ? "," : "") << "\"" << kCounterKeys[i] << "\":" << counters.values[i];
+
+        f << "}";
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool write_json(const std::string& path)
+    {
+        std::ofstream f(path);
+
+        if (!f.is_open())
+        {
+            NIMBLE_LOG_ERROR("Failed to open render stats file: " + path);
+            return false;
+        }
+
+        f << "{\n\"frame\":" << m_last.frame << ",\n\"totals\":";
+        write_json_counters(f, m_last.totals);
+
+        f << ",\n\"views\":[";
+
+        view_totals(m_view_totals);
+
+        for (uint32_t i = 0; i < m_view_totals.size(); i++)
+        {
+            f << (i > 0 ? ",\n" : "\n") << "{\"view\":";
+            utility::write_json_string(f, profiler::sample_name(m_view_totals[i].view));
+            f << ",\"totals\":";
+            write_json_counters(f, m_view_totals[i].counters);
+            f << "}";
+        }
+
+        f << "\n],\n\"nodes\":[";
+
+        for (uint32_t i = 0; i < m_last.entries.size(); i++)
+        {
+            const Entry& entry = m_last.entries[i];
+
+            f << (i > 0 ? ",\n" : "\n") << "{\"view\":";
+            utility::write_json_string(f, profiler::sample_name(entry.view));
+            f << ",\"node\":";
+            utility::write_json_string(f, profiler::sample_name(entry.node));
+            f << ",\"counters\":";
+            write_json_counters(f, entry.counters);
+            f << "}";
+        }
+
+        f << "\n]\n}\n";
+
+        NIMBLE_LOG_INFO("Wrote render stats of frame " + std::to_string(m_last.frame) + " to " + path);
+
+        return true;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    static void ui_row(const char* name, const Counters& counters, bool indent)
+    {
+        ImGui::Text(indent ? "    %s" : "%s", name);
+        ImGui::NextColumn();
+
+        for (uint32_t i = 0; i < COUNTER_COUNT; i++)
+        {
+            ImGui::Text("%llu", (unsigned long long)counters.values[i]);
+            ImGui::NextColumn();
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void ui()
+    {
+        bool enabled = g_enabled;
+
+        if (ImGui::Checkbox("Enabled", &enabled))
+            set_enabled(enabled);
+
+        if (!g_enabled)
+            return;
+
+        ImGui::SameLine();
+
+        if (ImGui::Button("Export CSV"))
+            write_csv("render_stats_frame_" + std::to_string(m_last.frame) + ".csv");
+
+        ImGui::SameLine();
+
+        if (ImGui::Button("Export JSON"))
+            write_json("render_stats_frame_" + std::to_string(m_last.frame) + ".json");
+
+        ImGui::Columns(COUNTER_COUNT + 1);
+        ImGui::Separator();
+
+        ImGui::Text("Scope");
+        ImGui::NextColumn();
+
+        for (uint32_t i = 0; i < COUNTER_COUNT; i++)
+        {
+            ImGui::Text("%s", kCounterNames[i]);
+            ImGui::NextColumn();
+        }
+
+        ImGui::Separator();
+
+        ui_row("Frame", m_last.totals, false);
+
+        view_totals(m_view_totals);
+
+        for (const auto& total : m_view_totals)
+        {
+            ImGui::Separator();
+            ui_row(profiler::sample_name(total.view), total.counters, false);
+
+            for (const auto& entry : m_last.entries)
+            {
+                if (entry.view != total.view)
+                    continue;
+
+                ui_row(profiler::sample_name(entry.node), entry.counters, true);
+            }
+        }
+
+        ImGui::Columns(1);
+        ImGui::Separator();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    FrameStats            m_current;
+    FrameStats            m_last;
+    Counters              m_unscoped;
+    std::vector<uint32_t> m_scope_stack;
+    std::vector<Entry>    m_view_totals;
+};
+
+static RenderStats g_render_stats;
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void set_enabled(bool enabled)
+{
+    g_render_stats.set_enabled(enabled);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool is_enabled()
+{
+    return g_enabled;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void begin_frame()
+{
+    g_render_stats.begin_frame();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void begin_scope(profiler::SampleID view, profiler::SampleID node)
+{
+    if (g_enabled)
+        g_render_stats.begin_scope(view, node);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void end_scope()
+{
+    if (g_enabled)
+        g_render_stats.end_scope();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+const char* counter_name(Counter counter)
+{
+    return kCounterNames[counter];
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+const FrameStats& last_frame()
+{
+    return g_render_stats.m_last;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool write_csv(const std::string& path)
+{
+    return g_render_stats.write_csv(path);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool write_json(const std::string& path)
+{
+    return g_render_stats.write_json(path);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void ui()
+{
+    g_render_stats.ui();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace render_stats
+} // namespace nimble
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "profiler.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Per-frame counters of the work submitted to OpenGL, attributed to the view and render node that was executing at the time.
+// Binds are counted as requested through the ogl wrappers, before the state cache filters redundant ones. The State Cache panel
+// shows how many of them actually reached the driver.
+namespace nimble
+{
+namespace render_stats
+{
+enum Counter
+{
+    COUNTER_DRAW_CALLS = 0,
+    COUNTER_TRIANGLES,
+    COUNTER_DISPATCHES,
+    COUNTER_PROGRAM_BINDS,
+    COUNTER_TEXTURE_BINDS,
+    COUNTER_FRAMEBUFFER_BINDS,
+    COUNTER_BUFFER_UPLOADS,
+    COUNTER_BUFFER_UPLOAD_BYTES,
+    COUNTER_COUNT
+};
+
+struct Counters
+{
+    uint64_t values[COUNTER_COUNT];
+};
+
+// The work done by one render node for one view. View and node names are profiler sample IDs.
+struct Entry
+{
+    profiler::SampleID view;
+    profiler::SampleID node;
+    Counters           counters;
+};
+
+struct FrameStats
+{
+    uint32_t           frame;
+    Counters           totals; // Includes work that happened outside of any node, such as UI rendering and uploads.
+    std::vector<Entry> entries;
+};
+
+// Counters of the scope that is currently open. Only touched through add() so that the disabled path is a single branch.
+extern bool     g_enabled;
+extern uint64_t g_counters[COUNTER_COUNT];
+
+inline void add(Counter counter, uint64_t value = 1)
+{
+    if (g_enabled)
+        g_counters[counter] += value;
+}
+
+extern void set_enabled(bool enabled);
+extern bool is_enabled();
+
+// Completes the previous frame.
+extern void begin_frame();
+
+// Attributes everything counted until the matching end_scope() to the given view and node. Scopes may nest, in which case the
+// outer scope only receives the work done outside of the inner one.
+extern void begin_scope(profiler::SampleID view, profiler::SampleID node);
+extern void end_scope();
+
+extern const char*       counter_name(Counter counter);
+extern const FrameStats& last_frame();
+
+// Write the last completed frame. One row per view and node, followed by per view and per frame totals.
+extern bool write_csv(const std::string& path);
+extern bool write_json(const std::string& path);
+
+extern void ui();
+} // namespace render_stats
+} // namespace nimble
\ No newline at end of file
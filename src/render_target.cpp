@@ -7,7 +7,7 @@ static uint32_t g_last_rt_id = 0;
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 RenderTarget::RenderTarget() :
-    id(g_last_rt_id++), forward_slot("")
+    id(g_last_rt_id++), forward_slot(""), render_scaled(false)
 {
 }
 
@@ -21,6 +21,7 @@ struct RenderTarget
     uint32_t                 mip_levels;
     std::string              forward_slot;
     std::shared_ptr<Texture> texture;
+    bool                     render_scaled; // Sized relative to the render resolution instead of the window when set.
 
     RenderTarget();
 
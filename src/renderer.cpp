@@ -123,9 +123,13 @@ bool Renderer::initialize(ResourceManager* res_mgr, const uint32_t& w, const uin
     }
 
     // Common resources
-    m_per_view   = std::make_unique<ShaderStorageBuffer>(GL_DYNAMIC_DRAW, MAX_VIEWS * sizeof(PerViewUniforms));
-    m_per_entity = std::make_unique<UniformBuffer>(GL_DYNAMIC_DRAW, MAX_ENTITIES * sizeof(PerEntityUniforms));
-    m_per_scene  = std::make_unique<ShaderStorageBuffer>(GL_DYNAMIC_DRAW, sizeof(PerSceneUniforms));
+    m_per_view     = std::make_unique<ShaderStorageBuffer>(GL_DYNAMIC_DRAW, MAX_VIEWS * sizeof(PerViewUniforms));
+    m_per_entity   = std::make_unique<UniformBuffer>(GL_DYNAMIC_DRAW, MAX_ENTITIES * sizeof(PerEntityUniforms));
+    m_per_scene    = std::make_unique<ShaderStorageBuffer>(GL_DYNAMIC_DRAW, sizeof(PerSceneUniforms));
+    m_per_material = std::make_unique<ShaderStorageBuffer>(GL_STATIC_DRAW, MAX_MATERIALS * sizeof(PerMaterialUniforms));
+
+    // The scene may have been set before the buffer existed.
+    update_material_buffer();
 
     create_cube();
 
@@ -133,6 +137,7 @@ bool Renderer::initialize(ResourceManager* res_mgr, const uint32_t& w, const uin
 
     for (auto& current_graph : m_registered_render_graphs)
     {
+        current_graph->set_render_scale(m_settings.render_scale);
         current_graph->on_window_resized(m_window_width, m_window_height);
 
         if (!current_graph->initialize(this, res_mgr))
@@ -195,6 +200,7 @@ void Renderer::shutdown()
     m_per_view.reset();
     m_per_entity.reset();
     m_per_scene.reset();
+    m_per_material.reset();
 
     m_directional_light_shadow_maps.reset();
     m_spot_light_shadow_maps.reset();
@@ -205,7 +211,13 @@ void Renderer::shutdown()
 
 void Renderer::set_settings(Settings settings)
 {
+    bool render_scale_changed = settings.render_scale != m_settings.render_scale;
+
     m_settings = settings;
+
+    // Render Targets only exist once the graphs have been baked.
+    if (render_scale_changed && m_rt_cache.size() > 0)
+        on_window_resized(m_window_width, m_window_height);
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -213,6 +225,8 @@ void Renderer::set_settings(Settings settings)
 void Renderer::set_scene(std::shared_ptr<Scene> scene)
 {
     m_scene = scene;
+
+    update_material_buffer();
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -540,17 +554,19 @@ void Renderer::on_window_resized(const uint32_t& w, const uint32_t& h)
     {
         if (desc.rt->is_scaled() && desc.rt->target == GL_TEXTURE_2D)
         {
-            uint32_t width  = uint32_t(float(w) * desc.rt->scale_w);
-            uint32_t height = uint32_t(float(h) * desc.rt->scale_h);
+            update_render_target_size(desc.rt, w, h);
 
             Texture2D* texture = (Texture2D*)desc.rt->texture.get();
-            texture->resize(width, height);
+            texture->resize(desc.rt->w, desc.rt->h);
             texture->set_wrapping(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
         }
     }
 
     if (m_scene_render_graph)
+    {
+        m_scene_render_graph->set_render_scale(m_settings.render_scale);
         m_scene_render_graph->on_window_resized(w, h);
+    }
 }
 
 // -----------------------------------------------------------------------------------------------------------------------------------
@@ -1344,7 +1360,7 @@ int32_t Renderer::find_render_target_last_usage(std::shared_ptr<RenderTarget> rt
 
 bool Renderer::is_aliasing_candidate(std::shared_ptr<RenderTarget> rt, uint32_t write_node, uint32_t read_node, const RenderTargetDesc& rt_desc)
 {
-    bool format_match = rt->internal_format == rt_desc.rt->texture->internal_format() && rt->target == rt_desc.rt->texture->target() && rt->scale_h == rt_desc.rt->scale_h && rt->scale_w == rt_desc.rt->scale_w && rt->w == rt_desc.rt->w && rt->h == rt_desc.rt->h;
+    bool format_match = rt->internal_format == rt_desc.rt->texture->internal_format() && rt->target == rt_desc.rt->texture->target() && rt->scale_h == rt_desc.rt->scale_h && rt->scale_w == rt_desc.rt->scale_w && rt->render_scaled == rt_desc.rt->render_scaled && rt->w == rt_desc.rt->w && rt->h == rt_desc.rt->h;
 
     if (!format_match)
         return false;
@@ -1375,10 +1391,7 @@ void Renderer::create_texture_for_render_target(std::shared_ptr<RenderTarget> rt
     std::shared_ptr<Texture> tex;
 
     if (rt->is_scaled())
-    {
-        rt->w = uint32_t(rt->scale_w * float(m_window_width));
-        rt->h = uint32_t(rt->scale_h * float(m_window_height));
-    }
+        update_render_target_size(rt, m_window_width, m_window_height);
 
     if (rt->target == GL_TEXTURE_2D)
         tex = std::make_shared<Texture2D>(rt->w, rt->h, rt->array_size, rt->mip_levels, rt->num_samples, rt->internal_format, rt->format, rt->type);
@@ -1396,6 +1409,16 @@ void Renderer::create_texture_for_render_target(std::shared_ptr<RenderTarget> rt
 
 // -----------------------------------------------------------------------------------------------------------------------------------
 
+void Renderer::update_render_target_size(std::shared_ptr<RenderTarget> rt, uint32_t w, uint32_t h)
+{
+    float render_scale = rt->render_scaled ? m_settings.render_scale : 1.0f;
+
+    rt->w = uint32_t(rt->scale_w * float(w) * render_scale);
+    rt->h = uint32_t(rt->scale_h * float(h) * render_scale);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
 void Renderer::bake_render_graphs()
 {
     uint32_t node_gid = 0;
@@ -1417,6 +1440,8 @@ void Renderer::bake_render_graphs()
 
                 if (rt->forward_slot == "")
                 {
+                    rt->render_scaled = node->is_render_scaled();
+
                     // Find last usage of output
                     int32_t current_node_id = node_gid;
                     int32_t last_node_id    = find_render_target_last_usage(rt);
@@ -1459,6 +1484,7 @@ void Renderer::bake_render_graphs()
                         rt->array_size      = input_rt->array_size;
                         rt->mip_levels      = input_rt->mip_levels;
                         rt->texture         = input_rt->texture;
+                        rt->render_scaled   = input_rt->render_scaled;
                     }
                 }
             }
@@ -1467,6 +1493,8 @@ void Renderer::bake_render_graphs()
             {
                 std::shared_ptr<RenderTarget> rt = node->intermediate_render_target(rt_idx);
 
+                rt->render_scaled = node->is_render_scaled();
+
                 bool found_texture = false;
 
                 // Try to find an already created texture that does not have an overlapping lifetime
@@ -1499,6 +1527,9 @@ void Renderer::update_uniforms()
     {
         auto scene = m_scene.lock();
 
+        if (!is_material_buffer_current(scene.get()))
+            update_material_buffer();
+
         // Update per entity uniforms
         Entity* entities = scene->entities();
 
@@ -1601,6 +1632,103 @@ void Renderer::update_uniforms()
     }
 }
 
+// Materials can be assigned to meshes, and their constants changed, at any time after the scene was set. Checking every submesh
+// against what was packed is cheap next to the per entity upload, so stale buffers are detected here instead of relying on callers.
+bool Renderer::is_material_buffer_current(Scene* scene)
+{
+    Entity* entities = scene->entities();
+
+    for (uint32_t i = 0; i < scene->entity_count(); i++)
+    {
+        Entity& e = entities[i];
+
+        if (!e.mesh)
+            continue;
+
+        for (uint32_t j = 0; j < e.mesh->submesh_count(); j++)
+        {
+            Material* material = e.mesh->submesh(j).material.get();
+
+            if (!material)
+                continue;
+
+            uint32_t index = material->buffer_index();
+
+            if (index >= m_packed_materials.size() || m_packed_materials[index] != material)
+            {
+                // Materials that did not fit share slot 0, which has already been reported.
+                if (m_packed_materials.size() == MAX_MATERIALS)
+                    continue;
+
+                return false;
+            }
+
+            PerMaterialUniforms uniforms = material->uniforms();
+
+            if (memcmp(&uniforms, &m_per_material_uniforms[index], sizeof(PerMaterialUniforms)) != 0)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void Renderer::update_material_buffer()
+{
+    // Pack the constants of every material used by the scene into one buffer so that draws only have to select a material index.
+    // Scenes set before initialize() are packed once the buffer has been created.
+    if (!m_per_material)
+        return;
+
+    m_per_material_uniforms.clear();
+    m_packed_materials.clear();
+
+    auto scene = m_scene.lock();
+
+    if (!scene)
+        return;
+
+    Entity* entities = scene->entities();
+
+    for (uint32_t i = 0; i < scene->entity_count(); i++)
+    {
+        Entity& e = entities[i];
+
+        if (!e.mesh)
+            continue;
+
+        for (uint32_t j = 0; j < e.mesh->submesh_count(); j++)
+        {
+            Material* material = e.mesh->submesh(j).material.get();
+
+            if (!material)
+                continue;
+
+            uint32_t index = material->buffer_index();
+
+            // Materials shared between submeshes have already been packed during this pass.
+            if (index < m_packed_materials.size() && m_packed_materials[index] == material)
+                continue;
+
+            if (m_packed_materials.size() == MAX_MATERIALS)
+            {
+                NIMBLE_LOG_ERROR("Material buffer is full, material will use the constants of another material: " + material->name());
+                material->set_buffer_index(0);
+                continue;
+            }
+
+            material->set_buffer_index(m_packed_materials.size());
+            m_packed_materials.push_back(material);
+            m_per_material_uniforms.push_back(material->uniforms());
+        }
+    }
+
+    if (m_per_material_uniforms.size() > 0)
+        m_per_material->set_data(0, sizeof(PerMaterialUniforms) * m_per_material_uniforms.size(), &m_per_material_uniforms[0]);
+}
+
 // -----------------------------------------------------------------------------------------------------------------------------------
 
 void Renderer::cull_scene()
@@ -1765,7 +1893,7 @@ void Renderer::render_all_views(double delta)
             {
                 if (view->graph)
                 {
-                    NIMBLE_SCOPED_SAMPLE(view->tag);
+                    NIMBLE_SCOPED_SAMPLE_ID(profiler::intern(view->tag));
                     view->graph->execute(delta, this, scene.get(), view);
                 }
                 else
@@ -20,6 +20,11 @@ class ResourceManager;
 class GlobalProbeRenderer;
 class LocalProbeRenderer;
 
+namespace micro_benchmark
+{
+struct RendererAccess;
+} // namespace micro_benchmark
+
 enum ShadowMapQuality : uint32_t
 {
     SHADOW_MAP_QUALITY_LOW,
@@ -39,6 +44,7 @@ public:
         bool             per_cascade_culling = true;
         bool             pssm                = false;
         float            csm_lambda          = 0.5f;
+        float            render_scale        = 1.0f; // Fraction of the window the scene is rendered at in graphs with an upscaler.
     };
 
     Renderer(Settings settings = Settings());
@@ -89,9 +95,13 @@ public:
     inline ShaderStorageBuffer*                 per_view_ssbo() { return m_per_view.get(); }
     inline UniformBuffer*                       per_entity_ubo() { return m_per_entity.get(); }
     inline ShaderStorageBuffer*                 per_scene_ssbo() { return m_per_scene.get(); }
+    inline ShaderStorageBuffer*                 per_material_ssbo() { return m_per_material.get(); }
     inline std::shared_ptr<VertexArray>         cube_vao() { return m_cube_vao; }
 
 private:
+    // Lets the CPU microbenchmarks run the per-frame stages in isolation.
+    friend struct micro_benchmark::RendererAccess;
+
     using TextureLifetimes = std::vector<std::pair<uint32_t, uint32_t>>;
 
     struct RenderTargetDesc
@@ -106,8 +116,11 @@ private:
     int32_t  find_render_target_last_usage(std::shared_ptr<RenderTarget> rt);
     bool     is_aliasing_candidate(std::shared_ptr<RenderTarget> rt, uint32_t write_node, uint32_t read_node, const RenderTargetDesc& rt_desc);
     void     create_texture_for_render_target(std::shared_ptr<RenderTarget> rt, uint32_t write_node, uint32_t read_node);
+    void     update_render_target_size(std::shared_ptr<RenderTarget> rt, uint32_t w, uint32_t h);
     void     bake_render_graphs();
     void     update_uniforms();
+    bool     is_material_buffer_current(Scene* scene);
+    void     update_material_buffer();
     void     cull_scene();
     bool     queue_rendered_view(View* view);
     uint32_t queue_update_view(View* view);
@@ -142,11 +155,14 @@ private:
     std::array<PerViewUniforms, MAX_VIEWS>      m_per_view_uniforms;
     std::array<PerEntityUniforms, MAX_ENTITIES> m_per_entity_uniforms;
     PerSceneUniforms                            m_per_scene_uniforms;
+    std::vector<PerMaterialUniforms>            m_per_material_uniforms;
+    std::vector<Material*>                      m_packed_materials;
 
     // Uniform buffers
     std::unique_ptr<ShaderStorageBuffer> m_per_view;
     std::unique_ptr<UniformBuffer>       m_per_entity;
     std::unique_ptr<ShaderStorageBuffer> m_per_scene;
+    std::unique_ptr<ShaderStorageBuffer> m_per_material;
 
     // Shadow Maps
     std::shared_ptr<Texture>      m_directional_light_shadow_maps;
@@ -0,0 +1,400 @@
+#include "scene_generator.h"
+#include "scene.h"
+#include "camera.h"
+#include "material.h"
+#include "mesh.h"
+#include "ogl.h"
+#include "logger.h"
+#include "murmur_hash.h"
+#include "constants.h"
+#include <float.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace nimble
+{
+namespace scene_generator
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Unit cube faces as normal, tangent and bitangent.
+static const glm::vec3 kFaces[6][3] = {
+    { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+    { glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+    { glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f) },
+    { glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) },
+    { glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+    { glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) }
+};
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Rotation phase and speed of a dynamic entity. Derived from its ID so that animate() needs no state of its own.
+static inline void motion(uint32_t id, float& phase, float& speed)
+{
+    uint64_t hash = murmur_hash_64(&id, sizeof(id), 0);
+
+    phase = float(hash & 0xffff) / 65535.0f * 360.0f;
+    speed = 15.0f + float((hash >> 16) & 0xffff) / 65535.0f * 75.0f;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static std::shared_ptr<Material> create_material(uint32_t index, std::mt19937& gen)
+{
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+
+    std::shared_ptr<Material> material = std::make_shared<Material>();
+
+    material->set_name("generated_material_" + std::to_string(index));
+    material->set_metallic_workflow(true);
+    material->set_double_sided(false);
+    material->set_blend_mode(BLEND_MODE_OPAQUE);
+    material->set_displacement_type(DISPLACEMENT_NONE);
+    material->set_shading_model(SHADING_MODEL_STANDARD);
+    material->set_lighting_model(LIGHTING_MODEL_LIT);
+    material->set_uniform_albedo(glm::vec4(dis(gen), dis(gen), dis(gen), 1.0f));
+    material->set_uniform_emissive(glm::vec3(0.0f));
+    material->set_uniform_metallic(dis(gen) < 0.3f ? 1.0f : 0.0f);
+    material->set_uniform_roughness(0.1f + 0.9f * dis(gen));
+
+    // Same keys as a material without textures or custom shader functions loaded by the resource manager.
+    VertexShaderKey   vs_key;
+    FragmentShaderKey fs_key;
+
+    vs_key.set_normal_texture(0);
+    vs_key.set_vertex_func_id(1023);
+
+    fs_key.set_normal_texture(0);
+    fs_key.set_fragment_func_id(1023);
+    fs_key.set_displacement_type(DISPLACEMENT_NONE);
+    fs_key.set_alpha_cutout(0);
+    fs_key.set_lighting_model(LIGHTING_MODEL_LIT);
+    fs_key.set_shading_model(SHADING_MODEL_STANDARD);
+    fs_key.set_albedo_texture(0);
+    fs_key.set_roughness_texture(0);
+    fs_key.set_metallic_texture(0);
+    fs_key.set_emissive_texture(0);
+    fs_key.set_metallic_workflow(1);
+    fs_key.set_custom_texture_count(0);
+
+    material->set_vs_key(vs_key);
+    material->set_fs_key(fs_key);
+    material->set_program_key(ProgramKey(vs_key, fs_key));
+
+    return material;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// A stack of boxes of random size, one per submesh.
+static std::shared_ptr<Mesh> create_mesh(uint32_t index, const std::vector<std::shared_ptr<Material>>& materials, uint32_t submesh_count, std::mt19937& gen)
+{
+    std::uniform_real_distribution<float> size(0.5f, 4.0f);
+    std::uniform_int_distribution<size_t> material(0, materials.size() - 1);
+
+    std::vector<ast::Vertex> vertices;
+    std::vector<uint32_t>    indices;
+    std::vector<SubMesh>     submeshes(submesh_count);
+
+    glm::vec3 min_extents = glm::vec3(FLT_MAX);
+    glm::vec3 max_extents = glm::vec3(-FLT_MAX);
+    float     base        = 0.0f;
+
+    for (uint32_t i = 0; i < submesh_count; i++)
+    {
+        glm::vec3 half   = glm::vec3(size(gen), size(gen), size(gen)) * 0.5f;
+        glm::vec3 center = glm::vec3(0.0f, base + half.y, 0.0f);
+
+        SubMesh& submesh = submeshes[i];
+
+        submesh.index_count = 36;
+        submesh.base_vertex = uint32_t(vertices.size());
+        submesh.base_index  = uint32_t(indices.size());
+        submesh.min_extents = center - half;
+        submesh.max_extents = center + half;
+        submesh.material    = materials[material(gen)];
+
+        for (uint32_t f = 0; f < 6; f++)
+        {
+            const glm::vec3& n = kFaces[f][0];
+            const glm::vec3& t = kFaces[f][1];
+            const glm::vec3& b = kFaces[f][2];
+
+            const glm::vec2 corners[4] = { glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, -1.0f), glm::vec2(1.0f, 1.0f), glm::vec2(-1.0f, 1.0f) };
+
+            // Indices are relative to the base vertex of the submesh.
+            uint32_t first = uint32_t(vertices.size()) - submesh.base_vertex;
+
+            for (uint32_t c = 0; c < 4; c++)
+            {
+                ast::Vertex v;
+
+                v.position  = center + (n + t * corners[c].x + b * corners[c].y) * half;
+                v.tex_coord = corners[c] * 0.5f + glm::vec2(0.5f);
+                v.normal    = n;
+                v.tangent   = t;
+                v.bitangent = b;
+
+                vertices.push_back(v);
+            }
+
+            const uint32_t quad[6] = { 0, 1, 2, 0, 2, 3 };
+
+            for (uint32_t q = 0; q < 6; q++)
+                indices.push_back(first + quad[q]);
+        }
+
+        min_extents = glm::min(min_extents, submesh.min_extents);
+        max_extents = glm::max(max_extents, submesh.max_extents);
+        base += half.y * 2.0f;
+    }
+
+    std::shared_ptr<VertexBuffer> vbo = std::make_shared<VertexBuffer>(GL_STATIC_DRAW, sizeof(ast::Vertex) * vertices.size(), (void*)&vertices[0]);
+    std::shared_ptr<IndexBuffer>  ibo = std::make_shared<IndexBuffer>(GL_STATIC_DRAW, sizeof(uint32_t) * indices.size(), (void*)&indices[0]);
+
+    // Same layout as the meshes loaded by the resource manager.
+    VertexAttrib attribs[] = {
+        { 3, GL_FLOAT, false, 0 },
+        { 2, GL_FLOAT, false, offsetof(ast::Vertex, tex_coord) },
+        { 3, GL_FLOAT, false, offsetof(ast::Vertex, normal) },
+        { 3, GL_FLOAT, false, offsetof(ast::Vertex, tangent) },
+        { 3, GL_FLOAT, false, offsetof(ast::Vertex, bitangent) }
+    };
+
+    std::shared_ptr<VertexArray> vao = std::make_shared<VertexArray>(vbo.get(), ibo.get(), sizeof(ast::Vertex), 5, attribs);
+
+    return std::make_shared<Mesh>("generated_mesh_" + std::to_string(index), max_extents, min_extents, submeshes, vbo, ibo, vao);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static uint32_t clamp_count(uint32_t count, uint32_t max, const char* name)
+{
+    if (count <= max)
+        return count;
+
+    NIMBLE_LOG_WARNING("Generated scene is limited to " + std::to_string(max) + " " + name + ", " + std::to_string(count) + " were requested");
+
+    return max;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// Shadow casters are also bounded by the number of lights of their type, which is not worth a warning.
+void clamp(Settings& settings)
+{
+    settings.entity_count               = clamp_count(settings.entity_count, MAX_ENTITIES, "entities");
+    settings.point_light_count          = clamp_count(settings.point_light_count, MAX_POINT_LIGHTS, "point lights");
+    settings.spot_light_count           = clamp_count(settings.spot_light_count, MAX_SPOT_LIGHTS, "spot lights");
+    settings.directional_light_count    = clamp_count(settings.directional_light_count, MAX_DIRECTIONAL_LIGHTS, "directional lights");
+    settings.point_shadow_casters       = std::min(clamp_count(settings.point_shadow_casters, MAX_SHADOW_CASTING_POINT_LIGHTS, "point shadow casters"), settings.point_light_count);
+    settings.spot_shadow_casters        = std::min(clamp_count(settings.spot_shadow_casters, MAX_SHADOW_CASTING_SPOT_LIGHTS, "spot shadow casters"), settings.spot_light_count);
+    settings.directional_shadow_casters = std::min(clamp_count(settings.directional_shadow_casters, MAX_SHADOW_CASTING_DIRECTIONAL_LIGHTS, "directional shadow casters"), settings.directional_light_count);
+    settings.material_count             = std::max(settings.material_count, 1u);
+    settings.submesh_count              = std::max(settings.submesh_count, 1u);
+    settings.instancing_ratio           = glm::clamp(settings.instancing_ratio, 0.0f, 1.0f);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+std::shared_ptr<Scene> generate(const Settings& requested)
+{
+    Settings settings = requested;
+    clamp(settings);
+
+    std::mt19937 gen(settings.seed);
+
+    const uint32_t entity_count      = settings.entity_count;
+    const uint32_t point_light_count = settings.point_light_count;
+    const uint32_t spot_light_count  = settings.spot_light_count;
+    const uint32_t dir_light_count   = settings.directional_light_count;
+    const uint32_t material_count    = settings.material_count;
+    const uint32_t submesh_count     = settings.submesh_count;
+    const uint32_t mesh_count        = std::max(uint32_t(float(entity_count) * (1.0f - settings.instancing_ratio) + 0.5f), 1u);
+
+    const float half_extent = settings.extent * 0.5f;
+
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+    std::uniform_real_distribution<float> dis_xz(-half_extent, half_extent);
+    std::uniform_real_distribution<float> dis_height(2.0f, std::max(settings.extent * 0.1f, 4.0f));
+
+    std::shared_ptr<Scene> scene = std::make_shared<Scene>(describe(settings));
+
+    std::vector<std::shared_ptr<Material>> materials;
+
+    for (uint32_t i = 0; i < material_count; i++)
+        materials.push_back(create_material(i, gen));
+
+    std::vector<std::shared_ptr<Mesh>> meshes;
+
+    for (uint32_t i = 0; i < mesh_count; i++)
+        meshes.push_back(create_mesh(i, materials, submesh_count, gen));
+
+    std::uniform_int_distribution<uint32_t> dis_mesh(0, mesh_count - 1);
+
+    for (uint32_t i = 0; i < entity_count; i++)
+    {
+        Entity::ID id = scene->create_entity("generated_entity_" + std::to_string(i));
+        Entity&    e  = scene->lookup_entity(id);
+
+        // The first entities create the meshes, the rest reuse them.
+        e.mesh      = i < mesh_count ? meshes[i] : meshes[dis_mesh(gen)];
+        e.is_static = dis(gen) < settings.static_ratio;
+
+        float phase = 0.0f;
+        float speed = 0.0f;
+
+        motion(id, phase, speed);
+
+        e.set_position(glm::vec3(dis_xz(gen), 0.0f, dis_xz(gen)));
+        e.set_rotation(glm::vec3(0.0f, e.is_static ? dis(gen) * 360.0f : phase, 0.0f));
+        e.set_scale(glm::vec3(0.5f + 1.5f * dis(gen)));
+        e.transform.update();
+
+        e.obb.min      = e.mesh->aabb().min;
+        e.obb.max      = e.mesh->aabb().max;
+        e.obb.position = e.transform.position;
+
+#ifdef ENABLE_SUBMESH_CULLING
+        e.submesh_visibility_flags.resize(e.mesh->submesh_count());
+
+        for (uint32_t j = 0; j < e.mesh->submesh_count(); j++)
+        {
+            SubMesh& submesh = e.mesh->submesh(j);
+
+            Sphere sphere;
+
+            sphere.position = (submesh.min_extents + submesh.max_extents) / 2.0f + e.transform.position;
+            sphere.radius   = glm::length(submesh.max_extents - submesh.min_extents) / 2.0f;
+
+            e.submesh_spheres.push_back(sphere);
+        }
+#endif
+    }
+
+    const float light_range = std::max(settings.extent * 0.1f, 10.0f);
+
+    for (uint32_t i = 0; i < point_light_count; i++)
+        scene->create_point_light(glm::vec3(dis_xz(gen), dis_height(gen), dis_xz(gen)), glm::vec3(dis(gen), dis(gen), dis(gen)), light_range, 10.0f, i < settings.point_shadow_casters);
+
+    for (uint32_t i = 0; i < spot_light_count; i++)
+        scene->create_spot_light(glm::vec3(dis_xz(gen), dis_height(gen), dis_xz(gen)), glm::vec3(-45.0f - dis(gen) * 45.0f, dis(gen) * 360.0f, 0.0f), glm::vec3(dis(gen), dis(gen), dis(gen)), 35.0f, 45.0f, light_range * 2.0f, 10.0f, i < settings.spot_shadow_casters);
+
+    // The first directional light matches the one the editor creates for loaded scenes.
+    for (uint32_t i = 0; i < dir_light_count; i++)
+        scene->create_directional_light(i == 0 ? glm::vec3(45.0f, 0.0f, 0.0f) : glm::vec3(20.0f + dis(gen) * 60.0f, dis(gen) * 360.0f, 0.0f), glm::vec3(1.0f), i == 0 ? 10.0f : 2.0f, i < settings.directional_shadow_casters);
+
+    auto camera = std::make_shared<Camera>(60.0f, 0.1f, 2000.0f, 16.0f / 9.0f, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    camera->set_position(glm::vec3(0.0f, settings.extent * 0.1f, half_extent));
+
+    scene->set_camera(camera);
+    scene->set_environment_map(std::make_shared<TextureCube>(ENVIRONMENT_MAP_SIZE, ENVIRONMENT_MAP_SIZE, 1, 1, GL_RGB16F, GL_RGB, GL_HALF_FLOAT, false));
+
+    NIMBLE_LOG_INFO("Generated scene " + scene->name() + ": " + std::to_string(entity_count) + " entities, " + std::to_string(mesh_count) + " meshes, " + std::to_string(material_count) + " materials, " + std::to_string(point_light_count + spot_light_count + dir_light_count) + " lights");
+
+    return scene;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void animate(Scene* scene, float time)
+{
+    Entity* entities = scene->entities();
+
+    for (uint32_t i = 0; i < scene->entity_count(); i++)
+    {
+        Entity& e = entities[i];
+
+        if (e.is_static)
+            continue;
+
+        float phase = 0.0f;
+        float speed = 0.0f;
+
+        motion(e.id, phase, speed);
+
+        e.set_rotation(glm::vec3(0.0f, fmodf(phase + speed * time, 360.0f), 0.0f));
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+// --generate builds a scene instead of loading one. --gen-seed <n>, --gen-entities <n>, --gen-instancing <0-1>, --gen-static <0-1>,
+// --gen-materials <n>, --gen-submeshes <n>, --gen-point-lights <n>, --gen-spot-lights <n>, --gen-directional-lights <n>,
+// --gen-point-shadows <n>, --gen-spot-shadows <n>, --gen-directional-shadows <n> and --gen-extent <units> override the defaults.
+bool parse_arguments(int argc, const char* argv[], Settings& settings)
+{
+    bool requested = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--generate") == 0)
+            requested = true;
+        else if (i + 1 < argc)
+        {
+            if (strcmp(argv[i], "--gen-seed") == 0)
+                settings.seed = uint32_t(atoi(argv[++i]));
+            else if (strcmp(argv[i], "--gen-entities") == 0)
+                settings.entity_count = uint32_t(atoi(argv[++i]));
+            else if (strcmp(argv[i], "--gen-instancing") == 0)
+                settings.instancing_ratio = float(atof(argv[++i]));
+            else if (strcmp(argv[i], "--gen-static") == 0)
+                settings.static_ratio = float(atof(argv[++i]));
+            else if (strcmp(argv[i], "--gen-materials") == 0)
+                settings.material_count = uint32_t(atoi(argv[++i]));
+            else if (strcmp(argv[i], "--gen-submeshes") == 0)
+                settings.submesh_count = uint32_t(atoi(argv[++i]));
+            else if (strcmp(argv[i], "--gen-point-lights") == 0)
+                settings.point_light_count = uint32_t(atoi(argv[++i]));
+            else if (strcmp(argv[i], "--gen-spot-lights") == 0)
+                settings.spot_light_count = uint32_t(atoi(argv[++i]));
+            else if (strcmp(argv[i], "--gen-directional-lights") == 0)
+                settings.directional_light_count = uint32_t(atoi(argv[++i]));
+            else if (strcmp(argv[i], "--gen-point-shadows") == 0)
+                settings.point_shadow_casters = uint32_t(atoi(argv[++i]));
+            else if (strcmp(argv[i], "--gen-spot-shadows") == 0)
+                settings.spot_shadow_casters = uint32_t(atoi(argv[++i]));
+            else if (strcmp(argv[i], "--gen-directional-shadows") == 0)
+                settings.directional_shadow_casters = uint32_t(atoi(argv[++i]));
+            else if (strcmp(argv[i], "--gen-extent") == 0)
+                settings.extent = float(atof(argv[++i]));
+        }
+    }
+
+    if (requested)
+        clamp(settings);
+
+    return requested;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+std::string describe(const Settings& settings)
+{
+    char buffer[256];
+
+    snprintf(buffer, sizeof(buffer), "generated(seed=%u,entities=%u,instancing=%.2f,static=%.2f,materials=%u,submeshes=%u,lights=%u/%u/%u,shadows=%u/%u/%u,extent=%.0f)",
+             settings.seed,
+             settings.entity_count,
+             settings.instancing_ratio,
+             settings.static_ratio,
+             settings.material_count,
+             settings.submesh_count,
+             settings.point_light_count,
+             settings.spot_light_count,
+             settings.directional_light_count,
+             settings.point_shadow_casters,
+             settings.spot_shadow_casters,
+             settings.directional_shadow_casters,
+             settings.extent);
+
+    return buffer;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace scene_generator
+} // namespace nimble
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+// Builds synthetic scenes from a seed and a handful of parameters so that the renderer can be pushed towards its limits in a
+// reproducible way. The same settings always produce the same scene. Meshes are boxes generated on the fly and materials are plain
+// constants, so no assets are needed besides the shaders.
+namespace nimble
+{
+class Scene;
+
+namespace scene_generator
+{
+struct Settings
+{
+    uint32_t seed                       = 0;
+    uint32_t entity_count               = 1000;
+    float    instancing_ratio           = 0.9f; // Fraction of entities that share their mesh with another entity.
+    float    static_ratio               = 0.8f; // Fraction of entities that are never moved by animate().
+    uint32_t material_count             = 16;
+    uint32_t submesh_count              = 1; // Submeshes per mesh, each with its own material.
+    uint32_t point_light_count          = 64;
+    uint32_t spot_light_count           = 16;
+    uint32_t directional_light_count    = 1;
+    uint32_t point_shadow_casters       = 0;
+    uint32_t spot_shadow_casters        = 0;
+    uint32_t directional_shadow_casters = 1;
+    float    extent                     = 500.0f; // Side length of the square the scene is spread over.
+};
+
+// Clamps the counts to the capacity of the scene containers (MAX_ENTITIES and the per-type light limits) and the shadow casters to
+// the number of shadow maps (MAX_SHADOW_CASTING_*_LIGHTS), logging a warning for every count that is reduced.
+extern void clamp(Settings& settings);
+
+// Applies clamp() to a copy of the settings. Requires a current GL context for the mesh buffers and the environment map.
+extern std::shared_ptr<Scene> generate(const Settings& settings);
+
+// Moves the dynamic entities of a generated scene to where they are at the given time in seconds.
+extern void animate(Scene* scene, float time);
+
+// Reads --generate and the --gen-* options. Returns true if a generated scene was requested, in which case the settings have been
+// clamped so that they describe the scene that will actually be generated.
+extern bool parse_arguments(int argc, const char* argv[], Settings& settings);
+
+// Short description of the settings, used as the scene name and in reports.
+extern std::string describe(const Settings& settings);
+} // namespace scene_generator
+} // namespace nimble
\ No newline at end of file
@@ -1,7 +1,7 @@
 #include <depth_conversion.glsl>
 #include <normal_packing.glsl>
 
-#define UNJITTER_TEX_COORDS(tc) (tc - current_prev_jitter.xy)
+#define UNJITTER_TEX_COORDS(tc) (tc - current_prev_jitter.xy * 0.5)
 
 // ------------------------------------------------------------------
 // HELPER FUNCTIONS -------------------------------------------------
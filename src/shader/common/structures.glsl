@@ -45,6 +45,15 @@ struct DirectionalLightData
 
 // ------------------------------------------------------------------
 
+struct MaterialData
+{
+	vec4 albedo;
+	vec4 emissive;
+	vec4 metalness_roughness;
+};
+
+// ------------------------------------------------------------------
+
 struct VertexProperties
 {
 	vec3 Position;
@@ -93,16 +93,25 @@ layout (std140) uniform u_PerSkeleton
     uniform sampler2D s_Emissive;
 #endif
 
+#if defined(UNIFORM_ALBEDO) || defined(UNIFORM_METAL_SPEC) || defined(UNIFORM_ROUGH_SMOOTH) || defined(UNIFORM_EMISSIVE)
+	layout(std430, binding = 3) readonly buffer u_PerMaterial
+	{
+		MaterialData materials[];
+	};
+
+	uniform int u_MaterialIndex;
+#endif
+
 #ifdef UNIFORM_ALBEDO
-	vec4 u_Albedo;
+	#define u_Albedo materials[u_MaterialIndex].albedo
 #endif
 
 #if defined(UNIFORM_METAL_SPEC) || defined(UNIFORM_ROUGH_SMOOTH)
-	vec4 u_MetalRough;
+	#define u_MetalRough materials[u_MaterialIndex].metalness_roughness
 #endif
 
 #ifdef UNIFORM_EMISSIVE
-	vec4 u_Emissive;
+	#define u_Emissive materials[u_MaterialIndex].emissive
 #endif
 
 #ifdef DIRECTIONAL_LIGHT_SHADOW_MAPPING
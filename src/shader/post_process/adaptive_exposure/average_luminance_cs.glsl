@@ -1,46 +1,56 @@
 #include <../../common/uniforms.glsl>
 #include <../../common/helper.glsl>
 
-// Average Luminance Compute Shader based off:
-// https://software.intel.com/en-us/articles/hdr-rendering-with-compute-shader-sample
-
 // ------------------------------------------------------------------
 // DEFINES ----------------------------------------------------------
 // ------------------------------------------------------------------
 
-#define LUM_THREADS 8
-#define AVG_LUM_THREADS 8
-#define DELTA 0.00000001
+#define HISTOGRAM_BIN_COUNT 256
 
 // ------------------------------------------------------------------
 // INPUTS -----------------------------------------------------------
 // ------------------------------------------------------------------
 
-layout (local_size_x = AVG_LUM_THREADS, local_size_y = 1) in;
+layout (local_size_x = HISTOGRAM_BIN_COUNT, local_size_y = 1) in;
+
+layout (std430, binding = 5) buffer u_LuminanceHistogram
+{
+    uint histogram[HISTOGRAM_BIN_COUNT];
+};
 
 // ------------------------------------------------------------------
-// CONSTANTS --------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
 // ------------------------------------------------------------------
 
-const int kSize = 512;
+layout (binding = 0, r32f) uniform image2D i_AvgLuma;
 
 // ------------------------------------------------------------------
 // UNIFORMS ---------------------------------------------------------
 // ------------------------------------------------------------------
 
-layout (binding = 0, r32f) uniform image2D i_Luma;
-layout (binding = 1, r32f) uniform image2D i_AvgLuma;
-
 uniform float u_MiddleGrey;
 uniform float u_Rate;
 uniform float u_Delta;
 uniform int u_First;
+uniform float u_MinLogLuma;
+uniform float u_LogLumaRange;
+uniform float u_LowPercentile;
+uniform float u_HighPercentile;
 
 // ------------------------------------------------------------------
 // GLOBALS ----------------------------------------------------------
 // ------------------------------------------------------------------
 
-shared float avg_temp[AVG_LUM_THREADS];
+shared float counts[HISTOGRAM_BIN_COUNT];
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+float bin_log_luminance(uint bin)
+{
+    return u_MinLogLuma + ((float(bin) - 0.5) / float(HISTOGRAM_BIN_COUNT - 2)) * u_LogLumaRange;
+}
 
 // ------------------------------------------------------------------
 // MAIN -------------------------------------------------------------
@@ -48,36 +58,63 @@ shared float avg_temp[AVG_LUM_THREADS];
 
 void main()
 {
-	float total_luminance = 0.0;
-	
-	for(uint i = 0; i < kSize/(LUM_THREADS * AVG_LUM_THREADS); i++)
-	{
-		for(uint j = 0; j < kSize/16; j++)
-			total_luminance += imageLoad(i_Luma, ivec2(gl_GlobalInvocationID.x + AVG_LUM_THREADS * i, j)).x;
-	}
+    uint bin = gl_LocalInvocationIndex;
 
-	avg_temp[gl_GlobalInvocationID.x] = total_luminance;
-	
-	groupMemoryBarrier();
-	barrier();
+    counts[bin] = float(histogram[bin]);
 
-	if (gl_GlobalInvocationID.x == 0)
-	{
-		for(uint i = 1; i < AVG_LUM_THREADS; i++)
-			total_luminance += avg_temp[i];
+    // Clear the histogram for the next frame.
+    histogram[bin] = 0;
 
-		float luminance = total_luminance / ((kSize / AVG_LUM_THREADS) * (kSize / AVG_LUM_THREADS));
+    memoryBarrierShared();
+    barrier();
 
-		float current_exposure = u_MiddleGrey / (exp(luminance) - DELTA);
-		float prev_exposure = imageLoad(i_AvgLuma, ivec2(0, 0)).x;
+    if (bin == 0)
+    {
+        // Bin 0 holds the black pixels and does not take part in the average.
+        float total = 0.0;
 
-		if (u_First == 1)
-			prev_exposure = current_exposure;
+        for (uint i = 1; i < HISTOGRAM_BIN_COUNT; i++)
+            total += counts[i];
 
-		float adapted_exposure = prev_exposure + (current_exposure - prev_exposure) * (1 - exp(-u_Delta * u_Rate));
+        // Skip the darkest and brightest pixels so that small highlights cannot dominate the result.
+        float low    = total * u_LowPercentile;
+        float high   = total * u_HighPercentile;
+        float sum    = 0.0;
+        float weight = 0.0;
 
-		imageStore(i_AvgLuma, ivec2(0, 0), vec4(adapted_exposure, 0, 0, 0));
-	}
+        for (uint i = 1; i < HISTOGRAM_BIN_COUNT; i++)
+        {
+            float count = counts[i];
+
+            float skipped = min(count, low);
+            count -= skipped;
+            low -= skipped;
+            high -= skipped;
+
+            count = min(count, high);
+            high -= count;
+
+            sum += count * bin_log_luminance(i);
+            weight += count;
+        }
+
+        float prev_exposure = imageLoad(i_AvgLuma, ivec2(0, 0)).x;
+
+        if (weight > 0.0)
+        {
+            float luminance        = exp2(sum / weight);
+            float current_exposure = u_MiddleGrey / luminance;
+
+            if (u_First == 1)
+                prev_exposure = current_exposure;
+
+            float adapted_exposure = prev_exposure + (current_exposure - prev_exposure) * (1 - exp(-u_Delta * u_Rate));
+
+            imageStore(i_AvgLuma, ivec2(0, 0), vec4(adapted_exposure, 0, 0, 0));
+        }
+        else if (u_First == 1)
+            imageStore(i_AvgLuma, ivec2(0, 0), vec4(1.0, 0, 0, 0));
+    }
 }
 
-// ------------------------------------------------------------------
\ No newline at end of file
+// ------------------------------------------------------------------
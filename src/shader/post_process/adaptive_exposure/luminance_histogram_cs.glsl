@@ -0,0 +1,89 @@
+#include <../../common/uniforms.glsl>
+#include <../../common/helper.glsl>
+
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Every thread takes one bilinear sample at the center of a 2x2 quad of the color buffer, so the histogram is built over a half
+// resolution view of the image without writing it anywhere. Bin 0 collects black pixels, everything else is clamped into the range.
+
+#define HISTOGRAM_THREADS 16
+#define HISTOGRAM_BIN_COUNT 256
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = HISTOGRAM_THREADS, local_size_y = HISTOGRAM_THREADS) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (std430, binding = 5) buffer u_LuminanceHistogram
+{
+    uint histogram[HISTOGRAM_BIN_COUNT];
+};
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_Color;
+uniform vec2 u_Size; // Size of the color buffer
+uniform float u_MinLogLuma;
+uniform float u_InvLogLumaRange;
+
+// ------------------------------------------------------------------
+// GLOBALS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+shared uint histogram_shared[HISTOGRAM_BIN_COUNT];
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+uint luminance_bin(vec3 color)
+{
+    float luma = dot(color, vec3(0.299, 0.587, 0.114));
+
+    if (luma < 0.0001)
+        return 0;
+
+    float t = clamp((log2(luma) - u_MinLogLuma) * u_InvLogLumaRange, 0.0, 1.0);
+
+    return uint(t * float(HISTOGRAM_BIN_COUNT - 2) + 1.0);
+}
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    histogram_shared[gl_LocalInvocationIndex] = 0;
+
+    memoryBarrierShared();
+    barrier();
+
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy) * 2;
+
+    if (all(lessThan(coord, ivec2(u_Size))))
+    {
+        vec3 color = textureLod(s_Color, (vec2(coord) + 1.0) / u_Size, 0.0).rgb;
+        atomicAdd(histogram_shared[luminance_bin(color)], 1);
+    }
+
+    memoryBarrierShared();
+    barrier();
+
+    // One global atomic per bin and work group instead of one per pixel.
+    uint count = histogram_shared[gl_LocalInvocationIndex];
+
+    if (count > 0)
+        atomicAdd(histogram[gl_LocalInvocationIndex], count);
+}
+
+// ------------------------------------------------------------------
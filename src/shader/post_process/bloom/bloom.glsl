@@ -0,0 +1,51 @@
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+// 13-tap downsample made of overlapping bilinear fetches. 'texel_size' is the size of a destination texel.
+vec3 bloom_downsample(sampler2D s, vec2 uv, vec2 texel_size)
+{
+    vec2 half_pixel = 0.5 * texel_size;
+    vec2 one_pixel  = texel_size;
+
+    vec3 sum = (4.0 / 32.0) * textureLod(s, uv, 0.0).rgb;
+
+    sum += (4.0 / 32.0) * textureLod(s, uv + vec2(-half_pixel.x, -half_pixel.y), 0.0).rgb;
+    sum += (4.0 / 32.0) * textureLod(s, uv + vec2(+half_pixel.x, +half_pixel.y), 0.0).rgb;
+    sum += (4.0 / 32.0) * textureLod(s, uv + vec2(+half_pixel.x, -half_pixel.y), 0.0).rgb;
+    sum += (4.0 / 32.0) * textureLod(s, uv + vec2(-half_pixel.x, +half_pixel.y), 0.0).rgb;
+
+    sum += (2.0 / 32.0) * textureLod(s, uv + vec2(+one_pixel.x, 0.0), 0.0).rgb;
+    sum += (2.0 / 32.0) * textureLod(s, uv + vec2(-one_pixel.x, 0.0), 0.0).rgb;
+    sum += (2.0 / 32.0) * textureLod(s, uv + vec2(0.0, +one_pixel.y), 0.0).rgb;
+    sum += (2.0 / 32.0) * textureLod(s, uv + vec2(0.0, -one_pixel.y), 0.0).rgb;
+
+    sum += (1.0 / 32.0) * textureLod(s, uv + vec2(+one_pixel.x, +one_pixel.y), 0.0).rgb;
+    sum += (1.0 / 32.0) * textureLod(s, uv + vec2(-one_pixel.x, +one_pixel.y), 0.0).rgb;
+    sum += (1.0 / 32.0) * textureLod(s, uv + vec2(+one_pixel.x, -one_pixel.y), 0.0).rgb;
+    sum += (1.0 / 32.0) * textureLod(s, uv + vec2(-one_pixel.x, -one_pixel.y), 0.0).rgb;
+
+    return sum;
+}
+
+// ------------------------------------------------------------------
+
+// 3x3 tent filter over mip 'lod'. 'texel_size' is the size of a destination texel.
+vec3 bloom_upsample(sampler2D s, vec2 uv, float lod, vec2 texel_size)
+{
+    vec3 sum = (4.0 / 16.0) * textureLod(s, uv, lod).rgb;
+
+    sum += (2.0 / 16.0) * textureLod(s, uv + vec2(-texel_size.x, 0.0), lod).rgb;
+    sum += (2.0 / 16.0) * textureLod(s, uv + vec2(0.0, texel_size.y), lod).rgb;
+    sum += (2.0 / 16.0) * textureLod(s, uv + vec2(texel_size.x, 0.0), lod).rgb;
+    sum += (2.0 / 16.0) * textureLod(s, uv + vec2(0.0, -texel_size.y), lod).rgb;
+
+    sum += (1.0 / 16.0) * textureLod(s, uv + vec2(-texel_size.x, -texel_size.y), lod).rgb;
+    sum += (1.0 / 16.0) * textureLod(s, uv + vec2(-texel_size.x, texel_size.y), lod).rgb;
+    sum += (1.0 / 16.0) * textureLod(s, uv + vec2(texel_size.x, -texel_size.y), lod).rgb;
+    sum += (1.0 / 16.0) * textureLod(s, uv + vec2(texel_size.x, texel_size.y), lod).rgb;
+
+    return sum;
+}
+
+// ------------------------------------------------------------------
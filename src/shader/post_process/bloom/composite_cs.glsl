@@ -0,0 +1,49 @@
+#include <bloom.glsl>
+
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+#define BLOOM_COMPOSITE_NUM_THREADS 8
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = BLOOM_COMPOSITE_NUM_THREADS, local_size_y = BLOOM_COMPOSITE_NUM_THREADS) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (binding = 0, rgba16f) writeonly uniform image2D i_Composite;
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_Color;
+uniform sampler2D s_Chain;
+uniform float u_Strength;
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    ivec2 size  = imageSize(i_Composite);
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+
+    if (any(greaterThanEqual(coord, size)))
+        return;
+
+    // The last upsample step is folded into the composite, so mip 0 of the chain is tent filtered straight to full resolution.
+    vec2 texel_size = 1.0 / vec2(size);
+    vec4 color      = texelFetch(s_Color, coord, 0);
+    vec3 bloom      = bloom_upsample(s_Chain, (vec2(coord) + 0.5) * texel_size, 0.0, texel_size);
+
+    imageStore(i_Composite, coord, vec4(color.rgb + bloom * u_Strength, color.a));
+}
+
+// ------------------------------------------------------------------
@@ -0,0 +1,123 @@
+#include <../../common/uniforms.glsl>
+#include <../../common/helper.glsl>
+#include <bloom.glsl>
+
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Every work group filters a 32x32 tile of the first bloom mip straight from the color buffer and then box-reduces it in shared
+// memory, writing one mip of the chain per step. Tiles never read their neighbours so the whole chain is built in one dispatch.
+
+#define BLOOM_NUM_THREADS 16
+#define BLOOM_TILE_SIZE 32
+#define BLOOM_MAX_CHAIN_SIZE 6
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = BLOOM_NUM_THREADS, local_size_y = BLOOM_NUM_THREADS) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Image i holds mip level i of the chain.
+layout (binding = 0, r11f_g11f_b10f) writeonly uniform image2D i_Chain[BLOOM_MAX_CHAIN_SIZE];
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_Color;
+uniform float u_Threshold;
+uniform int u_ChainLength;
+
+// ------------------------------------------------------------------
+// GLOBALS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+shared vec3 tile[BLOOM_TILE_SIZE * BLOOM_TILE_SIZE];
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+vec3 bright_pass(vec3 color)
+{
+    float luma = luminance(color);
+    luma = max(0.0, luma - u_Threshold);
+    return color * sign(luma);
+}
+
+// ------------------------------------------------------------------
+
+vec3 tile_texel(ivec2 coord)
+{
+    return tile[coord.y * BLOOM_TILE_SIZE + coord.x];
+}
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    ivec2 chain_size  = imageSize(i_Chain[0]);
+    ivec2 tile_origin = ivec2(gl_WorkGroupID.xy) * BLOOM_TILE_SIZE;
+    vec2  texel_size  = 1.0 / vec2(chain_size);
+
+    // Each thread filters a 2x2 quad of the first mip. The threshold is applied after filtering so the color buffer is read once.
+    for (int i = 0; i < 4; i++)
+    {
+        ivec2 local = ivec2(gl_LocalInvocationID.xy) * 2 + ivec2(i & 1, i >> 1);
+        ivec2 coord = tile_origin + local;
+
+        vec3 color = bright_pass(bloom_downsample(s_Color, (vec2(coord) + 0.5) * texel_size, texel_size));
+
+        tile[local.y * BLOOM_TILE_SIZE + local.x] = color;
+
+        if (all(lessThan(coord, chain_size)))
+            imageStore(i_Chain[0], coord, vec4(color, 1.0));
+    }
+
+    memoryBarrierShared();
+    barrier();
+
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+    int   size  = BLOOM_TILE_SIZE;
+
+    for (int level = 1; level < u_ChainLength; level++)
+    {
+        size /= 2;
+
+        bool active = all(lessThan(local, ivec2(size)));
+        vec3 color  = vec3(0.0);
+
+        if (active)
+        {
+            ivec2 src = local * 2;
+            color     = 0.25 * (tile_texel(src) + tile_texel(src + ivec2(1, 0)) + tile_texel(src + ivec2(0, 1)) + tile_texel(src + ivec2(1, 1)));
+        }
+
+        // The reduction happens in place, so every read of the previous level has to finish before it is overwritten.
+        memoryBarrierShared();
+        barrier();
+
+        if (active)
+        {
+            tile[local.y * BLOOM_TILE_SIZE + local.x] = color;
+
+            ivec2 coord = (tile_origin >> level) + local;
+
+            if (all(lessThan(coord, imageSize(i_Chain[level]))))
+                imageStore(i_Chain[level], coord, vec4(color, 1.0));
+        }
+
+        memoryBarrierShared();
+        barrier();
+    }
+}
+
+// ------------------------------------------------------------------
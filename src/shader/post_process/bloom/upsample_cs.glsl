@@ -0,0 +1,49 @@
+#include <bloom.glsl>
+
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+#define BLOOM_UPSAMPLE_NUM_THREADS 8
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = BLOOM_UPSAMPLE_NUM_THREADS, local_size_y = BLOOM_UPSAMPLE_NUM_THREADS) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Mip level (u_SourceLevel - 1) of the chain. The tent filtered source level is accumulated into it.
+layout (binding = 0, r11f_g11f_b10f) uniform image2D i_Destination;
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_Chain;
+uniform float u_SourceLevel;
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    ivec2 size  = imageSize(i_Destination);
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+
+    if (any(greaterThanEqual(coord, size)))
+        return;
+
+    vec2 texel_size = 1.0 / vec2(size);
+    vec3 color      = imageLoad(i_Destination, coord).rgb;
+
+    color += bloom_upsample(s_Chain, (vec2(coord) + 0.5) * texel_size, u_SourceLevel, texel_size);
+
+    imageStore(i_Destination, coord, vec4(color, 1.0));
+}
+
+// ------------------------------------------------------------------
@@ -1,5 +1,6 @@
 #include <../../common/uniforms.glsl>
 #include <../../common/helper.glsl>
+#include <dof.glsl>
 
 // ------------------------------------------------------------------
 // INPUT VARIABLES  -------------------------------------------------
@@ -28,26 +29,6 @@ void main()
 {
 	float z = texture(s_Depth, FS_IN_TexCoord).x;
 	float depth = linear_eye_depth(z);
-	
-	// Calculate Near CoC
-	float nearCOC = 0.0;
-
-	if (depth < u_NearEnd)
-		nearCOC = 1.0 / (u_NearBegin - u_NearEnd) * depth + -u_NearEnd / (u_NearBegin - u_NearEnd);
-	else if (depth < u_NearBegin)
-		nearCOC = 1.0;
-
-	nearCOC = clamp(nearCOC, 0.0, 1.0);
-	
-	// Calculate Far CoC
-	float farCOC = 1.0;
-
-	if (depth < u_FarBegin)
-		farCOC = 0.0;
-	else if (depth < u_FarEnd)
-		farCOC = 1.0 / (u_FarEnd - u_FarBegin) * depth + -u_FarBegin / (u_FarEnd - u_FarBegin);
-
-	farCOC = clamp(farCOC, 0.0, 1.0);
- 
-	FS_OUT_FragColor = vec2(nearCOC, farCOC);
+
+	FS_OUT_FragColor = circle_of_confusion(depth, vec4(u_NearBegin, u_NearEnd, u_FarBegin, u_FarEnd));
 }
\ No newline at end of file
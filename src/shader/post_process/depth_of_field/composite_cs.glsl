@@ -0,0 +1,102 @@
+#include <../../common/uniforms.glsl>
+#include <../../common/helper.glsl>
+#include <dof.glsl>
+
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+#define DOF_COMPOSITE_NUM_THREADS 8
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = DOF_COMPOSITE_NUM_THREADS, local_size_y = DOF_COMPOSITE_NUM_THREADS) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (binding = 0, rgba16f) writeonly uniform image2D i_Composite;
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_Color;
+uniform sampler2D s_Depth;
+uniform sampler2D s_NearDoF4;
+uniform sampler2D s_FarDoF4;
+uniform sampler2D s_CoC4;
+uniform sampler2D s_Tiles;
+
+uniform vec4  u_FocalPlanes;
+uniform float u_Blend;
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Bilinear upsample of the far field that ignores half resolution texels without a far CoC, which would otherwise pull in-focus
+// colors into the blur.
+vec3 far_field_upsample(vec2 tex_coord)
+{
+    ivec2 half_size = textureSize(s_FarDoF4, 0);
+    vec2  position  = tex_coord * vec2(half_size) - 0.5;
+    ivec2 base      = ivec2(floor(position));
+    vec2  f         = fract(position);
+
+    vec4 bilinear = vec4((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y);
+
+    vec3  result      = vec3(0.0);
+    float weights_sum = 0.0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        ivec2 sample_coord = clamp(base + ivec2(i & 1, i >> 1), ivec2(0), half_size - 1);
+        float weight       = bilinear[i] * texelFetch(s_CoC4, sample_coord, 0).y;
+
+        result += texelFetch(s_FarDoF4, sample_coord, 0).rgb * weight;
+        weights_sum += weight;
+    }
+
+    return weights_sum > 0.0001 ? result / weights_sum : texture(s_FarDoF4, tex_coord).rgb;
+}
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    ivec2 size  = imageSize(i_Composite);
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+
+    if (any(greaterThanEqual(coord, size)))
+        return;
+
+    vec4 color = texelFetch(s_Color, coord, 0);
+    vec4 tile  = texelFetch(s_Tiles, coord / (2 * DOF_TILE_SIZE), 0);
+
+    if (is_tile_in_focus(tile))
+    {
+        imageStore(i_Composite, coord, color);
+        return;
+    }
+
+    vec2  tex_coord = (vec2(coord) + 0.5) / vec2(size);
+    float coc_far   = circle_of_confusion(linear_eye_depth(texelFetch(s_Depth, coord, 0).x), u_FocalPlanes).y;
+    vec3  result    = color.rgb;
+
+    if (coc_far > 0.0)
+        result = mix(result, far_field_upsample(tex_coord), u_Blend * coc_far);
+
+    vec4 near = texture(s_NearDoF4, tex_coord);
+
+    result = mix(result, near.rgb, u_Blend * near.a);
+
+    imageStore(i_Composite, coord, vec4(result, color.a));
+}
+
+// ------------------------------------------------------------------
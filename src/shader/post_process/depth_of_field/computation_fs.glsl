@@ -1,3 +1,5 @@
+#include <dof.glsl>
+
 // ------------------------------------------------------------------
 // INPUT VARIABLES  -------------------------------------------------
 // ------------------------------------------------------------------
@@ -23,64 +25,6 @@ uniform sampler2D s_NearBlurCoC4;
 uniform sampler2D s_Color4;
 uniform sampler2D s_ColorFarCoC4;
 
-// ------------------------------------------------------------------
-// CONSTANTS  -------------------------------------------------------
-// ------------------------------------------------------------------
-
-const vec2 offsets[] =
-{
-	2.0f * vec2(1.000000f, 0.000000f),
-	2.0f * vec2(0.707107f, 0.707107f),
-	2.0f * vec2(-0.000000f, 1.000000f),
-	2.0f * vec2(-0.707107f, 0.707107f),
-	2.0f * vec2(-1.000000f, -0.000000f),
-	2.0f * vec2(-0.707106f, -0.707107f),
-	2.0f * vec2(0.000000f, -1.000000f),
-	2.0f * vec2(0.707107f, -0.707107f),
-	
-	4.0f * vec2(1.000000f, 0.000000f),
-	4.0f * vec2(0.923880f, 0.382683f),
-	4.0f * vec2(0.707107f, 0.707107f),
-	4.0f * vec2(0.382683f, 0.923880f),
-	4.0f * vec2(-0.000000f, 1.000000f),
-	4.0f * vec2(-0.382684f, 0.923879f),
-	4.0f * vec2(-0.707107f, 0.707107f),
-	4.0f * vec2(-0.923880f, 0.382683f),
-	4.0f * vec2(-1.000000f, -0.000000f),
-	4.0f * vec2(-0.923879f, -0.382684f),
-	4.0f * vec2(-0.707106f, -0.707107f),
-	4.0f * vec2(-0.382683f, -0.923880f),
-	4.0f * vec2(0.000000f, -1.000000f),
-	4.0f * vec2(0.382684f, -0.923879f),
-	4.0f * vec2(0.707107f, -0.707107f),
-	4.0f * vec2(0.923880f, -0.382683f),
-
-	6.0f * vec2(1.000000f, 0.000000f),
-	6.0f * vec2(0.965926f, 0.258819f),
-	6.0f * vec2(0.866025f, 0.500000f),
-	6.0f * vec2(0.707107f, 0.707107f),
-	6.0f * vec2(0.500000f, 0.866026f),
-	6.0f * vec2(0.258819f, 0.965926f),
-	6.0f * vec2(-0.000000f, 1.000000f),
-	6.0f * vec2(-0.258819f, 0.965926f),
-	6.0f * vec2(-0.500000f, 0.866025f),
-	6.0f * vec2(-0.707107f, 0.707107f),
-	6.0f * vec2(-0.866026f, 0.500000f),
-	6.0f * vec2(-0.965926f, 0.258819f),
-	6.0f * vec2(-1.000000f, -0.000000f),
-	6.0f * vec2(-0.965926f, -0.258820f),
-	6.0f * vec2(-0.866025f, -0.500000f),
-	6.0f * vec2(-0.707106f, -0.707107f),
-	6.0f * vec2(-0.499999f, -0.866026f),
-	6.0f * vec2(-0.258819f, -0.965926f),
-	6.0f * vec2(0.000000f, -1.000000f),
-	6.0f * vec2(0.258819f, -0.965926f),
-	6.0f * vec2(0.500000f, -0.866025f),
-	6.0f * vec2(0.707107f, -0.707107f),
-	6.0f * vec2(0.866026f, -0.499999f),
-	6.0f * vec2(0.965926f, -0.258818f),
-};
-
 // ------------------------------------------------------------------
 // FUNCTIONS  -------------------------------------------------------
 // ------------------------------------------------------------------
@@ -91,7 +35,7 @@ vec3 near_field(vec2 tex_coord)
 	
 	for (int i = 0; i < 48; i++)
 	{
-		vec2 offset = u_KernelSize * offsets[i] * u_PixelSize;
+		vec2 offset = u_KernelSize * kDoFKernelOffsets[i] * u_PixelSize;
 		result += texture(s_Color4, tex_coord + offset).xyz;
 	}
 
@@ -107,7 +51,7 @@ vec3 far_field(vec2 tex_coord)
 	
 	for (int i = 0; i < 48; i++)
 	{
-		vec2 offset = u_KernelSize * offsets[i] * u_PixelSize;
+		vec2 offset = u_KernelSize * kDoFKernelOffsets[i] * u_PixelSize;
 		
 		float coc_sample = texture(s_CoC4, tex_coord + offset).y;
 		vec3 color_sample = texture(s_ColorFarCoC4, tex_coord + offset).xyz;
@@ -0,0 +1,50 @@
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+#define DOF_DILATE_NUM_THREADS 8
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = DOF_DILATE_NUM_THREADS, local_size_y = DOF_DILATE_NUM_THREADS) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (binding = 0, rgba16f) writeonly uniform image2D i_DilatedTiles;
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_Tiles;
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+// The near field bleeds over its neighbours, so the maximum near CoC is spread over the surrounding tiles. The far field only
+// gathers onto pixels that are out of focus themselves and stays as it is.
+void main()
+{
+    ivec2 size  = imageSize(i_DilatedTiles);
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+
+    if (any(greaterThanEqual(coord, size)))
+        return;
+
+    vec4 tile = texelFetch(s_Tiles, coord, 0);
+
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+            tile.x = max(tile.x, texelFetch(s_Tiles, clamp(coord + ivec2(x, y), ivec2(0), size - 1), 0).x);
+    }
+
+    imageStore(i_DilatedTiles, coord, tile);
+}
+
+// ------------------------------------------------------------------
@@ -0,0 +1,101 @@
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Half resolution pixels covered by one tile of the compute path. The largest gather kernel reaches 6 half resolution pixels, so
+// dilating the tiles by one in every direction is enough to find every pixel a near field bokeh can spill onto.
+#define DOF_TILE_SIZE 16
+#define DOF_KERNEL_SAMPLES 48
+
+// ------------------------------------------------------------------
+// CONSTANTS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Three rings of 8, 16 and 24 samples at a radius of 2, 4 and 6 half resolution pixels.
+const vec2 kDoFKernelOffsets[DOF_KERNEL_SAMPLES] =
+{
+	2.0f * vec2(1.000000f, 0.000000f),
+	2.0f * vec2(0.707107f, 0.707107f),
+	2.0f * vec2(-0.000000f, 1.000000f),
+	2.0f * vec2(-0.707107f, 0.707107f),
+	2.0f * vec2(-1.000000f, -0.000000f),
+	2.0f * vec2(-0.707106f, -0.707107f),
+	2.0f * vec2(0.000000f, -1.000000f),
+	2.0f * vec2(0.707107f, -0.707107f),
+	
+	4.0f * vec2(1.000000f, 0.000000f),
+	4.0f * vec2(0.923880f, 0.382683f),
+	4.0f * vec2(0.707107f, 0.707107f),
+	4.0f * vec2(0.382683f, 0.923880f),
+	4.0f * vec2(-0.000000f, 1.000000f),
+	4.0f * vec2(-0.382684f, 0.923879f),
+	4.0f * vec2(-0.707107f, 0.707107f),
+	4.0f * vec2(-0.923880f, 0.382683f),
+	4.0f * vec2(-1.000000f, -0.000000f),
+	4.0f * vec2(-0.923879f, -0.382684f),
+	4.0f * vec2(-0.707106f, -0.707107f),
+	4.0f * vec2(-0.382683f, -0.923880f),
+	4.0f * vec2(0.000000f, -1.000000f),
+	4.0f * vec2(0.382684f, -0.923879f),
+	4.0f * vec2(0.707107f, -0.707107f),
+	4.0f * vec2(0.923880f, -0.382683f),
+
+	6.0f * vec2(1.000000f, 0.000000f),
+	6.0f * vec2(0.965926f, 0.258819f),
+	6.0f * vec2(0.866025f, 0.500000f),
+	6.0f * vec2(0.707107f, 0.707107f),
+	6.0f * vec2(0.500000f, 0.866026f),
+	6.0f * vec2(0.258819f, 0.965926f),
+	6.0f * vec2(-0.000000f, 1.000000f),
+	6.0f * vec2(-0.258819f, 0.965926f),
+	6.0f * vec2(-0.500000f, 0.866025f),
+	6.0f * vec2(-0.707107f, 0.707107f),
+	6.0f * vec2(-0.866026f, 0.500000f),
+	6.0f * vec2(-0.965926f, 0.258819f),
+	6.0f * vec2(-1.000000f, -0.000000f),
+	6.0f * vec2(-0.965926f, -0.258820f),
+	6.0f * vec2(-0.866025f, -0.500000f),
+	6.0f * vec2(-0.707106f, -0.707107f),
+	6.0f * vec2(-0.499999f, -0.866026f),
+	6.0f * vec2(-0.258819f, -0.965926f),
+	6.0f * vec2(0.000000f, -1.000000f),
+	6.0f * vec2(0.258819f, -0.965926f),
+	6.0f * vec2(0.500000f, -0.866025f),
+	6.0f * vec2(0.707107f, -0.707107f),
+	6.0f * vec2(0.866026f, -0.499999f),
+	6.0f * vec2(0.965926f, -0.258818f),
+};
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Near and far CoC from view space depth. The planes are given as (near begin, near end, far begin, far end).
+vec2 circle_of_confusion(float depth, vec4 planes)
+{
+    float near_coc = 0.0;
+
+    if (depth < planes.y)
+        near_coc = 1.0 / (planes.x - planes.y) * depth + -planes.y / (planes.x - planes.y);
+    else if (depth < planes.x)
+        near_coc = 1.0;
+
+    float far_coc = 1.0;
+
+    if (depth < planes.z)
+        far_coc = 0.0;
+    else if (depth < planes.w)
+        far_coc = 1.0 / (planes.w - planes.z) * depth + -planes.z / (planes.w - planes.z);
+
+    return clamp(vec2(near_coc, far_coc), 0.0, 1.0);
+}
+
+// ------------------------------------------------------------------
+
+// Tiles whose dilated near CoC and far CoC are both zero are entirely in focus.
+bool is_tile_in_focus(vec4 tile)
+{
+    return tile.x == 0.0 && tile.y == 0.0;
+}
+
+// ------------------------------------------------------------------
@@ -0,0 +1,144 @@
+#include <dof.glsl>
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = DOF_TILE_SIZE, local_size_y = DOF_TILE_SIZE) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (binding = 0, rgba16f) writeonly uniform image2D i_NearDoF4;
+layout (binding = 1, r11f_g11f_b10f) writeonly uniform image2D i_FarDoF4;
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_Color4;
+uniform sampler2D s_CoC4;
+uniform sampler2D s_Tiles;
+
+uniform vec2  u_PixelSize;
+uniform float u_KernelSize;
+
+// ------------------------------------------------------------------
+// GLOBALS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+shared vec3 near_dof[DOF_TILE_SIZE * DOF_TILE_SIZE];
+shared vec3 far_dof[DOF_TILE_SIZE * DOF_TILE_SIZE];
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Near field color weighted by the near CoC of every sample, with the coverage of the near field in alpha.
+vec4 near_field(vec2 tex_coord)
+{
+    vec3  center      = texture(s_Color4, tex_coord).rgb;
+    float weights_sum = texture(s_CoC4, tex_coord).x;
+    vec3  result      = center * weights_sum;
+
+    for (int i = 0; i < DOF_KERNEL_SAMPLES; i++)
+    {
+        vec2  offset     = u_KernelSize * kDoFKernelOffsets[i] * u_PixelSize;
+        float coc_sample = texture(s_CoC4, tex_coord + offset).x;
+
+        result += texture(s_Color4, tex_coord + offset).rgb * coc_sample;
+        weights_sum += coc_sample;
+    }
+
+    // Pixels half covered by the near field are already fully blurred, which stands in for the max and blur filter of the CoC.
+    float coverage = clamp(2.0 * weights_sum / float(DOF_KERNEL_SAMPLES + 1), 0.0, 1.0);
+
+    return vec4(weights_sum > 0.0 ? result / weights_sum : center, coverage);
+}
+
+// ------------------------------------------------------------------
+
+vec3 far_field(vec2 tex_coord)
+{
+    float weights_sum = texture(s_CoC4, tex_coord).y;
+    vec3  result      = texture(s_Color4, tex_coord).rgb * weights_sum;
+
+    for (int i = 0; i < DOF_KERNEL_SAMPLES; i++)
+    {
+        vec2  offset     = u_KernelSize * kDoFKernelOffsets[i] * u_PixelSize;
+        float coc_sample = texture(s_CoC4, tex_coord + offset).y;
+
+        result += texture(s_Color4, tex_coord + offset).rgb * coc_sample;
+        weights_sum += coc_sample;
+    }
+
+    return result / weights_sum;
+}
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    ivec2 size   = imageSize(i_NearDoF4);
+    ivec2 coord  = ivec2(gl_GlobalInvocationID.xy);
+    bool  inside = all(lessThan(coord, size));
+    vec4  tile   = texelFetch(s_Tiles, ivec2(gl_WorkGroupID.xy), 0);
+
+    // The whole work group takes this branch, so returning before the barrier below is safe.
+    if (is_tile_in_focus(tile))
+    {
+        if (inside)
+        {
+            imageStore(i_NearDoF4, coord, vec4(0.0));
+            imageStore(i_FarDoF4, coord, vec4(0.0));
+        }
+
+        return;
+    }
+
+    vec2 tex_coord = (vec2(coord) + 0.5) * u_PixelSize;
+    vec2 coc       = inside ? texelFetch(s_CoC4, coord, 0).xy : vec2(0.0);
+    vec4 near      = vec4(0.0);
+    vec3 far       = vec3(0.0);
+
+    // Only gather the fields that can be visible in this tile.
+    if (inside && tile.x > 0.0)
+        near = near_field(tex_coord);
+
+    if (inside && coc.y > 0.0)
+        far = far_field(tex_coord);
+
+    near_dof[gl_LocalInvocationIndex] = near.rgb;
+    far_dof[gl_LocalInvocationIndex]  = far;
+
+    barrier();
+
+    if (!inside)
+        return;
+
+    // Fill the gaps left between the sparse kernel samples with the 3x3 maximum of the tile.
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            ivec2 neighbour = clamp(local + ivec2(x, y), ivec2(0), ivec2(DOF_TILE_SIZE - 1));
+            uint  idx       = uint(neighbour.y * DOF_TILE_SIZE + neighbour.x);
+
+            if (near.a > 0.0)
+                near.rgb = max(near.rgb, near_dof[idx]);
+
+            if (coc.y > 0.0)
+                far = max(far, far_dof[idx]);
+        }
+    }
+
+    imageStore(i_NearDoF4, coord, near);
+    imageStore(i_FarDoF4, coord, vec4(far, 0.0));
+}
+
+// ------------------------------------------------------------------
@@ -0,0 +1,95 @@
+#include <../../common/uniforms.glsl>
+#include <../../common/helper.glsl>
+#include <dof.glsl>
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = DOF_TILE_SIZE, local_size_y = DOF_TILE_SIZE) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (binding = 0, r11f_g11f_b10f) writeonly uniform image2D i_Color4;
+layout (binding = 1, rg8) writeonly uniform image2D i_CoC4;
+layout (binding = 2, rgba16f) writeonly uniform image2D i_Tiles;
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_Color;
+uniform sampler2D s_Depth;
+
+uniform vec4 u_FocalPlanes;
+
+// ------------------------------------------------------------------
+// GLOBALS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+shared vec4 tile_coc[DOF_TILE_SIZE * DOF_TILE_SIZE];
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Downsamples color and CoC to half resolution and reduces the CoC of every tile to (max near, max far, min near, min far).
+void main()
+{
+    ivec2 size  = imageSize(i_Color4);
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+    uint  idx   = gl_LocalInvocationIndex;
+
+    // Out of bounds threads must not affect the minimum.
+    vec4 coc_range = vec4(0.0, 0.0, 1.0, 1.0);
+
+    if (all(lessThan(coord, size)))
+    {
+        ivec2 full_size = textureSize(s_Depth, 0) - 1;
+        vec3  color     = vec3(0.0);
+        vec2  coc_max   = vec2(0.0);
+        vec2  coc_min   = vec2(1.0);
+
+        for (int i = 0; i < 4; i++)
+        {
+            ivec2 full_coord = min(coord * 2 + ivec2(i & 1, i >> 1), full_size);
+            vec2  coc        = circle_of_confusion(linear_eye_depth(texelFetch(s_Depth, full_coord, 0).x), u_FocalPlanes);
+
+            color += texelFetch(s_Color, full_coord, 0).rgb;
+            coc_max = max(coc_max, coc);
+            coc_min = min(coc_min, coc);
+        }
+
+        // Keep the near CoC conservative so that thin foreground edges are not lost in the downsample.
+        vec2 coc = vec2(coc_max.x, 0.5 * (coc_min.y + coc_max.y));
+
+        imageStore(i_Color4, coord, vec4(color * 0.25, 1.0));
+        imageStore(i_CoC4, coord, vec4(coc, 0.0, 0.0));
+
+        coc_range = vec4(coc, coc);
+    }
+
+    tile_coc[idx] = coc_range;
+
+    barrier();
+
+    for (uint stride = (DOF_TILE_SIZE * DOF_TILE_SIZE) / 2; stride > 0; stride >>= 1)
+    {
+        if (idx < stride)
+        {
+            vec4 a = tile_coc[idx];
+            vec4 b = tile_coc[idx + stride];
+
+            tile_coc[idx] = vec4(max(a.xy, b.xy), min(a.zw, b.zw));
+        }
+
+        barrier();
+    }
+
+    if (idx == 0)
+        imageStore(i_Tiles, ivec2(gl_WorkGroupID.xy), tile_coc[0]);
+}
+
+// ------------------------------------------------------------------
@@ -0,0 +1,238 @@
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Every work group reduces a 64x64 tile of the depth buffer down to a single texel of mip 6. The last work group to finish (found
+// through a global atomic counter) fixes up the non-power-of-two edges and builds the remaining mips.
+
+#define HIZ_NUM_THREADS 16
+#define HIZ_TILE_SIZE 64
+#define HIZ_TILE_LEVELS 6
+#define HIZ_IMAGE_COUNT 8
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = HIZ_NUM_THREADS, local_size_y = HIZ_NUM_THREADS) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Image i holds mip level i, or mip level (7 + i) for the tail dispatch.
+layout (binding = 0, rg32f) coherent uniform image2D i_HiZ[HIZ_IMAGE_COUNT];
+
+layout (std430, binding = 4) coherent buffer u_HiZCounter
+{
+    uint finished_groups;
+};
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_Depth;
+uniform int u_ImageCount; // Number of levels bound for this dispatch
+uniform int u_TailOnly; // Second dispatch for pyramids with more levels than image units
+
+// ------------------------------------------------------------------
+// GLOBALS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+shared vec2 tile[HIZ_NUM_THREADS * HIZ_NUM_THREADS];
+shared bool is_last_group;
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+vec2 reduce(vec2 a, vec2 b)
+{
+    return vec2(min(a.x, b.x), max(a.y, b.y));
+}
+
+// ------------------------------------------------------------------
+
+vec2 reduce4(vec2 a, vec2 b, vec2 c, vec2 d)
+{
+    return reduce(reduce(a, b), reduce(c, d));
+}
+
+// ------------------------------------------------------------------
+
+void store(int image, ivec2 coord, vec2 value)
+{
+    if (image < u_ImageCount && all(lessThan(coord, imageSize(i_HiZ[image]))))
+        imageStore(i_HiZ[image], coord, vec4(value, 0.0, 0.0));
+}
+
+// ------------------------------------------------------------------
+
+// Mip sizes are rounded down, so the last column and row of a level also have to cover the third texel of an odd-sized parent.
+// Every other texel only ever depends on exact 2x2 footprints, which is what keeps the pyramid conservative.
+vec2 reduce_from_parent(int image, ivec2 coord)
+{
+    ivec2 parent_size = imageSize(i_HiZ[image - 1]);
+    ivec2 size        = imageSize(i_HiZ[image]);
+    ivec2 first       = coord * 2;
+    ivec2 last        = first + 1;
+
+    if (coord.x == size.x - 1)
+        last.x = parent_size.x - 1;
+
+    if (coord.y == size.y - 1)
+        last.y = parent_size.y - 1;
+
+    last = min(last, parent_size - 1);
+
+    vec2 value = vec2(1.0, 0.0);
+
+    for (int y = first.y; y <= last.y; y++)
+    {
+        for (int x = first.x; x <= last.x; x++)
+            value = reduce(value, imageLoad(i_HiZ[image - 1], ivec2(x, y)).xy);
+    }
+
+    return value;
+}
+
+// ------------------------------------------------------------------
+
+void reduce_tile()
+{
+    ivec2 depth_size = textureSize(s_Depth, 0);
+    ivec2 tile_base  = ivec2(gl_WorkGroupID.xy) * HIZ_TILE_SIZE;
+    ivec2 thread     = ivec2(gl_LocalInvocationID.xy);
+
+    // Mip 0 and 1: each thread copies a 4x4 block of depth and reduces it to 2x2. Reads are clamped to the edge which only
+    // duplicates texels that are already part of the footprint.
+    vec2 level_1[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+        ivec2 offset = ivec2(i & 1, i >> 1) * 2;
+        vec2  v[4];
+
+        for (int j = 0; j < 4; j++)
+        {
+            ivec2 coord = tile_base + thread * 4 + offset + ivec2(j & 1, j >> 1);
+            float depth = texelFetch(s_Depth, min(coord, depth_size - 1), 0).x;
+
+            v[j] = vec2(depth);
+            store(0, coord, v[j]);
+        }
+
+        level_1[i] = reduce4(v[0], v[1], v[2], v[3]);
+        store(1, (tile_base >> 1) + thread * 2 + ivec2(i & 1, i >> 1), level_1[i]);
+    }
+
+    // Mip 2: one texel per thread.
+    vec2 value = reduce4(level_1[0], level_1[1], level_1[2], level_1[3]);
+
+    store(2, (tile_base >> 2) + thread, value);
+    tile[thread.y * HIZ_NUM_THREADS + thread.x] = value;
+
+    barrier();
+
+    // Mips 3 to 6 are reduced in shared memory by a shrinking set of threads.
+    for (int level = 3, size = HIZ_NUM_THREADS / 2; level <= HIZ_TILE_LEVELS; level++, size /= 2)
+    {
+        if (all(lessThan(thread, ivec2(size))))
+        {
+            int stride = HIZ_NUM_THREADS;
+            int idx    = (thread.y * 2) * stride + thread.x * 2;
+
+            value = reduce4(tile[idx], tile[idx + 1], tile[idx + stride], tile[idx + stride + 1]);
+            store(level, (tile_base >> level) + thread, value);
+        }
+
+        barrier();
+
+        if (all(lessThan(thread, ivec2(size))))
+            tile[thread.y * HIZ_NUM_THREADS + thread.x] = value;
+
+        barrier();
+    }
+}
+
+// ------------------------------------------------------------------
+
+void fix_edges(int image)
+{
+    ivec2 size = imageSize(i_HiZ[image]);
+    int   edge_texels = size.x + size.y;
+
+    for (int i = int(gl_LocalInvocationIndex); i < edge_texels; i += HIZ_NUM_THREADS * HIZ_NUM_THREADS)
+    {
+        ivec2 coord = i < size.x ? ivec2(i, size.y - 1) : ivec2(size.x - 1, i - size.x);
+        imageStore(i_HiZ[image], coord, vec4(reduce_from_parent(image, coord), 0.0, 0.0));
+    }
+
+    memoryBarrierImage();
+    barrier();
+}
+
+// ------------------------------------------------------------------
+
+void reduce_level(int image)
+{
+    ivec2 size = imageSize(i_HiZ[image]);
+
+    for (int i = int(gl_LocalInvocationIndex); i < size.x * size.y; i += HIZ_NUM_THREADS * HIZ_NUM_THREADS)
+    {
+        ivec2 coord = ivec2(i % size.x, i / size.x);
+        imageStore(i_HiZ[image], coord, vec4(reduce_from_parent(image, coord), 0.0, 0.0));
+    }
+
+    memoryBarrierImage();
+    barrier();
+}
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    if (u_TailOnly == 1)
+    {
+        for (int image = 1; image < u_ImageCount; image++)
+            reduce_level(image);
+
+        return;
+    }
+
+    reduce_tile();
+
+    // Make this group's writes visible before announcing that it is done.
+    memoryBarrierImage();
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0)
+    {
+        uint group_count = gl_NumWorkGroups.x * gl_NumWorkGroups.y;
+        is_last_group    = atomicAdd(finished_groups, 1) == group_count - 1;
+    }
+
+    barrier();
+
+    if (!is_last_group)
+        return;
+
+    memoryBarrierImage();
+
+    int tile_levels = min(HIZ_TILE_LEVELS + 1, u_ImageCount);
+
+    for (int image = 1; image < tile_levels; image++)
+        fix_edges(image);
+
+    for (int image = tile_levels; image < u_ImageCount; image++)
+        reduce_level(image);
+
+    // Reset for the next frame.
+    if (gl_LocalInvocationIndex == 0)
+        finished_groups = 0;
+}
+
+// ------------------------------------------------------------------
@@ -0,0 +1,29 @@
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Pixels covered by one velocity tile. Velocities are clamped to the tile size so that the 3x3 neighbourhood of a tile holds every
+// pixel that can blur onto it.
+#define MOTION_BLUR_TILE_SIZE 32
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Converts a screen space velocity into the blur radius in pixels, which is half the distance travelled during the frame.
+vec2 blur_radius(vec2 velocity, vec2 size, float scale)
+{
+    vec2  radius = velocity * size * scale * 0.5;
+    float len    = length(radius);
+
+    return len > float(MOTION_BLUR_TILE_SIZE) ? radius * (float(MOTION_BLUR_TILE_SIZE) / len) : radius;
+}
+
+// ------------------------------------------------------------------
+
+vec2 longest(vec2 a, vec2 b)
+{
+    return dot(a, a) >= dot(b, b) ? a : b;
+}
+
+// ------------------------------------------------------------------
@@ -1,4 +1,15 @@
 #include <../../common/uniforms.glsl>
+#include <../../common/helper.glsl>
+#include <motion_blur.glsl>
+
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Reconstruction filter from "A Reconstruction Filter for Plausible Motion Blur" (McGuire et al. 2012). Samples are taken along the
+// dominant velocity of the neighbourhood and weighted by whether they are in front of or behind the center pixel.
+
+#define SOFT_Z_EXTENT 0.1
 
 // ------------------------------------------------------------------
 // OUTPUTS ----------------------------------------------------------
@@ -18,9 +29,51 @@ in vec2 FS_IN_TexCoord;
 
 uniform sampler2D s_Color;
 uniform sampler2D s_Velocity;
+uniform sampler2D s_Depth;
+uniform sampler2D s_NeighborMax;
 
 uniform int u_NumSamples;
+uniform int u_UseDepth;
 uniform float u_Scale;
+uniform float u_Threshold;
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+float cone(float dist, float radius)
+{
+	return clamp(1.0 - dist / max(radius, 0.0001), 0.0, 1.0);
+}
+
+// ------------------------------------------------------------------
+
+float cylinder(float dist, float radius)
+{
+	return 1.0 - smoothstep(0.95 * radius, 1.05 * radius, dist);
+}
+
+// ------------------------------------------------------------------
+
+// 1.0 when depth a is in front of depth b, fading out over SOFT_Z_EXTENT.
+float soft_depth_compare(float a, float b)
+{
+	return clamp(1.0 - (a - b) / SOFT_Z_EXTENT, 0.0, 1.0);
+}
+
+// ------------------------------------------------------------------
+
+float linear_depth(vec2 tex_coord)
+{
+	return u_UseDepth == 1 ? linear_eye_depth(textureLod(s_Depth, tex_coord, 0.0).r) : 0.0;
+}
+
+// ------------------------------------------------------------------
+
+float interleaved_gradient_noise(vec2 position)
+{
+	return fract(52.9829189 * fract(dot(position, vec2(0.06711056, 0.00583715))));
+}
 
 // ------------------------------------------------------------------
 // MAIN -------------------------------------------------------------
@@ -28,28 +81,52 @@ uniform float u_Scale;
 
 void main()
 {
-	vec3 result = texture(s_Color, FS_IN_TexCoord).rgb;
+	vec3 color = textureLod(s_Color, FS_IN_TexCoord, 0.0).rgb;
 
-	vec2 texel_size = 1.0 / vec2(textureSize(s_Color, 0));
-	vec2 velocity = texture(s_Velocity, FS_IN_TexCoord).rg;
+	vec2 size          = vec2(textureSize(s_Color, 0));
+	vec2 neighbor_max  = texelFetch(s_NeighborMax, ivec2(gl_FragCoord.xy) / MOTION_BLUR_TILE_SIZE, 0).rg;
+	float neighbor_len = length(neighbor_max);
 
-	// Remap to [-1, 1] range
-	//velocity = velocity * 2.0 - 1.0;
-		 
-	velocity *= u_Scale;
+	// Nothing around this tile moves far enough to be visible, which is the common case for most of the screen.
+	if (neighbor_len < u_Threshold || u_NumSamples < 1)
+	{
+		FS_OUT_FragColor = color;
+		return;
+	}
+
+	vec2  center_velocity = blur_radius(textureLod(s_Velocity, FS_IN_TexCoord, 0.0).rg, size, u_Scale);
+	float center_len      = max(length(center_velocity), 0.5);
+	float center_depth    = linear_depth(FS_IN_TexCoord);
+
+	float weight_sum = 1.0 / center_len;
+	vec3  result     = color * weight_sum;
 
-	float speed = length(velocity / texel_size);
-	int num_samples = u_NumSamples;//clamp(int(speed), 1, max_motion_blur_samples);
+	// Offset the sample positions per pixel to trade banding for noise.
+	float jitter = interleaved_gradient_noise(gl_FragCoord.xy) - 0.5;
 
-	for (int i = 0; i < num_samples; i++)
+	for (int i = 0; i < u_NumSamples; i++)
 	{
-		vec2 offset = velocity * (float(i) / float(num_samples - 1) - 0.5);
-		result += texture(s_Color, FS_IN_TexCoord + offset).rgb;
-	}
+		float t = mix(-1.0, 1.0, (float(i) + jitter + 1.0) / float(u_NumSamples + 1));
+
+		vec2  offset           = neighbor_max * t;
+		vec2  sample_tex_coord = FS_IN_TexCoord + offset / size;
+		float dist             = length(offset);
 
-	result =  result / float(num_samples);
+		float sample_depth = linear_depth(sample_tex_coord);
+		float sample_len   = length(blur_radius(textureLod(s_Velocity, sample_tex_coord, 0.0).rg, size, u_Scale));
 
-	FS_OUT_FragColor = result;
+		float foreground = soft_depth_compare(sample_depth, center_depth);
+		float background = soft_depth_compare(center_depth, sample_depth);
+
+		// Blurry foreground samples spread over the center, the center spreads over the background behind it, and two blurry
+		// samples at the same depth blend with each other.
+		float weight = foreground * cone(dist, sample_len) + background * cone(dist, center_len) + cylinder(dist, sample_len) * cylinder(dist, center_len) * 2.0;
+
+		result += weight * textureLod(s_Color, sample_tex_coord, 0.0).rgb;
+		weight_sum += weight;
+	}
+
+	FS_OUT_FragColor = result / weight_sum;
 }
 
-// ------------------------------------------------------------------
\ No newline at end of file
+// ------------------------------------------------------------------
@@ -0,0 +1,50 @@
+#include <motion_blur.glsl>
+
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+#define MOTION_BLUR_NEIGHBOR_NUM_THREADS 8
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = MOTION_BLUR_NEIGHBOR_NUM_THREADS, local_size_y = MOTION_BLUR_NEIGHBOR_NUM_THREADS) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (binding = 0, rg16f) writeonly uniform image2D i_NeighborMax;
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_TileMax;
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    ivec2 size  = imageSize(i_NeighborMax);
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+
+    if (any(greaterThanEqual(coord, size)))
+        return;
+
+    vec2 v = vec2(0.0);
+
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+            v = longest(v, texelFetch(s_TileMax, clamp(coord + ivec2(x, y), ivec2(0), size - 1), 0).rg);
+    }
+
+    imageStore(i_NeighborMax, coord, vec4(v, 0.0, 0.0));
+}
+
+// ------------------------------------------------------------------
@@ -0,0 +1,70 @@
+#include <motion_blur.glsl>
+
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Each thread reduces a 2x2 quad so that a 16x16 work group covers one tile.
+#define MOTION_BLUR_TILE_NUM_THREADS 16
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = MOTION_BLUR_TILE_NUM_THREADS, local_size_y = MOTION_BLUR_TILE_NUM_THREADS) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (binding = 0, rg16f) writeonly uniform image2D i_TileMax;
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_Velocity;
+
+uniform float u_Scale;
+
+// ------------------------------------------------------------------
+// GLOBALS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+shared vec2 tile_velocity[MOTION_BLUR_TILE_NUM_THREADS * MOTION_BLUR_TILE_NUM_THREADS];
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    ivec2 size = textureSize(s_Velocity, 0);
+    uint  idx  = gl_LocalInvocationIndex;
+    vec2  v    = vec2(0.0);
+
+    for (int i = 0; i < 4; i++)
+    {
+        ivec2 coord = ivec2(gl_GlobalInvocationID.xy) * 2 + ivec2(i & 1, i >> 1);
+
+        if (all(lessThan(coord, size)))
+            v = longest(v, blur_radius(texelFetch(s_Velocity, coord, 0).rg, vec2(size), u_Scale));
+    }
+
+    tile_velocity[idx] = v;
+
+    barrier();
+
+    for (uint stride = (MOTION_BLUR_TILE_NUM_THREADS * MOTION_BLUR_TILE_NUM_THREADS) / 2; stride > 0; stride >>= 1)
+    {
+        if (idx < stride)
+            tile_velocity[idx] = longest(tile_velocity[idx], tile_velocity[idx + stride]);
+
+        barrier();
+    }
+
+    if (idx == 0)
+        imageStore(i_TileMax, ivec2(gl_WorkGroupID.xy), vec4(tile_velocity[0], 0.0, 0.0));
+}
+
+// ------------------------------------------------------------------
@@ -0,0 +1,146 @@
+#include <../../common/uniforms.glsl>
+#include <../../common/helper.glsl>
+
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+#define SSAO_NUM_THREADS 16
+#define SSAO_APRON 16
+#define SSAO_TILE_SIZE (SSAO_NUM_THREADS + 2 * SSAO_APRON)
+#define DEPTH_LOD 1
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = SSAO_NUM_THREADS, local_size_y = SSAO_NUM_THREADS) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (binding = 0, r8) uniform writeonly image2D i_SSAO;
+
+// ------------------------------------------------------------------
+// UNIFORM BUFFERS --------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (std140) uniform u_SSAOData
+{
+    vec4 kernel[64];
+};
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_Normals; // Normals
+uniform sampler2D s_Depth; // HiZ Depth
+uniform sampler2D s_Noise; // SSAO Noise
+uniform vec2 u_Size; // Size of the half resolution output
+uniform int u_MaxMip;
+uniform int u_NumSamples;
+uniform float u_Radius;
+uniform float u_Bias;
+uniform float u_Power;
+
+// ------------------------------------------------------------------
+// GLOBALS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Half resolution depth for the work group plus an apron wide enough for most kernel taps.
+shared float depth_tile[SSAO_TILE_SIZE * SSAO_TILE_SIZE];
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+void load_depth_tile(ivec2 tile_origin)
+{
+    uint thread_idx = gl_LocalInvocationIndex;
+
+    for (uint i = thread_idx; i < SSAO_TILE_SIZE * SSAO_TILE_SIZE; i += SSAO_NUM_THREADS * SSAO_NUM_THREADS)
+    {
+        ivec2 coord = clamp(tile_origin + ivec2(i % SSAO_TILE_SIZE, i / SSAO_TILE_SIZE), ivec2(0), ivec2(u_Size) - 1);
+        depth_tile[i] = texelFetch(s_Depth, coord, DEPTH_LOD).x;
+    }
+
+    barrier();
+}
+
+// ------------------------------------------------------------------
+
+float sample_depth(vec2 tex_coord, ivec2 pixel, ivec2 tile_origin)
+{
+    ivec2 tap = ivec2(tex_coord * u_Size);
+    ivec2 tile_coord = tap - tile_origin;
+
+    // Nearby taps come from shared memory.
+    if (all(greaterThanEqual(tile_coord, ivec2(0))) && all(lessThan(tile_coord, ivec2(SSAO_TILE_SIZE))))
+        return depth_tile[tile_coord.y * SSAO_TILE_SIZE + tile_coord.x];
+
+    // Distant taps read progressively coarser HiZ levels so that they stay cache friendly. HiZ stores the closest depth of each
+    // footprint, which errs towards occlusion for the few taps that end up here.
+    float dist = length(vec2(tap - pixel));
+    int   lod  = clamp(DEPTH_LOD + int(ceil(log2(dist / float(SSAO_APRON)))), DEPTH_LOD, u_MaxMip);
+
+    return textureLod(s_Depth, tex_coord, float(lod)).x;
+}
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    ivec2 tile_origin = ivec2(gl_WorkGroupID.xy) * SSAO_NUM_THREADS - SSAO_APRON;
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+
+    load_depth_tile(tile_origin);
+
+    if (any(greaterThanEqual(pixel, ivec2(u_Size))))
+        return;
+
+    vec2 tex_coord = (vec2(pixel) + vec2(0.5)) / u_Size;
+
+    // Decode normal from G-Buffer in view-space
+    vec3 world_normal = textureLod(s_Normals, tex_coord, 0.0).rgb;
+    vec3 normal = world_to_view_space_normal(world_normal);
+
+    // Reconstruct view-space position from the shared depth tile
+    float frag_depth = depth_tile[(pixel.y - tile_origin.y) * SSAO_TILE_SIZE + (pixel.x - tile_origin.x)];
+    vec3 position = view_position_from_depth(tex_coord, frag_depth);
+
+    // Fetch random vector, tiled exactly like the fragment shader path
+    vec3 random = normalize(texelFetch(s_Noise, pixel & 3, 0).rgb);
+
+    // Construct view-space TBN matrix
+    vec3 tangent = normalize(random - normal * dot(random, normal));
+    vec3 bitangent = cross(normal, tangent);
+    mat3 TBN = mat3(tangent, bitangent, normal);
+
+    float occlusion = 0.0;
+
+    for (int i = 0; i < u_NumSamples; i++)
+    {
+        // Transform kernel sample from tangent space into view space
+        vec3 ssao_sample = TBN * kernel[i].xyz;
+        // Add sample to fragment position and scale by radius
+        ssao_sample = position + ssao_sample * u_Radius;
+        // Transform sample into clip space
+        vec4 offset = proj_mat * vec4(ssao_sample, 1.0);
+        // Perspective division and remap to the [0, 1] range
+        offset.xyz = (offset.xyz / offset.w) * 0.5 + 0.5;
+
+        float sample_z = view_position_from_depth(offset.xy, sample_depth(offset.xy, pixel, tile_origin)).z;
+        float range_check = smoothstep(0.0, 1.0, u_Radius / abs(position.z - sample_z));
+        occlusion += (sample_z >= (ssao_sample.z + u_Bias) ? 1.0 : 0.0) * range_check;
+    }
+
+    occlusion = 1.0 - (occlusion / float(u_NumSamples));
+
+    imageStore(i_SSAO, pixel, vec4(pow(occlusion, u_Power)));
+}
+
+// ------------------------------------------------------------------
@@ -0,0 +1,113 @@
+#include <../../common/uniforms.glsl>
+#include <../../common/helper.glsl>
+
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+#define SSAO_UPSAMPLE_NUM_THREADS 16
+#define SSAO_HALF_TILE_SIZE (SSAO_UPSAMPLE_NUM_THREADS / 2 + 4)
+#define DEPTH_LOD 1
+#define DEPTH_SHARPNESS 32.0
+#define NORMAL_POWER 8.0
+#define EPSILON 0.0001
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = SSAO_UPSAMPLE_NUM_THREADS, local_size_y = SSAO_UPSAMPLE_NUM_THREADS) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (binding = 0, r8) uniform writeonly image2D i_SSAO;
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_SSAO; // Half resolution SSAO
+uniform sampler2D s_Normals; // Normals
+uniform sampler2D s_Depth; // HiZ Depth
+uniform vec2 u_Size; // Size of the full resolution output
+
+// ------------------------------------------------------------------
+// GLOBALS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Half resolution occlusion, view-space depth and normal covering the 4x4 footprint of every pixel in the work group.
+shared float ao_tile[SSAO_HALF_TILE_SIZE * SSAO_HALF_TILE_SIZE];
+shared float depth_tile[SSAO_HALF_TILE_SIZE * SSAO_HALF_TILE_SIZE];
+shared vec3  normal_tile[SSAO_HALF_TILE_SIZE * SSAO_HALF_TILE_SIZE];
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+void load_tiles(ivec2 tile_origin)
+{
+    ivec2 half_size = textureSize(s_SSAO, 0);
+
+    for (uint i = gl_LocalInvocationIndex; i < SSAO_HALF_TILE_SIZE * SSAO_HALF_TILE_SIZE; i += SSAO_UPSAMPLE_NUM_THREADS * SSAO_UPSAMPLE_NUM_THREADS)
+    {
+        ivec2 coord = clamp(tile_origin + ivec2(i % SSAO_HALF_TILE_SIZE, i / SSAO_HALF_TILE_SIZE), ivec2(0), half_size - 1);
+        vec2  tex_coord = (vec2(coord) + vec2(0.5)) / vec2(half_size);
+
+        ao_tile[i] = texelFetch(s_SSAO, coord, 0).x;
+        depth_tile[i] = view_position_from_depth(tex_coord, texelFetch(s_Depth, coord, DEPTH_LOD).x).z;
+        normal_tile[i] = texelFetch(s_Normals, clamp(coord * 2, ivec2(0), ivec2(u_Size) - 1), 0).xyz;
+    }
+
+    barrier();
+}
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    ivec2 tile_origin = ivec2(gl_WorkGroupID.xy) * (SSAO_UPSAMPLE_NUM_THREADS / 2) - 2;
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+
+    load_tiles(tile_origin);
+
+    if (any(greaterThanEqual(pixel, ivec2(u_Size))))
+        return;
+
+    vec2  tex_coord = (vec2(pixel) + vec2(0.5)) / u_Size;
+    float depth = view_position_from_depth(tex_coord, texelFetch(s_Depth, pixel, 0).x).z;
+    vec3  normal = texelFetch(s_Normals, pixel, 0).xyz;
+
+    // Same 4x4 footprint as the fragment blur, weighted so that occlusion does not bleed across depth and normal discontinuities.
+    ivec2 center = pixel / 2 - tile_origin;
+
+    float result = 0.0;
+    float total_weight = 0.0;
+    float box = 0.0;
+
+    for (int x = -2; x < 2; ++x)
+    {
+        for (int y = -2; y < 2; ++y)
+        {
+            int idx = (center.y + y) * SSAO_HALF_TILE_SIZE + (center.x + x);
+
+            float depth_weight = exp(-abs(depth - depth_tile[idx]) * DEPTH_SHARPNESS / max(abs(depth), EPSILON));
+            float normal_weight = pow(max(dot(normal, normal_tile[idx]), 0.0), NORMAL_POWER);
+            float weight = depth_weight * normal_weight;
+
+            result += ao_tile[idx] * weight;
+            total_weight += weight;
+            box += ao_tile[idx];
+        }
+    }
+
+    // Fall back to the plain box filter on pixels that share no similar neighbours, such as single pixel features.
+    float occlusion = total_weight > EPSILON ? result / total_weight : box / 16.0;
+
+    imageStore(i_SSAO, pixel, vec4(occlusion));
+}
+
+// ------------------------------------------------------------------
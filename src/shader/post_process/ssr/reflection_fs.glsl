@@ -2,7 +2,8 @@
 // OUTPUTS ----------------------------------------------------------
 // ------------------------------------------------------------------
 
-out vec3 FS_OUT_FragColor;
+layout (location = 0) out vec3 FS_OUT_FragColor;
+layout (location = 1) out vec4 FS_OUT_History;
 
 // ------------------------------------------------------------------
 // INPUTS -----------------------------------------------------------
@@ -16,8 +17,23 @@ in vec2 FS_IN_TexCoord;
 
 uniform sampler2D s_SSR;
 uniform sampler2D s_Color;
+uniform sampler2D s_History;
+uniform sampler2D s_Velocity;
 
 uniform float u_SSR;
+uniform float u_TemporalWeight;
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Reflected color premultiplied by the hit confidence, which is stored in alpha.
+vec4 reflection(ivec2 coord)
+{
+	vec3 ssr = texelFetch(s_SSR, coord, 0).rgb;
+
+	return vec4(texture(s_Color, ssr.xy).rgb * ssr.z, ssr.z);
+}
 
 // ------------------------------------------------------------------
 // MAIN -------------------------------------------------------------
@@ -25,12 +41,36 @@ uniform float u_SSR;
 
 void main()
 {
-	vec3 color = texture(s_Color, FS_IN_TexCoord).rgb;
-	vec3 ssr = texture(s_SSR, FS_IN_TexCoord).rgb;
+	vec3  color = texture(s_Color, FS_IN_TexCoord).rgb;
+	ivec2 coord = ivec2(gl_FragCoord.xy);
+	ivec2 size  = textureSize(s_SSR, 0) - 1;
+
+	vec4 current = reflection(coord);
+	vec4 resolved = current;
+
+	if (u_TemporalWeight > 0.0)
+	{
+		vec2 history_tex_coord = FS_IN_TexCoord - texture(s_Velocity, FS_IN_TexCoord).rg;
+
+		if (all(greaterThanEqual(history_tex_coord, vec2(0.0))) && all(lessThanEqual(history_tex_coord, vec2(1.0))))
+		{
+			// Clamp the history to the neighbourhood of the current frame to reject disoccluded and stale reflections.
+			vec4 n0 = reflection(clamp(coord + ivec2(1, 0), ivec2(0), size));
+			vec4 n1 = reflection(clamp(coord - ivec2(1, 0), ivec2(0), size));
+			vec4 n2 = reflection(clamp(coord + ivec2(0, 1), ivec2(0), size));
+			vec4 n3 = reflection(clamp(coord - ivec2(0, 1), ivec2(0), size));
+
+			vec4 box_min = min(current, min(min(n0, n1), min(n2, n3)));
+			vec4 box_max = max(current, max(max(n0, n1), max(n2, n3)));
+
+			vec4 history = clamp(texture(s_History, history_tex_coord), box_min, box_max);
 
-	vec3 reflection = texture(s_Color, ssr.xy).rgb;
+			resolved = mix(current, history, u_TemporalWeight);
+		}
+	}
 
-	FS_OUT_FragColor = mix(color, reflection, ssr.z * u_SSR);
+	FS_OUT_History   = resolved;
+	FS_OUT_FragColor = color * (1.0 - resolved.a * u_SSR) + resolved.rgb * u_SSR;
 }
 
 // ------------------------------------------------------------------
\ No newline at end of file
@@ -0,0 +1,114 @@
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Every work group looks at a 16x16 tile of the G-Buffer. Pixels that cannot show a reflection are cleared right away, tiles that
+// contain at least one reflective pixel are appended to one of two lists that drive the indirect trace dispatches:
+//
+// * Full resolution list: four 8x8 sub-tiles per 16x16 tile, one work group each.
+// * Half resolution list: one 16x16 tile per work group, used when every reflective pixel of the tile is rough.
+
+#define SSR_CLASSIFY_TILE_SIZE 16
+#define SSR_TRACE_TILE_SIZE 8
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = SSR_CLASSIFY_TILE_SIZE, local_size_y = SSR_CLASSIFY_TILE_SIZE) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (binding = 0, rgba16f) uniform writeonly image2D i_SSR;
+
+layout (std430, binding = 4) buffer u_SSRTiles
+{
+    uint dispatch_args[8]; // Indirect arguments of the full resolution (0..2) and half resolution (4..6) trace dispatches
+    uint tiles[]; // Tile origins packed as (x | y << 16)
+};
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_HiZDepth;
+uniform sampler2D s_Metallic;
+
+uniform float u_MinMetallic;
+uniform float u_MaxRoughness;
+uniform float u_HalfResRoughness;
+uniform int   u_HalfResTileOffset;
+
+// ------------------------------------------------------------------
+// GLOBALS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+shared uint reflective_count;
+shared uint min_roughness;
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+uint pack_tile(uvec2 origin)
+{
+    return origin.x | (origin.y << 16);
+}
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    if (gl_LocalInvocationIndex == 0)
+    {
+        reflective_count = 0;
+        min_roughness    = 255;
+    }
+
+    barrier();
+
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+
+    if (all(lessThan(coord, imageSize(i_SSR))))
+    {
+        float depth       = texelFetch(s_HiZDepth, coord, 0).x;
+        vec2  metal_rough = texelFetch(s_Metallic, coord, 0).rg;
+
+        if (depth < 1.0 && metal_rough.x >= u_MinMetallic && metal_rough.y <= u_MaxRoughness)
+        {
+            atomicAdd(reflective_count, 1);
+            atomicMin(min_roughness, uint(metal_rough.y * 255.0));
+        }
+        else
+            imageStore(i_SSR, coord, vec4(0.0));
+    }
+
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0 && reflective_count > 0)
+    {
+        uvec2 origin = gl_WorkGroupID.xy * SSR_CLASSIFY_TILE_SIZE;
+
+        if (float(min_roughness) / 255.0 > u_HalfResRoughness)
+        {
+            uint idx = atomicAdd(dispatch_args[4], 1);
+
+            tiles[uint(u_HalfResTileOffset) + idx] = pack_tile(origin);
+        }
+        else
+        {
+            uint idx = atomicAdd(dispatch_args[0], 4);
+
+            tiles[idx + 0] = pack_tile(origin);
+            tiles[idx + 1] = pack_tile(origin + uvec2(SSR_TRACE_TILE_SIZE, 0));
+            tiles[idx + 2] = pack_tile(origin + uvec2(0, SSR_TRACE_TILE_SIZE));
+            tiles[idx + 3] = pack_tile(origin + uvec2(SSR_TRACE_TILE_SIZE, SSR_TRACE_TILE_SIZE));
+        }
+    }
+}
+
+// ------------------------------------------------------------------
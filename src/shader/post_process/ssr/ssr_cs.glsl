@@ -1,14 +1,18 @@
-// https://github.com/simeonradivoev/ComputeStochasticReflections
-
 #include <../../common/uniforms.glsl>
 #include <../../common/helper.glsl>
+#include <../../common/depth_conversion.glsl>
 
 // ------------------------------------------------------------------
 // DEFINES ----------------------------------------------------------
 // ------------------------------------------------------------------
 
+// Traces the tiles written by the classification pass. Rays are marched in screen space (uv, hardware depth) through the min-max
+// Hi-Z pyramid: a cell whose depth range the ray segment cannot touch is skipped and the trace moves up a level, otherwise it moves
+// down a level until a hit is found at the finest level. In half resolution mode every thread traces a single ray for a 2x2 quad.
+
 #define SSR_NUM_THREADS 8
-#define MAX_HIZ_LEVEL 6
+#define SSR_MAX_HIZ_LEVEL 7
+#define SSR_FLT_MAX 3.402823466e+38
 
 // ------------------------------------------------------------------
 // INPUTS -----------------------------------------------------------
@@ -16,11 +20,17 @@
 
 layout (local_size_x = SSR_NUM_THREADS, local_size_y = SSR_NUM_THREADS) in;
 
+layout (std430, binding = 4) buffer u_SSRTiles
+{
+    uint dispatch_args[8];
+    uint tiles[];
+};
+
 // ------------------------------------------------------------------
 // OUTPUTS ----------------------------------------------------------
 // ------------------------------------------------------------------
 
-layout (binding = 0, rgba32f) uniform image2D i_SSR;
+layout (binding = 0, rgba16f) uniform writeonly image2D i_SSR;
 
 // ------------------------------------------------------------------
 // SAMPLERS ---------------------------------------------------------
@@ -34,147 +44,203 @@ uniform sampler2D s_Normal;
 // UNIFORMS ---------------------------------------------------------
 // ------------------------------------------------------------------
 
-const float kRayStep = 0.1;
-const float kMinRayStep = 0.1;
-const int kMaxSteps = 32;
-const float kSearchDist = 5.0;
-const int kNumBinarySearchSteps = 5;
-const float kReflectionSpecularFalloffExponent = 3.0;
+uniform float u_Thickness;
+uniform int   u_MaxIterations;
+uniform float u_MinMetallic;
+uniform float u_MaxRoughness;
+uniform int   u_HalfRes;
+uniform int   u_TileOffset;
 
 // ------------------------------------------------------------------
 // FUNCTIONS --------------------------------------------------------
 // ------------------------------------------------------------------
 
-float read_depth(vec2 uv)
+bool is_reflective(ivec2 coord, ivec2 size)
 {
-    return textureLod(s_HiZDepth, uv.xy, 0).x * 2.0 - 1.0;
+    if (any(greaterThanEqual(coord, size)))
+        return false;
+
+    float depth       = texelFetch(s_HiZDepth, coord, 0).x;
+    vec2  metal_rough = texelFetch(s_Metallic, coord, 0).rg;
+
+    return depth < 1.0 && metal_rough.x >= u_MinMetallic && metal_rough.y <= u_MaxRoughness;
 }
 
 // ------------------------------------------------------------------
 
-vec2 binary_search(inout vec3 dir, inout vec3 hit_coord)
+// Returns the ray parameter at which the ray leaves the given cell.
+float cell_exit(vec3 origin, vec3 dir, vec2 cell, vec2 cell_count)
 {
-	vec4 projected_coord;
-
-	for (int i = 0; i < kNumBinarySearchSteps; i++)
-	{
-		projected_coord = proj_mat * vec4(hit_coord, 1.0);
-		projected_coord.xyz /= projected_coord.w;
-		projected_coord.xy = projected_coord.xy * 0.5 + 0.5;
+    vec2 boundary = (cell + step(0.0, dir.xy)) / cell_count;
+    vec2 t        = vec2(SSR_FLT_MAX);
 
-		float depth = texture(s_HiZDepth, projected_coord.xy).r * 2.0 - 1.0;
+    if (dir.x != 0.0)
+        t.x = (boundary.x - origin.x) / dir.x;
 
-		dir *= 0.5;
+    if (dir.y != 0.0)
+        t.y = (boundary.y - origin.y) / dir.y;
 
-		if (projected_coord.z < depth)
-			hit_coord += dir;
-		else
-			hit_coord -= dir;
-	}
-
-	projected_coord = proj_mat * vec4(hit_coord, 1.0);
-	projected_coord.xy /= projected_coord.w;
-	projected_coord.xy = projected_coord.xy * 0.5 + 0.5;
-
-	return vec2(projected_coord.xy);
+    return min(t.x, t.y);
 }
 
 // ------------------------------------------------------------------
 
-vec3 ray_march(in vec3 dir, in vec3 pos)
+// Returns the ray parameter at which the ray leaves the [0, 1] screen space volume.
+float volume_exit(vec3 origin, vec3 dir)
 {
-    vec3 ray_step = dir * kRayStep;
-    vec3 ray_sample = pos;
-
-	for (int ray_step_idx = 0; ray_step_idx < kMaxSteps; ray_step_idx++)
-	{
-        ray_sample += ray_step;
-
-        vec4 projected_coord = proj_mat * vec4(ray_sample, 1.0);
-		projected_coord.xyz /= projected_coord.w;
-		projected_coord.xy = projected_coord.xy * 0.5 + 0.5;
+    vec3 boundary = step(0.0, dir);
+    vec3 t        = vec3(SSR_FLT_MAX);
 
-		float z_val = read_depth(projected_coord.xy);
+    for (int i = 0; i < 3; i++)
+    {
+        if (dir[i] != 0.0)
+            t[i] = (boundary[i] - origin[i]) / dir[i];
+    }
 
-		if (projected_coord.z > z_val)
-			return vec3(binary_search(ray_step, ray_sample), 1.0);
-	}
-
-	return vec3(0.0, 0.0, 0.0);
+    return min(min(t.x, t.y), t.z);
 }
 
 // ------------------------------------------------------------------
 
-vec3 fresnel_schlick(float cos_theta, vec3 F0)
-{	
-	return F0 + (1.0 - F0) * pow(1.0 - cos_theta, 5.0);
+vec2 cell_of(vec3 p, vec3 dir, vec2 cell_count)
+{
+    // Nudge the position along the ray so that points lying exactly on a boundary resolve to the cell the ray is entering.
+    return clamp(floor(p.xy * cell_count + sign(dir.xy) * 0.001), vec2(0.0), cell_count - 1.0);
 }
 
 // ------------------------------------------------------------------
 
-#define Scale vec3(.8, .8, .8)
-#define K 19.19
-
-vec3 hash(vec3 a)
+// Returns the screen space hit position in xy and 1.0 in z on a hit, zero otherwise.
+vec3 hiz_trace(vec3 origin, vec3 dir)
 {
-    a = fract(a * Scale);
-    a += dot(a, a.yxz + K);
-    return fract((a.xxy + a.yxx)*a.zyx);
+    int   max_level = min(textureQueryLevels(s_HiZDepth) - 1, SSR_MAX_HIZ_LEVEL);
+    float t_max     = volume_exit(origin, dir);
+
+    // Step out of the starting pixel to avoid self intersection.
+    vec2  cell_count = vec2(textureSize(s_HiZDepth, 0));
+    float t          = cell_exit(origin, dir, cell_of(origin, dir, cell_count), cell_count);
+    int   level      = 0;
+
+    for (int i = 0; i < u_MaxIterations && t < t_max && level >= 0; i++)
+    {
+        cell_count = vec2(textureSize(s_HiZDepth, level));
+
+        vec3  p      = origin + dir * t;
+        vec2  cell   = cell_of(p, dir, cell_count);
+        float t_exit = min(cell_exit(origin, dir, cell, cell_count), t_max);
+        float z_exit = origin.z + dir.z * t_exit;
+
+        vec2 min_max = texelFetch(s_HiZDepth, ivec2(cell), level).xy;
+
+        float z_near = min(p.z, z_exit);
+        float z_far  = max(p.z, z_exit);
+
+        // The segment inside the cell can only hit something if it reaches the closest surface and does not pass behind the
+        // furthest one by more than the thickness.
+        bool overlaps = z_far >= min_max.x && linear_eye_depth(z_near) <= linear_eye_depth(min_max.y) + u_Thickness;
+
+        if (overlaps)
+        {
+            if (level == 0)
+            {
+                float t_hit = dir.z != 0.0 ? clamp((min_max.x - origin.z) / dir.z, t, t_exit) : t;
+                return vec3((origin + dir * t_hit).xy, 1.0);
+            }
+
+            level--;
+        }
+        else
+        {
+            t     = t_exit;
+            level = min(level + 1, max_level);
+        }
+    }
+
+    return vec3(0.0);
 }
 
-// ------------------------------------------------------------------
-// MAIN -------------------------------------------------------------
 // ------------------------------------------------------------------
 
-void main()
+vec4 trace(ivec2 coord, ivec2 size)
 {
-	ivec2 size = textureSize(s_HiZDepth, 0);
-	vec2 tex_coord = vec2(gl_GlobalInvocationID.x, gl_GlobalInvocationID.y) / vec2(size.x - 1, size.y - 1);
-
-	// Fetch depth from hardware depth buffer
-	float depth = texture(s_HiZDepth, tex_coord).r;
+    vec2  tex_coord = (vec2(coord) + 0.5) / vec2(size);
+    float depth     = texelFetch(s_HiZDepth, coord, 0).x;
+    float roughness = texelFetch(s_Metallic, coord, 0).g;
 
-	// Reconstruct view space position
-	vec3 view_pos = view_position_from_depth(tex_coord, depth);
+    // Reconstruct view space position and normal
+    vec3 view_pos    = view_position_from_depth(tex_coord, depth);
+    vec3 view_normal = normalize(world_to_view_space_normal(texelFetch(s_Normal, coord, 0).rgb));
+    vec3 view_dir    = normalize(view_pos);
+    vec3 reflection  = normalize(reflect(view_dir, view_normal));
 
-	// Get normal from G-Buffer in View Space
-    vec3 world_normal = texture(s_Normal, tex_coord).rgb;
-	vec3 view_normal = world_to_view_space_normal(world_normal);
+    float camera_facing_refl_attenuation = 1.0 - smoothstep(0.25, 0.5, dot(-view_dir, reflection));
 
-	// Retrieve metalness and roughness values
-	float metallic = texture(s_Metallic, tex_coord).r;
+    if (camera_facing_refl_attenuation <= 0.0)
+        return vec4(0.0);
 
-	vec3 view_dir = normalize(view_pos);
+    // Clip the ray against the near plane before projecting the end point.
+    float ray_length = (view_pos.z + reflection.z * far_plane) > -near_plane ? (-near_plane - view_pos.z) / reflection.z : far_plane;
 
-	// Calculate reflection vector
-	vec3 reflection = normalize(reflect(view_dir, view_normal));
+    vec4 end_clip = proj_mat * vec4(view_pos + reflection * ray_length, 1.0);
+    vec3 end_ss   = (end_clip.xyz / end_clip.w) * 0.5 + 0.5;
+    vec3 start_ss = vec3(tex_coord, depth);
 
-	float camera_facing_refl_attenuation = 1.0 - smoothstep(0.25, 0.5, dot(-view_dir, reflection));
+    vec3 hit = hiz_trace(start_ss, end_ss - start_ss);
 
-	if (camera_facing_refl_attenuation <= 0.0 || metallic < 0.1)
-		imageStore(i_SSR, ivec2(gl_GlobalInvocationID.x, gl_GlobalInvocationID.y), vec4(0.0, 0.0, 0.0, 0.0));
-	else
-	{
-		vec3 wp = vec3(inv_view * vec4(view_pos, 1.0));
-		//vec3 jitt = mix(vec3(0.0), vec3(hash(wp)), roughness);
+    if (hit.z == 0.0)
+        return vec4(0.0);
 
-		vec3 hit_pos = view_pos;
-		float out_depth;
-		vec3 ray = reflection * max(kMinRayStep, -view_pos.z);
+    vec2  edge               = smoothstep(0.2, 0.6, abs(vec2(0.5) - hit.xy));
+    float screen_edge_factor = clamp(1.0 - (edge.x + edge.y), 0.0, 1.0);
+    float roughness_fade     = 1.0 - smoothstep(u_MaxRoughness * 0.75, u_MaxRoughness, roughness);
 
-		vec3 hit_coord = ray_march(ray, hit_pos);
-
-		vec2 tex_coord = smoothstep(0.2, 0.6, abs(vec2(0.5, 0.5) - hit_coord.xy));
-		float screen_edge_factor = clamp(1.0 - (tex_coord.x + tex_coord.y), 0.0, 1.0);
-		// float reflection_multiplier = screen_edge_factor * -reflection.z;
-
-		vec2 uv_sampling_attenuation = smoothstep(vec2(0.05), vec2(0.1), hit_coord.xy) * (vec2(1.0) - smoothstep(vec2(0.95), vec2(1.0), hit_coord.xy));
-		uv_sampling_attenuation.x *= uv_sampling_attenuation.y;
+    return vec4(hit.xy, camera_facing_refl_attenuation * screen_edge_factor * roughness_fade, 1.0);
+}
 
-		float total_attenuation = camera_facing_refl_attenuation * screen_edge_factor * hit_coord.z;//uv_sampling_attenuation.x;
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
 
-		imageStore(i_SSR, ivec2(gl_GlobalInvocationID.x, gl_GlobalInvocationID.y), vec4(hit_coord.xy, total_attenuation, 1.0));
-	}
+void main()
+{
+    uint  packed_tile = tiles[uint(u_TileOffset) + gl_WorkGroupID.x];
+    ivec2 tile        = ivec2(packed_tile & 0xFFFF, packed_tile >> 16);
+    ivec2 size        = imageSize(i_SSR);
+
+    if (u_HalfRes == 0)
+    {
+        ivec2 coord = tile + ivec2(gl_LocalInvocationID.xy);
+
+        if (is_reflective(coord, size))
+            imageStore(i_SSR, coord, trace(coord, size));
+    }
+    else
+    {
+        ivec2 quad = tile + ivec2(gl_LocalInvocationID.xy) * 2;
+
+        bool reflective[4];
+        int  first = -1;
+
+        for (int i = 0; i < 4; i++)
+        {
+            reflective[i] = is_reflective(quad + ivec2(i & 1, i >> 1), size);
+
+            if (reflective[i] && first == -1)
+                first = i;
+        }
+
+        if (first == -1)
+            return;
+
+        // One ray per quad, shared by every reflective pixel in it. The temporal resolve hides the lost detail.
+        vec4 result = trace(quad + ivec2(first & 1, first >> 1), size);
+
+        for (int i = 0; i < 4; i++)
+        {
+            if (reflective[i])
+                imageStore(i_SSR, quad + ivec2(i & 1, i >> 1), result);
+        }
+    }
 }
 
-// ------------------------------------------------------------------
\ No newline at end of file
+// ------------------------------------------------------------------
@@ -1,353 +1,219 @@
-// GLSL port of the Temporal Anti-Aliasing implementation from Playdead
-// https://github.com/playdeadgames/temporal/
+#include <../../common/uniforms.glsl>
 
 // ------------------------------------------------------------------
-// OUTPUT VARIABLES  ------------------------------------------------
+// DEFINES ----------------------------------------------------------
 // ------------------------------------------------------------------
 
-out vec3 FS_OUT_Color;
+// Temporal reconstruction of the output resolution from jittered frames that may have been rendered at a lower resolution. Every
+// output pixel gathers the 3x3 rendered samples around it, weighted by the distance of their unjittered positions, and blends the
+// result into the reprojected history. The history is clipped against the variance of the same neighbourhood.
+
+#define TAA_VARIANCE_GAMMA 1.0
+#define TAA_FLT_EPS 0.00000001
 
 // ------------------------------------------------------------------
-// INPUT VARIABLES  -------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
 // ------------------------------------------------------------------
 
-int vec2 FS_IN_TexCoord;
+layout (location = 0) out vec3 FS_OUT_FragColor;
+layout (location = 1) out vec4 FS_OUT_History;
 
 // ------------------------------------------------------------------
-// UNIFORMS  --------------------------------------------------------
+// INPUTS -----------------------------------------------------------
 // ------------------------------------------------------------------
 
-uniform sampler2D s_Current;
-uniform sampler2D s_Prev;
-uniform sampler2D s_Velocity;
-
-#ifdef USE_MOTION_BLUR_NEIGHBORMAX
-    uniform sampler2D s_VelocityNeighborMax;
-
-    uniform float u_MotionScale;
-#endif
-
-uniform vec4 u_TexelSize;
-uniform float u_FeedbackMin;
-uniform float u_FeedbackMax;
+in vec2 FS_IN_TexCoord;
 
 // ------------------------------------------------------------------
-// CONSTANTS  -------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
 // ------------------------------------------------------------------
 
-const float FLT_EPS = 0.00000001f;
+uniform sampler2D s_Color;
+uniform sampler2D s_Velocity;
+uniform sampler2D s_Depth;
+uniform sampler2D s_History;
+
+uniform float u_Feedback;
+uniform int   u_HistoryValid;
+uniform int   u_ClosestVelocity;
 
 // ------------------------------------------------------------------
-// FUNCTIONS  -------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
 // ------------------------------------------------------------------
 
 // https://software.intel.com/en-us/node/503873
-vec3 RGB_YCoCg(vec3 c)
+vec3 rgb_to_ycocg(vec3 c)
 {
-	// Y = R/4 + G/2 + B/4
-	// Co = R/2 - B/2
-	// Cg = -R/4 + G/2 - B/4
-	return vec3(
-		 c.x/4.0 + c.y/2.0 + c.z/4.0,
-		 c.x/2.0 - c.z/2.0,
-		-c.x/4.0 + c.y/2.0 - c.z/4.0
-	);
+    return vec3(c.x * 0.25 + c.y * 0.5 + c.z * 0.25,
+                c.x * 0.5 - c.z * 0.5,
+                -c.x * 0.25 + c.y * 0.5 - c.z * 0.25);
 }
 
 // ------------------------------------------------------------------
 
-// https://software.intel.com/en-us/node/503873
-vec3 YCoCg_RGB(vec3 c)
+vec3 ycocg_to_rgb(vec3 c)
 {
-	// R = Y + Co - Cg
-	// G = Y + Cg
-	// B = Y - Co - Cg
-	return clamp(vec3(
-		c.x + c.y - c.z,
-		c.x + c.z,
-		c.x - c.y - c.z
-	), 0.0, 1.0);
+    return vec3(c.x + c.y - c.z,
+                c.x + c.z,
+                c.x - c.y - c.z);
 }
 
 // ------------------------------------------------------------------
 
-vec4 sample_color(sampler2D tex, vec2 uv)
+// Compresses HDR values before filtering so that a few very bright samples do not dominate the neighbourhood (Karis 2014).
+vec3 tonemap(vec3 c)
 {
-#ifdef USE_YCOCG
-	vec4 c = texture(tex, uv);
-	return vec4(RGB_YCoCg(c.rgb), c.a);
-#else
-	return texture(tex, uv);
-#endif
+    return c / (1.0 + max(c.r, max(c.g, c.b)));
 }
 
 // ------------------------------------------------------------------
 
-vec4 resolve_color(vec4 c)
+vec3 inverse_tonemap(vec3 c)
 {
-#ifdef USE_YCOCG
-	return vec4(YCoCg_RGB(c.rgb).rgb, c.a);
-#else
-	return c;
-#endif
+    return c / max(1.0 - max(c.r, max(c.g, c.b)), TAA_FLT_EPS);
 }
 
 // ------------------------------------------------------------------
 
-vec4 clip_aabb(vec3 aabb_min, vec3 aabb_max, vec4 p, vec4 q)
+// Gaussian fit of the Blackman-Harris window over a distance measured in rendered pixels.
+float reconstruction_weight(vec2 d)
 {
-#ifdef USE_OPTIMIZATIONS
-	// note: only clips towards aabb center (but fast!)
-	vec3 p_clip = 0.5 * (aabb_max + aabb_min);
-	vec3 e_clip = 0.5 * (aabb_max - aabb_min) + FLT_EPS;
-	vec4 v_clip = q - vec4(p_clip, p.w);
-	vec3 v_unit = v_clip.xyz / e_clip;
-	vec3 a_unit = abs(v_unit);
-	float ma_unit = max(a_unit.x, max(a_unit.y, a_unit.z));
-	if (ma_unit > 1.0)
-		return vec4(p_clip, p.w) + v_clip / ma_unit;
-	else
-		return q;// point inside aabb
-#else
-	vec4 r = q - p;
-	vec3 rmax = aabb_max - p.xyz;
-	vec3 rmin = aabb_min - p.xyz;
-	const float eps = FLT_EPS;
-	if (r.x > rmax.x + eps)
-		r *= (rmax.x / r.x);
-	if (r.y > rmax.y + eps)
-		r *= (rmax.y / r.y);
-	if (r.z > rmax.z + eps)
-		r *= (rmax.z / r.z);
-	if (r.x < rmin.x - eps)
-		r *= (rmin.x / r.x);
-	if (r.y < rmin.y - eps)
-		r *= (rmin.y / r.y);
-	if (r.z < rmin.z - eps)
-		r *= (rmin.z / r.z);
-	return p + r;
-#endif
+    return exp(-2.29 * dot(d, d));
 }
 
 // ------------------------------------------------------------------
 
-vec2 sample_velocity_dilated(sampler2D tex, vec2 uv, int support)
+// 5-tap Catmull-Rom filter built on top of bilinear fetches. Keeps the history sharp while it is resampled every frame.
+vec3 sample_history(vec2 tex_coord)
 {
-	vec2 du = vec2(u_TexelSize.x, 0.0);
-	vec2 dv = vec2(0.0, u_TexelSize.y);
-	vec2 mv = 0.0;
-	float rmv = 0.0;
-	int end = support + 1;
-	for (int i = -support; i != end; i++)
-	{
-		for (int j = -support; j != end; j++)
-		{
-			vec2 v = texture(tex, uv + i * dv + j * du).xy;
-			float rv = dot(v, v);
-			if (rv > rmv)
-			{
-				mv = v;
-				rmv = rv;
-			}
-		}
-	}
-	return mv;
+    vec2 size     = vec2(textureSize(s_History, 0));
+    vec2 texel    = 1.0 / size;
+    vec2 position = tex_coord * size;
+    vec2 center   = floor(position - 0.5) + 0.5;
+    vec2 f        = position - center;
+    vec2 f2       = f * f;
+    vec2 f3       = f2 * f;
+
+    vec2 w0  = -0.5 * f3 + f2 - 0.5 * f;
+    vec2 w1  = 1.5 * f3 - 2.5 * f2 + 1.0;
+    vec2 w2  = -1.5 * f3 + 2.0 * f2 + 0.5 * f;
+    vec2 w3  = 0.5 * f3 - 0.5 * f2;
+    vec2 w12 = w1 + w2;
+
+    vec2 tc0  = (center - 1.0) * texel;
+    vec2 tc3  = (center + 2.0) * texel;
+    vec2 tc12 = (center + w2 / w12) * texel;
+
+    vec3 result = vec3(0.0);
+
+    result += texture(s_History, vec2(tc12.x, tc0.y)).rgb * (w12.x * w0.y);
+    result += texture(s_History, vec2(tc0.x, tc12.y)).rgb * (w0.x * w12.y);
+    result += texture(s_History, vec2(tc12.x, tc12.y)).rgb * (w12.x * w12.y);
+    result += texture(s_History, vec2(tc3.x, tc12.y)).rgb * (w3.x * w12.y);
+    result += texture(s_History, vec2(tc12.x, tc3.y)).rgb * (w12.x * w3.y);
+
+    float weight = (w12.x * w0.y) + (w0.x * w12.y) + (w12.x * w12.y) + (w3.x * w12.y) + (w12.x * w3.y);
+
+    return max(result / weight, vec3(0.0));
 }
 
 // ------------------------------------------------------------------
 
-vec4 sample_color_motion(sampler2D tex, vec2 uv, vec2 ss_vel)
+// Moves the history color towards the center of the neighbourhood box until it lies inside it.
+vec3 clip_aabb(vec3 box_min, vec3 box_max, vec3 history)
 {
-	const vec2 v = 0.5 * ss_vel;
-	const int taps = 3;// on either side!
-	float srand = PDsrand(uv + _SinTime.xx);
-	vec2 vtap = v / taps;
-	vec2 pos0 = uv + vtap * (0.5 * srand);
-	vec4 accu = 0.0;
-	float wsum = 0.0;
-	[unroll]
-	for (int i = -taps; i <= taps; i++)
-	{
-		float w = 1.0;// box
-		//float w = taps - abs(i) + 1;// triangle
-		//float w = 1.0 / (1 + abs(i));// pointy triangle
-		accu += w * sample_color(tex, pos0 + i * vtap);
-		wsum += w;
-	}
-	return accu / wsum;
-}
-
-// ------------------------------------------------------------------
+    vec3  center  = 0.5 * (box_max + box_min);
+    vec3  extents = 0.5 * (box_max - box_min) + TAA_FLT_EPS;
+    vec3  offset  = history - center;
+    vec3  ts      = abs(offset) / extents;
+    float t       = max(ts.x, max(ts.y, ts.z));
 
-vec4 temporal_reprojection(vec2 ss_txc, vec2 ss_vel, float vs_dist)
-{
-	// read texels
-#ifdef UNJITTER_COLORSAMPLES
-	vec4 texel0 = sample_color(s_Current, ss_txc - current_prev_jitter.xy);
-#else
-	vec4 texel0 = sample_color(s_Current, ss_txc);
-#endif
-
-	vec4 texel1 = sample_color(s_Prev, ss_txc - ss_vel);
-
-	// calc min-max of current neighbourhood
-#ifdef UNJITTER_NEIGHBORHOOD
-	vec2 uv = ss_txc - current_prev_jitter.xy;
-#else
-	vec2 uv = ss_txc;
-#endif
-
-#ifdef MINMAX_3X3 || MINMAX_3X3_ROUNDED
-	vec2 du = vec2(u_TexelSize.x, 0.0);
-	vec2 dv = vec2(0.0, u_TexelSize.y);
-	vec4 ctl = sample_color(s_Current, uv - dv - du);
-	vec4 ctc = sample_color(s_Current, uv - dv);
-	vec4 ctr = sample_color(s_Current, uv - dv + du);
-	vec4 cml = sample_color(s_Current, uv - du);
-	vec4 cmc = sample_color(s_Current, uv);
-	vec4 cmr = sample_color(s_Current, uv + du);
-	vec4 cbl = sample_color(s_Current, uv + dv - du);
-	vec4 cbc = sample_color(s_Current, uv + dv);
-	vec4 cbr = sample_color(s_Current, uv + dv + du);
-	vec4 cmin = min(ctl, min(ctc, min(ctr, min(cml, min(cmc, min(cmr, min(cbl, min(cbc, cbr))))))));
-	vec4 cmax = max(ctl, max(ctc, max(ctr, max(cml, max(cmc, max(cmr, max(cbl, max(cbc, cbr))))))));
-
-	#ifdef MINMAX_3X3_ROUNDED || USE_YCOCG || USE_CLIPPING
-		vec4 cavg = (ctl + ctc + ctr + cml + cmc + cmr + cbl + cbc + cbr) / 9.0;
-	#endif
-
-	#ifdef MINMAX_3X3_ROUNDED
-		vec4 cmin5 = min(ctc, min(cml, min(cmc, min(cmr, cbc))));
-		vec4 cmax5 = max(ctc, max(cml, max(cmc, max(cmr, cbc))));
-		vec4 cavg5 = (ctc + cml + cmc + cmr + cbc) / 5.0;
-		cmin = 0.5 * (cmin + cmin5);
-		cmax = 0.5 * (cmax + cmax5);
-		cavg = 0.5 * (cavg + cavg5);
-	#endif
-
-#elif MINMAX_4TAP_VARYING// this is the method used in v2 (PDTemporalReprojection2)
-	const float _SubpixelThreshold = 0.5;
-	const float _GatherBase = 0.5;
-	const float _GatherSubpixelMotion = 0.1666;
-	vec2 texel_vel = ss_vel / u_TexelSize.xy;
-	float texel_vel_mag = length(texel_vel) * vs_dist;
-	float k_subpixel_motion = clamp(_SubpixelThreshold / (FLT_EPS + texel_vel_mag), 0.0, 1.0);
-	float k_min_max_support = _GatherBase + _GatherSubpixelMotion * k_subpixel_motion;
-	vec2 ss_offset01 = k_min_max_support * vec2(-u_TexelSize.x, u_TexelSize.y);
-	vec2 ss_offset11 = k_min_max_support * vec2(u_TexelSize.x, u_TexelSize.y);
-	vec4 c00 = sample_color(s_Current, uv - ss_offset11);
-	vec4 c10 = sample_color(s_Current, uv - ss_offset01);
-	vec4 c01 = sample_color(s_Current, uv + ss_offset01);
-	vec4 c11 = sample_color(s_Current, uv + ss_offset11);
-	vec4 cmin = min(c00, min(c10, min(c01, c11)));
-	vec4 cmax = max(c00, max(c10, max(c01, c11)));
-
-	#ifdef USE_YCOCG || USE_CLIPPING
-		vec4 cavg = (c00 + c10 + c01 + c11) / 4.0;
-	#endif
-#else
-	#error "missing keyword MINMAX_..."
-#endif
-
-	// shrink chroma min-max
-#ifdef USE_YCOCG
-	vec2 chroma_extent = 0.25 * 0.5 * (cmax.r - cmin.r);
-	vec2 chroma_center = texel0.gb;
-	cmin.yz = chroma_center - chroma_extent;
-	cmax.yz = chroma_center + chroma_extent;
-	cavg.yz = chroma_center;
-#endif
-
-	// clamp to neighbourhood of current sample
-#ifdef USE_CLIPPING
-	texel1 = clip_aabb(cmin.xyz, cmax.xyz, clamp(cavg, cmin, cmax), texel1);
-#else
-	texel1 = clamp(texel1, cmin, cmax);
-#endif
-
-	// feedback weight from unbiased luminance diff (t.lottes)
-#ifdef USE_YCOCG
-	float lum0 = texel0.r;
-	float lum1 = texel1.r;
-#else
-	float lum0 = Luminance(texel0.rgb);
-	float lum1 = Luminance(texel1.rgb);
-#endif
-	float unbiased_diff = abs(lum0 - lum1) / max(lum0, max(lum1, 0.2));
-	float unbiased_weight = 1.0 - unbiased_diff;
-	float unbiased_weight_sqr = unbiased_weight * unbiased_weight;
-	float k_feedback = mix(u_FeedbackMin, u_FeedbackMax, unbiased_weight_sqr);
-	// output
-	return mix(texel0, texel1, k_feedback);
+    return t > 1.0 ? center + offset / t : history;
 }
 
 // ------------------------------------------------------------------
-// MAIN  ------------------------------------------------------------
+// MAIN -------------------------------------------------------------
 // ------------------------------------------------------------------
 
 void main()
 {
-#ifdef UNJITTER_REPROJECTION
-	vec2 uv = FS_IN_TexCoord - current_prev_jitter.xy;
-#else
-	vec2 uv = FS_IN_TexCoord;
-#endif
-
-#ifdef USE_DILATION
-	//--- 3x3 norm (sucks)
-	//vec2 ss_vel = sample_velocity_dilated(s_Velocity, uv, 1);
-	//float vs_dist = depth_sample_linear(uv);
-	//--- 5 tap nearest (decent)
-	//vec3 c_frag = find_closest_fragment_5tap(uv);
-	//vec2 ss_vel = texture(s_Velocity, c_frag.xy).xy;
-	//float vs_dist = depth_resolve_linear(c_frag.z);
-	//--- 3x3 nearest (good)
-	vec3 c_frag = find_closest_fragment_3x3(uv);
-	vec2 ss_vel = texture(s_Velocity, c_frag.xy).xy;
-	float vs_dist = depth_resolve_linear(c_frag.z);
-#else
-	vec2 ss_vel = texture(s_Velocity, uv).xy;
-	float vs_dist = depth_sample_linear(uv);
-#endif
-	// temporal resolve
-	vec4 color_temporal = temporal_reprojection(FS_IN_TexCoord, ss_vel, vs_dist);
-	// prepare outputs
-	vec4 to_buffer = resolve_color(color_temporal);
-	
-#ifdef USE_MOTION_BLUR
-	#ifdef USE_MOTION_BLUR_NEIGHBORMAX
-		ss_vel = u_MotionScale * texture(s_VelocityNeighborMax, FS_IN_TexCoord).xy;
-	#else
-		ss_vel = u_MotionScale * ss_vel;
-	#endif
-
-	float vel_mag = length(ss_vel * u_TexelSize.zw);
-	const float vel_trust_full = 2.0;
-	const float vel_trust_none = 15.0;
-	const float vel_trust_span = vel_trust_none - vel_trust_full;
-	float trust = 1.0 - clamp(vel_mag - vel_trust_full, 0.0, vel_trust_span) / vel_trust_span;
-
-	#ifdef UNJITTER_COLORSAMPLES
-		vec4 color_motion = sample_color_motion(s_Current, FS_IN_TexCoord - current_prev_jitter.xy, ss_vel);
-	#else
-		vec4 color_motion = sample_color_motion(s_Current, FS_IN_TexCoord, ss_vel);
-	#endif
-
-	vec4 to_screen = resolve_color(mix(color_motion, color_temporal, trust));
-#else
-	vec4 to_screen = resolve_color(color_temporal);
-#endif
-
-	//// NOTE: velocity debug
-	//to_screen.g += 100.0 * length(ss_vel);
-	//to_screen = vec4(100.0 * abs(ss_vel), 0.0, 0.0);
-	// add noise
-	vec4 noise4 = PDsrand4(FS_IN_TexCoord + _SinTime.x + 0.6959174) / 510.0;
-	OUT.buffer = clamp(to_buffer + noise4, 0.0, 1.0);
-	OUT.screen = clamp(to_screen + noise4, 0.0, 1.0);
-
-	// done
-	return OUT;
+    ivec2 render_size = textureSize(s_Color, 0);
+
+    // The samples of the current frame were rendered with the projection offset by the jitter, so the sample at the center of
+    // rendered pixel p represents the unjittered position (p + 0.5) / size - jitter.
+    vec2  jitter     = current_prev_jitter.xy * 0.5;
+    vec2  render_pos = (FS_IN_TexCoord + jitter) * vec2(render_size);
+    ivec2 base_coord = ivec2(floor(render_pos));
+
+    vec3  accum         = vec3(0.0);
+    float weight_sum    = 0.0;
+    float max_weight    = 0.0;
+    vec3  m1            = vec3(0.0);
+    vec3  m2            = vec3(0.0);
+    vec3  box_min       = vec3(1.0e10);
+    vec3  box_max       = vec3(-1.0e10);
+    float closest       = 1.0;
+    ivec2 closest_coord = clamp(base_coord, ivec2(0), render_size - 1);
+
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            ivec2 coord  = clamp(base_coord + ivec2(x, y), ivec2(0), render_size - 1);
+            vec3  color  = rgb_to_ycocg(tonemap(texelFetch(s_Color, coord, 0).rgb));
+            float weight = reconstruction_weight(vec2(base_coord + ivec2(x, y)) + 0.5 - render_pos);
+
+            accum      += color * weight;
+            weight_sum += weight;
+            max_weight  = max(max_weight, weight);
+
+            m1      += color;
+            m2      += color * color;
+            box_min = min(box_min, color);
+            box_max = max(box_max, color);
+
+            if (u_ClosestVelocity == 1)
+            {
+                float depth = texelFetch(s_Depth, coord, 0).r;
+
+                if (depth < closest)
+                {
+                    closest       = depth;
+                    closest_coord = coord;
+                }
+            }
+        }
+    }
+
+    vec3 current = accum / weight_sum;
+
+    // Velocity of the front-most surface in the neighbourhood so that silhouettes are reprojected with the moving object.
+    vec2 velocity          = texelFetch(s_Velocity, closest_coord, 0).rg;
+    vec2 history_tex_coord = FS_IN_TexCoord - velocity;
+
+    vec3 resolved = current;
+
+    if (u_HistoryValid == 1 && all(greaterThanEqual(history_tex_coord, vec2(0.0))) && all(lessThanEqual(history_tex_coord, vec2(1.0))))
+    {
+        vec3 history = rgb_to_ycocg(tonemap(sample_history(history_tex_coord)));
+
+        // Variance clipping, bounded by the min-max box of the neighbourhood.
+        vec3 mean  = m1 / 9.0;
+        vec3 sigma = sqrt(abs(m2 / 9.0 - mean * mean));
+
+        history = clip_aabb(max(box_min, mean - TAA_VARIANCE_GAMMA * sigma), min(box_max, mean + TAA_VARIANCE_GAMMA * sigma), history);
+
+        // Output pixels that are far from every sample of this frame rely more on the history. At reduced render scales most output
+        // pixels only receive a nearby sample every few frames.
+        float alpha = clamp((1.0 - u_Feedback) * max_weight, 0.0, 1.0);
+
+        resolved = mix(history, current, alpha);
+    }
+
+    vec3 color = inverse_tonemap(ycocg_to_rgb(resolved));
+
+    FS_OUT_History   = vec4(color, 1.0);
+    FS_OUT_FragColor = color;
 }
 
-// ------------------------------------------------------------------
\ No newline at end of file
+// ------------------------------------------------------------------
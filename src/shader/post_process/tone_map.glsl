@@ -0,0 +1,29 @@
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// The tone mapping LUT is indexed by exposed color in log2 space, which spreads its texels evenly over the stops of the scene.
+#define TONE_MAP_LUT_SIZE 32
+#define TONE_MAP_LUT_MIN_LOG2 -10.0
+#define TONE_MAP_LUT_MAX_LOG2 6.0
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+vec3 lut_encode(vec3 linear_color)
+{
+    return clamp((log2(max(linear_color, vec3(1e-10))) - TONE_MAP_LUT_MIN_LOG2) / (TONE_MAP_LUT_MAX_LOG2 - TONE_MAP_LUT_MIN_LOG2), 0.0, 1.0);
+}
+
+// ------------------------------------------------------------------
+
+// The bottom of the encoded range decodes to black so that the LUT does not lift the black level.
+vec3 lut_decode(vec3 log_color)
+{
+    vec3 linear_color = exp2(mix(vec3(TONE_MAP_LUT_MIN_LOG2), vec3(TONE_MAP_LUT_MAX_LOG2), log_color));
+
+    return mix(linear_color, vec3(0.0), lessThanEqual(log_color, vec3(0.0)));
+}
+
+// ------------------------------------------------------------------
@@ -0,0 +1,180 @@
+#include <../common/uniforms.glsl>
+#include <../common/helper.glsl>
+#include <tone_map.glsl>
+
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+#define TONE_MAP_LUT_NUM_THREADS 4
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = TONE_MAP_LUT_NUM_THREADS, local_size_y = TONE_MAP_LUT_NUM_THREADS, local_size_z = TONE_MAP_LUT_NUM_THREADS) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (binding = 0, rgba16f) writeonly uniform image3D i_LUT;
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_LUT;
+
+uniform int u_ToneMapOperator;
+uniform float u_Saturation;
+uniform float u_Contrast;
+uniform float u_Lift;
+uniform float u_Gamma;
+uniform float u_Gain;
+
+// ------------------------------------------------------------------
+// CONSTANTS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Global constants for Uncharted 2 tone mapping.
+const float A = 0.15;
+const float B = 0.50;
+const float C = 0.10;
+const float D = 0.20;
+const float E = 0.02;
+const float F = 0.30;
+const float W = 11.2;
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+vec3 reinhard_tone_mapping(vec3 exp_color)
+{
+	vec3 ret_color = exp_color;
+	ret_color = ret_color / (1.0 + ret_color);
+
+	return ret_color;
+}
+
+// ------------------------------------------------------------------
+
+vec3 haarm_peter_duiker_tone_mapping(vec3 exp_color)
+{
+	vec3 ld = vec3(0.002);
+	float lin_reference = 0.18;
+	float log_reference = 444;
+	float log_gamma = 0.45;
+
+	vec3 log_color = (log10(0.4 * exp_color / lin_reference) / ld * log_gamma + log_reference) / 1023.0;
+	log_color = clamp(log_color, 0.0, 1.0);
+
+	float film_lut_width = 256;
+   	float padding = 0.5 / film_lut_width;
+      
+	//  apply response lookup and color grading for target display
+	vec3 ret_color;
+	ret_color.r = texture(s_LUT, vec2(mix(padding, 1.0 - padding, log_color.r), 0.5)).r;
+	ret_color.g = texture(s_LUT, vec2(mix(padding, 1.0 - padding, log_color.g), 0.5)).r;
+	ret_color.b = texture(s_LUT, vec2(mix(padding, 1.0 - padding, log_color.b), 0.5)).r;
+
+	return ret_color;
+}
+
+// ------------------------------------------------------------------
+
+vec3 filmic_tone_mapping(vec3 exp_color)
+{
+	vec3 x = max(vec3(0.0), exp_color - vec3(0.004));
+   	vec3 ret_color = (x * (6.2 * x + 0.5)) / (x * (6.2 * x + 1.7) + 0.06);
+
+	return ret_color; 
+}
+
+// ------------------------------------------------------------------
+
+vec3 u2_func(vec3 x)
+{
+	return ((x*(A*x+C*B)+D*E)/(x*(A*x+B)+D*F))-E/F;
+}
+
+// ------------------------------------------------------------------
+
+vec3 uncharted_2_tone_mapping(vec3 exp_color)
+{
+	float exposure_bias = 2.0;
+	vec3 curr = u2_func(exposure_bias * exp_color);
+
+   	vec3 white_scale = 1.0f/u2_func(vec3(W));
+   	vec3 ret_color = curr * white_scale;
+
+	return ret_color;
+}
+
+// ------------------------------------------------------------------
+
+vec3 apply_tone_map(vec3 exp_color)
+{
+	if (u_ToneMapOperator == 1)
+		return reinhard_tone_mapping(exp_color);
+	else if (u_ToneMapOperator == 2)
+		return haarm_peter_duiker_tone_mapping(exp_color);
+	else if (u_ToneMapOperator == 3)
+		return filmic_tone_mapping(exp_color);
+	else if (u_ToneMapOperator == 4)
+		return uncharted_2_tone_mapping(exp_color);
+	else
+		return exp_color;  
+}
+
+// ------------------------------------------------------------------
+
+// Contrast around middle grey and saturation, applied to the exposed scene color.
+vec3 scene_grading(vec3 color)
+{
+	const float kMiddleGrey = 0.18;
+
+	vec3 log_color = log2(max(color, vec3(1e-10)));
+	color = exp2((log_color - log2(kMiddleGrey)) * u_Contrast + log2(kMiddleGrey));
+
+	return max(mix(vec3(luminance(color)), color, u_Saturation), vec3(0.0));
+}
+
+// ------------------------------------------------------------------
+
+// Lift, gamma and gain, applied to the tone mapped color.
+vec3 display_grading(vec3 color)
+{
+	color = color * u_Gain + u_Lift * (1.0 - color);
+
+	return pow(max(color, vec3(0.0)), vec3(1.0 / u_Gamma));
+}
+
+// ------------------------------------------------------------------
+
+vec3 gamma_correction(vec3 color)
+{
+	return pow(color, vec3(1.0/2.2));
+}
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+	ivec3 coord = ivec3(gl_GlobalInvocationID);
+
+	if (any(greaterThanEqual(coord, ivec3(TONE_MAP_LUT_SIZE))))
+		return;
+
+	// Texel centers map to the ends of the encoded range, matching the half texel offset used when sampling.
+	vec3 exp_color = lut_decode(vec3(coord) / float(TONE_MAP_LUT_SIZE - 1));
+
+	vec3 tone_mapped_color = display_grading(apply_tone_map(scene_grading(exp_color)));
+
+	imageStore(i_LUT, coord, vec4(gamma_correction(tone_mapped_color), 1.0));
+}
+
+// ------------------------------------------------------------------
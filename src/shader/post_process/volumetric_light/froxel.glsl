@@ -0,0 +1,36 @@
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Froxel slices are distributed exponentially between the near plane and 'max_distance' so that the resolution follows the
+// perspective projection. 'slice' is normalized to [0, 1].
+float froxel_slice_to_depth(float slice, float max_distance)
+{
+    return near_plane * pow(max_distance / near_plane, slice);
+}
+
+// ------------------------------------------------------------------
+
+float froxel_depth_to_slice(float depth, float max_distance)
+{
+    return log(max(depth, near_plane) / near_plane) / log(max_distance / near_plane);
+}
+
+// ------------------------------------------------------------------
+
+// View-space direction through 'uv' scaled so that its depth is 1.
+vec3 froxel_view_ray(vec2 uv)
+{
+    vec2 ndc = uv * 2.0 - 1.0;
+    return vec3(ndc.x * tan_half_fov * aspect_ratio, ndc.y * tan_half_fov, -1.0);
+}
+
+// ------------------------------------------------------------------
+
+vec3 froxel_world_position(vec3 uvw, float max_distance)
+{
+    vec3 view_position = froxel_view_ray(uvw.xy) * froxel_slice_to_depth(uvw.z, max_distance);
+    return (inv_view * vec4(view_position, 1.0)).xyz;
+}
+
+// ------------------------------------------------------------------
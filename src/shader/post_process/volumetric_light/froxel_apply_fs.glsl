@@ -0,0 +1,42 @@
+#include <../../common/uniforms.glsl>
+#include <../../common/helper.glsl>
+#include <froxel.glsl>
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Blended with (ONE, SRC_ALPHA) so the scene color is attenuated by the transmittance before the scattering is added.
+out vec4 FS_OUT_FragColor;
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+in vec2 FS_IN_TexCoord;
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler2D s_Depth;
+uniform sampler3D s_Volume;
+
+uniform float u_MaxDistance;
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    float depth = linear_eye_depth(textureLod(s_Depth, FS_IN_TexCoord, 0.0).r);
+    float slice = froxel_depth_to_slice(depth, u_MaxDistance);
+
+    // Texel z of the volume holds the integral up to the far end of slice z.
+    float half_texel = 0.5 / float(textureSize(s_Volume, 0).z);
+
+    FS_OUT_FragColor = textureLod(s_Volume, vec3(FS_IN_TexCoord, slice - half_texel), 0.0);
+}
+
+// ------------------------------------------------------------------
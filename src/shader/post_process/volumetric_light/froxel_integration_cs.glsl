@@ -0,0 +1,69 @@
+#include <../../common/uniforms.glsl>
+#include <../../common/helper.glsl>
+#include <froxel.glsl>
+
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+#define FROXEL_NUM_THREADS 8
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = FROXEL_NUM_THREADS, local_size_y = FROXEL_NUM_THREADS) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// RGB: In-scattered light from the camera up to the far end of the slice, A: Transmittance
+layout (binding = 0, rgba16f) writeonly uniform image3D i_Integrated;
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler3D s_Scattering;
+uniform float u_MaxDistance;
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    ivec3 size  = imageSize(i_Integrated);
+    ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+
+    if (any(greaterThanEqual(coord, size.xy)))
+        return;
+
+    // Converts a distance along the view axis into a distance along the ray through this froxel column.
+    float ray_scale = length(froxel_view_ray((vec2(coord) + 0.5) / vec2(size.xy)));
+
+    vec3  scattering    = vec3(0.0);
+    float transmittance = 1.0;
+    float prev_depth    = near_plane;
+
+    // March front to back, integrating each slice analytically so that the result does not depend on the slice thickness.
+    for (int z = 0; z < size.z; z++)
+    {
+        vec4 froxel = texelFetch(s_Scattering, ivec3(coord, z), 0);
+
+        float depth = froxel_slice_to_depth(float(z + 1) / float(size.z), u_MaxDistance);
+        float step  = (depth - prev_depth) * ray_scale;
+        prev_depth  = depth;
+
+        float extinction          = max(froxel.a, 0.00001);
+        float slice_transmittance = exp(-extinction * step);
+
+        scattering += transmittance * (froxel.rgb - froxel.rgb * slice_transmittance) / extinction;
+        transmittance *= slice_transmittance;
+
+        imageStore(i_Integrated, ivec3(coord, z), vec4(scattering, transmittance));
+    }
+}
+
+// ------------------------------------------------------------------
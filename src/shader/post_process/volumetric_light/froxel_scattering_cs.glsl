@@ -0,0 +1,219 @@
+#include <../../common/uniforms.glsl>
+#include <../../common/helper.glsl>
+#include <froxel.glsl>
+
+// ------------------------------------------------------------------
+// DEFINES ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// Every thread evaluates the in-scattered light for a single froxel at a jittered depth within the slice. The result is blended
+// with the reprojected result of the previous frame so that one sample per froxel and frame converges over time.
+
+#define FROXEL_NUM_THREADS 8
+
+// ------------------------------------------------------------------
+// INPUTS -----------------------------------------------------------
+// ------------------------------------------------------------------
+
+layout (local_size_x = FROXEL_NUM_THREADS, local_size_y = FROXEL_NUM_THREADS, local_size_z = 1) in;
+
+// ------------------------------------------------------------------
+// OUTPUTS ----------------------------------------------------------
+// ------------------------------------------------------------------
+
+// RGB: In-scattered light, A: Extinction
+layout (binding = 0, rgba16f) writeonly uniform image3D i_Scattering;
+
+// ------------------------------------------------------------------
+// UNIFORMS ---------------------------------------------------------
+// ------------------------------------------------------------------
+
+uniform sampler3D s_History;
+
+uniform vec4 u_MieG;
+uniform float u_Density;
+uniform float u_MaxDistance;
+uniform float u_Jitter;
+uniform float u_HistoryWeight;
+
+// ------------------------------------------------------------------
+// FUNCTIONS --------------------------------------------------------
+// ------------------------------------------------------------------
+
+float mie_scattering(float cos_angle)
+{
+    return u_MieG.w * (u_MieG.x / (pow(u_MieG.y - u_MieG.z * cos_angle, 1.5)));
+}
+
+// ------------------------------------------------------------------
+
+float directional_light_visibility(vec3 frag_pos, int shadow_map_idx)
+{
+#ifdef DIRECTIONAL_LIGHT_SHADOW_MAPPING
+    int start_idx = shadow_map_idx * num_cascades; // Starting from this value
+    int end_idx   = start_idx + num_cascades; // Less that this value
+
+    int index = start_idx;
+
+    vec4 clip_pos = view_proj * vec4(frag_pos, 1.0);
+    clip_pos /= clip_pos.w;
+    float frag_depth = clip_pos.z * 0.5 + 0.5;
+
+    // Find shadow cascade.
+    for (int i = start_idx; i < (end_idx - 1); i++)
+    {
+        if (frag_depth > cascade_far_plane[i])
+            index = i + 1;
+    }
+
+    // Transform frag position into Light-space.
+    vec4 light_space_pos = cascade_matrix[index] * vec4(frag_pos, 1.0);
+
+    float depth = texture(s_DirectionalLightShadowMaps, vec3(light_space_pos.xy, float(index))).r;
+
+    return light_space_pos.z > depth ? 0.0 : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+// ------------------------------------------------------------------
+
+float spot_light_visibility(vec3 frag_pos, int shadow_map_idx, int light_idx)
+{
+#ifdef SPOT_LIGHT_SHADOW_MAPPING
+    vec4 light_space_pos = spot_light_shadow_matrix[shadow_map_idx] * vec4(frag_pos, 1.0);
+    vec3 proj_coords     = (light_space_pos.xyz / light_space_pos.w) * 0.5 + 0.5;
+
+    float closest_depth = texture(s_SpotLightShadowMaps, vec3(proj_coords.xy, float(shadow_map_idx))).r;
+
+    float linear_closest_depth = exp_01_to_linear_01_depth(closest_depth, 1.0, spot_light_direction_range[light_idx].w);
+    float linear_current_depth = exp_01_to_linear_01_depth(proj_coords.z, 1.0, spot_light_direction_range[light_idx].w);
+
+    return linear_current_depth - shadow_map_bias[light_idx].y > linear_closest_depth ? 0.0 : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+// ------------------------------------------------------------------
+
+float point_light_visibility(vec3 frag_pos, int shadow_map_idx, int light_idx)
+{
+#ifdef POINT_LIGHT_SHADOW_MAPPING
+    vec3  light_to_frag = frag_pos - point_light_position_range[light_idx].xyz;
+    float closest_depth = texture(s_PointLightShadowMaps, vec4(light_to_frag, float(shadow_map_idx))).r * point_light_position_range[light_idx].w;
+
+    return length(light_to_frag) - shadow_map_bias[light_idx].z > closest_depth ? 0.0 : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+// ------------------------------------------------------------------
+
+// Only shadow casting point and spot lights contribute since unshadowed local lights would light the medium through walls.
+vec3 in_scattering(vec3 frag_pos, vec3 to_camera)
+{
+    vec3 light = vec3(0.0);
+
+#ifdef DIRECTIONAL_LIGHTS
+    int directional_shadow_idx = 0;
+
+    for (int i = 0; i < directional_light_count; i++)
+    {
+        float visibility = 1.0;
+
+        if (directional_light_casts_shadow[i] == 1)
+        {
+            visibility = directional_light_visibility(frag_pos, directional_shadow_idx);
+            directional_shadow_idx++;
+        }
+
+        float cos_angle = dot(directional_light_direction[i].xyz, to_camera);
+        light += visibility * mie_scattering(cos_angle) * directional_light_color_intensity[i].xyz * directional_light_color_intensity[i].w;
+    }
+#endif
+
+#ifdef POINT_LIGHTS
+    int point_shadow_idx = 0;
+
+    for (int i = 0; i < point_light_count; i++)
+    {
+        if (point_light_casts_shadow[i] == 0)
+            continue;
+
+        float visibility = point_light_visibility(frag_pos, point_shadow_idx, i);
+        point_shadow_idx++;
+
+        vec3  light_to_frag = frag_pos - point_light_position_range[i].xyz;
+        float distance      = length(light_to_frag);
+        float attenuation   = smoothstep(point_light_position_range[i].w, 0, distance);
+        float cos_angle     = dot(light_to_frag / max(distance, 0.0001), to_camera);
+
+        light += visibility * attenuation * mie_scattering(cos_angle) * point_light_color_intensity[i].xyz * point_light_color_intensity[i].w;
+    }
+#endif
+
+#ifdef SPOT_LIGHTS
+    int spot_shadow_idx = 0;
+
+    for (int i = 0; i < spot_light_count; i++)
+    {
+        if (spot_light_casts_shadow[i] == 0)
+            continue;
+
+        float visibility = spot_light_visibility(frag_pos, spot_shadow_idx, i);
+        spot_shadow_idx++;
+
+        vec3  light_to_frag = frag_pos - spot_light_position[i].xyz;
+        float distance      = length(light_to_frag);
+        vec3  L             = -light_to_frag / max(distance, 0.0001);
+
+        float theta         = dot(L, normalize(-spot_light_direction_range[i].xyz));
+        float inner_cut_off = spot_light_cutoff_inner_outer[i].x;
+        float outer_cut_off = spot_light_cutoff_inner_outer[i].y;
+        float epsilon       = inner_cut_off - outer_cut_off;
+        float attenuation   = smoothstep(spot_light_direction_range[i].w, 0, distance) * clamp((theta - outer_cut_off) / epsilon, 0.0, 1.0);
+        float cos_angle     = dot(-L, to_camera);
+
+        light += visibility * attenuation * mie_scattering(cos_angle) * spot_light_color_intensity[i].xyz * spot_light_color_intensity[i].w;
+    }
+#endif
+
+    return light;
+}
+
+// ------------------------------------------------------------------
+// MAIN -------------------------------------------------------------
+// ------------------------------------------------------------------
+
+void main()
+{
+    ivec3 size  = imageSize(i_Scattering);
+    ivec3 coord = ivec3(gl_GlobalInvocationID.xyz);
+
+    if (any(greaterThanEqual(coord, size)))
+        return;
+
+    vec3 frag_pos  = froxel_world_position((vec3(coord) + vec3(0.5, 0.5, u_Jitter)) / vec3(size), u_MaxDistance);
+    vec3 to_camera = normalize(view_pos.xyz - frag_pos);
+
+    vec4 result = vec4(u_Density * in_scattering(frag_pos, to_camera), u_Density);
+
+    if (u_HistoryWeight > 0.0)
+    {
+        // Reproject the froxel center into the volume of the previous frame. The w component of a perspective projection is the
+        // view-space depth.
+        vec3 center    = froxel_world_position((vec3(coord) + 0.5) / vec3(size), u_MaxDistance);
+        vec4 prev_clip = last_view_proj * vec4(center, 1.0);
+        vec3 prev_uvw  = vec3((prev_clip.xy / prev_clip.w) * 0.5 + 0.5, froxel_depth_to_slice(prev_clip.w, u_MaxDistance));
+
+        if (prev_clip.w > 0.0 && all(greaterThanEqual(prev_uvw, vec3(0.0))) && all(lessThanEqual(prev_uvw, vec3(1.0))))
+            result = mix(result, textureLod(s_History, prev_uvw, 0.0), u_HistoryWeight);
+    }
+
+    imageStore(i_Scattering, coord, result);
+}
+
+// ------------------------------------------------------------------
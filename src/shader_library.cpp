@@ -304,6 +304,10 @@ Program* ShaderLibrary::create_program(const MeshType& type, const uint32_t& fla
 
         program->uniform_block_binding("u_PerEntity", 1);
 
+        // Material textures are always bound starting at unit 0, so the samplers only need to be assigned once.
+        program->use();
+        Material::set_texture_units(program, 0);
+
         m_program_cache.set(program_key.key, program);
 
         return program;
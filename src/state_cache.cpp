@@ -0,0 +1,1192 @@
+#include "state_cache.h"
+#include "logger.h"
+#include "macros.h"
+#include <string.h>
+#include <string>
+#include <imgui.h>
+
+namespace nimble
+{
+namespace state_cache
+{
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static const uint32_t kUnknown = UINT32_MAX;
+
+static const GLenum kCachedCapabilities[] = {
+    GL_DEPTH_TEST,
+    GL_CULL_FACE,
+    GL_BLEND,
+    GL_STENCIL_TEST,
+    GL_SCISSOR_TEST,
+    GL_POLYGON_OFFSET_FILL,
+    GL_TEXTURE_CUBE_MAP_SEAMLESS,
+    GL_MULTISAMPLE,
+    GL_FRAMEBUFFER_SRGB,
+    GL_DEPTH_CLAMP,
+    GL_PROGRAM_POINT_SIZE
+};
+
+static const GLenum kCachedBufferTargets[] = {
+    GL_ARRAY_BUFFER,
+    GL_ELEMENT_ARRAY_BUFFER,
+    GL_UNIFORM_BUFFER,
+    GL_SHADER_STORAGE_BUFFER,
+    GL_ATOMIC_COUNTER_BUFFER,
+    GL_DRAW_INDIRECT_BUFFER,
+    GL_DISPATCH_INDIRECT_BUFFER,
+    GL_PIXEL_PACK_BUFFER,
+    GL_PIXEL_UNPACK_BUFFER,
+    GL_COPY_READ_BUFFER,
+    GL_COPY_WRITE_BUFFER
+};
+
+static const GLenum kCachedBufferTargetBindings[] = {
+    GL_ARRAY_BUFFER_BINDING,
+    GL_ELEMENT_ARRAY_BUFFER_BINDING,
+    GL_UNIFORM_BUFFER_BINDING,
+    GL_SHADER_STORAGE_BUFFER_BINDING,
+    GL_ATOMIC_COUNTER_BUFFER_BINDING,
+    GL_DRAW_INDIRECT_BUFFER_BINDING,
+    GL_DISPATCH_INDIRECT_BUFFER_BINDING,
+    GL_PIXEL_PACK_BUFFER_BINDING,
+    GL_PIXEL_UNPACK_BUFFER_BINDING,
+    GL_COPY_READ_BUFFER_BINDING,
+    GL_COPY_WRITE_BUFFER_BINDING
+};
+
+// Only these targets have indexed binding points.
+static const GLenum kIndexedBufferTargets[] = {
+    GL_UNIFORM_BUFFER,
+    GL_SHADER_STORAGE_BUFFER,
+    GL_ATOMIC_COUNTER_BUFFER
+};
+
+static const char* kCategoryNames[] = {
+    "Capability",
+    "Blend",
+    "Depth",
+    "Raster",
+    "Program",
+    "Texture",
+    "Buffer",
+    "Vertex Array",
+    "Framebuffer"
+};
+
+#define NUM_CACHED_CAPABILITIES (sizeof(kCachedCapabilities) / sizeof(GLenum))
+#define NUM_CACHED_BUFFER_TARGETS (sizeof(kCachedBufferTargets) / sizeof(GLenum))
+#define NUM_INDEXED_BUFFER_TARGETS (sizeof(kIndexedBufferTargets) / sizeof(GLenum))
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static int32_t capability_index(GLenum cap)
+{
+    for (uint32_t i = 0; i < NUM_CACHED_CAPABILITIES; i++)
+    {
+        if (kCachedCapabilities[i] == cap)
+            return int32_t(i);
+    }
+
+    return -1;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static int32_t buffer_target_index(GLenum target)
+{
+    for (uint32_t i = 0; i < NUM_CACHED_BUFFER_TARGETS; i++)
+    {
+        if (kCachedBufferTargets[i] == target)
+            return int32_t(i);
+    }
+
+    return -1;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static int32_t indexed_buffer_target_index(GLenum target)
+{
+    for (uint32_t i = 0; i < NUM_INDEXED_BUFFER_TARGETS; i++)
+    {
+        if (kIndexedBufferTargets[i] == target)
+            return int32_t(i);
+    }
+
+    return -1;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+static GLenum texture_binding_for_target(GLenum target)
+{
+    switch (target)
+    {
+        case GL_TEXTURE_1D: return GL_TEXTURE_BINDING_1D;
+        case GL_TEXTURE_1D_ARRAY: return GL_TEXTURE_BINDING_1D_ARRAY;
+        case GL_TEXTURE_2D: return GL_TEXTURE_BINDING_2D;
+        case GL_TEXTURE_2D_ARRAY: return GL_TEXTURE_BINDING_2D_ARRAY;
+        case GL_TEXTURE_2D_MULTISAMPLE: return GL_TEXTURE_BINDING_2D_MULTISAMPLE;
+        case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: return GL_TEXTURE_BINDING_2D_MULTISAMPLE_ARRAY;
+        case GL_TEXTURE_3D: return GL_TEXTURE_BINDING_3D;
+        case GL_TEXTURE_CUBE_MAP: return GL_TEXTURE_BINDING_CUBE_MAP;
+        case GL_TEXTURE_CUBE_MAP_ARRAY: return GL_TEXTURE_BINDING_CUBE_MAP_ARRAY;
+        default: return GL_NONE;
+    }
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+struct StateCache
+{
+    struct TextureBinding
+    {
+        GLenum target;
+        GLuint texture;
+    };
+
+    struct IndexedBufferBinding
+    {
+        GLuint     buffer;
+        GLintptr   offset;
+        GLsizeiptr size;
+    };
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    StateCache()
+    {
+        NIMBLE_ZERO_MEMORY(m_counters);
+        NIMBLE_ZERO_MEMORY(m_last_frame_counters);
+        invalidate();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void invalidate()
+    {
+        for (uint32_t i = 0; i < NUM_CACHED_CAPABILITIES; i++)
+            m_capabilities[i] = kUnknown;
+
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            m_blend_func[i]  = kUnknown;
+            m_color_mask[i]  = kUnknown;
+            m_viewport[i]    = -1;
+            m_clear_color[i] = -1.0f;
+        }
+
+        m_clear_color_valid = false;
+        m_viewport_valid    = false;
+        m_blend_equation    = kUnknown;
+        m_depth_func        = kUnknown;
+        m_depth_mask        = kUnknown;
+        m_cull_face         = kUnknown;
+        m_front_face        = kUnknown;
+        m_program           = kUnknown;
+        m_active_texture    = kUnknown;
+        m_vertex_array      = kUnknown;
+        m_draw_framebuffer  = kUnknown;
+        m_read_framebuffer  = kUnknown;
+
+        for (uint32_t i = 0; i < MAX_CACHED_TEXTURE_UNITS; i++)
+        {
+            m_textures[i].target  = GL_NONE;
+            m_textures[i].texture = kUnknown;
+        }
+
+        for (uint32_t i = 0; i < NUM_CACHED_BUFFER_TARGETS; i++)
+            m_buffers[i] = kUnknown;
+
+        for (uint32_t i = 0; i < NUM_INDEXED_BUFFER_TARGETS; i++)
+        {
+            for (uint32_t j = 0; j < MAX_CACHED_BUFFER_BINDINGS; j++)
+                m_indexed_buffers[i][j].buffer = kUnknown;
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void begin_frame()
+    {
+        m_last_frame_counters = m_counters;
+        NIMBLE_ZERO_MEMORY(m_counters);
+
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+        validate();
+#endif
+
+        // Third-party code (ImGui, GLFW) changes state behind our back between frames.
+        invalidate();
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    inline bool filter(StateCategory category, bool redundant)
+    {
+        if (redundant)
+            m_counters.filtered[category]++;
+        else
+            m_counters.issued[category]++;
+
+        return redundant;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void set_capability(GLenum cap, bool enabled)
+    {
+        int32_t idx = capability_index(cap);
+
+        if (idx != -1)
+        {
+            if (filter(STATE_CATEGORY_CAPABILITY, m_capabilities[idx] == (uint32_t)enabled))
+            {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+                validate_capability(idx);
+#endif
+                return;
+            }
+
+            m_capabilities[idx] = enabled;
+        }
+        else
+            m_counters.issued[STATE_CATEGORY_CAPABILITY]++;
+
+        if (enabled)
+            glEnable(cap);
+        else
+            glDisable(cap);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void blend_func_separate(GLenum src_rgb, GLenum dst_rgb, GLenum src_alpha, GLenum dst_alpha)
+    {
+        bool redundant = m_blend_func[0] == src_rgb && m_blend_func[1] == dst_rgb && m_blend_func[2] == src_alpha && m_blend_func[3] == dst_alpha;
+
+        if (filter(STATE_CATEGORY_BLEND, redundant))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            validate_blend();
+#endif
+            return;
+        }
+
+        m_blend_func[0] = src_rgb;
+        m_blend_func[1] = dst_rgb;
+        m_blend_func[2] = src_alpha;
+        m_blend_func[3] = dst_alpha;
+
+        glBlendFuncSeparate(src_rgb, dst_rgb, src_alpha, dst_alpha);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void blend_equation(GLenum mode)
+    {
+        if (filter(STATE_CATEGORY_BLEND, m_blend_equation == mode))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            validate_blend();
+#endif
+            return;
+        }
+
+        m_blend_equation = mode;
+        glBlendEquation(mode);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void depth_func(GLenum func)
+    {
+        if (filter(STATE_CATEGORY_DEPTH, m_depth_func == func))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            validate_depth();
+#endif
+            return;
+        }
+
+        m_depth_func = func;
+        glDepthFunc(func);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void depth_mask(GLboolean flag)
+    {
+        if (filter(STATE_CATEGORY_DEPTH, m_depth_mask == (uint32_t)flag))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            validate_depth();
+#endif
+            return;
+        }
+
+        m_depth_mask = flag;
+        glDepthMask(flag);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void cull_face(GLenum mode)
+    {
+        if (filter(STATE_CATEGORY_RASTER, m_cull_face == mode))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            validate_raster();
+#endif
+            return;
+        }
+
+        m_cull_face = mode;
+        glCullFace(mode);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void front_face(GLenum mode)
+    {
+        if (filter(STATE_CATEGORY_RASTER, m_front_face == mode))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            validate_raster();
+#endif
+            return;
+        }
+
+        m_front_face = mode;
+        glFrontFace(mode);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void color_mask(GLboolean r, GLboolean g, GLboolean b, GLboolean a)
+    {
+        bool redundant = m_color_mask[0] == (uint32_t)r && m_color_mask[1] == (uint32_t)g && m_color_mask[2] == (uint32_t)b && m_color_mask[3] == (uint32_t)a;
+
+        if (filter(STATE_CATEGORY_RASTER, redundant))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            validate_raster();
+#endif
+            return;
+        }
+
+        m_color_mask[0] = r;
+        m_color_mask[1] = g;
+        m_color_mask[2] = b;
+        m_color_mask[3] = a;
+
+        glColorMask(r, g, b, a);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+    {
+        bool redundant = m_viewport_valid && m_viewport[0] == x && m_viewport[1] == y && m_viewport[2] == width && m_viewport[3] == height;
+
+        if (filter(STATE_CATEGORY_RASTER, redundant))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            validate_raster();
+#endif
+            return;
+        }
+
+        m_viewport_valid = true;
+        m_viewport[0]    = x;
+        m_viewport[1]    = y;
+        m_viewport[2]    = width;
+        m_viewport[3]    = height;
+
+        glViewport(x, y, width, height);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void clear_color(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+    {
+        bool redundant = m_clear_color_valid && m_clear_color[0] == r && m_clear_color[1] == g && m_clear_color[2] == b && m_clear_color[3] == a;
+
+        if (filter(STATE_CATEGORY_RASTER, redundant))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            validate_raster();
+#endif
+            return;
+        }
+
+        m_clear_color_valid = true;
+        m_clear_color[0]    = r;
+        m_clear_color[1]    = g;
+        m_clear_color[2]    = b;
+        m_clear_color[3]    = a;
+
+        glClearColor(r, g, b, a);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void use_program(GLuint program)
+    {
+        if (filter(STATE_CATEGORY_PROGRAM, m_program == program))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            validate_program();
+#endif
+            return;
+        }
+
+        m_program = program;
+        glUseProgram(program);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void active_texture(uint32_t unit)
+    {
+        if (filter(STATE_CATEGORY_TEXTURE, m_active_texture == unit))
+            return;
+
+        m_active_texture = unit;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void bind_texture(uint32_t unit, GLenum target, GLuint texture)
+    {
+        if (unit >= MAX_CACHED_TEXTURE_UNITS)
+        {
+            m_counters.issued[STATE_CATEGORY_TEXTURE]++;
+            m_active_texture = unit;
+            glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(target, texture);
+            return;
+        }
+
+        // A unit can hold one texture per target, but only the most recent binding is tracked. Binding a different target therefore
+        // always reaches the driver, which is conservative but never wrong.
+        TextureBinding& binding = m_textures[unit];
+
+        if (filter(STATE_CATEGORY_TEXTURE, binding.target == target && binding.texture == texture))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            validate_texture_unit(unit);
+#endif
+            return;
+        }
+
+        active_texture(unit);
+
+        binding.target  = target;
+        binding.texture = texture;
+
+        glBindTexture(target, texture);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void bind_textures(uint32_t first, uint32_t count, const GLenum* targets, const GLuint* textures)
+    {
+        bool cached = first + count <= MAX_CACHED_TEXTURE_UNITS;
+
+        for (uint32_t i = 0; cached && i < count; i++)
+        {
+            const TextureBinding& binding = m_textures[first + i];
+            cached                        = binding.target == targets[i] && binding.texture == textures[i];
+        }
+
+        if (filter(STATE_CATEGORY_TEXTURE, cached))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            for (uint32_t i = 0; i < count; i++)
+                validate_texture_unit(first + i);
+#endif
+            return;
+        }
+
+#if !defined(__EMSCRIPTEN__)
+        // glBindTextures (core since OpenGL 4.4) replaces every target on each unit and leaves the active texture unit untouched.
+        if (GLAD_GL_VERSION_4_4)
+        {
+            for (uint32_t i = 0; i < count && first + i < MAX_CACHED_TEXTURE_UNITS; i++)
+            {
+                m_textures[first + i].target  = targets[i];
+                m_textures[first + i].texture = textures[i];
+            }
+
+            glBindTextures(first, count, textures);
+            return;
+        }
+#endif
+
+        // The issued counter was already bumped above, so undo it to keep the statistics per actual call.
+        m_counters.issued[STATE_CATEGORY_TEXTURE]--;
+
+        for (uint32_t i = 0; i < count; i++)
+            bind_texture(first + i, targets[i], textures[i]);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void bind_texture(GLenum target, GLuint texture)
+    {
+        if (m_active_texture == kUnknown)
+        {
+            GLint unit = 0;
+            glGetIntegerv(GL_ACTIVE_TEXTURE, &unit);
+            m_active_texture = unit - GL_TEXTURE0;
+        }
+
+        bind_texture(m_active_texture, target, texture);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void bind_buffer(GLenum target, GLuint buffer)
+    {
+        int32_t idx = buffer_target_index(target);
+
+        if (idx == -1)
+        {
+            m_counters.issued[STATE_CATEGORY_BUFFER]++;
+            glBindBuffer(target, buffer);
+            return;
+        }
+
+        if (filter(STATE_CATEGORY_BUFFER, m_buffers[idx] == buffer))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            validate_buffer(idx);
+#endif
+            return;
+        }
+
+        m_buffers[idx] = buffer;
+        glBindBuffer(target, buffer);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void bind_buffer_range(GLenum target, uint32_t index, GLuint buffer, GLintptr offset, GLsizeiptr size, bool whole)
+    {
+        int32_t target_idx = indexed_buffer_target_index(target);
+
+        if (target_idx != -1 && index < MAX_CACHED_BUFFER_BINDINGS)
+        {
+            IndexedBufferBinding& binding = m_indexed_buffers[target_idx][index];
+
+            if (filter(STATE_CATEGORY_BUFFER, binding.buffer == buffer && binding.offset == offset && binding.size == size))
+                return;
+
+            binding.buffer = buffer;
+            binding.offset = offset;
+            binding.size   = size;
+        }
+        else
+            m_counters.issued[STATE_CATEGORY_BUFFER]++;
+
+        if (whole)
+            glBindBufferBase(target, index, buffer);
+        else
+            glBindBufferRange(target, index, buffer, offset, size);
+
+        // Indexed binds also replace the generic binding point of the target.
+        int32_t idx = buffer_target_index(target);
+
+        if (idx != -1)
+            m_buffers[idx] = buffer;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void bind_vertex_array(GLuint vao)
+    {
+        if (filter(STATE_CATEGORY_VERTEX_ARRAY, m_vertex_array == vao))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            validate_vertex_array();
+#endif
+            return;
+        }
+
+        m_vertex_array = vao;
+        glBindVertexArray(vao);
+
+        // The element array binding is part of the vertex array object.
+        m_buffers[buffer_target_index(GL_ELEMENT_ARRAY_BUFFER)] = kUnknown;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void bind_framebuffer(GLenum target, GLuint fbo)
+    {
+        bool redundant = false;
+
+        if (target == GL_FRAMEBUFFER)
+            redundant = m_draw_framebuffer == fbo && m_read_framebuffer == fbo;
+        else if (target == GL_DRAW_FRAMEBUFFER)
+            redundant = m_draw_framebuffer == fbo;
+        else if (target == GL_READ_FRAMEBUFFER)
+            redundant = m_read_framebuffer == fbo;
+
+        if (filter(STATE_CATEGORY_FRAMEBUFFER, redundant))
+        {
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+            validate_framebuffer();
+#endif
+            return;
+        }
+
+        if (target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER)
+            m_draw_framebuffer = fbo;
+
+        if (target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER)
+            m_read_framebuffer = fbo;
+
+        glBindFramebuffer(target, fbo);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void forget_texture(GLuint texture)
+    {
+        for (uint32_t i = 0; i < MAX_CACHED_TEXTURE_UNITS; i++)
+        {
+            if (m_textures[i].texture == texture)
+                m_textures[i].texture = kUnknown;
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void forget_buffer(GLuint buffer)
+    {
+        for (uint32_t i = 0; i < NUM_CACHED_BUFFER_TARGETS; i++)
+        {
+            if (m_buffers[i] == buffer)
+                m_buffers[i] = kUnknown;
+        }
+
+        for (uint32_t i = 0; i < NUM_INDEXED_BUFFER_TARGETS; i++)
+        {
+            for (uint32_t j = 0; j < MAX_CACHED_BUFFER_BINDINGS; j++)
+            {
+                if (m_indexed_buffers[i][j].buffer == buffer)
+                    m_indexed_buffers[i][j].buffer = kUnknown;
+            }
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void forget_program(GLuint program)
+    {
+        if (m_program == program)
+            m_program = kUnknown;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void forget_vertex_array(GLuint vao)
+    {
+        if (m_vertex_array == vao)
+        {
+            m_vertex_array = kUnknown;
+            m_buffers[buffer_target_index(GL_ELEMENT_ARRAY_BUFFER)] = kUnknown;
+        }
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void forget_framebuffer(GLuint fbo)
+    {
+        if (m_draw_framebuffer == fbo)
+            m_draw_framebuffer = kUnknown;
+
+        if (m_read_framebuffer == fbo)
+            m_read_framebuffer = kUnknown;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool check(const char* name, uint32_t cached, GLint actual)
+    {
+        if (cached == kUnknown || cached == (uint32_t)actual)
+            return true;
+
+        NIMBLE_LOG_ERROR("State cache mismatch for " + std::string(name) + ": cached " + std::to_string(cached) + ", actual " + std::to_string(actual));
+        return false;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool validate_capability(uint32_t idx)
+    {
+        return check("capability", m_capabilities[idx], glIsEnabled(kCachedCapabilities[idx]));
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool validate_blend()
+    {
+        GLint values[5];
+
+        glGetIntegerv(GL_BLEND_SRC_RGB, &values[0]);
+        glGetIntegerv(GL_BLEND_DST_RGB, &values[1]);
+        glGetIntegerv(GL_BLEND_SRC_ALPHA, &values[2]);
+        glGetIntegerv(GL_BLEND_DST_ALPHA, &values[3]);
+        glGetIntegerv(GL_BLEND_EQUATION_RGB, &values[4]);
+
+        bool valid = true;
+
+        for (uint32_t i = 0; i < 4; i++)
+            valid &= check("blend func", m_blend_func[i], values[i]);
+
+        valid &= check("blend equation", m_blend_equation, values[4]);
+
+        return valid;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool validate_depth()
+    {
+        GLint     func;
+        GLboolean mask;
+
+        glGetIntegerv(GL_DEPTH_FUNC, &func);
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &mask);
+
+        bool valid = check("depth func", m_depth_func, func);
+        valid &= check("depth mask", m_depth_mask, mask);
+
+        return valid;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool validate_raster()
+    {
+        GLint     cull_face;
+        GLint     front_face;
+        GLint     viewport[4];
+        GLboolean color_mask[4];
+
+        glGetIntegerv(GL_CULL_FACE_MODE, &cull_face);
+        glGetIntegerv(GL_FRONT_FACE, &front_face);
+        glGetIntegerv(GL_VIEWPORT, &viewport[0]);
+        glGetBooleanv(GL_COLOR_WRITEMASK, &color_mask[0]);
+
+        bool valid = check("cull face", m_cull_face, cull_face);
+        valid &= check("front face", m_front_face, front_face);
+
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            valid &= check("color mask", m_color_mask[i], color_mask[i]);
+
+            if (m_viewport_valid)
+                valid &= check("viewport", m_viewport[i], viewport[i]);
+        }
+
+        return valid;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool validate_program()
+    {
+        GLint program;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+
+        return check("program", m_program, program);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool validate_texture_unit(uint32_t unit)
+    {
+        const TextureBinding& binding = m_textures[unit];
+
+        if (binding.texture == kUnknown)
+            return true;
+
+        GLint active;
+        GLint texture;
+
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &active);
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glGetIntegerv(texture_binding_for_target(binding.target), &texture);
+        glActiveTexture(active);
+
+        return check("texture unit", binding.texture, texture);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool validate_buffer(uint32_t idx)
+    {
+        GLint buffer;
+        glGetIntegerv(kCachedBufferTargetBindings[idx], &buffer);
+
+        return check("buffer", m_buffers[idx], buffer);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool validate_vertex_array()
+    {
+        GLint vao;
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+
+        return check("vertex array", m_vertex_array, vao);
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool validate_framebuffer()
+    {
+        GLint draw;
+        GLint read;
+
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &draw);
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read);
+
+        bool valid = check("draw framebuffer", m_draw_framebuffer, draw);
+        valid &= check("read framebuffer", m_read_framebuffer, read);
+
+        return valid;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    bool validate()
+    {
+        bool valid = true;
+
+        for (uint32_t i = 0; i < NUM_CACHED_CAPABILITIES; i++)
+            valid &= validate_capability(i);
+
+        for (uint32_t i = 0; i < MAX_CACHED_TEXTURE_UNITS; i++)
+            valid &= validate_texture_unit(i);
+
+        for (uint32_t i = 0; i < NUM_CACHED_BUFFER_TARGETS; i++)
+            valid &= validate_buffer(i);
+
+        valid &= validate_blend();
+        valid &= validate_depth();
+        valid &= validate_raster();
+        valid &= validate_program();
+        valid &= validate_vertex_array();
+        valid &= validate_framebuffer();
+
+        return valid;
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    void ui()
+    {
+        uint32_t total_issued   = 0;
+        uint32_t total_filtered = 0;
+
+        ImGui::Columns(3);
+        ImGui::Text("Category");
+        ImGui::NextColumn();
+        ImGui::Text("Issued");
+        ImGui::NextColumn();
+        ImGui::Text("Filtered");
+        ImGui::NextColumn();
+        ImGui::Separator();
+
+        for (uint32_t i = 0; i < STATE_CATEGORY_COUNT; i++)
+        {
+            ImGui::Text("%s", kCategoryNames[i]);
+            ImGui::NextColumn();
+            ImGui::Text("%u", m_last_frame_counters.issued[i]);
+            ImGui::NextColumn();
+            ImGui::Text("%u", m_last_frame_counters.filtered[i]);
+            ImGui::NextColumn();
+
+            total_issued += m_last_frame_counters.issued[i];
+            total_filtered += m_last_frame_counters.filtered[i];
+        }
+
+        ImGui::Separator();
+        ImGui::Text("Total");
+        ImGui::NextColumn();
+        ImGui::Text("%u", total_issued);
+        ImGui::NextColumn();
+        ImGui::Text("%u", total_filtered);
+        ImGui::NextColumn();
+        ImGui::Columns(1);
+
+#ifdef NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+        ImGui::Text("Validation: Enabled");
+#else
+        ImGui::Text("Validation: Disabled");
+#endif
+    }
+
+    // -----------------------------------------------------------------------------------------------------------------------------------
+
+    uint32_t             m_capabilities[NUM_CACHED_CAPABILITIES];
+    uint32_t             m_blend_func[4];
+    uint32_t             m_blend_equation;
+    uint32_t             m_depth_func;
+    uint32_t             m_depth_mask;
+    uint32_t             m_cull_face;
+    uint32_t             m_front_face;
+    uint32_t             m_color_mask[4];
+    bool                 m_viewport_valid;
+    GLint                m_viewport[4];
+    bool                 m_clear_color_valid;
+    GLfloat              m_clear_color[4];
+    uint32_t             m_program;
+    uint32_t             m_active_texture;
+    TextureBinding       m_textures[MAX_CACHED_TEXTURE_UNITS];
+    uint32_t             m_buffers[NUM_CACHED_BUFFER_TARGETS];
+    IndexedBufferBinding m_indexed_buffers[NUM_INDEXED_BUFFER_TARGETS][MAX_CACHED_BUFFER_BINDINGS];
+    uint32_t             m_vertex_array;
+    uint32_t             m_draw_framebuffer;
+    uint32_t             m_read_framebuffer;
+    Counters             m_counters;
+    Counters             m_last_frame_counters;
+};
+
+// The cache has static storage since GL objects may be created and bound before the application finishes initializing.
+static StateCache g_state_cache;
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void invalidate()
+{
+    g_state_cache.invalidate();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void begin_frame()
+{
+    g_state_cache.begin_frame();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+bool validate()
+{
+    return g_state_cache.validate();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+const Counters& last_frame_counters()
+{
+    return g_state_cache.m_last_frame_counters;
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void ui()
+{
+    g_state_cache.ui();
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void enable(GLenum cap)
+{
+    g_state_cache.set_capability(cap, true);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void disable(GLenum cap)
+{
+    g_state_cache.set_capability(cap, false);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void blend_func(GLenum sfactor, GLenum dfactor)
+{
+    g_state_cache.blend_func_separate(sfactor, dfactor, sfactor, dfactor);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void blend_func_separate(GLenum src_rgb, GLenum dst_rgb, GLenum src_alpha, GLenum dst_alpha)
+{
+    g_state_cache.blend_func_separate(src_rgb, dst_rgb, src_alpha, dst_alpha);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void blend_equation(GLenum mode)
+{
+    g_state_cache.blend_equation(mode);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void depth_func(GLenum func)
+{
+    g_state_cache.depth_func(func);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void depth_mask(GLboolean flag)
+{
+    g_state_cache.depth_mask(flag);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void cull_face(GLenum mode)
+{
+    g_state_cache.cull_face(mode);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void front_face(GLenum mode)
+{
+    g_state_cache.front_face(mode);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void color_mask(GLboolean r, GLboolean g, GLboolean b, GLboolean a)
+{
+    g_state_cache.color_mask(r, g, b, a);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    g_state_cache.viewport(x, y, width, height);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void clear_color(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+    g_state_cache.clear_color(r, g, b, a);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void use_program(GLuint program)
+{
+    g_state_cache.use_program(program);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void active_texture(uint32_t unit)
+{
+    g_state_cache.active_texture(unit);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void bind_texture(GLenum target, GLuint texture)
+{
+    g_state_cache.bind_texture(target, texture);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void bind_texture(uint32_t unit, GLenum target, GLuint texture)
+{
+    g_state_cache.bind_texture(unit, target, texture);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void bind_textures(uint32_t first, uint32_t count, const GLenum* targets, const GLuint* textures)
+{
+    g_state_cache.bind_textures(first, count, targets, textures);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void bind_buffer(GLenum target, GLuint buffer)
+{
+    g_state_cache.bind_buffer(target, buffer);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void bind_buffer_base(GLenum target, uint32_t index, GLuint buffer)
+{
+    g_state_cache.bind_buffer_range(target, index, buffer, 0, -1, true);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void bind_buffer_range(GLenum target, uint32_t index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    g_state_cache.bind_buffer_range(target, index, buffer, offset, size, false);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void bind_vertex_array(GLuint vao)
+{
+    g_state_cache.bind_vertex_array(vao);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void bind_framebuffer(GLenum target, GLuint fbo)
+{
+    g_state_cache.bind_framebuffer(target, fbo);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void forget_texture(GLuint texture)
+{
+    g_state_cache.forget_texture(texture);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void forget_buffer(GLuint buffer)
+{
+    g_state_cache.forget_buffer(buffer);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void forget_program(GLuint program)
+{
+    g_state_cache.forget_program(program);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void forget_vertex_array(GLuint vao)
+{
+    g_state_cache.forget_vertex_array(vao);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void forget_framebuffer(GLuint fbo)
+{
+    g_state_cache.forget_framebuffer(fbo);
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+} // namespace state_cache
+} // namespace nimble
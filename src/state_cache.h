@@ -0,0 +1,89 @@
+#pragma once
+
+#include "glad.h"
+#include <stdint.h>
+
+//#define NIMBLE_ENABLE_STATE_CACHE_VALIDATION
+// When enabled, every filtered call is checked against the real OpenGL state and mismatches are logged.
+
+#define MAX_CACHED_TEXTURE_UNITS 32
+#define MAX_CACHED_BUFFER_BINDINGS 16
+
+namespace nimble
+{
+namespace state_cache
+{
+enum StateCategory
+{
+    STATE_CATEGORY_CAPABILITY = 0,
+    STATE_CATEGORY_BLEND,
+    STATE_CATEGORY_DEPTH,
+    STATE_CATEGORY_RASTER,
+    STATE_CATEGORY_PROGRAM,
+    STATE_CATEGORY_TEXTURE,
+    STATE_CATEGORY_BUFFER,
+    STATE_CATEGORY_VERTEX_ARRAY,
+    STATE_CATEGORY_FRAMEBUFFER,
+    STATE_CATEGORY_COUNT
+};
+
+struct Counters
+{
+    uint32_t issued[STATE_CATEGORY_COUNT];
+    uint32_t filtered[STATE_CATEGORY_COUNT];
+};
+
+// Forget everything that is cached so that the next call of every kind reaches the driver. Must be called after code that
+// touches GL state without going through the cache.
+extern void invalidate();
+
+// Rotates the per-frame counters and invalidates the cache.
+extern void begin_frame();
+
+// Compares the entire shadow state against the real OpenGL state and logs every mismatch.
+extern bool validate();
+
+extern const Counters& last_frame_counters();
+extern void            ui();
+
+// Capabilities.
+extern void enable(GLenum cap);
+extern void disable(GLenum cap);
+
+// Blend state.
+extern void blend_func(GLenum sfactor, GLenum dfactor);
+extern void blend_func_separate(GLenum src_rgb, GLenum dst_rgb, GLenum src_alpha, GLenum dst_alpha);
+extern void blend_equation(GLenum mode);
+
+// Depth state.
+extern void depth_func(GLenum func);
+extern void depth_mask(GLboolean flag);
+
+// Rasterizer state.
+extern void cull_face(GLenum mode);
+extern void front_face(GLenum mode);
+extern void color_mask(GLboolean r, GLboolean g, GLboolean b, GLboolean a);
+extern void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+extern void clear_color(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+
+// Object bindings.
+extern void use_program(GLuint program);
+extern void active_texture(uint32_t unit);
+extern void bind_texture(GLenum target, GLuint texture);
+extern void bind_texture(uint32_t unit, GLenum target, GLuint texture);
+// Binds consecutive texture units in a single call where supported. A texture of 0 unbinds the unit.
+extern void bind_textures(uint32_t first, uint32_t count, const GLenum* targets, const GLuint* textures);
+extern void bind_buffer(GLenum target, GLuint buffer);
+extern void bind_buffer_base(GLenum target, uint32_t index, GLuint buffer);
+extern void bind_buffer_range(GLenum target, uint32_t index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+extern void bind_vertex_array(GLuint vao);
+extern void bind_framebuffer(GLenum target, GLuint fbo);
+
+// Must be called right before an object is deleted since OpenGL silently unbinds deleted objects and recycles their names.
+extern void forget_texture(GLuint texture);
+extern void forget_buffer(GLuint buffer);
+extern void forget_program(GLuint program);
+extern void forget_vertex_array(GLuint vao);
+extern void forget_framebuffer(GLuint fbo);
+} // namespace state_cache
+} // namespace nimble
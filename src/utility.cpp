@@ -302,6 +302,40 @@ bool preprocess_shader(const std::string& path, const std::string& src, std::str
     return true;
 }
 
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void write_json_string(std::ostream& out, const char* str)
+{
+    out << '"';
+
+    for (const char* c = str; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            out << '\\' << *c;
+        else if (uint8_t(*c) >= 0x20)
+            out << *c;
+    }
+
+    out << '"';
+}
+
+// -----------------------------------------------------------------------------------------------------------------------------------
+
+void write_csv_string(std::ostream& out, const char* str)
+{
+    out << '"';
+
+    for (const char* c = str; *c; c++)
+    {
+        if (*c == '"')
+            out << '"';
+
+        out << *c;
+    }
+
+    out << '"';
+}
+
 // -----------------------------------------------------------------------------------------------------------------------------------
 } // namespace utility
 } // namespace nimble
\ No newline at end of file
@@ -41,5 +41,11 @@ extern std::string current_working_directory();
 
 // Changes the current working directory.
 extern void change_current_working_directory(std::string path);
+
+// Writes the string as a quoted JSON string. Quotes and backslashes are escaped and control characters dropped.
+extern void write_json_string(std::ostream& out, const char* str);
+
+// Writes the string as a quoted CSV field. Embedded quotes are doubled.
+extern void write_csv_string(std::ostream& out, const char* str);
 } // namespace utility
-} // namespace nimble
+} // namespace nimble
\ No newline at end of file